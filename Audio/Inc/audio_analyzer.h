@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file           : audio_analyzer.h
+  * @brief          : Loopback THD+N and frequency response analyzer
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Commissioning and QA of the analog chain without an external analyzer:
+  * an output is wired back to an input, the analyzer plays a sine on the
+  * output and measures what comes back. While it runs the DSP chain is
+  * bypassed, so the result covers DAC, ADC and the wiring between them.
+  * Channel gains and mutes still apply at the converters.
+  *
+  * Test frequencies are snapped to odd bins of the capture length, so
+  * every capture holds a whole number of cycles and no window is needed.
+  * Per point it reports:
+  *
+  *   level/phase   synchronous demodulation against the generator
+  *   THD+N         RMS left after subtracting the fitted fundamental
+  *                 and DC (an ideal notch), relative to the fundamental
+  *   harmonics     Goertzel on harmonics 2..10, relative to the fundamental
+  *
+  * The audio side only generates and copies samples. The analysis runs
+  * from the main loop in Analyzer_Service() slices while the tone holds.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __AUDIO_ANALYZER_H
+#define __AUDIO_ANALYZER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define ANALYZER_CAPTURE_SAMPLES    4096U       /* 85 ms, 11.7 Hz bins at 48 kHz */
+#define ANALYZER_MAX_POINTS         32U
+#define ANALYZER_HARMONICS          10U         /* Fundamental plus 2..10 */
+#define ANALYZER_FLOOR_DB           -200.0f     /* Reported for unmeasurable values */
+#define ANALYZER_SERVICE_CYCLES     20000U      /* Main loop slice */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Measurement modes
+  */
+typedef enum {
+  ANALYZER_MODE_STEPPED = 0,    /* Full analysis per point */
+  ANALYZER_MODE_SWEEP           /* Level and phase only, short settling */
+} Analyzer_Mode_TypeDef;
+
+/**
+  * @brief  Analyzer state
+  */
+typedef enum {
+  ANALYZER_IDLE = 0,
+  ANALYZER_SETTLING,            /* Tone playing, waiting for the loop to settle */
+  ANALYZER_CAPTURING,           /* Copying input samples */
+  ANALYZER_ANALYZING,           /* Capture complete, main loop crunching */
+  ANALYZER_DONE
+} Analyzer_State_TypeDef;
+
+/**
+  * @brief  Measurement setup
+  */
+typedef struct {
+  uint8_t mode;                 /* Analyzer_Mode_TypeDef */
+  uint8_t outputChannel;        /* Generator output */
+  uint8_t inputChannel;         /* Loopback input */
+  uint8_t points;               /* Log-spaced points, 1 to ANALYZER_MAX_POINTS */
+  float startHz;
+  float stopHz;
+  float levelDb;                /* Generator level, dBFS */
+  float settleMs;               /* Wait after each frequency change */
+} Analyzer_Config_TypeDef;
+
+/**
+  * @brief  Result of one test frequency
+  */
+typedef struct {
+  float frequency;              /* Actual (bin-snapped) frequency, Hz */
+  float levelDb;                /* Input fundamental relative to the generator */
+  float phaseDeg;               /* Includes the loopback latency */
+  float thdnDb;                 /* THD+N relative to the fundamental */
+  float harmonicDb[ANALYZER_HARMONICS - 1U];  /* Harmonics 2..10, dBc */
+} Analyzer_Point_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void Analyzer_GetDefaultConfig(Analyzer_Config_TypeDef *config);
+HAL_StatusTypeDef Analyzer_Start(const Analyzer_Config_TypeDef *config);
+void Analyzer_Stop(void);
+uint8_t Analyzer_IsActive(void);
+Analyzer_State_TypeDef Analyzer_GetState(void);
+
+/* Audio side, replaces the DSP chain while active */
+void Analyzer_ProcessFrame(const AudioBuffer_TypeDef *input, AudioBuffer_TypeDef *output);
+
+/* Main loop side */
+Analyzer_State_TypeDef Analyzer_Service(uint32_t budgetCycles);
+uint8_t Analyzer_GetPointCount(void);
+HAL_StatusTypeDef Analyzer_GetPoint(uint8_t index, Analyzer_Point_TypeDef *point);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_ANALYZER_H */
@@ -39,9 +39,14 @@ extern "C" {
 #define AUDIO_OUTPUT_CHANNELS     4U             /* Number of output channels */
 
 /* RMS calculation parameters */
-#define AUDIO_RMS_WINDOW_SIZE     32U            /* RMS window size in samples */
+#define AUDIO_RMS_WINDOW_SIZE     AUDIO_FRAME_SIZE  /* Whole frame, the health check needs every sample */
 #define AUDIO_RMS_DECAY           0.9f           /* Decay factor for RMS smoothing */
 
+/* Master volume, applied with the output gains in the int24 conversion */
+#define AUDIO_MASTER_STEP_DB      0.5f           /* Volume resolution */
+#define AUDIO_MASTER_MIN_DB       -80.0f         /* At or below this the outputs are muted */
+#define AUDIO_GAIN_SMOOTH_MS      10.0f          /* Output gain glide time constant */
+
 /* Exported types ------------------------------------------------------------*/
 typedef struct {
     float channels[AUDIO_INPUT_CHANNELS][AUDIO_BUFFER_SIZE];   /* Input/Output channel buffer */
@@ -58,6 +63,10 @@ typedef struct {
     uint32_t sampleRate;
     uint32_t inputUnderflows;
     uint32_t outputOverflows;
+    uint32_t lateFrames;              /* DMA reached a half the CPU still owned */
+    uint32_t droppedFrames;           /* Capture not taken / output replayed */
+    int32_t dacSkewSamples;           /* I2S4 lead over I2S3 at the last start */
+    float masterVolumeDb;             /* Quantized to AUDIO_MASTER_STEP_DB */
     float inputGain[AUDIO_INPUT_CHANNELS];
     float outputGain[AUDIO_OUTPUT_CHANNELS];
     uint8_t inputMute[AUDIO_INPUT_CHANNELS];
@@ -78,6 +87,8 @@ HAL_StatusTypeDef Audio_SetInputGain(uint8_t channel, float gain);
 HAL_StatusTypeDef Audio_SetOutputGain(uint8_t channel, float gain);
 HAL_StatusTypeDef Audio_MuteInput(uint8_t channel, uint8_t state);
 HAL_StatusTypeDef Audio_MuteOutput(uint8_t channel, uint8_t state);
+HAL_StatusTypeDef Audio_SetMasterVolume(float volumeDb);
+float Audio_GetMasterVolume(void);
 
 void Audio_ProcessCallback(void);  /* DMA callback for audio processing */
 float Audio_CalculateRMS(uint8_t channel, AudioBuffer_TypeDef *buffer);
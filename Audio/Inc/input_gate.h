@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file           : input_gate.h
+  * @brief          : Input noise gate / downward expander
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Per-input gate ahead of the routing matrix so idle inputs stop feeding
+  * hiss into every output. Detection runs once per frame on the block peak
+  * and the gain is ramped across the frame, leaving one multiply per sample.
+  * When every input is closed to silence long enough for the DSP chain to
+  * flush, InputGate_IsSilent() lets the pipeline skip processing.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __INPUT_GATE_H
+#define __INPUT_GATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define INPUT_GATE_RATIO_GATE       100.0f    /* Ratios from here on act as a hard gate */
+#define INPUT_GATE_MUTE_DB          -90.0f    /* Range at or below closes to exact silence */
+#define INPUT_GATE_SILENCE_MS       250U      /* Closed time before the chain is skipped */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Gate state
+  */
+typedef enum {
+  INPUT_GATE_OPEN = 0,
+  INPUT_GATE_HOLD,
+  INPUT_GATE_CLOSED
+} InputGate_State_TypeDef;
+
+/**
+  * @brief  Gate parameters of one input
+  * @note   The gate opens at thresholdDb and closes below
+  *         thresholdDb - hysteresisDb after holdMs. While closed the gain
+  *         follows (ratio - 1) dB per dB below the close threshold,
+  *         limited to rangeDb.
+  */
+typedef struct {
+  float thresholdDb;            /* Open threshold (block peak, dBFS) */
+  float hysteresisDb;           /* Close threshold offset below thresholdDb */
+  float ratio;                  /* Expansion ratio, >= INPUT_GATE_RATIO_GATE for a gate */
+  float rangeDb;                /* Maximum attenuation */
+  float attackMs;               /* Opening time */
+  float holdMs;                 /* Time kept open after the signal drops */
+  float releaseMs;              /* Closing time */
+  uint8_t enabled;
+} InputGate_Params_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void InputGate_Init(float sampleRate);
+HAL_StatusTypeDef InputGate_SetParams(uint8_t channel, const InputGate_Params_TypeDef *params);
+HAL_StatusTypeDef InputGate_GetParams(uint8_t channel, InputGate_Params_TypeDef *params);
+HAL_StatusTypeDef InputGate_SetEnabled(uint8_t channel, uint8_t enabled);
+InputGate_State_TypeDef InputGate_GetState(uint8_t channel);
+float InputGate_GetGainDb(uint8_t channel);
+uint8_t InputGate_IsClosed(uint8_t channel);
+uint8_t InputGate_IsSilent(void);
+void InputGate_Process(AudioBuffer_TypeDef *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INPUT_GATE_H */
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file           : input_strip.h
+  * @brief          : Per-input processing strip ahead of the routing matrix
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Corrections that belong to a source (subsonic high-pass, input EQ,
+  * input alignment, polarity) run once per input here instead of once
+  * per output the input is routed to. The high-pass and EQ sections of
+  * an input are compiled into one biquad cascade and the polarity is the
+  * cascade's output gain, so an input with nothing set costs nothing.
+  *
+  * The delay is an alignment setting, it is not reported to the latency
+  * manager (which would compensate it away on the other outputs).
+  *
+  ******************************************************************************
+  */
+
+#ifndef __INPUT_STRIP_H
+#define __INPUT_STRIP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include "coeff_batch.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define INPUT_STRIP_BANDS           4U        /* EQ bands per input */
+#define INPUT_STRIP_HPF_MIN_HZ      10.0f
+#define INPUT_STRIP_HPF_MAX_HZ      500.0f
+#define INPUT_STRIP_MAX_DELAY_MS    10.0f
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  One EQ band of an input
+  */
+typedef struct {
+  uint8_t type;                 /* CoeffBatch_Type_TypeDef */
+  float frequency;              /* Hz */
+  float gainDb;                 /* Bell and shelf gain */
+  float q;                      /* Q, shelf slope for shelves */
+  uint8_t enabled;
+} InputStrip_Band_TypeDef;
+
+/**
+  * @brief  Strip settings of one input
+  */
+typedef struct {
+  float hpfFrequency;           /* Butterworth high-pass corner, 0 = off */
+  uint8_t hpfOrder;             /* 2 (12 dB/oct) or 4 (24 dB/oct) */
+  InputStrip_Band_TypeDef bands[INPUT_STRIP_BANDS];
+  float delayMs;                /* 0 to INPUT_STRIP_MAX_DELAY_MS */
+  uint8_t invert;               /* 1 to invert polarity */
+} InputStrip_Params_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void InputStrip_Init(float sampleRate);
+HAL_StatusTypeDef InputStrip_SetParams(uint8_t channel, const InputStrip_Params_TypeDef *params);
+HAL_StatusTypeDef InputStrip_GetParams(uint8_t channel, InputStrip_Params_TypeDef *params);
+HAL_StatusTypeDef InputStrip_SetHighPass(uint8_t channel, float frequency, uint8_t order);
+HAL_StatusTypeDef InputStrip_SetBand(uint8_t channel, uint8_t band, const InputStrip_Band_TypeDef *config);
+HAL_StatusTypeDef InputStrip_SetDelay(uint8_t channel, float delayMs);
+HAL_StatusTypeDef InputStrip_SetInvert(uint8_t channel, uint8_t invert);
+void InputStrip_Reset(uint8_t channel);
+void InputStrip_Process(AudioBuffer_TypeDef *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INPUT_STRIP_H */
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file           : level_stats.h
+  * @brief          : Per-channel peak histogram, crest factor and clip counts
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Gain staging needs more than the smoothed RMS of the VU meter: how the
+  * block peaks of an output are spread, how close to full scale it sits
+  * and how much headroom the program has over its RMS. The statistics are
+  * fed from the DAC conversion loop with the peak, sum of squares and clip
+  * count of the samples after output gain and master volume, so a block
+  * costs a table lookup, a multiply and an increment for the histogram,
+  * and a few float ops for the crest.
+  *
+  * The peak goes into a 1 dB bin straight from its float bits: the
+  * exponent gives whole octaves, the top mantissa bits index a small
+  * table with the fraction, and one multiply turns octaves into dB. No log
+  * is evaluated per block.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __LEVEL_STATS_H
+#define __LEVEL_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define LEVELSTATS_BINS             96U         /* 1 dB bins below full scale, the last one takes all quieter blocks */
+#define LEVELSTATS_NEAR_CLIP_DB     3U          /* Peaks within this of full scale count as near clip */
+#define LEVELSTATS_CREST_TIME_MS    3000U       /* Window of the running RMS and peak */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Summary of one channel since its last reset
+  */
+typedef struct {
+  uint32_t blocks;              /* Metered blocks */
+  uint32_t clipBlocks;          /* Blocks with a sample at or over full scale */
+  uint32_t clipSamples;         /* Samples at or over full scale */
+  float nearClipPercent;        /* Blocks peaking within LEVELSTATS_NEAR_CLIP_DB of full scale */
+  float peakMaxDb;              /* Loudest block peak, dBFS */
+  float rmsDb;                  /* Running RMS, dBFS */
+  float crestDb;                /* Running peak over running RMS */
+} LevelStats_Summary_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void LevelStats_Init(float sampleRate);
+void LevelStats_Update(uint8_t channel, float peak, float sumSquares, uint32_t clips);
+void LevelStats_Reset(void);
+void LevelStats_GetSummary(uint8_t channel, LevelStats_Summary_TypeDef *summary);
+void LevelStats_GetHistogram(uint8_t channel, uint32_t bins[LEVELSTATS_BINS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LEVEL_STATS_H */
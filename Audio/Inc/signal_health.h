@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : signal_health.h
+  * @brief          : Per-channel clip, NaN/Inf and runaway monitor
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * A NaN or an unstable filter never leaves a recursive state by itself,
+  * and the int24 conversion clamps it to full-scale DC. The monitor rides
+  * on the output meter: the RMS sum is already there, a NaN or Inf
+  * anywhere in the frame poisons it, and the same loop adds the peak and
+  * the clip count. That costs a few hundred cycles per frame, so it is
+  * always on.
+  *
+  * A bad output frame is muted and the channel is probed on the next
+  * frame: HEALTH_PROBE() after every stage finds the first stage whose
+  * output is bad. That stage and the stateful stages after it (which saw
+  * its output) are reset; stages before it keep their state. Each fault
+  * is logged as an event.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __SIGNAL_HEALTH_H
+#define __SIGNAL_HEALTH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define HEALTH_RUNAWAY_LEVEL        1000.0f     /* +60 dBFS, only an unstable stage gets here */
+#define HEALTH_CLIP_LEVEL           1.0f        /* Full scale of the DAC conversion */
+#define HEALTH_EVENT_COUNT          8U          /* Fault events kept */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Probe points in the per-channel chain, in processing order
+  */
+typedef enum {
+  HEALTH_STAGE_CROSSOVER = 0,
+  HEALTH_STAGE_EQ,
+  HEALTH_STAGE_FIR,
+  HEALTH_STAGE_COMPRESSOR,
+  HEALTH_STAGE_LIMITER,
+  HEALTH_STAGE_DELAY,
+  HEALTH_STAGE_OUTPUT,          /* After the gain stage, checked every frame */
+  HEALTH_STAGE_COUNT
+} Health_Stage_TypeDef;
+
+/**
+  * @brief  One detected fault
+  */
+typedef struct {
+  uint32_t tick;                /* HAL_GetTick() at detection */
+  uint8_t channel;
+  uint8_t stage;                /* Health_Stage_TypeDef that was reset first */
+  uint8_t nonFinite;            /* 1 for NaN/Inf, 0 for a runaway level */
+} Health_Event_TypeDef;
+
+/**
+  * @brief  Counters of one channel
+  */
+typedef struct {
+  uint32_t faults;              /* Bad output frames */
+  uint32_t resets[HEALTH_STAGE_COUNT];
+  uint32_t clips[HEALTH_STAGE_COUNT];   /* Samples at or over full scale per tap */
+} Health_Stats_TypeDef;
+
+/* Exported macros -----------------------------------------------------------*/
+/* Stage tap; costs one bit test unless the channel is being probed */
+#define HEALTH_PROBE(mask, ch, stage, data) \
+  do { if ((mask) & (1UL << (ch))) { Health_Probe((ch), (stage), (data)); } } while (0)
+
+/* Exported functions --------------------------------------------------------*/
+void Health_Init(void);
+uint32_t Health_BeginFrame(void);
+void Health_Probe(uint8_t channel, Health_Stage_TypeDef stage, float *data);
+uint8_t Health_CheckOutput(uint8_t channel, float *data, float sumSquares, float peak, uint32_t clips);
+void Health_SetStageProbes(uint8_t enable);
+void Health_GetStats(uint8_t channel, Health_Stats_TypeDef *stats);
+uint8_t Health_GetEvent(uint8_t index, Health_Event_TypeDef *event);
+const char *Health_GetStageName(Health_Stage_TypeDef stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIGNAL_HEALTH_H */
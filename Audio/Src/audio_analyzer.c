@@ -0,0 +1,528 @@
+/**
+  ******************************************************************************
+  * @file           : audio_analyzer.c
+  * @brief          : Loopback THD+N and frequency response analyzer
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The generator and the demodulation reference are rotating phasors
+  * (one complex multiply per sample, renormalized per block), so neither
+  * side calls sinf() per sample. Because the bin is odd and the capture
+  * length a power of two, every sample of a capture lands on a different
+  * phase of the sine, which exercises the converters at all codes the
+  * tone passes through.
+  *
+  * The capture is analyzed in passes over ANALYZER_CHUNK samples each:
+  * demodulation (fundamental and DC), residual after removing both, then
+  * the harmonic Goertzel filters. Sweep mode stops after the first pass.
+  * The Goertzel filters use Reinsch's form (state plus first difference):
+  * with the plain 2cos(w) recurrence, float loses low harmonics to
+  * rounding long before 4096 samples.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_analyzer.h"
+#include "mem_plan.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define ANALYZER_CHUNK              256U        /* Samples per unit of analysis work */
+#define ANALYZER_PI                 3.14159265f
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  ANALYZER_PASS_DEMOD = 0,
+  ANALYZER_PASS_RESIDUAL,
+  ANALYZER_PASS_HARMONICS,
+  ANALYZER_PASS_FINISH
+} Analyzer_Pass_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static Analyzer_Config_TypeDef job;
+static volatile Analyzer_State_TypeDef state = ANALYZER_IDLE;
+
+static float *capture;                  /* Overlay in the memory plan, MEASURE mode */
+static uint32_t captureCount;
+static uint32_t settleFrames;
+static uint32_t settleCounter;
+
+static uint16_t bins[ANALYZER_MAX_POINTS];
+static uint8_t pointTotal;
+static uint8_t pointIndex;
+static Analyzer_Point_TypeDef points[ANALYZER_MAX_POINTS];
+
+/* Generator */
+static float amplitude;
+static float genCos, genSin;                    /* Phasor, output is genSin */
+static float stepCos, stepSin;                  /* Rotation per sample */
+static float startCos, startSin;                /* Phasor at the first captured sample */
+
+/* Analysis of the current capture */
+static Analyzer_Pass_TypeDef pass;
+static uint32_t cursor;
+static float refCos, refSin;
+static float sumI, sumQ, sumDc, sumResidual;
+static float fundCos, fundSin, dcLevel;         /* Fitted a*cos + b*sin + dc */
+static float goertzelLambda[ANALYZER_HARMONICS - 1U];   /* -4 sin^2(w/2) */
+static float goertzelS[ANALYZER_HARMONICS - 1U];
+static float goertzelD[ANALYZER_HARMONICS - 1U];        /* s[n] - s[n-1] */
+static uint8_t harmonicCount;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t Analyzer_PlanBins(void);
+static void Analyzer_BeginPoint(void);
+static void Analyzer_BeginPass(Analyzer_Pass_TypeDef next);
+static void Analyzer_RunChunk(void);
+static void Analyzer_FinishPoint(void);
+static float Analyzer_RatioDb(float power, float reference);
+
+/**
+  * @brief  Fill a configuration with production test defaults
+  * @param  config: Configuration to fill
+  * @retval None
+  */
+void Analyzer_GetDefaultConfig(Analyzer_Config_TypeDef *config)
+{
+  if (config == NULL) {
+    return;
+  }
+
+  config->mode = ANALYZER_MODE_STEPPED;
+  config->outputChannel = 0;
+  config->inputChannel = 0;
+  config->points = 11;
+  config->startHz = 20.0f;
+  config->stopHz = 20000.0f;
+  config->levelDb = -3.0f;
+  config->settleMs = 100.0f;
+}
+
+/**
+  * @brief  Start a measurement
+  * @note   The DSP chain is bypassed on every output until it completes
+  * @param  config: Measurement setup
+  * @retval HAL_StatusTypeDef: HAL_ERROR for an invalid setup, HAL_BUSY
+  *         while FIR filters hold the memory
+  */
+HAL_StatusTypeDef Analyzer_Start(const Analyzer_Config_TypeDef *config)
+{
+  if (config == NULL || config->outputChannel >= AUDIO_OUTPUT_CHANNELS ||
+      config->inputChannel >= AUDIO_INPUT_CHANNELS || config->points == 0 ||
+      config->points > ANALYZER_MAX_POINTS || config->startHz <= 0.0f ||
+      config->stopHz < config->startHz || config->levelDb > 0.0f) {
+    return HAL_ERROR;
+  }
+
+  Analyzer_Stop();
+
+  /* The capture shares its RAM with the FIR pool */
+  if (MemPlan_Enter(MEM_MODE_MEASURE) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  capture = (float *)MemPlan_GetBuffer(MEM_BUF_ANALYZER_CAPTURE);
+
+  job = *config;
+
+  if (!Analyzer_PlanBins()) {
+    return HAL_ERROR;
+  }
+
+  amplitude = powf(10.0f, job.levelDb / 20.0f);
+  settleFrames = (uint32_t)((job.settleMs * (float)AUDIO_SAMPLE_RATE) / (1000.0f * AUDIO_FRAME_SIZE)) + 1U;
+  genCos = 1.0f;
+  genSin = 0.0f;
+  pointIndex = 0;
+  memset(points, 0, sizeof(points));
+
+  Analyzer_BeginPoint();
+
+  DEBUG_PRINT("Analyzer: out %d -> in %d, %d points, %.1f dBFS\r\n",
+              job.outputChannel + 1, job.inputChannel + 1, pointTotal, job.levelDb);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Abort the measurement, points completed so far are kept
+  * @retval None
+  */
+void Analyzer_Stop(void)
+{
+  if (Analyzer_IsActive()) {
+    state = ANALYZER_DONE;
+  }
+}
+
+/**
+  * @brief  Check whether the analyzer owns the audio path
+  * @retval 1 while a measurement runs
+  */
+uint8_t Analyzer_IsActive(void)
+{
+  const Analyzer_State_TypeDef s = state;
+
+  return (s == ANALYZER_SETTLING || s == ANALYZER_CAPTURING || s == ANALYZER_ANALYZING) ? 1U : 0U;
+}
+
+/**
+  * @brief  Get the analyzer state
+  * @retval Analyzer_State_TypeDef
+  */
+Analyzer_State_TypeDef Analyzer_GetState(void)
+{
+  return state;
+}
+
+/**
+  * @brief  Generate the test tone and capture the loopback input
+  * @note   Replaces the DSP chain for the frame. Other outputs are silent.
+  * @param  input: Input frame from the ADC
+  * @param  output: Output frame for the DAC
+  * @retval None
+  */
+void Analyzer_ProcessFrame(const AudioBuffer_TypeDef *input, AudioBuffer_TypeDef *output)
+{
+  float *out = output->samples[job.outputChannel];
+  float c = genCos;
+  float s = genSin;
+  float norm;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    if (ch != job.outputChannel) {
+      memset(output->samples[ch], 0, AUDIO_FRAME_SIZE * sizeof(float));
+    }
+  }
+
+  if (state == ANALYZER_SETTLING && --settleCounter == 0U) {
+    /* Capture starts with this frame */
+    startCos = c;
+    startSin = s;
+    captureCount = 0;
+    state = ANALYZER_CAPTURING;
+  }
+
+  for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+    const float nc = c * stepCos - s * stepSin;
+
+    out[i] = amplitude * s;
+    s = c * stepSin + s * stepCos;
+    c = nc;
+  }
+
+  /* Keep the phasor on the unit circle */
+  norm = 1.5f - 0.5f * (c * c + s * s);
+  genCos = c * norm;
+  genSin = s * norm;
+
+  if (state == ANALYZER_CAPTURING) {
+    uint32_t count = ANALYZER_CAPTURE_SAMPLES - captureCount;
+
+    if (count > AUDIO_FRAME_SIZE) {
+      count = AUDIO_FRAME_SIZE;
+    }
+
+    memcpy(&capture[captureCount], input->samples[job.inputChannel], count * sizeof(float));
+    captureCount += count;
+
+    if (captureCount >= ANALYZER_CAPTURE_SAMPLES) {
+      Analyzer_BeginPass(ANALYZER_PASS_DEMOD);
+      state = ANALYZER_ANALYZING;
+    }
+  }
+}
+
+/**
+  * @brief  Analyze the finished capture
+  * @note   Call from the main loop. Does nothing unless a capture is
+  *         waiting; at least one chunk runs per call.
+  * @param  budgetCycles: CPU cycles this call may use
+  * @retval State after the slice
+  */
+Analyzer_State_TypeDef Analyzer_Service(uint32_t budgetCycles)
+{
+  const uint32_t start = DWT->CYCCNT;
+
+  while (state == ANALYZER_ANALYZING) {
+    Analyzer_RunChunk();
+
+    if ((DWT->CYCCNT - start) >= budgetCycles) {
+      break;
+    }
+  }
+
+  return state;
+}
+
+/**
+  * @brief  Number of points measured so far
+  * @retval Point count
+  */
+uint8_t Analyzer_GetPointCount(void)
+{
+  return pointIndex;
+}
+
+/**
+  * @brief  Get the result of one test frequency
+  * @param  index: Point, below Analyzer_GetPointCount()
+  * @param  point: Structure to fill
+  * @retval HAL_StatusTypeDef: HAL_ERROR if not measured yet
+  */
+HAL_StatusTypeDef Analyzer_GetPoint(uint8_t index, Analyzer_Point_TypeDef *point)
+{
+  if (point == NULL || index >= pointIndex) {
+    return HAL_ERROR;
+  }
+
+  *point = points[index];
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Snap the log-spaced test frequencies to odd capture bins
+  * @retval Number of distinct points, 0 if none fits below Nyquist
+  */
+static uint8_t Analyzer_PlanBins(void)
+{
+  const float binHz = (float)AUDIO_SAMPLE_RATE / (float)ANALYZER_CAPTURE_SAMPLES;
+  const float ratio = (job.points > 1U) ? powf(job.stopHz / job.startHz, 1.0f / (float)(job.points - 1U)) : 1.0f;
+  float f = job.startHz;
+  int32_t last = -1;
+
+  pointTotal = 0;
+
+  for (uint8_t i = 0; i < job.points; i++, f *= ratio) {
+    const float exact = f / binHz;
+    int32_t k = (int32_t)(exact + 0.5f);
+
+    if ((k & 1) == 0) {
+      k += ((float)k < exact) ? 1 : -1;
+    }
+    if (k < 1) {
+      k = 1;
+    }
+    if (i == 0U && (float)k < exact) {
+      k += 2;                   /* Stay at or above startHz */
+    }
+    if (k <= last) {
+      k = last + 2;
+    }
+    if (k >= (int32_t)(ANALYZER_CAPTURE_SAMPLES / 2U)) {
+      break;
+    }
+
+    bins[pointTotal++] = (uint16_t)k;
+    last = k;
+  }
+
+  return pointTotal;
+}
+
+/**
+  * @brief  Retune the generator to the next point and wait for settling
+  * @note   The phasor keeps running, so the step is phase continuous
+  * @retval None
+  */
+static void Analyzer_BeginPoint(void)
+{
+  const float w = 2.0f * ANALYZER_PI * (float)bins[pointIndex] / (float)ANALYZER_CAPTURE_SAMPLES;
+
+  stepCos = cosf(w);
+  stepSin = sinf(w);
+  settleCounter = settleFrames;
+  state = ANALYZER_SETTLING;
+}
+
+/**
+  * @brief  Reset the accumulators of an analysis pass
+  * @param  next: Pass to start
+  * @retval None
+  */
+static void Analyzer_BeginPass(Analyzer_Pass_TypeDef next)
+{
+  const uint32_t k = bins[pointIndex];
+
+  pass = next;
+  cursor = 0;
+  refCos = 1.0f;
+  refSin = 0.0f;
+
+  if (next == ANALYZER_PASS_DEMOD) {
+    sumI = 0.0f;
+    sumQ = 0.0f;
+    sumDc = 0.0f;
+  } else if (next == ANALYZER_PASS_RESIDUAL) {
+    sumResidual = 0.0f;
+  } else if (next == ANALYZER_PASS_HARMONICS) {
+    harmonicCount = 0;
+    for (uint32_t h = 2; h <= ANALYZER_HARMONICS && h * k < ANALYZER_CAPTURE_SAMPLES / 2U; h++) {
+      const float half = sinf(ANALYZER_PI * (float)(h * k) / (float)ANALYZER_CAPTURE_SAMPLES);
+
+      goertzelLambda[harmonicCount] = -4.0f * half * half;
+      goertzelS[harmonicCount] = 0.0f;
+      goertzelD[harmonicCount] = 0.0f;
+      harmonicCount++;
+    }
+  }
+}
+
+/**
+  * @brief  Run one chunk of the current pass
+  * @retval None
+  */
+static void Analyzer_RunChunk(void)
+{
+  const float *x = &capture[cursor];
+  uint32_t n = ANALYZER_CAPTURE_SAMPLES - cursor;
+  float c = refCos;
+  float s = refSin;
+  float norm;
+
+  if (pass == ANALYZER_PASS_FINISH) {
+    Analyzer_FinishPoint();
+    return;
+  }
+
+  if (n > ANALYZER_CHUNK) {
+    n = ANALYZER_CHUNK;
+  }
+
+  if (pass == ANALYZER_PASS_DEMOD || pass == ANALYZER_PASS_RESIDUAL) {
+    /* Partial sums per chunk keep the float error from growing with N */
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f;
+
+    for (uint32_t i = 0; i < n; i++) {
+      const float nc = c * stepCos - s * stepSin;
+
+      if (pass == ANALYZER_PASS_DEMOD) {
+        acc0 += x[i] * c;
+        acc1 += x[i] * s;
+        acc2 += x[i];
+      } else {
+        const float r = x[i] - dcLevel - fundCos * c - fundSin * s;
+        acc0 += r * r;
+      }
+
+      s = c * stepSin + s * stepCos;
+      c = nc;
+    }
+
+    norm = 1.5f - 0.5f * (c * c + s * s);
+    refCos = c * norm;
+    refSin = s * norm;
+
+    if (pass == ANALYZER_PASS_DEMOD) {
+      sumI += acc0;
+      sumQ += acc1;
+      sumDc += acc2;
+    } else {
+      sumResidual += acc0;
+    }
+  } else {
+    for (uint32_t i = 0; i < n; i++) {
+      for (uint8_t h = 0; h < harmonicCount; h++) {
+        goertzelD[h] += goertzelLambda[h] * goertzelS[h] + x[i];
+        goertzelS[h] += goertzelD[h];
+      }
+    }
+  }
+
+  cursor += n;
+
+  if (cursor < ANALYZER_CAPTURE_SAMPLES) {
+    return;
+  }
+
+  if (pass == ANALYZER_PASS_DEMOD) {
+    const float scale = 2.0f / (float)ANALYZER_CAPTURE_SAMPLES;
+
+    fundCos = sumI * scale;
+    fundSin = sumQ * scale;
+    dcLevel = sumDc / (float)ANALYZER_CAPTURE_SAMPLES;
+
+    Analyzer_BeginPass((job.mode == ANALYZER_MODE_SWEEP) ? ANALYZER_PASS_FINISH : ANALYZER_PASS_RESIDUAL);
+  } else if (pass == ANALYZER_PASS_RESIDUAL) {
+    Analyzer_BeginPass(ANALYZER_PASS_HARMONICS);
+  } else {
+    Analyzer_BeginPass(ANALYZER_PASS_FINISH);
+  }
+}
+
+/**
+  * @brief  Convert the accumulators into a result and move to the next point
+  * @retval None
+  */
+static void Analyzer_FinishPoint(void)
+{
+  Analyzer_Point_TypeDef *p = &points[pointIndex];
+  const float n = (float)ANALYZER_CAPTURE_SAMPLES;
+  const float fundPower = 0.5f * (fundCos * fundCos + fundSin * fundSin);
+  const float w = 2.0f * ANALYZER_PI * (float)bins[pointIndex] / n;
+  float phase;
+
+  p->frequency = (float)bins[pointIndex] * (float)AUDIO_SAMPLE_RATE / n;
+  p->levelDb = Analyzer_RatioDb(fundPower, 0.5f * amplitude * amplitude);
+
+  /* x = A sin(wn + theta) gives cos weight A sin(theta), sin weight A cos(theta) */
+  phase = atan2f(fundCos, fundSin) - atan2f(startSin, startCos);
+  phase = fmodf(phase + 3.0f * ANALYZER_PI, 2.0f * ANALYZER_PI) - ANALYZER_PI;
+  p->phaseDeg = phase * (180.0f / ANALYZER_PI);
+
+  if (job.mode == ANALYZER_MODE_SWEEP) {
+    p->thdnDb = ANALYZER_FLOOR_DB;
+    for (uint8_t h = 0; h < ANALYZER_HARMONICS - 1U; h++) {
+      p->harmonicDb[h] = ANALYZER_FLOOR_DB;
+    }
+  } else {
+    p->thdnDb = Analyzer_RatioDb(sumResidual / n, fundPower);
+
+    for (uint8_t h = 0; h < ANALYZER_HARMONICS - 1U; h++) {
+      if (h < harmonicCount) {
+        /* DFT bin from the last two states, s[N-1] and s[N-2] */
+        const float hw = w * (float)(h + 2U);
+        const float s1 = goertzelS[h];
+        const float s2 = goertzelS[h] - goertzelD[h];
+        const float re = s1 - cosf(hw) * s2;
+        const float im = sinf(hw) * s2;
+        const float amp = 2.0f * sqrtf(re * re + im * im) / n;
+
+        p->harmonicDb[h] = Analyzer_RatioDb(0.5f * amp * amp, fundPower);
+      } else {
+        p->harmonicDb[h] = ANALYZER_FLOOR_DB;
+      }
+    }
+  }
+
+  DEBUG_PRINT("Analyzer: %.1f Hz, %+.2f dB, %+.1f deg, THD+N %.1f dB\r\n",
+              p->frequency, p->levelDb, p->phaseDeg, p->thdnDb);
+
+  pointIndex++;
+
+  if (pointIndex < pointTotal && state == ANALYZER_ANALYZING) {
+    Analyzer_BeginPoint();
+  } else {
+    state = ANALYZER_DONE;
+  }
+}
+
+/**
+  * @brief  Power ratio in dB with a floor for silence
+  * @param  power: Measured power
+  * @param  reference: Reference power
+  * @retval 10*log10(power/reference), ANALYZER_FLOOR_DB at the floor
+  */
+static float Analyzer_RatioDb(float power, float reference)
+{
+  if (power <= 0.0f || reference <= 0.0f) {
+    return ANALYZER_FLOOR_DB;
+  }
+
+  return fmaxf(10.0f * log10f(power / reference), ANALYZER_FLOOR_DB);
+}
@@ -15,21 +15,29 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "audio_driver.h"
+#include "dma_slots.h"
+#include "param_snapshot.h"
+#include "signal_health.h"
+#include "level_stats.h"
+#include "latency_manager.h"
 #include "math_utils.h"
 #include "debug.h"
 #include <math.h>
 #include <string.h>
 
-/* Private typedef -----------------------------------------------------------*/
-typedef enum {
-    BUFFER_HALF = 0,
-    BUFFER_FULL
-} BufferState_TypeDef;
-
 /* Private define ------------------------------------------------------------*/
 /* DMA buffer sizes, each sample is 32-bit (24-bit audio in 32-bit container) */
 #define DMA_INPUT_BUFFER_SIZE     (AUDIO_BUFFER_SIZE * AUDIO_INPUT_CHANNELS)
-#define DMA_OUTPUT_BUFFER_SIZE    (AUDIO_BUFFER_SIZE * AUDIO_OUTPUT_CHANNELS)
+
+/* One stereo DAC per I2S: I2S3 plays outputs 1-2, I2S4 outputs 3-4 */
+#define AUDIO_DAC_COUNT           2U
+#define AUDIO_DAC_CHANNELS        2U
+#define DMA_DAC_BUFFER_SIZE       (AUDIO_BUFFER_SIZE * AUDIO_DAC_CHANNELS)
+
+/* One slot per DMA half, each holds one interleaved frame */
+#define DMA_SLOT_COUNT            2U
+#define DMA_INPUT_SLOT_WORDS      (DMA_INPUT_BUFFER_SIZE / DMA_SLOT_COUNT)
+#define DMA_OUTPUT_SLOT_WORDS     (DMA_DAC_BUFFER_SIZE / DMA_SLOT_COUNT)
 
 /* Private macro -------------------------------------------------------------*/
 #define FLOAT_TO_INT24(x)     ((int32_t)((x) * AUDIO_MAX_VALUE))
@@ -38,12 +46,11 @@ typedef enum {
 /* Private variables ---------------------------------------------------------*/
 /* DMA buffers for input and output */
 static int32_t inputDmaBuffer[DMA_INPUT_BUFFER_SIZE];
-static int32_t outputDmaBuffer[DMA_OUTPUT_BUFFER_SIZE];
+static int32_t dacDmaBuffer[AUDIO_DAC_COUNT][DMA_DAC_BUFFER_SIZE];
 
-/* Buffer management */
-static volatile BufferState_TypeDef inputBufferState = BUFFER_HALF;
-static volatile BufferState_TypeDef outputBufferState = BUFFER_HALF;
-static volatile uint8_t audioProcessingNeeded = 0;
+/* Ownership of the DMA halves; the I2S3 ring stands for both DACs */
+static DMA_Slots_TypeDef inputSlots;
+static DMA_Slots_TypeDef outputSlots;
 
 /* Driver status */
 static AudioDriverStatus_TypeDef audioStatus;
@@ -51,10 +58,20 @@ static AudioDriverStatus_TypeDef audioStatus;
 /* RMS calculation buffers */
 static float rmsValues[AUDIO_OUTPUT_CHANNELS] = {0.0f};
 
+/* Output gains as applied by the conversion loop, gliding to the published ones */
+static float outputGainNow[AUDIO_OUTPUT_CHANNELS];
+static float gainSmoothCoeff;
+
+/* Outputs the health check passed this frame, level statistics are taken
+   from them after the gain, in the conversion loop */
+static uint32_t levelStatsMask;
+
 /* Private function prototypes -----------------------------------------------*/
-static void Audio_ProcessInputSamples(uint32_t offset, AudioBuffer_TypeDef *buffer);
-static void Audio_PrepareOutputSamples(uint32_t offset, AudioBuffer_TypeDef *buffer);
+static void Audio_ProcessInputSamples(const int32_t *slot, AudioBuffer_TypeDef *buffer);
+static void Audio_PrepareOutputSamples(int32_t *dac1, int32_t *dac2, AudioBuffer_TypeDef *buffer);
+static void Audio_AlignOutputs(void);
 static void Audio_ResetBuffers(void);
+static void Audio_PublishGains(void);
 
 /**
   * @brief  Initialize audio driver and codec hardware
@@ -69,6 +86,11 @@ HAL_StatusTypeDef Audio_Init(void)
     audioStatus.sampleRate = AUDIO_SAMPLING_RATE;
     audioStatus.inputUnderflows = 0;
     audioStatus.outputOverflows = 0;
+    audioStatus.masterVolumeDb = 0.0f;
+    
+    /* One-pole glide per frame, stepped linearly across the frame */
+    gainSmoothCoeff = 1.0f - expf(-(float)AUDIO_FRAME_SIZE /
+                                  (AUDIO_GAIN_SMOOTH_MS * 0.001f * (float)audioStatus.sampleRate));
     
     /* Set default gains to 0dB (1.0) */
     for (uint8_t i = 0; i < AUDIO_INPUT_CHANNELS; i++) {
@@ -80,6 +102,7 @@ HAL_StatusTypeDef Audio_Init(void)
         audioStatus.outputGain[i] = 1.0f;
         audioStatus.outputMute[i] = 0;
     }
+    Audio_PublishGains();
     
     /* Initialize input codec (PCM1808) */
     status = PCM1808_Init();
@@ -125,6 +148,13 @@ HAL_StatusTypeDef Audio_Start(void)
         return status;
     }
     
+    /* Both streams start in slot 0, the CPU owns nothing yet */
+    DMA_Slots_Init(&inputSlots, inputDmaBuffer, DMA_INPUT_SLOT_WORDS, DMA_SLOT_COUNT, DMA_SLOTS_RX);
+    DMA_Slots_Init(&outputSlots, dacDmaBuffer[0], DMA_OUTPUT_SLOT_WORDS, DMA_SLOT_COUNT, DMA_SLOTS_TX);
+    
+    /* Outputs glide up from silence instead of starting with a step */
+    memset(outputGainNow, 0, sizeof(outputGainNow));
+    
     /* Start I2S DMA for receiving audio */
     status = HAL_I2S_Receive_DMA(&hi2s2, (uint16_t*)inputDmaBuffer, DMA_INPUT_BUFFER_SIZE);
     if (status != HAL_OK) {
@@ -132,13 +162,16 @@ HAL_StatusTypeDef Audio_Start(void)
         return status;
     }
     
-    /* Start I2S DMA for transmitting audio */
-    status = HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*)outputDmaBuffer, DMA_OUTPUT_BUFFER_SIZE);
+    /* Start both DAC streams in lockstep */
+    status = I2S_StartOutputsLockstep(dacDmaBuffer[0], dacDmaBuffer[1], DMA_DAC_BUFFER_SIZE);
     if (status != HAL_OK) {
         DEBUG_PRINT("I2S transmit DMA start failed\r\n");
         return status;
     }
     
+    /* Whatever skew is left goes to the latency manager */
+    Audio_AlignOutputs();
+    
     audioStatus.state = AUDIO_STATE_RUNNING;
     DEBUG_PRINT("Audio processing started\r\n");
     
@@ -164,6 +197,11 @@ HAL_StatusTypeDef Audio_Stop(void)
         return status;
     }
     
+    status = HAL_I2S_DMAStop(&hi2s4);
+    if (status != HAL_OK) {
+        return status;
+    }
+    
     /* Stop codecs */
     PCM1808_Stop();
     PCM5102A_Stop();
@@ -210,44 +248,70 @@ HAL_StatusTypeDef Audio_Resume(void)
 
 /**
   * @brief  Get input samples from DMA buffer
+  * @note   Converts straight out of the captured DMA half while the CPU
+  *         owns it, HAL_TIMEOUT means the stream wrapped into it meanwhile
   * @param  buffer: Pointer to audio buffer
   * @retval HAL status
   */
 HAL_StatusTypeDef Audio_GetInputSamples(AudioBuffer_TypeDef *buffer)
 {
-    uint32_t offset;
+    const int32_t *slot;
     
     if (audioStatus.state != AUDIO_STATE_RUNNING) {
         return HAL_ERROR;
     }
     
-    /* Determine which half of the buffer to process */
-    offset = (inputBufferState == BUFFER_HALF) ? 0 : (DMA_INPUT_BUFFER_SIZE / 2);
+    /* Take the half the ADC just finished */
+    slot = DMA_Slots_Acquire(&inputSlots);
+    if (slot == NULL) {
+        /* No new capture since the last frame */
+        memset(buffer, 0, sizeof(*buffer));
+        audioStatus.inputUnderflows++;
+        return HAL_BUSY;
+    }
     
     /* Process input samples - convert from int24 to float */
-    Audio_ProcessInputSamples(offset, buffer);
+    Audio_ProcessInputSamples(slot, buffer);
+    
+    /* Give it back to the stream */
+    if (!DMA_Slots_Release(&inputSlots)) {
+        return HAL_TIMEOUT;
+    }
     
     return HAL_OK;
 }
 
 /**
   * @brief  Send output samples to DMA buffer
+  * @note   Writes straight into the free DMA half. HAL_TIMEOUT means the
+  *         DAC reached that half before the frame was complete.
   * @param  buffer: Pointer to audio buffer
   * @retval HAL status
   */
 HAL_StatusTypeDef Audio_SendOutputSamples(AudioBuffer_TypeDef *buffer)
 {
-    uint32_t offset;
+    int32_t *slot;
     
     if (audioStatus.state != AUDIO_STATE_RUNNING) {
         return HAL_ERROR;
     }
     
-    /* Determine which half of the buffer to process */
-    offset = (outputBufferState == BUFFER_HALF) ? 0 : (DMA_OUTPUT_BUFFER_SIZE / 2);
+    /* Take the half the DAC plays next */
+    slot = DMA_Slots_Acquire(&outputSlots);
+    if (slot == NULL) {
+        /* Both halves already hold unplayed frames */
+        audioStatus.outputOverflows++;
+        levelStatsMask = 0;
+        return HAL_BUSY;
+    }
     
-    /* Prepare output samples - convert from float to int24 */
-    Audio_PrepareOutputSamples(offset, buffer);
+    /* Same half of the I2S4 buffer, both written in one pass */
+    Audio_PrepareOutputSamples(slot, &dacDmaBuffer[1][slot - dacDmaBuffer[0]], buffer);
+    
+    /* Queue it for the stream */
+    if (!DMA_Slots_Release(&outputSlots)) {
+        return HAL_TIMEOUT;
+    }
     
     return HAL_OK;
 }
@@ -265,6 +329,7 @@ HAL_StatusTypeDef Audio_SetInputGain(uint8_t channel, float gain)
     }
     
     audioStatus.inputGain[channel] = gain;
+    Audio_PublishGains();
     return HAL_OK;
 }
 
@@ -281,6 +346,7 @@ HAL_StatusTypeDef Audio_SetOutputGain(uint8_t channel, float gain)
     }
     
     audioStatus.outputGain[channel] = gain;
+    Audio_PublishGains();
     return HAL_OK;
 }
 
@@ -297,6 +363,7 @@ HAL_StatusTypeDef Audio_MuteInput(uint8_t channel, uint8_t state)
     }
     
     audioStatus.inputMute[channel] = state ? 1 : 0;
+    Audio_PublishGains();
     return HAL_OK;
 }
 
@@ -313,15 +380,48 @@ HAL_StatusTypeDef Audio_MuteOutput(uint8_t channel, uint8_t state)
     }
     
     audioStatus.outputMute[channel] = state ? 1 : 0;
+    Audio_PublishGains();
+    return HAL_OK;
+}
+
+/**
+  * @brief  Set the master volume of all outputs
+  * @note   Rounded to AUDIO_MASTER_STEP_DB; the conversion loop glides to
+  *         the new gain, so it can be called at any rate
+  * @param  volumeDb: Volume in dB (0 = unity), AUDIO_MASTER_MIN_DB or less mutes
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Audio_SetMasterVolume(float volumeDb)
+{
+    if (volumeDb > 0.0f) {
+        volumeDb = 0.0f;
+    } else if (volumeDb < AUDIO_MASTER_MIN_DB) {
+        volumeDb = AUDIO_MASTER_MIN_DB;
+    }
+    
+    audioStatus.masterVolumeDb = roundf(volumeDb / AUDIO_MASTER_STEP_DB) * AUDIO_MASTER_STEP_DB;
+    Audio_PublishGains();
     return HAL_OK;
 }
 
+/**
+  * @brief  Get the master volume
+  * @retval Volume in dB
+  */
+float Audio_GetMasterVolume(void)
+{
+    return audioStatus.masterVolumeDb;
+}
+
 /**
   * @brief  Get audio driver status
   * @retval Audio driver status structure
   */
 AudioDriverStatus_TypeDef Audio_GetStatus(void)
 {
+    audioStatus.lateFrames = inputSlots.stats.lateFrames + outputSlots.stats.lateFrames;
+    audioStatus.droppedFrames = inputSlots.stats.droppedFrames + outputSlots.stats.droppedFrames;
+    
     return audioStatus;
 }
 
@@ -366,7 +466,10 @@ HAL_StatusTypeDef Audio_Reset(void)
 float Audio_CalculateRMS(uint8_t channel, AudioBuffer_TypeDef *buffer)
 {
     float sum = 0.0f;
+    float peak = 0.0f;
+    uint32_t clips = 0;
     float sample;
+    float magnitude;
     
     if (channel >= AUDIO_OUTPUT_CHANNELS) {
         return 0.0f;
@@ -376,6 +479,16 @@ float Audio_CalculateRMS(uint8_t channel, AudioBuffer_TypeDef *buffer)
     for (uint32_t i = 0; i < AUDIO_RMS_WINDOW_SIZE; i++) {
         sample = buffer->channels[channel][i];
         sum += sample * sample;
+        magnitude = fabsf(sample);
+        peak = (magnitude > peak) ? magnitude : peak;
+        clips += (magnitude >= HEALTH_CLIP_LEVEL) ? 1U : 0U;
+    }
+    
+    /* Same reduction is the health check; a bad frame is muted, not metered */
+    if (Health_CheckOutput(channel, buffer->channels[channel], sum, peak, clips)) {
+        sum = 0.0f;
+    } else {
+        levelStatsMask |= 1UL << channel;
     }
     
     /* Calculate RMS */
@@ -391,12 +504,13 @@ float Audio_CalculateRMS(uint8_t channel, AudioBuffer_TypeDef *buffer)
 
 /**
   * @brief  Process input samples from DMA buffer to audio buffer
-  * @param  offset: Offset in DMA buffer
+  * @param  slot: Owned input slot in DMA memory
   * @param  buffer: Pointer to audio buffer
   * @retval None
   */
-static void Audio_ProcessInputSamples(uint32_t offset, AudioBuffer_TypeDef *buffer)
+static void Audio_ProcessInputSamples(const int32_t *slot, AudioBuffer_TypeDef *buffer)
 {
+    const float *gain = ParamSnapshot_Frame()->inputGain;
     uint32_t sample_idx = 0;
     int32_t sample;
     float sample_float;
@@ -406,17 +520,13 @@ static void Audio_ProcessInputSamples(uint32_t offset, AudioBuffer_TypeDef *buff
         /* Process each input channel */
         for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
             /* Get sample from DMA buffer */
-            sample = inputDmaBuffer[offset + sample_idx++];
+            sample = slot[sample_idx++];
             
             /* Convert to float in range [-1.0, 1.0] */
             sample_float = INT24_TO_FLOAT(sample);
             
-            /* Apply input gain and mute */
-            if (audioStatus.inputMute[ch]) {
-                sample_float = 0.0f;
-            } else {
-                sample_float *= audioStatus.inputGain[ch];
-            }
+            /* Apply input gain, zero when muted */
+            sample_float *= gain[ch];
             
             /* Store in audio buffer */
             buffer->channels[ch][i] = sample_float;
@@ -425,41 +535,118 @@ static void Audio_ProcessInputSamples(uint32_t offset, AudioBuffer_TypeDef *buff
 }
 
 /**
-  * @brief  Prepare output samples from audio buffer to DMA buffer
-  * @param  offset: Offset in DMA buffer
+  * @brief  Prepare output samples from audio buffer to both DAC buffers
+  * @param  dac1: Owned output slot of I2S3, outputs 1-2 interleaved
+  * @param  dac2: Same slot of I2S4, outputs 3-4 interleaved
   * @param  buffer: Pointer to audio buffer
   * @retval None
   */
-static void Audio_PrepareOutputSamples(uint32_t offset, AudioBuffer_TypeDef *buffer)
+static void Audio_PrepareOutputSamples(int32_t *dac1, int32_t *dac2, AudioBuffer_TypeDef *buffer)
 {
-    uint32_t sample_idx = 0;
-    float sample_float;
-    int32_t sample_int;
+    const float *target = ParamSnapshot_Frame()->outputGain;
+    const float *ch0 = buffer->channels[0];
+    const float *ch1 = buffer->channels[1];
+    const float *ch2 = buffer->channels[2];
+    const float *ch3 = buffer->channels[3];
+    float g[AUDIO_OUTPUT_CHANNELS];
+    float step[AUDIO_OUTPUT_CHANNELS];
+    float y[AUDIO_OUTPUT_CHANNELS];
+    float peak[AUDIO_OUTPUT_CHANNELS] = { 0.0f };
+    float sum[AUDIO_OUTPUT_CHANNELS] = { 0.0f };
+    uint32_t clips[AUDIO_OUTPUT_CHANNELS] = { 0U };
+    
+    /* Frame-end gain of each channel, reached by a per-sample ramp */
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+        float next = outputGainNow[ch] + (target[ch] - outputGainNow[ch]) * gainSmoothCoeff;
+        
+        if (fabsf(target[ch] - next) < 1.0e-6f) {
+            next = target[ch];
+        }
+        
+        g[ch] = outputGainNow[ch];
+        step[ch] = (next - outputGainNow[ch]) * (1.0f / (float)AUDIO_FRAME_SIZE);
+        outputGainNow[ch] = next;
+    }
     
-    /* Process each sample in the current buffer half */
+    /* Each plane is read once and lands straight in its DAC's L/R slot;
+       ramped gain (master volume and mute folded in), hard limit and int24
+       conversion per sample. The gain is applied in float, so attenuation
+       costs no resolution before the one int24 quantization. Peak, sum of
+       squares and clips are reduced from the gained samples, before the
+       hard limit, so the level statistics see what the DAC is sent. */
     for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
-        /* Process each output channel */
+        g[0] += step[0];
+        g[1] += step[1];
+        g[2] += step[2];
+        g[3] += step[3];
+        y[0] = ch0[i] * g[0];
+        y[1] = ch1[i] * g[1];
+        y[2] = ch2[i] * g[2];
+        y[3] = ch3[i] * g[3];
         for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
-            /* Get sample from audio buffer */
-            sample_float = buffer->channels[ch][i];
-            
-            /* Apply output gain and mute */
-            if (audioStatus.outputMute[ch]) {
-                sample_float = 0.0f;
-            } else {
-                sample_float *= audioStatus.outputGain[ch];
-            }
+            const float magnitude = fabsf(y[ch]);
             
-            /* Hard limit to prevent clipping */
-            sample_float = CLAMP(sample_float, -1.0f, 1.0f);
-            
-            /* Convert float to int24 */
-            sample_int = FLOAT_TO_INT24(sample_float);
-            
-            /* Store in DMA buffer */
-            outputDmaBuffer[offset + sample_idx++] = sample_int;
+            sum[ch] += y[ch] * y[ch];
+            peak[ch] = (magnitude > peak[ch]) ? magnitude : peak[ch];
+            clips[ch] += (magnitude >= HEALTH_CLIP_LEVEL) ? 1U : 0U;
+        }
+        dac1[2U * i]      = FLOAT_TO_INT24(CLAMP(y[0], -1.0f, 1.0f));
+        dac1[2U * i + 1U] = FLOAT_TO_INT24(CLAMP(y[1], -1.0f, 1.0f));
+        dac2[2U * i]      = FLOAT_TO_INT24(CLAMP(y[2], -1.0f, 1.0f));
+        dac2[2U * i + 1U] = FLOAT_TO_INT24(CLAMP(y[3], -1.0f, 1.0f));
+    }
+    
+    /* A muted frame or one the analyzer sent is not metered */
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+        if ((levelStatsMask & (1UL << ch)) != 0U) {
+            LevelStats_Update(ch, peak[ch], sum[ch], clips[ch]);
         }
     }
+    levelStatsMask = 0;
+}
+
+/**
+  * @brief  Measure the DAC skew and report it for alignment
+  * @note   The late DAC's outputs report the skew as output latency, the
+  *         latency manager then delays the other DAC's outputs to match
+  * @retval None
+  */
+static void Audio_AlignOutputs(void)
+{
+    const int32_t skew = I2S_GetOutputSkew(DMA_DAC_BUFFER_SIZE);
+    const uint32_t dac1Late = (skew > 0) ? (uint32_t)skew : 0U;
+    const uint32_t dac2Late = (skew < 0) ? (uint32_t)(-skew) : 0U;
+    
+    audioStatus.dacSkewSamples = skew;
+    
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+        Latency_ReportStage(ch, LATENCY_STAGE_OUTPUT, (ch < AUDIO_DAC_CHANNELS) ? dac1Late : dac2Late);
+    }
+    
+    if (skew != 0) {
+        DEBUG_PRINT("DAC skew %ld samples, aligned by the latency manager\r\n", (long)skew);
+    }
+}
+
+/**
+  * @brief  Publish gains with mutes and master volume applied for the conversion loops
+  * @retval None
+  */
+static void Audio_PublishGains(void)
+{
+    ParamSnapshot_TypeDef *hot = ParamSnapshot_BeginUpdate();
+    const float master = (audioStatus.masterVolumeDb <= AUDIO_MASTER_MIN_DB) ? 0.0f :
+                         powf(10.0f, audioStatus.masterVolumeDb / 20.0f);
+    
+    for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+        hot->inputGain[ch] = audioStatus.inputMute[ch] ? 0.0f : audioStatus.inputGain[ch];
+    }
+    
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+        hot->outputGain[ch] = audioStatus.outputMute[ch] ? 0.0f : audioStatus.outputGain[ch] * master;
+    }
+    
+    ParamSnapshot_Publish();
 }
 
 /**
@@ -470,12 +657,11 @@ static void Audio_ResetBuffers(void)
 {
     /* Clear DMA buffers */
     memset(inputDmaBuffer, 0, sizeof(inputDmaBuffer));
-    memset(outputDmaBuffer, 0, sizeof(outputDmaBuffer));
+    memset(dacDmaBuffer, 0, sizeof(dacDmaBuffer));
     
-    /* Reset buffer states */
-    inputBufferState = BUFFER_HALF;
-    outputBufferState = BUFFER_HALF;
-    audioProcessingNeeded = 0;
+    /* Reset ownership, the streams are stopped here */
+    DMA_Slots_Init(&inputSlots, inputDmaBuffer, DMA_INPUT_SLOT_WORDS, DMA_SLOT_COUNT, DMA_SLOTS_RX);
+    DMA_Slots_Init(&outputSlots, dacDmaBuffer[0], DMA_OUTPUT_SLOT_WORDS, DMA_SLOT_COUNT, DMA_SLOTS_TX);
 }
 
 /* I2S DMA Callbacks ---------------------------------------------------------*/
@@ -488,8 +674,8 @@ static void Audio_ResetBuffers(void)
 void HAL_I2S_RxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
 {
     if (hi2s->Instance == SPI2) {
-        inputBufferState = BUFFER_HALF;
-        audioProcessingNeeded = 1;
+        /* ADC finished a half, it is ready for the CPU */
+        DMA_Slots_Advance(&inputSlots);
         
         /* Call the audio processing callback */
         Audio_ProcessCallback();
@@ -504,8 +690,8 @@ void HAL_I2S_RxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
 void HAL_I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s)
 {
     if (hi2s->Instance == SPI2) {
-        inputBufferState = BUFFER_FULL;
-        audioProcessingNeeded = 1;
+        /* ADC finished a half, it is ready for the CPU */
+        DMA_Slots_Advance(&inputSlots);
         
         /* Call the audio processing callback */
         Audio_ProcessCallback();
@@ -520,7 +706,8 @@ void HAL_I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s)
 void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
 {
     if (hi2s->Instance == SPI3) {
-        outputBufferState = BUFFER_HALF;
+        /* DAC moved into the other half, checks it was written in time */
+        DMA_Slots_Advance(&outputSlots);
     }
 }
 
@@ -532,7 +719,8 @@ void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
 void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s)
 {
     if (hi2s->Instance == SPI3) {
-        outputBufferState = BUFFER_FULL;
+        /* DAC moved into the other half, checks it was written in time */
+        DMA_Slots_Advance(&outputSlots);
     }
 }
 
@@ -547,8 +735,8 @@ void HAL_I2S_ErrorCallback(I2S_HandleTypeDef *hi2s)
         /* Input error */
         audioStatus.inputUnderflows++;
         DEBUG_PRINT("I2S input error\r\n");
-    } else if (hi2s->Instance == SPI3) {
-        /* Output error */
+    } else if (hi2s->Instance == SPI3 || hi2s->Instance == SPI4) {
+        /* Output error, either DAC; the restart realigns both */
         audioStatus.outputOverflows++;
         DEBUG_PRINT("I2S output error\r\n");
     }
@@ -15,12 +15,13 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "codec_pcm5102a.h"
+#include "audio_driver.h"
 #include "i2s.h"
 #include "debug.h"
 
 /* Private define ------------------------------------------------------------*/
 #define PCM5102A_DEFAULT_SAMPLE_RATE  48000
-#define PCM5102A_DEFAULT_VOLUME       80
+#define PCM5102A_DEFAULT_VOLUME       100           /* Unity master volume */
 #define PCM5102A_VOLUME_MAX           100
 
 /* Private variables ---------------------------------------------------------*/
@@ -297,11 +298,14 @@ PCM5102A_Status_t PCM5102A_Resume(void)
   * @brief Set PCM5102A volume
   * @param volume Volume level (0-100)
   * @retval PCM5102A_Status_t
-  * @note PCM5102A doesn't have hardware volume control, this is for
-  *       software volume control implemented in the DSP path
+  * @note PCM5102A doesn't have hardware volume control, the level sets
+  *       the software master volume of the audio driver on a dB law:
+  *       100 is 0 dB, each step down is an equal dB step, 0 mutes
   */
 PCM5102A_Status_t PCM5102A_SetVolume(uint8_t volume)
 {
+    float volumeDb;
+    
     if (!pcm5102a_initialized) {
         return PCM5102A_ERROR;
     }
@@ -314,7 +318,12 @@ PCM5102A_Status_t PCM5102A_SetVolume(uint8_t volume)
     /* Store volume setting */
     PCM5102A_Config.Volume = volume;
     
-    DEBUG_PRINT("PCM5102A volume set to %d%%\r\n", volume);
+    volumeDb = AUDIO_MASTER_MIN_DB * (1.0f - (float)volume / (float)PCM5102A_VOLUME_MAX);
+    if (Audio_SetMasterVolume(volumeDb) != HAL_OK) {
+        return PCM5102A_ERROR;
+    }
+    
+    DEBUG_PRINT("PCM5102A volume set to %d%% (%.1f dB)\r\n", volume, Audio_GetMasterVolume());
     return PCM5102A_OK;
 }
 
@@ -0,0 +1,360 @@
+/**
+  ******************************************************************************
+  * @file           : input_gate.c
+  * @brief          : Input noise gate / downward expander
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Per frame: one peak scan, the open/hold/closed decision with hysteresis,
+  * a target gain and a one-pole step of the gain evaluated at block rate.
+  * The samples are then multiplied by a linear ramp from the previous gain
+  * to the new one, which keeps the gain continuous without per-sample
+  * smoothing.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "input_gate.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define INPUT_GATE_SETTLE           1.0e-3f   /* Gain distance treated as reached (-60 dB) */
+#define INPUT_GATE_PEAK_FLOOR       1.0e-9f   /* -180 dBFS, avoids log of zero */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  InputGate_Params_TypeDef params;
+  InputGate_State_TypeDef state;
+  float closeThresholdDb;       /* thresholdDb - hysteresisDb */
+  float attackCoeff;            /* Per-frame smoothing while opening */
+  float releaseCoeff;           /* Per-frame smoothing while closing */
+  float gain;                   /* Linear gain at the end of the last frame */
+  float gainDb;                 /* Target of the last frame, for metering */
+  uint32_t holdFrames;          /* Hold time in frames */
+  uint32_t holdCounter;         /* Frames left in hold */
+  uint8_t closedSilent;         /* Closed, settled and muting */
+} InputGate_Channel_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static InputGate_Channel_TypeDef gateChannels[AUDIO_INPUT_CHANNELS];
+static float gateSampleRate = (float)AUDIO_SAMPLE_RATE;
+static uint32_t silentFrames = 0;
+static uint32_t silenceFrames = UINT32_MAX;   /* Frames of silence before IsSilent() */
+
+/* Private function prototypes -----------------------------------------------*/
+static void InputGate_UpdateCoefficients(uint8_t channel);
+static float InputGate_FrameCoeff(float timeMs);
+static void InputGate_ProcessChannel(uint8_t channel, float *data, uint32_t blockSize);
+static void InputGate_Open(uint8_t channel);
+
+/**
+  * @brief  Initialize all input gates, disabled
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void InputGate_Init(float sampleRate)
+{
+  memset(gateChannels, 0, sizeof(gateChannels));
+  gateSampleRate = (sampleRate > 0.0f) ? sampleRate : (float)AUDIO_SAMPLE_RATE;
+  silenceFrames = (uint32_t)((INPUT_GATE_SILENCE_MS * gateSampleRate) / (1000.0f * AUDIO_FRAME_SIZE));
+  silentFrames = 0;
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    InputGate_Params_TypeDef *p = &gateChannels[ch].params;
+
+    p->thresholdDb = -70.0f;
+    p->hysteresisDb = 6.0f;
+    p->ratio = INPUT_GATE_RATIO_GATE;
+    p->rangeDb = -100.0f;
+    p->attackMs = 1.0f;
+    p->holdMs = 100.0f;
+    p->releaseMs = 200.0f;
+    p->enabled = 0;
+
+    gateChannels[ch].state = INPUT_GATE_OPEN;
+    gateChannels[ch].gain = 1.0f;
+    InputGate_UpdateCoefficients(ch);
+  }
+
+  DEBUG_PRINT("Input gate initialized\r\n");
+}
+
+/**
+  * @brief  Set gate parameters of an input
+  * @param  channel: Input channel (0-1)
+  * @param  params: Pointer to parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputGate_SetParams(uint8_t channel, const InputGate_Params_TypeDef *params)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS || params == NULL) {
+    DEBUG_PRINT("InputGate_SetParams: Invalid parameters\r\n");
+    return HAL_ERROR;
+  }
+
+  if (params->hysteresisDb < 0.0f || params->ratio < 1.0f || params->rangeDb > 0.0f ||
+      params->attackMs < 0.0f || params->holdMs < 0.0f || params->releaseMs < 0.0f) {
+    DEBUG_PRINT("InputGate_SetParams: Value out of range on input %d\r\n", channel);
+    return HAL_ERROR;
+  }
+
+  gateChannels[channel].params = *params;
+  InputGate_UpdateCoefficients(channel);
+
+  /* The next frame decides again whether this input still mutes to silence */
+  gateChannels[channel].closedSilent = 0;
+  if (!params->enabled) {
+    InputGate_Open(channel);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get gate parameters of an input
+  * @param  channel: Input channel (0-1)
+  * @param  params: Pointer to store parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputGate_GetParams(uint8_t channel, InputGate_Params_TypeDef *params)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS || params == NULL) {
+    return HAL_ERROR;
+  }
+
+  *params = gateChannels[channel].params;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Enable or bypass the gate of an input
+  * @param  channel: Input channel (0-1)
+  * @param  enabled: 1 to enable, 0 to bypass
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputGate_SetEnabled(uint8_t channel, uint8_t enabled)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS) {
+    return HAL_ERROR;
+  }
+
+  gateChannels[channel].params.enabled = enabled ? 1 : 0;
+  if (!enabled) {
+    InputGate_Open(channel);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get gate state of an input
+  * @param  channel: Input channel (0-1)
+  * @retval Gate state
+  */
+InputGate_State_TypeDef InputGate_GetState(uint8_t channel)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS) {
+    return INPUT_GATE_OPEN;
+  }
+
+  return gateChannels[channel].state;
+}
+
+/**
+  * @brief  Get current gate gain of an input
+  * @param  channel: Input channel (0-1)
+  * @retval Gain in dB (zero or negative)
+  */
+float InputGate_GetGainDb(uint8_t channel)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS) {
+    return 0.0f;
+  }
+
+  return gateChannels[channel].gainDb;
+}
+
+/**
+  * @brief  Check whether an input is closed to exact silence
+  * @param  channel: Input channel (0-1)
+  * @retval 1 if closed, settled and muting
+  */
+uint8_t InputGate_IsClosed(uint8_t channel)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS) {
+    return 0;
+  }
+
+  return gateChannels[channel].closedSilent;
+}
+
+/**
+  * @brief  Check whether all inputs have been silent long enough to skip DSP
+  * @note   INPUT_GATE_SILENCE_MS covers the longest tail in the chain
+  *         (delay lines, FIR correction), so stage state is already flushed
+  * @retval 1 if processing can be skipped and outputs zeroed
+  */
+uint8_t InputGate_IsSilent(void)
+{
+  return (silentFrames >= silenceFrames) ? 1 : 0;
+}
+
+/**
+  * @brief  Gate one frame of all inputs in place
+  * @param  buffer: Input audio buffer
+  * @retval None
+  */
+void InputGate_Process(AudioBuffer_TypeDef *buffer)
+{
+  uint8_t allClosed = 1;
+
+  if (buffer == NULL) {
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    if (gateChannels[ch].params.enabled) {
+      InputGate_ProcessChannel(ch, buffer->samples[ch], AUDIO_FRAME_SIZE);
+    }
+    allClosed &= gateChannels[ch].closedSilent;
+  }
+
+  if (!allClosed) {
+    silentFrames = 0;
+  } else if (silentFrames < silenceFrames) {
+    silentFrames++;
+  }
+}
+
+/**
+  * @brief  Gate one frame of an input
+  * @param  channel: Input channel (0-1)
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples
+  * @retval None
+  */
+static void InputGate_ProcessChannel(uint8_t channel, float *data, uint32_t blockSize)
+{
+  InputGate_Channel_TypeDef *gate = &gateChannels[channel];
+  const InputGate_Params_TypeDef *p = &gate->params;
+  float peak = 0.0f;
+  float targetDb = 0.0f;
+  float target;
+  float coeff;
+  float start = gate->gain;
+  float end;
+
+  /* Block peak */
+  for (uint32_t i = 0; i < blockSize; i++) {
+    float a = fabsf(data[i]);
+    if (a > peak) {
+      peak = a;
+    }
+  }
+  const float peakDb = 20.0f * log10f(peak + INPUT_GATE_PEAK_FLOOR);
+
+  /* Open above threshold, stay open above the close threshold, then hold */
+  if (peakDb >= p->thresholdDb ||
+      (gate->state != INPUT_GATE_CLOSED && peakDb >= gate->closeThresholdDb)) {
+    gate->state = INPUT_GATE_OPEN;
+    gate->holdCounter = gate->holdFrames;
+  } else if (gate->state != INPUT_GATE_CLOSED && gate->holdCounter > 0U) {
+    gate->state = INPUT_GATE_HOLD;
+    gate->holdCounter--;
+  } else {
+    gate->state = INPUT_GATE_CLOSED;
+  }
+
+  /* Closed: expand below the close threshold, limited to the range */
+  if (gate->state == INPUT_GATE_CLOSED) {
+    if (p->ratio >= INPUT_GATE_RATIO_GATE) {
+      targetDb = p->rangeDb;
+    } else {
+      targetDb = (p->ratio - 1.0f) * (peakDb - gate->closeThresholdDb);
+      if (targetDb < p->rangeDb) {
+        targetDb = p->rangeDb;
+      }
+    }
+  }
+
+  target = (targetDb <= INPUT_GATE_MUTE_DB) ? 0.0f : powf(10.0f, targetDb / 20.0f);
+  coeff = (target > start) ? gate->attackCoeff : gate->releaseCoeff;
+  end = target + coeff * (start - target);
+  if (fabsf(end - target) < INPUT_GATE_SETTLE) {
+    end = target;
+  }
+
+  gate->gain = end;
+  gate->gainDb = targetDb;
+  gate->closedSilent = (gate->state == INPUT_GATE_CLOSED && start == 0.0f && end == 0.0f) ? 1 : 0;
+
+  /* Apply: unity and silence are exact, otherwise a linear ramp */
+  if (start == 1.0f && end == 1.0f) {
+    return;
+  }
+  if (start == 0.0f && end == 0.0f) {
+    memset(data, 0, blockSize * sizeof(float));
+    return;
+  }
+
+  const float step = (end - start) / (float)blockSize;
+  float g = start;
+  for (uint32_t i = 0; i < blockSize; i++) {
+    g += step;
+    data[i] *= g;
+  }
+}
+
+/**
+  * @brief  Derive thresholds and frame-rate coefficients of an input
+  * @param  channel: Input channel (0-1)
+  * @retval None
+  */
+static void InputGate_UpdateCoefficients(uint8_t channel)
+{
+  InputGate_Channel_TypeDef *gate = &gateChannels[channel];
+  const float frameMs = 1000.0f * (float)AUDIO_FRAME_SIZE / gateSampleRate;
+
+  gate->closeThresholdDb = gate->params.thresholdDb - gate->params.hysteresisDb;
+  gate->attackCoeff = InputGate_FrameCoeff(gate->params.attackMs);
+  gate->releaseCoeff = InputGate_FrameCoeff(gate->params.releaseMs);
+  gate->holdFrames = (uint32_t)(gate->params.holdMs / frameMs + 0.5f);
+  if (gate->holdCounter > gate->holdFrames) {
+    gate->holdCounter = gate->holdFrames;
+  }
+}
+
+/**
+  * @brief  One-pole coefficient applied once per frame
+  * @param  timeMs: Time constant in milliseconds
+  * @retval Coefficient (0 = reach the target within one frame)
+  */
+static float InputGate_FrameCoeff(float timeMs)
+{
+  if (timeMs <= 0.0f) {
+    return 0.0f;
+  }
+
+  return expf(-(1000.0f * (float)AUDIO_FRAME_SIZE) / (timeMs * gateSampleRate));
+}
+
+/**
+  * @brief  Put a bypassed input back to open at unity gain
+  * @note   Also drops its silent flag, InputGate_Process() skips bypassed
+  *         inputs and would otherwise keep the stale one
+  * @param  channel: Input channel (0-1)
+  * @retval None
+  */
+static void InputGate_Open(uint8_t channel)
+{
+  gateChannels[channel].state = INPUT_GATE_OPEN;
+  gateChannels[channel].gain = 1.0f;
+  gateChannels[channel].gainDb = 0.0f;
+  gateChannels[channel].closedSilent = 0;
+}
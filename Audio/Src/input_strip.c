@@ -0,0 +1,367 @@
+/**
+  ******************************************************************************
+  * @file           : input_strip.c
+  * @brief          : Per-input processing strip ahead of the routing matrix
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Section slots of a cascade: high-pass pair first, then the EQ bands.
+  * Both inputs go through BiquadCascade_ProcessGroup(), which runs them
+  * through the two-channel kernel when their stage counts match.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "input_strip.h"
+#include "biquad_cascade.h"
+#include "dsp_common.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define INPUT_STRIP_HPF_SECTIONS    2U
+#define INPUT_STRIP_SECTIONS        (INPUT_STRIP_HPF_SECTIONS + INPUT_STRIP_BANDS)
+#define INPUT_STRIP_DELAY_LINE      512U      /* Power of two, > 10 ms at 48 kHz */
+#define INPUT_STRIP_DELAY_MASK      (INPUT_STRIP_DELAY_LINE - 1U)
+
+/* Butterworth section Qs */
+#define INPUT_STRIP_Q_ORDER2        0.70710678f
+#define INPUT_STRIP_Q_ORDER4_A      0.54119610f
+#define INPUT_STRIP_Q_ORDER4_B      1.30656296f
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  InputStrip_Params_TypeDef params;
+  BiquadCascade_TypeDef cascade;
+  float delayLine[INPUT_STRIP_DELAY_LINE];
+  uint32_t delaySamples;
+  uint32_t writeIndex;
+} InputStrip_Channel_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static InputStrip_Channel_TypeDef strips[AUDIO_INPUT_CHANNELS];
+static float stripSampleRate = (float)AUDIO_SAMPLE_RATE;
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef InputStrip_Validate(const InputStrip_Params_TypeDef *params);
+static void InputStrip_Compile(uint8_t channel);
+static void InputStrip_UpdateDelay(uint8_t channel);
+static void InputStrip_DelayChannel(InputStrip_Channel_TypeDef *strip, float *data, uint32_t blockSize);
+
+/**
+  * @brief  Initialize all input strips, flat and undelayed
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void InputStrip_Init(float sampleRate)
+{
+  memset(strips, 0, sizeof(strips));
+  stripSampleRate = (sampleRate > 0.0f) ? sampleRate : (float)AUDIO_SAMPLE_RATE;
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    InputStrip_Params_TypeDef *p = &strips[ch].params;
+
+    p->hpfFrequency = 0.0f;
+    p->hpfOrder = 2;
+    for (uint8_t b = 0; b < INPUT_STRIP_BANDS; b++) {
+      p->bands[b].type = COEFF_BATCH_BELL;
+      p->bands[b].frequency = 1000.0f;
+      p->bands[b].gainDb = 0.0f;
+      p->bands[b].q = 1.0f;
+      p->bands[b].enabled = 0;
+    }
+    p->delayMs = 0.0f;
+    p->invert = 0;
+
+    BiquadCascade_Init(&strips[ch].cascade);
+    InputStrip_Compile(ch);
+    InputStrip_UpdateDelay(ch);
+  }
+}
+
+/**
+  * @brief  Set all strip parameters of an input
+  * @param  channel: Input channel (0-1)
+  * @param  params: Pointer to parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_SetParams(uint8_t channel, const InputStrip_Params_TypeDef *params)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS || params == NULL) {
+    DEBUG_PRINT("InputStrip_SetParams: Invalid parameters\r\n");
+    return HAL_ERROR;
+  }
+
+  if (InputStrip_Validate(params) != HAL_OK) {
+    DEBUG_PRINT("InputStrip_SetParams: Value out of range on input %d\r\n", channel);
+    return HAL_ERROR;
+  }
+
+  strips[channel].params = *params;
+  InputStrip_Compile(channel);
+  InputStrip_UpdateDelay(channel);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get strip parameters of an input
+  * @param  channel: Input channel (0-1)
+  * @param  params: Pointer to store parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_GetParams(uint8_t channel, InputStrip_Params_TypeDef *params)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS || params == NULL) {
+    return HAL_ERROR;
+  }
+
+  *params = strips[channel].params;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Set the subsonic high-pass of an input
+  * @param  channel: Input channel (0-1)
+  * @param  frequency: Corner in Hz, 0 to turn it off
+  * @param  order: 2 or 4
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_SetHighPass(uint8_t channel, float frequency, uint8_t order)
+{
+  InputStrip_Params_TypeDef params;
+
+  if (InputStrip_GetParams(channel, &params) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  params.hpfFrequency = frequency;
+  params.hpfOrder = order;
+
+  return InputStrip_SetParams(channel, &params);
+}
+
+/**
+  * @brief  Set one EQ band of an input
+  * @param  channel: Input channel (0-1)
+  * @param  band: Band index (0 to INPUT_STRIP_BANDS - 1)
+  * @param  config: Band settings
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_SetBand(uint8_t channel, uint8_t band, const InputStrip_Band_TypeDef *config)
+{
+  InputStrip_Params_TypeDef params;
+
+  if (band >= INPUT_STRIP_BANDS || config == NULL ||
+      InputStrip_GetParams(channel, &params) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  params.bands[band] = *config;
+
+  return InputStrip_SetParams(channel, &params);
+}
+
+/**
+  * @brief  Set the alignment delay of an input
+  * @param  channel: Input channel (0-1)
+  * @param  delayMs: Delay in ms (0 to INPUT_STRIP_MAX_DELAY_MS)
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_SetDelay(uint8_t channel, float delayMs)
+{
+  InputStrip_Params_TypeDef params;
+
+  if (InputStrip_GetParams(channel, &params) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  params.delayMs = delayMs;
+
+  return InputStrip_SetParams(channel, &params);
+}
+
+/**
+  * @brief  Set the polarity of an input
+  * @param  channel: Input channel (0-1)
+  * @param  invert: 1 to invert, 0 for normal
+  * @retval HAL status
+  */
+HAL_StatusTypeDef InputStrip_SetInvert(uint8_t channel, uint8_t invert)
+{
+  InputStrip_Params_TypeDef params;
+
+  if (InputStrip_GetParams(channel, &params) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  params.invert = invert ? 1U : 0U;
+
+  return InputStrip_SetParams(channel, &params);
+}
+
+/**
+  * @brief  Clear the filter and delay history of an input
+  * @param  channel: Input channel (0-1)
+  * @retval None
+  */
+void InputStrip_Reset(uint8_t channel)
+{
+  if (channel >= AUDIO_INPUT_CHANNELS) {
+    return;
+  }
+
+  BiquadCascade_Reset(&strips[channel].cascade);
+  memset(strips[channel].delayLine, 0, sizeof(strips[channel].delayLine));
+}
+
+/**
+  * @brief  Run both input strips on one frame
+  * @param  buffer: Input frame, processed in place
+  * @retval None
+  */
+void InputStrip_Process(AudioBuffer_TypeDef *buffer)
+{
+  BiquadCascade_TypeDef *cascades[AUDIO_INPUT_CHANNELS];
+  float *samples[AUDIO_INPUT_CHANNELS];
+
+  if (buffer == NULL) {
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    cascades[ch] = &strips[ch].cascade;
+    samples[ch] = buffer->samples[ch];
+  }
+
+  /* Empty unity cascades return straight away */
+  BiquadCascade_ProcessGroup(cascades, samples, AUDIO_INPUT_CHANNELS, AUDIO_FRAME_SIZE);
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    if (strips[ch].delaySamples != 0U) {
+      InputStrip_DelayChannel(&strips[ch], samples[ch], AUDIO_FRAME_SIZE);
+    }
+  }
+}
+
+/**
+  * @brief  Range-check strip parameters
+  * @param  params: Parameters to check
+  * @retval HAL_OK if usable
+  */
+static HAL_StatusTypeDef InputStrip_Validate(const InputStrip_Params_TypeDef *params)
+{
+  const float nyquist = 0.5f * stripSampleRate;
+
+  if (params->hpfFrequency != 0.0f &&
+      (params->hpfFrequency < INPUT_STRIP_HPF_MIN_HZ || params->hpfFrequency > INPUT_STRIP_HPF_MAX_HZ ||
+       (params->hpfOrder != 2U && params->hpfOrder != 4U))) {
+    return HAL_ERROR;
+  }
+
+  if (params->delayMs < 0.0f || params->delayMs > INPUT_STRIP_MAX_DELAY_MS) {
+    return HAL_ERROR;
+  }
+
+  for (uint8_t b = 0; b < INPUT_STRIP_BANDS; b++) {
+    const InputStrip_Band_TypeDef *band = &params->bands[b];
+
+    if (band->enabled &&
+        (band->type > COEFF_BATCH_ALL_PASS || band->frequency < DSP_MIN_FREQUENCY ||
+         band->frequency >= nyquist || band->q < DSP_MIN_Q_FACTOR || band->q > DSP_MAX_Q_FACTOR ||
+         fabsf(band->gainDb) > (float)COEFF_BATCH_DB_RANGE)) {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Design and compile the section cascade of an input
+  * @param  channel: Input channel (0-1)
+  * @retval None
+  */
+static void InputStrip_Compile(uint8_t channel)
+{
+  InputStrip_Channel_TypeDef *strip = &strips[channel];
+  const InputStrip_Params_TypeDef *p = &strip->params;
+  CoeffBatch_Band_TypeDef specs[INPUT_STRIP_SECTIONS];
+  BiquadCoeff_t coeffs[INPUT_STRIP_SECTIONS];
+  uint8_t enabled[INPUT_STRIP_SECTIONS];
+  const uint8_t hpfOn = (p->hpfFrequency > 0.0f) ? 1U : 0U;
+
+  /* High-pass pair: one section for 2nd order, both for 4th */
+  for (uint8_t s = 0; s < INPUT_STRIP_HPF_SECTIONS; s++) {
+    specs[s].type = COEFF_BATCH_HIGH_PASS;
+    specs[s].frequency = hpfOn ? p->hpfFrequency : INPUT_STRIP_HPF_MIN_HZ;
+    specs[s].gainDb = 0.0f;
+    specs[s].q = (p->hpfOrder == 4U) ? ((s == 0U) ? INPUT_STRIP_Q_ORDER4_A : INPUT_STRIP_Q_ORDER4_B) :
+                 INPUT_STRIP_Q_ORDER2;
+    enabled[s] = (hpfOn && (s == 0U || p->hpfOrder == 4U)) ? 1U : 0U;
+  }
+
+  for (uint8_t b = 0; b < INPUT_STRIP_BANDS; b++) {
+    CoeffBatch_Band_TypeDef *spec = &specs[INPUT_STRIP_HPF_SECTIONS + b];
+
+    spec->type = p->bands[b].type;
+    spec->frequency = p->bands[b].frequency;
+    spec->gainDb = p->bands[b].gainDb;
+    spec->q = p->bands[b].q;
+    enabled[INPUT_STRIP_HPF_SECTIONS + b] = p->bands[b].enabled;
+  }
+
+  CoeffBatch_Design(specs, coeffs, INPUT_STRIP_SECTIONS);
+  BiquadCascade_Compile(&strip->cascade, coeffs, enabled, INPUT_STRIP_SECTIONS, 0);
+
+  /* Polarity rides on the cascade output gain */
+  strip->cascade.gain = p->invert ? -1.0f : 1.0f;
+}
+
+/**
+  * @brief  Convert the delay setting of an input to samples
+  * @param  channel: Input channel (0-1)
+  * @retval None
+  */
+static void InputStrip_UpdateDelay(uint8_t channel)
+{
+  InputStrip_Channel_TypeDef *strip = &strips[channel];
+  uint32_t samples = (uint32_t)(strip->params.delayMs * 0.001f * stripSampleRate + 0.5f);
+
+  if (samples > INPUT_STRIP_DELAY_MASK) {
+    samples = INPUT_STRIP_DELAY_MASK;
+  }
+
+  /* The line is not written while off, start it from silence */
+  if (strip->delaySamples == 0U && samples != 0U) {
+    memset(strip->delayLine, 0, sizeof(strip->delayLine));
+  }
+
+  strip->delaySamples = samples;
+}
+
+/**
+  * @brief  Delay one frame of an input
+  * @param  strip: Input strip
+  * @param  data: Sample buffer, delayed in place
+  * @param  blockSize: Number of samples
+  * @retval None
+  */
+static void InputStrip_DelayChannel(InputStrip_Channel_TypeDef *strip, float *data, uint32_t blockSize)
+{
+  const uint32_t delay = strip->delaySamples;
+  uint32_t w = strip->writeIndex;
+
+  for (uint32_t i = 0; i < blockSize; i++) {
+    strip->delayLine[w] = data[i];
+    data[i] = strip->delayLine[(w - delay) & INPUT_STRIP_DELAY_MASK];
+    w = (w + 1U) & INPUT_STRIP_DELAY_MASK;
+  }
+
+  strip->writeIndex = w;
+}
@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file           : level_stats.c
+  * @brief          : Per-channel peak histogram, crest factor and clip counts
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * LevelStats_Update() runs on the audio side for every good output frame,
+  * with the samples as the DAC gets them, after output gain and master
+  * volume; a frame the health check muted is left out. A reset from the main loop
+  * is only requested here and carried out by the next update of each
+  * channel, so the counters have a single writer.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "level_stats.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define LEVELSTATS_FRAC_BITS        6U          /* Mantissa bits indexing the fraction table */
+#define LEVELSTATS_FRAC_SIZE        (1U << LEVELSTATS_FRAC_BITS)
+#define LEVELSTATS_LOG2_ONE         256         /* log2 in 1/256 octave */
+#define LEVELSTATS_DB_PER_LOG2      1541U       /* 20*log10(2) dB per octave, per 1/256 octave, in Q16 */
+#define LEVELSTATS_ALL_CHANNELS     ((1UL << AUDIO_OUTPUT_CHANNELS) - 1UL)
+#define LEVELSTATS_FLOOR_DB         -200.0f     /* Reported for silence */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint32_t bins[LEVELSTATS_BINS];
+  uint32_t blocks;
+  uint32_t clipBlocks;
+  uint32_t clipSamples;
+  float peakMax;
+  float peakHold;               /* Decays with the crest window */
+  float meanSquare;             /* Per sample, averaged over the crest window */
+} LevelStats_Channel_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static LevelStats_Channel_TypeDef stats[AUDIO_OUTPUT_CHANNELS];
+static volatile uint32_t resetMask;         /* Channels to clear on their next update */
+
+/* log2 of 1.m at the middle of each mantissa step, in 1/256 octave */
+static uint8_t log2Frac[LEVELSTATS_FRAC_SIZE];
+
+static float averageCoeff;
+static float peakRelease;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t LevelStats_GetBin(float peak);
+static float LevelStats_ToDb(float power);
+
+/**
+  * @brief  Build the fraction table and clear all channels
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void LevelStats_Init(float sampleRate)
+{
+  const float blocks = (sampleRate / (float)AUDIO_FRAME_SIZE) * ((float)LEVELSTATS_CREST_TIME_MS / 1000.0f);
+
+  for (uint32_t k = 0; k < LEVELSTATS_FRAC_SIZE; k++) {
+    const float m = 1.0f + ((float)k + 0.5f) / (float)LEVELSTATS_FRAC_SIZE;
+
+    log2Frac[k] = (uint8_t)(log2f(m) * (float)LEVELSTATS_LOG2_ONE + 0.5f);
+  }
+
+  peakRelease = expf(-1.0f / blocks);
+  averageCoeff = 1.0f - peakRelease;
+
+  memset(stats, 0, sizeof(stats));
+  resetMask = 0;
+}
+
+/**
+  * @brief  Fold one output block into the statistics of its channel
+  * @note   Takes the reductions of the DAC conversion loop, never the samples
+  * @param  channel: Output channel (0-3)
+  * @param  peak: Largest magnitude in the block
+  * @param  sumSquares: Sum of squares over the block
+  * @param  clips: Samples at or over HEALTH_CLIP_LEVEL
+  * @retval None
+  */
+void LevelStats_Update(uint8_t channel, float peak, float sumSquares, uint32_t clips)
+{
+  LevelStats_Channel_TypeDef *s;
+  uint32_t bit;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return;
+  }
+
+  bit = 1UL << channel;
+  s = &stats[channel];
+  if ((resetMask & bit) != 0U) {
+    memset(s, 0, sizeof(*s));
+    resetMask &= ~bit;
+  }
+
+  s->bins[LevelStats_GetBin(peak)]++;
+  s->blocks++;
+  if (clips != 0U) {
+    s->clipBlocks++;
+    s->clipSamples += clips;
+  }
+  s->peakMax = (peak > s->peakMax) ? peak : s->peakMax;
+
+  s->peakHold *= peakRelease;
+  s->peakHold = (peak > s->peakHold) ? peak : s->peakHold;
+  s->meanSquare += averageCoeff * (sumSquares * (1.0f / (float)AUDIO_FRAME_SIZE) - s->meanSquare);
+}
+
+/**
+  * @brief  Clear the statistics of all channels
+  * @note   Each channel is cleared by its next update; a stopped stream
+  *         keeps showing the old values
+  * @retval None
+  */
+void LevelStats_Reset(void)
+{
+  resetMask = LEVELSTATS_ALL_CHANNELS;
+}
+
+/**
+  * @brief  Get the summary of a channel
+  * @param  channel: Output channel (0-3)
+  * @param  summary: Summary
+  * @retval None
+  */
+void LevelStats_GetSummary(uint8_t channel, LevelStats_Summary_TypeDef *summary)
+{
+  const LevelStats_Channel_TypeDef *s;
+  uint32_t nearClip = 0;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || summary == NULL) {
+    return;
+  }
+
+  s = &stats[channel];
+  for (uint32_t b = 0; b < LEVELSTATS_NEAR_CLIP_DB; b++) {
+    nearClip += s->bins[b];
+  }
+
+  summary->blocks = s->blocks;
+  summary->clipBlocks = s->clipBlocks;
+  summary->clipSamples = s->clipSamples;
+  summary->nearClipPercent = (s->blocks > 0U) ? (100.0f * (float)nearClip / (float)s->blocks) : 0.0f;
+  summary->peakMaxDb = LevelStats_ToDb(s->peakMax * s->peakMax);
+  summary->rmsDb = LevelStats_ToDb(s->meanSquare);
+  summary->crestDb = (s->meanSquare > 0.0f) ?
+                     LevelStats_ToDb(s->peakHold * s->peakHold / s->meanSquare) : 0.0f;
+}
+
+/**
+  * @brief  Copy the peak histogram of a channel
+  * @note   Bin b counts blocks peaking from -(b+1) up to -b dBFS; bin 0
+  *         also holds blocks over full scale
+  * @param  channel: Output channel (0-3)
+  * @param  bins: Block counts
+  * @retval None
+  */
+void LevelStats_GetHistogram(uint8_t channel, uint32_t bins[LEVELSTATS_BINS])
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || bins == NULL) {
+    return;
+  }
+
+  memcpy(bins, stats[channel].bins, sizeof(stats[channel].bins));
+}
+
+/**
+  * @brief  Histogram bin of a block peak from its float bits
+  * @note   Bins are accurate to within 0.07 dB of their edges
+  * @param  peak: Non-negative peak magnitude
+  * @retval Bin index, 0 at or above full scale
+  */
+static uint32_t LevelStats_GetBin(float peak)
+{
+  union { float f; uint32_t i; } v = { peak };
+  const int32_t exponent = (int32_t)((v.i >> 23) & 0xFFU);
+  int32_t log2Peak;
+  uint32_t bin;
+
+  /* Zero and denormals are below every bin */
+  if (exponent == 0) {
+    return LEVELSTATS_BINS - 1U;
+  }
+
+  log2Peak = (exponent - 127) * LEVELSTATS_LOG2_ONE +
+             (int32_t)log2Frac[(v.i >> (23U - LEVELSTATS_FRAC_BITS)) & (LEVELSTATS_FRAC_SIZE - 1U)];
+  if (log2Peak >= 0) {
+    return 0;
+  }
+
+  bin = ((uint32_t)(-log2Peak) * LEVELSTATS_DB_PER_LOG2) >> 16;
+  return (bin < LEVELSTATS_BINS) ? bin : (LEVELSTATS_BINS - 1U);
+}
+
+/**
+  * @brief  Power ratio to dB for the read side
+  * @param  power: Power ratio
+  * @retval dB, LEVELSTATS_FLOOR_DB for zero
+  */
+static float LevelStats_ToDb(float power)
+{
+  return (power > 0.0f) ? (10.0f * log10f(power)) : LEVELSTATS_FLOOR_DB;
+}
@@ -0,0 +1,312 @@
+/**
+  ******************************************************************************
+  * @file           : signal_health.c
+  * @brief          : Per-channel clip, NaN/Inf and runaway monitor
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Output check (every frame, from the meter) and stage probes (only on
+  * channels armed by a bad output, or all with Health_SetStageProbes())
+  * share the same verdict: not finite, or a peak above
+  * HEALTH_RUNAWAY_LEVEL. A probe that finds bad data zeroes it, so the
+  * stages after it run on silence for the rest of the frame.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "signal_health.h"
+#include "crossover.h"
+#include "peq.h"
+#include "convolution.h"
+#include "dynamics.h"
+#include "limiter.h"
+#include "delay.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define HEALTH_ALL_CHANNELS         ((1UL << AUDIO_OUTPUT_CHANNELS) - 1UL)
+#define HEALTH_LOG_INTERVAL_MS      1000U       /* Repeats of the same fault are logged this often */
+#define HEALTH_NO_STAGE             0xFFU
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  HEALTH_OK = 0,
+  HEALTH_NON_FINITE,
+  HEALTH_RUNAWAY
+} Health_Verdict_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t armedMask;         /* Channels to probe on the next frame */
+static uint32_t frameMask;                  /* Channels probed in this frame */
+static uint8_t stageProbes;
+
+static uint8_t firstBadStage[AUDIO_OUTPUT_CHANNELS];
+static uint8_t firstBadVerdict[AUDIO_OUTPUT_CHANNELS];
+
+static Health_Stats_TypeDef stats[AUDIO_OUTPUT_CHANNELS];
+static Health_Event_TypeDef events[HEALTH_EVENT_COUNT];
+static uint8_t eventHead;
+static uint8_t eventCount;
+static uint32_t lastLogTick;
+
+static const char *const stageNames[HEALTH_STAGE_COUNT] = {
+  "CROSSOVER", "EQ", "FIR", "COMPRESSOR", "LIMITER", "DELAY", "OUTPUT"
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void Health_Recover(uint8_t channel, uint8_t stage, uint8_t verdict);
+static void Health_ResetStage(uint8_t channel, Health_Stage_TypeDef stage);
+
+/**
+  * @brief  Clear counters and events
+  * @retval None
+  */
+void Health_Init(void)
+{
+  armedMask = 0;
+  frameMask = 0;
+  stageProbes = 0;
+  memset(stats, 0, sizeof(stats));
+  memset(events, 0, sizeof(events));
+  eventHead = 0;
+  eventCount = 0;
+  lastLogTick = 0;
+}
+
+/**
+  * @brief  Start a processing frame
+  * @retval Channel mask to pass to HEALTH_PROBE(), usually 0
+  */
+uint32_t Health_BeginFrame(void)
+{
+  frameMask = stageProbes ? HEALTH_ALL_CHANNELS : armedMask;
+  armedMask = 0;
+
+  if (frameMask != 0U) {
+    memset(firstBadStage, HEALTH_NO_STAGE, sizeof(firstBadStage));
+  }
+
+  return frameMask;
+}
+
+/**
+  * @brief  Check the output of one stage
+  * @note   Use through HEALTH_PROBE() so idle channels cost a bit test
+  * @param  channel: Output channel (0-3)
+  * @param  stage: Stage that just processed the data
+  * @param  data: One frame, zeroed if bad
+  * @retval None
+  */
+void Health_Probe(uint8_t channel, Health_Stage_TypeDef stage, float *data)
+{
+  float sum = 0.0f;
+  float peak = 0.0f;
+  uint32_t clips = 0;
+  uint8_t verdict;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || stage >= HEALTH_STAGE_OUTPUT) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+    const float a = fabsf(data[i]);
+
+    /* A NaN or Inf anywhere carries through the sum */
+    sum += a;
+    peak = (a > peak) ? a : peak;
+    clips += (a >= HEALTH_CLIP_LEVEL) ? 1U : 0U;
+  }
+
+  stats[channel].clips[stage] += clips;
+
+  verdict = !isfinite(sum) ? HEALTH_NON_FINITE : (peak > HEALTH_RUNAWAY_LEVEL) ? HEALTH_RUNAWAY : HEALTH_OK;
+  if (verdict == HEALTH_OK) {
+    return;
+  }
+
+  if (firstBadStage[channel] == HEALTH_NO_STAGE) {
+    firstBadStage[channel] = (uint8_t)stage;
+    firstBadVerdict[channel] = verdict;
+  }
+
+  memset(data, 0, AUDIO_FRAME_SIZE * sizeof(float));
+}
+
+/**
+  * @brief  Judge one output frame from the meter reduction
+  * @param  channel: Output channel (0-3)
+  * @param  data: The frame, muted if bad
+  * @param  sumSquares: Sum of squares over the frame
+  * @param  peak: Largest magnitude in the frame
+  * @param  clips: Samples at or over HEALTH_CLIP_LEVEL
+  * @retval 1 if the frame was bad and has been muted
+  */
+uint8_t Health_CheckOutput(uint8_t channel, float *data, float sumSquares, float peak, uint32_t clips)
+{
+  uint32_t bit;
+  uint8_t verdict;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return 0;
+  }
+
+  bit = 1UL << channel;
+
+  stats[channel].clips[HEALTH_STAGE_OUTPUT] += clips;
+
+  verdict = !isfinite(sumSquares) ? HEALTH_NON_FINITE :
+            (peak > HEALTH_RUNAWAY_LEVEL) ? HEALTH_RUNAWAY : HEALTH_OK;
+
+  if (verdict != HEALTH_OK) {
+    stats[channel].faults++;
+    memset(data, 0, AUDIO_FRAME_SIZE * sizeof(float));
+  }
+
+  if ((frameMask & bit) != 0U) {
+    /* Probed frame: the first bad tap names the stage, the gain stage holds no state */
+    if (firstBadStage[channel] != HEALTH_NO_STAGE) {
+      Health_Recover(channel, firstBadStage[channel], firstBadVerdict[channel]);
+    } else if (verdict != HEALTH_OK) {
+      Health_Recover(channel, HEALTH_STAGE_OUTPUT, verdict);
+    }
+  } else if (verdict != HEALTH_OK) {
+    armedMask |= bit;
+  }
+
+  return (verdict != HEALTH_OK) ? 1U : 0U;
+}
+
+/**
+  * @brief  Probe every stage of every channel on every frame
+  * @note   Counts clips per stage tap; costs roughly one extra meter
+  *         pass per stage
+  * @param  enable: 1 to probe always, 0 to probe only after a fault
+  * @retval None
+  */
+void Health_SetStageProbes(uint8_t enable)
+{
+  stageProbes = enable ? 1U : 0U;
+}
+
+/**
+  * @brief  Get the counters of a channel
+  * @param  channel: Output channel (0-3)
+  * @param  result: Counters
+  * @retval None
+  */
+void Health_GetStats(uint8_t channel, Health_Stats_TypeDef *result)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || result == NULL) {
+    return;
+  }
+
+  *result = stats[channel];
+}
+
+/**
+  * @brief  Get a logged fault, newest first
+  * @param  index: 0 for the newest event
+  * @param  event: Event
+  * @retval 1 if the event exists
+  */
+uint8_t Health_GetEvent(uint8_t index, Health_Event_TypeDef *event)
+{
+  if (index >= eventCount || event == NULL) {
+    return 0;
+  }
+
+  *event = events[(eventHead + HEALTH_EVENT_COUNT - 1U - index) % HEALTH_EVENT_COUNT];
+  return 1;
+}
+
+/**
+  * @brief  Get the name of a stage
+  * @param  stage: HEALTH_STAGE_x
+  * @retval Name string
+  */
+const char *Health_GetStageName(Health_Stage_TypeDef stage)
+{
+  return (stage < HEALTH_STAGE_COUNT) ? stageNames[stage] : "?";
+}
+
+/**
+  * @brief  Reset the faulty stage and the stages it fed, log the event
+  * @param  channel: Output channel (0-3)
+  * @param  stage: First bad stage
+  * @param  verdict: Health_Verdict_TypeDef
+  * @retval None
+  */
+static void Health_Recover(uint8_t channel, uint8_t stage, uint8_t verdict)
+{
+  const uint32_t now = HAL_GetTick();
+  const Health_Event_TypeDef *last = &events[(eventHead + HEALTH_EVENT_COUNT - 1U) % HEALTH_EVENT_COUNT];
+  Health_Event_TypeDef *event;
+
+  for (uint8_t s = stage; s < HEALTH_STAGE_OUTPUT; s++) {
+    Health_ResetStage(channel, (Health_Stage_TypeDef)s);
+  }
+  stats[channel].resets[stage]++;
+
+  /* A stage that keeps failing is logged once per interval, not per frame */
+  if (eventCount > 0U && last->channel == channel && last->stage == stage &&
+      (now - lastLogTick) < HEALTH_LOG_INTERVAL_MS) {
+    return;
+  }
+
+  event = &events[eventHead];
+  event->tick = now;
+  event->channel = channel;
+  event->stage = stage;
+  event->nonFinite = (verdict == HEALTH_NON_FINITE) ? 1U : 0U;
+  eventHead = (uint8_t)((eventHead + 1U) % HEALTH_EVENT_COUNT);
+  if (eventCount < HEALTH_EVENT_COUNT) {
+    eventCount++;
+  }
+  lastLogTick = now;
+
+  DEBUG_PRINT("Health: ch%d %s at %s, state reset\r\n", channel + 1,
+              event->nonFinite ? "NaN/Inf" : "runaway", stageNames[stage]);
+}
+
+/**
+  * @brief  Clear the processing state of one stage, keeping its settings
+  * @param  channel: Output channel (0-3)
+  * @param  stage: HEALTH_STAGE_x
+  * @retval None
+  */
+static void Health_ResetStage(uint8_t channel, Health_Stage_TypeDef stage)
+{
+  switch (stage) {
+    case HEALTH_STAGE_CROSSOVER:
+      Crossover_ResetFilterState(channel);
+      break;
+
+    case HEALTH_STAGE_EQ:
+      PEQ_ResetState(channel);
+      break;
+
+    case HEALTH_STAGE_FIR:
+      Convolution_ResetState(channel);
+      break;
+
+    case HEALTH_STAGE_COMPRESSOR:
+      Dynamics_ResetChannel(channel);
+      break;
+
+    case HEALTH_STAGE_LIMITER:
+      Limiter_Reset(channel);
+      break;
+
+    case HEALTH_STAGE_DELAY:
+      Delay_ResetChannel(channel);
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : dma_slots.h
+  * @brief          : Ownership tracking for circular audio DMA buffers
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * A circular I2S DMA buffer is split into slots of one audio frame. Every
+  * slot is owned by exactly one side at a time:
+  *
+  *   Rx: DMA fills it -> READY -> CPU converts it in place -> FREE -> DMA
+  *   Tx: FREE -> CPU writes it in place -> READY -> DMA plays it -> FREE
+  *
+  * The DMA half/full interrupts call DMA_Slots_Advance(), the processing
+  * context gets direct pointers into DMA memory with DMA_Slots_Acquire()
+  * and hands them back with DMA_Slots_Release(). When the DMA moves into a
+  * slot the CPU still owns, or a Tx slot that was never written, the frame
+  * is counted as late instead of being silently overwritten or replayed.
+  *
+  * With HAL circular mode the two halves are the two slots, the same
+  * pairing the stream double-buffer mode (M0AR/M1AR) would give. The ring
+  * itself has no hardware dependency, so the host simulator drives the
+  * same code from its virtual-time callbacks.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __DMA_SLOTS_H
+#define __DMA_SLOTS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define DMA_SLOTS_MAX               4U      /* Upper limit for slots per ring */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Transfer direction of a ring
+  */
+typedef enum {
+  DMA_SLOTS_RX = 0,             /* Peripheral to memory (ADC) */
+  DMA_SLOTS_TX                  /* Memory to peripheral (DAC) */
+} DMA_Slots_Dir_TypeDef;
+
+/**
+  * @brief  Owner of a slot
+  */
+typedef enum {
+  DMA_SLOT_FREE = 0,            /* Nobody, waiting for its next owner */
+  DMA_SLOT_DMA,                 /* Being transferred by the stream */
+  DMA_SLOT_READY,               /* Handed over, waiting to be taken */
+  DMA_SLOT_CPU                  /* Acquired by the processing context */
+} DMA_Slot_Owner_TypeDef;
+
+/**
+  * @brief  Ring counters
+  */
+typedef struct {
+  uint32_t framesCompleted;     /* Slots finished by the DMA */
+  uint32_t framesAcquired;      /* Slots taken by the CPU */
+  uint32_t lateFrames;          /* DMA entered a slot the CPU still owned */
+  uint32_t droppedFrames;       /* Rx slot overwritten unread, Tx slot replayed */
+  uint32_t staleReleases;       /* CPU released a slot the DMA had reclaimed */
+} DMA_Slots_Stats_TypeDef;
+
+/**
+  * @brief  One circular buffer split into frame slots
+  */
+typedef struct {
+  int32_t *base;                /* Start of the DMA buffer */
+  uint32_t slotWords;           /* 32-bit words per slot */
+  uint8_t count;                /* Slots in the buffer */
+  uint8_t dir;                  /* DMA_Slots_Dir_TypeDef */
+  volatile uint8_t dmaSlot;     /* Slot the stream is transferring */
+  volatile uint8_t cpuSlot;     /* Slot held by the CPU, count if none */
+  volatile uint8_t owner[DMA_SLOTS_MAX];
+  DMA_Slots_Stats_TypeDef stats;
+} DMA_Slots_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void DMA_Slots_Init(DMA_Slots_TypeDef *ring, int32_t *base, uint32_t slotWords, uint8_t count,
+                    DMA_Slots_Dir_TypeDef dir);
+void DMA_Slots_Advance(DMA_Slots_TypeDef *ring);
+int32_t *DMA_Slots_Acquire(DMA_Slots_TypeDef *ring);
+uint8_t DMA_Slots_Release(DMA_Slots_TypeDef *ring);
+uint8_t DMA_Slots_IsOwned(const DMA_Slots_TypeDef *ring);
+void DMA_Slots_GetStats(const DMA_Slots_TypeDef *ring, DMA_Slots_Stats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DMA_SLOTS_H */
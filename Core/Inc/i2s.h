@@ -47,7 +47,8 @@ typedef enum {
 
 /* Exported variables --------------------------------------------------------*/
 extern I2S_HandleTypeDef hi2s2;  /* For PCM1808 (ADC) */
-extern I2S_HandleTypeDef hi2s3;  /* For PCM5102A (DAC) */
+extern I2S_HandleTypeDef hi2s3;  /* For PCM5102A (DAC) outputs 1-2 */
+extern I2S_HandleTypeDef hi2s4;  /* For PCM5102A (DAC) outputs 3-4 */
 
 /* Exported functions prototypes ---------------------------------------------*/
 void MX_I2S2_Init(void); /* Initialize I2S2 for PCM1808 (ADC) */
@@ -58,6 +59,8 @@ I2S_Status_TypeDef I2S_StartAudioInterface(void);
 I2S_Status_TypeDef I2S_StopAudioInterface(void);
 I2S_Status_TypeDef I2S_TransmitData(uint16_t *pData, uint16_t Size);
 I2S_Status_TypeDef I2S_ReceiveData(uint16_t *pData, uint16_t Size);
+HAL_StatusTypeDef I2S_StartOutputsLockstep(int32_t *dac1Buffer, int32_t *dac2Buffer, uint16_t size);
+int32_t I2S_GetOutputSkew(uint16_t size);
 void I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s);
 void I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s);
 void I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s);
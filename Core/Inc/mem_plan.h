@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : mem_plan.h
+  * @brief          : Static memory planner with mode overlays
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Large buffers of features that never run together share one arena.
+  * Every buffer is declared once in MEM_PLAN_TABLE with the mode it
+  * belongs to; buffers of the same mode are packed one after another
+  * from the arena start, so the modes overlay each other and the arena
+  * is only as large as the largest mode. The sizes are compile-time
+  * constants and the arena is checked against MEM_PLAN_RAM_BUDGET when
+  * mem_plan.c is compiled.
+  *
+  * Buffer addresses never move. What changes is the owner: a feature
+  * calls MemPlan_Enter() for its mode before touching its buffers, and
+  * the switch is refused while the current owner still holds data
+  * (FIR filters loaded, measurement or IIR fit running). Nothing is evicted
+  * behind a feature's back.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __MEM_PLAN_H
+#define __MEM_PLAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "convolution.h"
+#include "audio_analyzer.h"
+#include "iir_fit.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define MEM_PLAN_RAM_BUDGET         (72U * 1024U)   /* Arena share of the 128 KB SRAM */
+#define MEM_PLAN_ALIGN(bytes)       (((uint32_t)(bytes) + 7U) & ~7U)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Mutually exclusive arena owners
+  */
+typedef enum {
+  MEM_MODE_NONE = 0,            /* Arena unused */
+  MEM_MODE_FIR,                 /* FIR partitions and spectra */
+  MEM_MODE_MEASURE,             /* Loopback analyzer capture */
+  MEM_MODE_FIT,                 /* IIR fit workspace */
+  MEM_MODE_COUNT
+} MemPlan_Mode_TypeDef;
+
+/* Overlay buffers: name, owning mode, size in bytes */
+#define MEM_PLAN_TABLE(X) \
+  X(MEM_BUF_CONV_POOL,         MEM_MODE_FIR,      CONV_POOL_FLOATS * sizeof(float)) \
+  X(MEM_BUF_ANALYZER_CAPTURE,  MEM_MODE_MEASURE,  ANALYZER_CAPTURE_SAMPLES * sizeof(float)) \
+  X(MEM_BUF_IIRFIT_MATRIX,     MEM_MODE_FIT,      IIRFIT_MATRIX_BYTES) \
+  X(MEM_BUF_IIRFIT_CEPSTRUM,   MEM_MODE_FIT,      IIRFIT_CEPSTRUM_BYTES)
+
+/**
+  * @brief  Overlay buffers
+  */
+typedef enum {
+#define MEM_PLAN_ENUM(name, mode, bytes) name,
+  MEM_PLAN_TABLE(MEM_PLAN_ENUM)
+#undef MEM_PLAN_ENUM
+  MEM_BUF_COUNT
+} MemPlan_Buffer_TypeDef;
+
+/* Peak usage per mode, evaluated by the compiler */
+#define MEM_PLAN_IN_FIR(name, mode, bytes)      + (((mode) == MEM_MODE_FIR) ? MEM_PLAN_ALIGN(bytes) : 0U)
+#define MEM_PLAN_IN_MEASURE(name, mode, bytes)  + (((mode) == MEM_MODE_MEASURE) ? MEM_PLAN_ALIGN(bytes) : 0U)
+#define MEM_PLAN_IN_FIT(name, mode, bytes)      + (((mode) == MEM_MODE_FIT) ? MEM_PLAN_ALIGN(bytes) : 0U)
+#define MEM_PLAN_IN_ANY(name, mode, bytes)      + MEM_PLAN_ALIGN(bytes)
+
+#define MEM_PLAN_FIR_BYTES          (0U MEM_PLAN_TABLE(MEM_PLAN_IN_FIR))
+#define MEM_PLAN_MEASURE_BYTES      (0U MEM_PLAN_TABLE(MEM_PLAN_IN_MEASURE))
+#define MEM_PLAN_FIT_BYTES          (0U MEM_PLAN_TABLE(MEM_PLAN_IN_FIT))
+#define MEM_PLAN_SEPARATE_BYTES     (0U MEM_PLAN_TABLE(MEM_PLAN_IN_ANY))
+#define MEM_PLAN_MAX(a, b)          (((a) > (b)) ? (a) : (b))
+#define MEM_PLAN_ARENA_BYTES        MEM_PLAN_MAX(MEM_PLAN_MAX(MEM_PLAN_FIR_BYTES, MEM_PLAN_MEASURE_BYTES), \
+                                                 MEM_PLAN_FIT_BYTES)
+
+/* Exported functions --------------------------------------------------------*/
+void MemPlan_Init(void);
+void *MemPlan_GetBuffer(MemPlan_Buffer_TypeDef buffer);
+HAL_StatusTypeDef MemPlan_Enter(MemPlan_Mode_TypeDef mode);
+MemPlan_Mode_TypeDef MemPlan_GetMode(void);
+uint32_t MemPlan_GetModeBytes(MemPlan_Mode_TypeDef mode);
+const char *MemPlan_GetModeName(MemPlan_Mode_TypeDef mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_PLAN_H */
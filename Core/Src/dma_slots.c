@@ -0,0 +1,216 @@
+/**
+  ******************************************************************************
+  * @file           : dma_slots.c
+  * @brief          : Ownership tracking for circular audio DMA buffers
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * DMA_Slots_Advance() runs in the DMA interrupt, Acquire/Release in the
+  * main loop. The ownership hand-over in the main loop is a read-modify-
+  * write of the same byte the interrupt writes, so it runs with interrupts
+  * masked for a few instructions.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dma_slots.h"
+#include "main.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Private macro -------------------------------------------------------------*/
+#ifdef AUDIO_SIM
+/* Simulator callbacks never preempt the main loop */
+#define DMA_SLOTS_LOCK(m)           do { (m) = 0U; } while (0)
+#define DMA_SLOTS_UNLOCK(m)         do { (void)(m); } while (0)
+#else
+#define DMA_SLOTS_LOCK(m)           do { (m) = __get_PRIMASK(); __disable_irq(); } while (0)
+#define DMA_SLOTS_UNLOCK(m)         do { if ((m) == 0U) { __enable_irq(); } } while (0)
+#endif
+
+#define DMA_SLOTS_NEXT(r, s)        ((uint8_t)(((s) + 1U) % (r)->count))
+#define DMA_SLOTS_PREV(r, s)        ((uint8_t)(((s) + (r)->count - 1U) % (r)->count))
+
+/**
+  * @brief  Split a DMA buffer into slots, before the stream is started
+  * @param  ring: Ring to initialize
+  * @param  base: DMA buffer, count * slotWords words
+  * @param  slotWords: Words per slot (one frame, all channels)
+  * @param  count: Number of slots, 2 for HAL half/full circular mode
+  * @param  dir: Transfer direction
+  * @note   Tx slots start as READY, the caller clears the buffer so the
+  *         stream plays silence until the first frame is written
+  * @retval None
+  */
+void DMA_Slots_Init(DMA_Slots_TypeDef *ring, int32_t *base, uint32_t slotWords, uint8_t count,
+                    DMA_Slots_Dir_TypeDef dir)
+{
+  memset(ring, 0, sizeof(*ring));
+
+  if (count < 2U) {
+    count = 2U;
+  } else if (count > DMA_SLOTS_MAX) {
+    count = DMA_SLOTS_MAX;
+  }
+
+  ring->base = base;
+  ring->slotWords = slotWords;
+  ring->count = count;
+  ring->dir = (uint8_t)dir;
+  ring->dmaSlot = 0U;
+  ring->cpuSlot = count;
+
+  for (uint8_t s = 0; s < count; s++) {
+    ring->owner[s] = (dir == DMA_SLOTS_TX) ? DMA_SLOT_READY : DMA_SLOT_FREE;
+  }
+  ring->owner[0] = DMA_SLOT_DMA;
+}
+
+/**
+  * @brief  The stream finished the current slot and moved into the next one
+  * @note   Call from the half and full transfer complete interrupts
+  * @param  ring: Ring of the stream
+  * @retval None
+  */
+void DMA_Slots_Advance(DMA_Slots_TypeDef *ring)
+{
+  const uint8_t done = ring->dmaSlot;
+  const uint8_t next = DMA_SLOTS_NEXT(ring, done);
+
+  ring->stats.framesCompleted++;
+
+  /* Completed slot goes to its next owner */
+  ring->owner[done] = (ring->dir == DMA_SLOTS_RX) ? DMA_SLOT_READY : DMA_SLOT_FREE;
+
+  /* The stream is already inside the next slot, check who had it */
+  switch (ring->owner[next]) {
+    case DMA_SLOT_CPU:
+      /* Processing did not finish in time, its data is being overwritten or sent half done */
+      ring->stats.lateFrames++;
+      break;
+
+    case DMA_SLOT_READY:
+      if (ring->dir == DMA_SLOTS_RX) {
+        /* Captured frame nobody took */
+        ring->stats.droppedFrames++;
+      }
+      break;
+
+    case DMA_SLOT_FREE:
+      if (ring->dir == DMA_SLOTS_TX) {
+        /* Nothing written since the last pass, the old frame is played again */
+        ring->stats.droppedFrames++;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  ring->owner[next] = DMA_SLOT_DMA;
+  ring->dmaSlot = next;
+}
+
+/**
+  * @brief  Take the slot the processing context works on this frame
+  * @note   Rx: the most recently captured slot. Tx: the free slot the
+  *         stream reaches first. The pointer is valid until Release.
+  * @param  ring: Ring to take a slot from
+  * @retval Slot memory, NULL if no slot is available or one is already held
+  */
+int32_t *DMA_Slots_Acquire(DMA_Slots_TypeDef *ring)
+{
+  int32_t *slot = NULL;
+  uint32_t mask;
+
+  if (ring->cpuSlot < ring->count) {
+    return NULL;
+  }
+
+  DMA_SLOTS_LOCK(mask);
+
+  if (ring->dir == DMA_SLOTS_RX) {
+    const uint8_t s = DMA_SLOTS_PREV(ring, ring->dmaSlot);
+
+    if (ring->owner[s] == DMA_SLOT_READY) {
+      ring->owner[s] = DMA_SLOT_CPU;
+      ring->cpuSlot = s;
+    }
+  } else {
+    uint8_t s = DMA_SLOTS_NEXT(ring, ring->dmaSlot);
+
+    for (uint8_t n = 1; n < ring->count; n++) {
+      if (ring->owner[s] == DMA_SLOT_FREE) {
+        ring->owner[s] = DMA_SLOT_CPU;
+        ring->cpuSlot = s;
+        break;
+      }
+      s = DMA_SLOTS_NEXT(ring, s);
+    }
+  }
+
+  DMA_SLOTS_UNLOCK(mask);
+
+  if (ring->cpuSlot < ring->count) {
+    ring->stats.framesAcquired++;
+    slot = ring->base + (uint32_t)ring->cpuSlot * ring->slotWords;
+  }
+
+  return slot;
+}
+
+/**
+  * @brief  Hand the held slot back
+  * @note   Rx slots become FREE for the stream, Tx slots READY to be played
+  * @param  ring: Ring the slot was taken from
+  * @retval 1 if the CPU still owned the slot, 0 if the stream had already
+  *         reclaimed it (late frame) or nothing was held
+  */
+uint8_t DMA_Slots_Release(DMA_Slots_TypeDef *ring)
+{
+  const uint8_t s = ring->cpuSlot;
+  uint8_t ok = 0;
+  uint32_t mask;
+
+  if (s >= ring->count) {
+    return 0;
+  }
+
+  DMA_SLOTS_LOCK(mask);
+
+  if (ring->owner[s] == DMA_SLOT_CPU) {
+    ring->owner[s] = (ring->dir == DMA_SLOTS_RX) ? DMA_SLOT_FREE : DMA_SLOT_READY;
+    ok = 1;
+  } else {
+    ring->stats.staleReleases++;
+  }
+  ring->cpuSlot = ring->count;
+
+  DMA_SLOTS_UNLOCK(mask);
+
+  return ok;
+}
+
+/**
+  * @brief  Check whether the processing context holds a slot
+  * @param  ring: Ring to check
+  * @retval 1 if a slot is held, 0 otherwise
+  */
+uint8_t DMA_Slots_IsOwned(const DMA_Slots_TypeDef *ring)
+{
+  return (ring->cpuSlot < ring->count) ? 1 : 0;
+}
+
+/**
+  * @brief  Copy the ring counters
+  * @param  ring: Ring to read
+  * @param  stats: Pointer to store the counters
+  * @retval None
+  */
+void DMA_Slots_GetStats(const DMA_Slots_TypeDef *ring, DMA_Slots_Stats_TypeDef *stats)
+{
+  *stats = ring->stats;
+}
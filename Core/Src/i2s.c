@@ -37,6 +37,11 @@ DMA_HandleTypeDef hdma_spi2_rx;
 DMA_HandleTypeDef hdma_spi3_tx;
 DMA_HandleTypeDef hdma_spi4_tx;
 
+/* DAC buffers of the running streams, for a lockstep restart after an error */
+static int32_t *dacBuffer1;
+static int32_t *dacBuffer2;
+static uint16_t dacBufferSize;
+
 /* Private function prototypes -----------------------------------------------*/
 static void I2S2_Init(uint32_t AudioFreq);
 static void I2S3_Init(uint32_t AudioFreq);
@@ -156,17 +161,10 @@ HAL_StatusTypeDef I2S_StartAudio(int32_t *input_buffer, int32_t *output_buffer1,
     return status;
   }
   
-  /* Start I2S3 transmission with DMA (PCM5102A channels 1-2) */
-  status = HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*)output_buffer1, size * 2);
-  if (status != HAL_OK) {
-    DEBUG_PRINT("Error: Could not start I2S3 transmission\r\n");
-    return status;
-  }
-  
-  /* Start I2S4 transmission with DMA (PCM5102A channels 3-4) */
-  status = HAL_I2S_Transmit_DMA(&hi2s4, (uint16_t*)output_buffer2, size * 2);
+  /* Start I2S3 (channels 1-2) and I2S4 (channels 3-4) together */
+  status = I2S_StartOutputsLockstep(output_buffer1, output_buffer2, size * 2);
   if (status != HAL_OK) {
-    DEBUG_PRINT("Error: Could not start I2S4 transmission\r\n");
+    DEBUG_PRINT("Error: Could not start I2S3/I2S4 transmission\r\n");
     return status;
   }
   
@@ -174,6 +172,69 @@ HAL_StatusTypeDef I2S_StartAudio(int32_t *input_buffer, int32_t *output_buffer1,
   return HAL_OK;
 }
 
+/**
+  * @brief  Start both DAC streams back to back
+  * @note   Interrupts are held off between the two starts, so the word
+  *         clocks begin well under one sample apart. I2S4 goes first:
+  *         the CPU is paced by the I2S3 callbacks, and the paced stream
+  *         must be the one that trails, never the one that leads.
+  * @param  dac1Buffer: Circular buffer of I2S3 (outputs 1-2)
+  * @param  dac2Buffer: Circular buffer of I2S4 (outputs 3-4)
+  * @param  size: Length of each buffer in 32-bit words
+  * @retval HAL status
+  */
+HAL_StatusTypeDef I2S_StartOutputsLockstep(int32_t *dac1Buffer, int32_t *dac2Buffer, uint16_t size)
+{
+  HAL_StatusTypeDef status;
+  const uint32_t primask = __get_PRIMASK();
+  
+  dacBuffer1 = dac1Buffer;
+  dacBuffer2 = dac2Buffer;
+  dacBufferSize = size;
+  
+  __disable_irq();
+  
+  status = HAL_I2S_Transmit_DMA(&hi2s4, (uint16_t*)dac2Buffer, size);
+  if (status == HAL_OK) {
+    status = HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*)dac1Buffer, size);
+    if (status != HAL_OK) {
+      HAL_I2S_DMAStop(&hi2s4);
+    }
+  }
+  
+  __set_PRIMASK(primask);
+  
+  return status;
+}
+
+/**
+  * @brief  Measure how far I2S4 plays ahead of I2S3
+  * @note   Both DMA counters are read back to back; valid while both
+  *         streams run on equal-sized buffers
+  * @param  size: Length of each buffer in 32-bit words
+  * @retval Lead of I2S4 in sample frames, negative if it trails
+  */
+int32_t I2S_GetOutputSkew(uint16_t size)
+{
+  const int32_t total = (int32_t)size * 2;    /* DMA counts half-words */
+  const uint32_t primask = __get_PRIMASK();
+  int32_t lead;
+  
+  __disable_irq();
+  lead = (int32_t)__HAL_DMA_GET_COUNTER(hi2s3.hdmatx) - (int32_t)__HAL_DMA_GET_COUNTER(hi2s4.hdmatx);
+  __set_PRIMASK(primask);
+  
+  /* Circular buffers: the smaller distance is the real one */
+  if (lead > total / 2) {
+    lead -= total;
+  } else if (lead < -total / 2) {
+    lead += total;
+  }
+  
+  /* Four half-words per stereo frame of 32-bit slots, rounded */
+  return (lead >= 0) ? (lead + 2) / 4 : -((2 - lead) / 4);
+}
+
 /**
   * @brief Stop I2S interfaces
   * @retval HAL status
@@ -269,12 +330,13 @@ void HAL_I2S_ErrorCallback(I2S_HandleTypeDef *hi2s)
   if (hi2s->Instance == SPI2) {
     HAL_I2S_DMAStop(&hi2s2);
     HAL_I2S_Receive_DMA(&hi2s2, (uint16_t*)hi2s->pRxBuffPtr, hi2s->RxXferSize);
-  } else if (hi2s->Instance == SPI3) {
+  } else if ((hi2s->Instance == SPI3 || hi2s->Instance == SPI4) && dacBufferSize > 0U) {
+    /* Restarting one DAC alone would leave it skewed against the other */
     HAL_I2S_DMAStop(&hi2s3);
-    HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*)hi2s->pTxBuffPtr, hi2s->TxXferSize);
-  } else if (hi2s->Instance == SPI4) {
     HAL_I2S_DMAStop(&hi2s4);
-    HAL_I2S_Transmit_DMA(&hi2s4, (uint16_t*)hi2s->pTxBuffPtr, hi2s->TxXferSize);
+    if (I2S_StartOutputsLockstep(dacBuffer1, dacBuffer2, dacBufferSize) != HAL_OK) {
+      DEBUG_PRINT("Error: Could not restart I2S3/I2S4 transmission\r\n");
+    }
   }
 }
 
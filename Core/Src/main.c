@@ -28,6 +28,23 @@
 #include "audio_driver.h"
 #include "audio_routing.h"
 #include "audio_processing.h"
+#include "crossover.h"
+#include "peq.h"
+#include "compressor.h"
+#include "limiter.h"
+#include "delay.h"
+#include "latency_manager.h"
+#include "cpu_budget.h"
+#include "quality_scaler.h"
+#include "convolution.h"
+#include "input_gate.h"
+#include "input_strip.h"
+#include "param_snapshot.h"
+#include "auto_eq.h"
+#include "audio_analyzer.h"
+#include "iir_fit.h"
+#include "preset_morph.h"
+#include "signal_health.h"
 
 /* UI includes */
 #include "ui_config.h"
@@ -44,16 +61,21 @@
 /* Utility includes */
 #include "debug.h"
 #include "system_monitor.h"
+#include <string.h>
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 void System_Init(void);
 void Error_Handler(void);
+static void Audio_MainLoopService(void);
 static void Audio_Pipeline_Process(void);
+static void Audio_Pipeline_ProcessChain(void);
 
 /* Private variables ---------------------------------------------------------*/
 static volatile uint32_t systemTicks = 0;
 static volatile uint8_t audioProcessFlag = 0;
+static volatile uint8_t audioOverrun = 0;
+static volatile uint32_t audioSignalCycles = 0;
 static volatile uint8_t uiUpdateFlag = 0;
 static volatile uint32_t lastUserInteraction = 0;
 
@@ -63,6 +85,7 @@ AudioBuffer_TypeDef audioOutputBuffer;
 /* Global variables ---------------------------------------------------------*/
 SystemState_TypeDef SystemState;
 
+#ifndef AUDIO_SIM
 /**
   * @brief  The application entry point.
   * @retval int
@@ -100,11 +123,8 @@ int main(void)
   /* Infinite loop */
   while (1)
   {
-    /* Audio DSP processing */
-    if (audioProcessFlag) {
-      audioProcessFlag = 0;
-      Audio_Pipeline_Process();
-    }
+    /* Audio DSP processing and its control-rate services */
+    Audio_MainLoopService();
     
     /* UI update at lower frequency */
     if (uiUpdateFlag) {
@@ -136,7 +156,59 @@ int main(void)
     DEBUG_ProcessCommands();
   }
 }
+#else
+/**
+  * @brief  Audio part of one main loop pass, driven by the host simulator
+  * @note   Sim/Src/sim_main.c provides main() in AUDIO_SIM builds
+  * @retval None
+  */
+void Audio_SimService(void)
+{
+  Audio_MainLoopService();
+}
+#endif /* AUDIO_SIM */
 
+/**
+  * @brief  Audio part of one main loop pass
+  * @note   Shared by the firmware loop and the host simulator, so both run
+  *         the same service sequence
+  * @retval None
+  */
+static void Audio_MainLoopService(void)
+{
+  if (audioProcessFlag) {
+    const uint32_t signalCycles = audioSignalCycles;
+    
+    audioProcessFlag = 0;
+    Audio_Pipeline_Process();
+    
+    /* Deadline slack, from the DMA signal to the last output write */
+    QualityScaler_ReportFrame(DWT->CYCCNT - signalCycles, audioOverrun);
+    audioOverrun = 0;
+  }
+  
+  /* Re-align outputs if any stage changed its latency */
+  Latency_Update();
+  
+  /* Calibrate the cost model from the last measured frames */
+  CpuBudget_Update();
+  
+  /* Step the quality ladder on the deadline slack */
+  QualityScaler_Update();
+  
+  /* Preset morph steps at control rate, cheap between steps */
+  Morph_Service();
+  
+  /* Background EQ fit, only in the gap before the next frame is due
+     and paused while the quality scaler is short of slack */
+  if (!audioProcessFlag && QualityScaler_IsAnalysisAllowed()) {
+    AutoEQ_Service(AUTOEQ_SERVICE_CYCLES);
+    Analyzer_Service(ANALYZER_SERVICE_CYCLES);
+    IIRFit_Service(IIRFIT_SERVICE_CYCLES);
+  }
+}
+
+#ifndef AUDIO_SIM
 /**
   * @brief System Clock Configuration
   * @retval None
@@ -187,6 +259,7 @@ void SystemClock_Config(void)
     Error_Handler();
   }
 }
+#endif /* AUDIO_SIM */
 
 /**
   * @brief Audio Processing Pipeline
@@ -196,44 +269,116 @@ void SystemClock_Config(void)
 static void Audio_Pipeline_Process(void)
 {
   uint32_t startTime = DWT->CYCCNT;  // For performance measurement
+  uint8_t silent;
+  
+  /* Parameters published since the last frame apply from here on */
+  ParamSnapshot_AcquireFrame();
+  CpuBudget_BeginFrame();
   
   /* Get samples from ADC */
   Audio_GetInputSamples(&audioInputBuffer);
   
+  /* Loopback analyzer owns the converters while it measures */
+  if (Analyzer_IsActive()) {
+    Analyzer_ProcessFrame(&audioInputBuffer, &audioOutputBuffer);
+    Audio_SendOutputSamples(&audioOutputBuffer);
+    SystemState.dspLoadPercent = ((DWT->CYCCNT - startTime) * 100) / SystemState.dspCyclesPerFrame;
+    return;
+  }
+  
+  /* Gate idle inputs before they reach the routing matrix */
+  InputGate_Process(&audioInputBuffer);
+  
+  /* All inputs gated long enough for every tail to decay: skip the chain,
+     but keep the morph, health check and meters running on the silence */
+  silent = InputGate_IsSilent();
+  if (silent) {
+    for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
+      memset(audioOutputBuffer.samples[i], 0, AUDIO_FRAME_SIZE * sizeof(float));
+    }
+  } else {
+    Audio_Pipeline_ProcessChain();
+  }
+  
+  /* Fade around a discrete switch of a preset morph */
+  Morph_ProcessFrame(&audioOutputBuffer);
+  
+  /* Update VU meter levels; also the health check, so it runs before the
+     DAC gets the frame and can mute a bad one */
+  for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
+    SystemState.vuMeterLevels[i] = Audio_CalculateRMS(i, &audioOutputBuffer);
+  }
+  
+  /* Send processed samples to DAC */
+  Audio_SendOutputSamples(&audioOutputBuffer);
+  
+  /* Only full-chain frames at configured quality calibrate the cost model */
+  if (!silent && !QualityScaler_IsChainReduced()) {
+    CpuBudget_EndFrame();
+  }
+  
+  /* Performance monitoring */
+  SystemState.dspLoadPercent = ((DWT->CYCCNT - startTime) * 100) / SystemState.dspCyclesPerFrame;
+}
+
+/**
+  * @brief Output DSP chain from the input strips to the final gain
+  * @retval None
+  */
+static void Audio_Pipeline_ProcessChain(void)
+{
+  uint32_t probe;
+  
+  /* Source corrections, once per input instead of once per routed output */
+  InputStrip_Process(&audioInputBuffer);
+  
   /* Apply routing matrix */
   AudioRouting_Process(&audioInputBuffer, &audioOutputBuffer);
   
+  /* Channels with a bad output last frame get every stage probed */
+  probe = Health_BeginFrame();
+  
+  /* Everything up to here is the fixed part of the frame cost */
+  CpuBudget_Mark(CPUBUDGET_STAGE_FIXED);
+  
   /* Process each output channel through DSP chain */
   for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
     /* Apply crossover filters */
     DSP_Crossover_Process(i, &audioOutputBuffer);
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_CROSSOVER, audioOutputBuffer.samples[i]);
+    CpuBudget_Mark(CPUBUDGET_STAGE_CROSSOVER);
     
     /* Apply parametric EQ */
     DSP_EQ_Process(i, &audioOutputBuffer);
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_EQ, audioOutputBuffer.samples[i]);
+    CpuBudget_Mark(CPUBUDGET_STAGE_EQ);
     
-    /* Apply dynamics processing (compressor) */
-    DSP_Compressor_Process(i, &audioOutputBuffer);
+    /* Apply FIR room/driver correction */
+    Convolution_Process(i, audioOutputBuffer.samples[i], AUDIO_FRAME_SIZE);
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_FIR, audioOutputBuffer.samples[i]);
+    CpuBudget_Mark(CPUBUDGET_STAGE_FIR);
+  }
+  
+  /* Apply dynamics processing (compressor), all channels in one pass */
+  DSP_Compressor_ProcessAll(&audioOutputBuffer);
+  CpuBudget_Mark(CPUBUDGET_STAGE_COMPRESSOR);
+  
+  for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_COMPRESSOR, audioOutputBuffer.samples[i]);
     
     /* Apply limiter for protection */
     DSP_Limiter_Process(i, &audioOutputBuffer);
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_LIMITER, audioOutputBuffer.samples[i]);
+    CpuBudget_Mark(CPUBUDGET_STAGE_LIMITER);
     
     /* Apply delay */
     DSP_Delay_Process(i, &audioOutputBuffer);
-    
-    /* Apply final gain */
-    DSP_Gain_Process(i, &audioOutputBuffer);
-  }
-  
-  /* Send processed samples to DAC */
-  Audio_SendOutputSamples(&audioOutputBuffer);
-  
-  /* Update VU meter levels */
-  for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
-    SystemState.vuMeterLevels[i] = Audio_CalculateRMS(i, &audioOutputBuffer);
+    HEALTH_PROBE(probe, i, HEALTH_STAGE_DELAY, audioOutputBuffer.samples[i]);
+    CpuBudget_Mark(CPUBUDGET_STAGE_DELAY);
   }
   
-  /* Performance monitoring */
-  SystemState.dspLoadPercent = ((DWT->CYCCNT - startTime) * 100) / SystemState.dspCyclesPerFrame;
+  /* Final gain is ramped from the frame snapshot in the output conversion
+     pass (Audio_PrepareOutputSamples), no separate pass over the buffer */
 }
 
 /**
@@ -259,6 +404,11 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
   */
 void Audio_ProcessCallback(void)
 {
+  /* The previous frame has not started yet, it is lost */
+  if (audioProcessFlag) {
+    audioOverrun = 1;
+  }
+  audioSignalCycles = DWT->CYCCNT;
   audioProcessFlag = 1;
 }
 
@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file           : mem_plan.c
+  * @brief          : Static memory planner with mode overlays
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The arena is a plain static array; offsets are derived from
+  * MEM_PLAN_TABLE on request, so the planner needs no setup before a
+  * feature takes its buffer pointer.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "mem_plan.h"
+#include "debug.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Build fails here if the largest mode no longer fits the budget */
+typedef char MemPlan_ArenaFits_TypeDef[(MEM_PLAN_ARENA_BYTES <= MEM_PLAN_RAM_BUDGET) ? 1 : -1];
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t arena[MEM_PLAN_ARENA_BYTES / sizeof(uint64_t)];
+static volatile MemPlan_Mode_TypeDef owner = MEM_MODE_NONE;
+
+static const uint8_t bufferMode[MEM_BUF_COUNT] = {
+#define MEM_PLAN_MODE(name, mode, bytes) (uint8_t)(mode),
+  MEM_PLAN_TABLE(MEM_PLAN_MODE)
+#undef MEM_PLAN_MODE
+};
+
+static const uint32_t bufferBytes[MEM_BUF_COUNT] = {
+#define MEM_PLAN_BYTES(name, mode, bytes) MEM_PLAN_ALIGN(bytes),
+  MEM_PLAN_TABLE(MEM_PLAN_BYTES)
+#undef MEM_PLAN_BYTES
+};
+
+static const char *const modeNames[MEM_MODE_COUNT] = { "NONE", "FIR", "MEASURE", "FIT" };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t MemPlan_IsHeld(MemPlan_Mode_TypeDef mode);
+
+/**
+  * @brief  Release the arena and report the plan
+  * @retval None
+  */
+void MemPlan_Init(void)
+{
+  owner = MEM_MODE_NONE;
+
+  DEBUG_PRINT("Memory plan: arena %lu bytes (FIR %lu, MEASURE %lu, FIT %lu), %lu saved by overlays\r\n",
+              (unsigned long)MEM_PLAN_ARENA_BYTES, (unsigned long)MEM_PLAN_FIR_BYTES,
+              (unsigned long)MEM_PLAN_MEASURE_BYTES, (unsigned long)MEM_PLAN_FIT_BYTES,
+              (unsigned long)(MEM_PLAN_SEPARATE_BYTES - MEM_PLAN_ARENA_BYTES));
+}
+
+/**
+  * @brief  Get the fixed address of an overlay buffer
+  * @note   The contents are only valid while the buffer's mode owns the arena
+  * @param  buffer: MEM_BUF_x
+  * @retval Buffer start, 8-byte aligned, NULL for an invalid buffer
+  */
+void *MemPlan_GetBuffer(MemPlan_Buffer_TypeDef buffer)
+{
+  uint32_t offset = 0;
+
+  if (buffer >= MEM_BUF_COUNT) {
+    return NULL;
+  }
+
+  /* Packed after the earlier buffers of the same mode */
+  for (uint32_t i = 0; i < (uint32_t)buffer; i++) {
+    if (bufferMode[i] == bufferMode[buffer]) {
+      offset += bufferBytes[i];
+    }
+  }
+
+  return (uint8_t *)arena + offset;
+}
+
+/**
+  * @brief  Take the arena for a mode
+  * @note   Call from the main loop before touching the mode's buffers
+  * @param  mode: MEM_MODE_x
+  * @retval HAL_OK if the mode owns the arena, HAL_BUSY if another mode
+  *         still holds data in it
+  */
+HAL_StatusTypeDef MemPlan_Enter(MemPlan_Mode_TypeDef mode)
+{
+  if (mode >= MEM_MODE_COUNT) {
+    return HAL_ERROR;
+  }
+
+  if (owner == mode) {
+    return HAL_OK;
+  }
+
+  if (MemPlan_IsHeld(owner)) {
+    DEBUG_PRINT("Memory plan: %s blocked, arena held by %s\r\n", modeNames[mode], modeNames[owner]);
+    return HAL_BUSY;
+  }
+
+  owner = mode;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the current arena owner
+  * @retval MemPlan_Mode_TypeDef
+  */
+MemPlan_Mode_TypeDef MemPlan_GetMode(void)
+{
+  return owner;
+}
+
+/**
+  * @brief  Get the planned peak usage of a mode
+  * @param  mode: MEM_MODE_x
+  * @retval Bytes
+  */
+uint32_t MemPlan_GetModeBytes(MemPlan_Mode_TypeDef mode)
+{
+  uint32_t bytes = 0;
+
+  for (uint32_t i = 0; i < MEM_BUF_COUNT; i++) {
+    if (bufferMode[i] == (uint8_t)mode) {
+      bytes += bufferBytes[i];
+    }
+  }
+
+  return bytes;
+}
+
+/**
+  * @brief  Get the name of a mode
+  * @param  mode: MEM_MODE_x
+  * @retval Name string
+  */
+const char *MemPlan_GetModeName(MemPlan_Mode_TypeDef mode)
+{
+  return (mode < MEM_MODE_COUNT) ? modeNames[mode] : "?";
+}
+
+/**
+  * @brief  Check whether a mode still has data in the arena
+  * @param  mode: MEM_MODE_x
+  * @retval 1 if switching away would destroy live data
+  */
+static uint8_t MemPlan_IsHeld(MemPlan_Mode_TypeDef mode)
+{
+  switch (mode) {
+    case MEM_MODE_FIR:
+      return (Convolution_GetPoolFree() < CONV_POOL_FLOATS) ? 1U : 0U;
+
+    case MEM_MODE_MEASURE:
+      return Analyzer_IsActive();
+
+    case MEM_MODE_FIT:
+      return IIRFit_IsActive();
+
+    default:
+      return 0;
+  }
+}
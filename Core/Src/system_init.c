@@ -30,6 +30,20 @@
 #include "audio_processing.h"
 #include "codec_pcm1808.h"
 #include "codec_pcm5102a.h"
+#include "latency_manager.h"
+#include "cpu_budget.h"
+#include "response_cache.h"
+#include "quality_scaler.h"
+#include "convolution.h"
+#include "input_gate.h"
+#include "input_strip.h"
+#include "coeff_batch.h"
+#include "param_snapshot.h"
+#include "param_registry.h"
+#include "preset_morph.h"
+#include "mem_plan.h"
+#include "signal_health.h"
+#include "level_stats.h"
 
 /* UI includes */
 #include "ui_config.h"
@@ -79,6 +93,9 @@ void System_Init(void)
   /* Initialize memory buffers */
   BufferManager_Init();
   
+  /* Pass-through parameter snapshot, before anything publishes settings */
+  ParamSnapshot_Init();
+  
   /* Initialize UI subsystem */
   UISubsystem_Init();
   
@@ -258,6 +275,16 @@ static void DSP_Init(void)
 {
   DEBUG_PRINT("Initializing DSP modules...\r\n");
   
+  /* Build coefficient designer tables before any filter is designed */
+  CoeffBatch_Init((float)AUDIO_SAMPLE_RATE);
+  
+  /* Response curves follow every filter design from here on */
+  ResponseCache_Init((float)AUDIO_SAMPLE_RATE);
+  
+  /* Cost model first, stages report their loads from their init on */
+  CpuBudget_Init();
+  QualityScaler_Init();
+  
   /* Initialize crossover filters */
   if (DSP_Crossover_Init() != HAL_OK) {
     DEBUG_PRINT("Crossover initialization failed!\r\n");
@@ -271,7 +298,7 @@ static void DSP_Init(void)
   }
   
   /* Initialize compressor */
-  if (DSP_Compressor_Init() != HAL_OK) {
+  if (DSP_Compressor_Init((float)AUDIO_SAMPLE_RATE) != HAL_OK) {
     DEBUG_PRINT("Compressor initialization failed!\r\n");
     Error_Handler();
   }
@@ -288,6 +315,33 @@ static void DSP_Init(void)
     Error_Handler();
   }
   
+  /* Initialize latency manager (uses delay lines for alignment) */
+  Latency_Init();
+  
+  /* Shared arena for FIR and measurement buffers, owned by nobody yet */
+  MemPlan_Init();
+  
+  /* Initialize FIR correction, outputs pass through until a filter is loaded */
+  Convolution_Init();
+  
+  /* Initialize input gates, bypassed by default */
+  InputGate_Init((float)AUDIO_SAMPLE_RATE);
+  
+  /* Initialize input strips (after the coefficient designer), flat by default */
+  InputStrip_Init((float)AUDIO_SAMPLE_RATE);
+  
+  /* Parameter registry over the modules above, then the morph that uses it */
+  ParamRegistry_Init();
+  
+  /* Initialize preset morph, idle until a morph is started */
+  Morph_Init((float)AUDIO_SAMPLE_RATE);
+  
+  /* Signal health monitor, checks every output frame from here on */
+  Health_Init();
+  
+  /* Level statistics, fed by the same meter pass */
+  LevelStats_Init((float)AUDIO_SAMPLE_RATE);
+  
   /* Set default DSP configuration */
   DSP_SetDefaultConfiguration();
   
@@ -17,6 +17,18 @@
 #include "usart.h"
 #include "gpio.h"
 #include "debug.h"
+#include "audio_driver.h"
+#include "latency_manager.h"
+#include "convolution.h"
+#include "input_strip.h"
+#include "audio_analyzer.h"
+#include "mem_plan.h"
+#include "signal_health.h"
+#include "level_stats.h"
+#include "cpu_budget.h"
+#include "quality_scaler.h"
+#include "param_registry.h"
+#include "response_cache.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,7 +48,7 @@ static volatile uint16_t uartRxIndex = 0;
 static volatile uint8_t uartRxComplete = 0;
 
 /* Command buffer for processing received commands */
-#define MAX_CMD_LENGTH          64
+#define MAX_CMD_LENGTH          128     /* Room for a line of FIR taps */
 static char cmdBuffer[MAX_CMD_LENGTH];
 static uint8_t cmdBufferIndex = 0;
 
@@ -169,8 +181,33 @@ static void UART_ProcessCommand(char *cmd)
     UART_SendString(" PRESET SAVE x - Save to preset x (1-10)\r\n");
     UART_SendString(" MUTE x - Mute channel x (1-4)\r\n");
     UART_SendString(" UNMUTE x - Unmute channel x (1-4)\r\n");
+    UART_SendString(" VOLUME d - Set master volume to d dB (0 to -80, 0.5 dB steps)\r\n");
+    UART_SendString(" INPUT x HPF f [2|4] - Subsonic high-pass on input x, f=0 off\r\n");
+    UART_SendString(" INPUT x EQ b f g q - Bell band b (1-4) on input x, EQ b OFF to clear\r\n");
+    UART_SendString(" INPUT x DELAY ms - Align input x (0-10 ms)\r\n");
+    UART_SendString(" INPUT x INVERT ON|OFF - Input polarity\r\n");
     UART_SendString(" XOVER x y - Set crossover frequency for channel x to y Hz\r\n");
     UART_SendString(" GAIN x y - Set gain for channel x to y dB\r\n");
+    UART_SendString(" FIR x LEN n - Start loading n FIR taps for channel x\r\n");
+    UART_SendString(" FIR x TAP i v... - Write taps starting at index i\r\n");
+    UART_SendString(" FIR x COMMIT - Activate loaded FIR on channel x\r\n");
+    UART_SendString(" FIR x OFF - Remove FIR from channel x\r\n");
+    UART_SendString(" ANALYZE THDN o i - THD+N test, output o looped to input i\r\n");
+    UART_SendString(" ANALYZE SWEEP o i - Frequency response, output o to input i\r\n");
+    UART_SendString(" ANALYZE REPORT - Print measured points\r\n");
+    UART_SendString(" ANALYZE STOP - Abort measurement\r\n");
+    UART_SendString(" MEM - Show the shared memory plan\r\n");
+    UART_SendString(" HEALTH - Show clip counts and signal faults\r\n");
+    UART_SendString(" HEALTH PROBE ON|OFF - Probe every stage on every frame\r\n");
+    UART_SendString(" LEVELS - Show peak, RMS, crest factor and clips per output\r\n");
+    UART_SendString(" LEVELS x - Show the peak histogram of output x\r\n");
+    UART_SendString(" LEVELS RESET - Clear level statistics\r\n");
+    UART_SendString(" CPU - Show frame budget and headroom\r\n");
+    UART_SendString(" QUALITY - Show quality level and transitions\r\n");
+    UART_SendString(" PARAM id - Read parameter id (0xFFCI: family, channel, index)\r\n");
+    UART_SendString(" PARAM id v - Set parameter id to v\r\n");
+    UART_SendString(" PARAMS - List parameter families and ranges\r\n");
+    UART_SendString(" CURVE x - Export the filter response of channel x\r\n");
   }
   /* Command: VERSION */
   else if (strcmp(cmd, "VERSION") == 0) {
@@ -183,7 +220,11 @@ static void UART_ProcessCommand(char *cmd)
     
     UART_SendString("System Status:\r\n");
     UART_Printf(" DSP load: %d%%\r\n", SystemState.dspLoadPercent);
+    UART_Printf(" CPU headroom: %d%%\r\n", CpuBudget_GetHeadroomPercent());
+    UART_Printf(" Quality: %s\r\n", QualityScaler_GetLevelName(QualityScaler_GetLevel()));
     UART_Printf(" Sample rate: %d Hz\r\n", SystemState.currentSampleRate);
+    UART_Printf(" I/O latency: %lu samples (%.2f ms)\r\n", 
+               (unsigned long)Latency_GetTotalSamples(), Latency_GetTotalMs());
     
     for (int i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
       UART_Printf(" Channel %d: %s, %d Hz, %+.1f dB\r\n", 
@@ -237,6 +278,352 @@ static void UART_ProcessCommand(char *cmd)
       UART_SendString("Invalid channel number\r\n");
     }
   }
+  /* Command pattern: VOLUME d */
+  else if (strncmp(cmd, "VOLUME ", 7) == 0) {
+    Audio_SetMasterVolume(strtof(&cmd[7], NULL));
+    UART_Printf("Master volume %.1f dB\r\n", Audio_GetMasterVolume());
+  }
+  /* Command pattern: INPUT x HPF f [o] | EQ b f g q | EQ b OFF | DELAY ms | INVERT ON|OFF */
+  else if (strncmp(cmd, "INPUT ", 6) == 0) {
+    char *arg;
+    long channelNum = strtol(&cmd[6], &arg, 10);
+    HAL_StatusTypeDef status = HAL_ERROR;
+    
+    while (*arg == ' ') {
+      arg++;
+    }
+    
+    if (channelNum < 1 || channelNum > AUDIO_INPUT_CHANNELS) {
+      UART_SendString("Invalid input number\r\n");
+      return;
+    }
+    
+    if (strncmp(arg, "HPF ", 4) == 0) {
+      char *next;
+      float frequency = strtof(&arg[4], &next);
+      long order = strtol(next, NULL, 10);
+      status = InputStrip_SetHighPass(channelNum - 1, frequency, (order == 4) ? 4U : 2U);
+    } else if (strncmp(arg, "EQ ", 3) == 0) {
+      char *next;
+      long band = strtol(&arg[3], &next, 10);
+      InputStrip_Band_TypeDef config = { COEFF_BATCH_BELL, 1000.0f, 0.0f, 1.0f, 0 };
+      
+      while (*next == ' ') {
+        next++;
+      }
+      if (strcmp(next, "OFF") != 0) {
+        config.frequency = strtof(next, &next);
+        config.gainDb = strtof(next, &next);
+        config.q = strtof(next, NULL);
+        config.enabled = 1;
+      }
+      if (band >= 1 && band <= (long)INPUT_STRIP_BANDS) {
+        status = InputStrip_SetBand(channelNum - 1, (uint8_t)(band - 1), &config);
+      }
+    } else if (strncmp(arg, "DELAY ", 6) == 0) {
+      status = InputStrip_SetDelay(channelNum - 1, strtof(&arg[6], NULL));
+    } else if (strcmp(arg, "INVERT ON") == 0 || strcmp(arg, "INVERT OFF") == 0) {
+      status = InputStrip_SetInvert(channelNum - 1, (arg[8] == 'N') ? 1U : 0U);
+    }
+    
+    UART_SendString((status == HAL_OK) ? "OK\r\n" : "INPUT command failed\r\n");
+  }
+  /* Command pattern: FIR x LEN n | TAP i v... | COMMIT | OFF */
+  else if (strncmp(cmd, "FIR ", 4) == 0) {
+    char *arg;
+    long channelNum = strtol(&cmd[4], &arg, 10);
+    HAL_StatusTypeDef status = HAL_ERROR;
+    
+    while (*arg == ' ') {
+      arg++;
+    }
+    
+    if (channelNum < 1 || channelNum > AUDIO_OUTPUT_CHANNELS) {
+      UART_SendString("Invalid channel number\r\n");
+      return;
+    }
+    
+    if (strncmp(arg, "LEN ", 4) == 0) {
+      status = Convolution_BeginLoad(channelNum - 1, (uint32_t)strtoul(&arg[4], NULL, 10));
+    } else if (strncmp(arg, "TAP ", 4) == 0) {
+      float taps[16];
+      uint32_t count = 0;
+      char *next;
+      uint32_t offset = (uint32_t)strtoul(&arg[4], &next, 10);
+      
+      /* Values follow the start index, space separated */
+      while (count < 16) {
+        char *end;
+        taps[count] = strtof(next, &end);
+        if (end == next) {
+          break;
+        }
+        next = end;
+        count++;
+      }
+      status = Convolution_LoadTaps(channelNum - 1, offset, taps, count);
+    } else if (strcmp(arg, "COMMIT") == 0) {
+      status = Convolution_Commit(channelNum - 1);
+      if (status == HAL_BUSY) {
+        UART_SendString("FIR refused, not enough CPU headroom\r\n");
+        return;
+      }
+    } else if (strcmp(arg, "OFF") == 0) {
+      Convolution_Disable(channelNum - 1);
+      status = HAL_OK;
+    }
+    
+    if (status == HAL_BUSY) {
+      UART_SendString("FIR memory in use by the analyzer\r\n");
+    } else {
+      UART_SendString((status == HAL_OK) ? "OK\r\n" : "FIR command failed\r\n");
+    }
+  }
+  /* Command pattern: ANALYZE THDN o i | SWEEP o i | REPORT | STOP */
+  else if (strncmp(cmd, "ANALYZE ", 8) == 0) {
+    char *arg = &cmd[8];
+    
+    if (strncmp(arg, "THDN ", 5) == 0 || strncmp(arg, "SWEEP ", 6) == 0) {
+      Analyzer_Config_TypeDef config;
+      char *next;
+      long out, in;
+      
+      Analyzer_GetDefaultConfig(&config);
+      if (arg[0] == 'S') {
+        config.mode = ANALYZER_MODE_SWEEP;
+        config.points = ANALYZER_MAX_POINTS;
+        config.settleMs = 20.0f;
+        arg += 6;
+      } else {
+        arg += 5;
+      }
+      
+      out = strtol(arg, &next, 10);
+      in = strtol(next, NULL, 10);
+      
+      if (out < 1 || in < 1) {
+        UART_SendString("Invalid channel number\r\n");
+        return;
+      }
+      
+      config.outputChannel = (uint8_t)(out - 1);
+      config.inputChannel = (uint8_t)(in - 1);
+      switch (Analyzer_Start(&config)) {
+        case HAL_OK:
+          UART_SendString("OK\r\n");
+          break;
+        case HAL_BUSY:
+          UART_SendString("Analyzer memory in use, turn FIR filters OFF first\r\n");
+          break;
+        default:
+          UART_SendString("ANALYZE failed\r\n");
+          break;
+      }
+    } else if (strcmp(arg, "REPORT") == 0) {
+      Analyzer_Point_TypeDef point;
+      
+      UART_Printf("Analyzer: %s, %d points\r\n",
+                 Analyzer_IsActive() ? "running" : "idle", Analyzer_GetPointCount());
+      
+      for (uint8_t i = 0; Analyzer_GetPoint(i, &point) == HAL_OK; i++) {
+        UART_Printf(" %8.1f Hz %+7.2f dB %+7.1f deg THD+N %6.1f dB H2 %6.1f H3 %6.1f\r\n",
+                   point.frequency, point.levelDb, point.phaseDeg, point.thdnDb,
+                   point.harmonicDb[0], point.harmonicDb[1]);
+      }
+    } else if (strcmp(arg, "STOP") == 0) {
+      Analyzer_Stop();
+      UART_SendString("OK\r\n");
+    } else {
+      UART_SendString("Unknown ANALYZE command\r\n");
+    }
+  }
+  /* Command: MEM */
+  else if (strcmp(cmd, "MEM") == 0) {
+    UART_Printf("Memory plan: arena %lu bytes, owner %s\r\n",
+               (unsigned long)MEM_PLAN_ARENA_BYTES, MemPlan_GetModeName(MemPlan_GetMode()));
+    
+    for (uint8_t m = MEM_MODE_NONE + 1; m < MEM_MODE_COUNT; m++) {
+      UART_Printf(" %-8s %6lu bytes\r\n", MemPlan_GetModeName((MemPlan_Mode_TypeDef)m),
+                 (unsigned long)MemPlan_GetModeBytes((MemPlan_Mode_TypeDef)m));
+    }
+    UART_Printf(" Saved by overlays: %lu bytes\r\n",
+               (unsigned long)(MEM_PLAN_SEPARATE_BYTES - MEM_PLAN_ARENA_BYTES));
+  }
+  /* Command: HEALTH | HEALTH PROBE ON|OFF */
+  else if (strcmp(cmd, "HEALTH") == 0) {
+    Health_Stats_TypeDef health;
+    Health_Event_TypeDef event;
+    
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+      Health_GetStats(ch, &health);
+      UART_Printf(" Channel %d: %lu faults, clips", ch + 1, (unsigned long)health.faults);
+      for (uint8_t s = 0; s < HEALTH_STAGE_COUNT; s++) {
+        UART_Printf(" %s %lu", Health_GetStageName((Health_Stage_TypeDef)s), (unsigned long)health.clips[s]);
+      }
+      UART_SendString("\r\n");
+    }
+    
+    for (uint8_t i = 0; Health_GetEvent(i, &event); i++) {
+      UART_Printf(" %10lu ms ch%d %s at %s\r\n", (unsigned long)event.tick, event.channel + 1,
+                 event.nonFinite ? "NaN/Inf" : "runaway",
+                 Health_GetStageName((Health_Stage_TypeDef)event.stage));
+    }
+  }
+  else if (strncmp(cmd, "HEALTH PROBE ", 13) == 0) {
+    Health_SetStageProbes(strcmp(&cmd[13], "ON") == 0);
+    UART_SendString("OK\r\n");
+  }
+  /* Command: LEVELS | LEVELS RESET | LEVELS x */
+  else if (strcmp(cmd, "LEVELS") == 0) {
+    LevelStats_Summary_TypeDef levels;
+    
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+      LevelStats_GetSummary(ch, &levels);
+      UART_Printf(" Channel %d: peak %+6.1f dBFS, RMS %+6.1f dBFS, crest %5.1f dB, "
+                 "near clip %5.2f%%, clips %lu in %lu of %lu blocks\r\n",
+                 ch + 1, levels.peakMaxDb, levels.rmsDb, levels.crestDb, levels.nearClipPercent,
+                 (unsigned long)levels.clipSamples, (unsigned long)levels.clipBlocks,
+                 (unsigned long)levels.blocks);
+    }
+  }
+  else if (strcmp(cmd, "LEVELS RESET") == 0) {
+    LevelStats_Reset();
+    UART_SendString("OK\r\n");
+  }
+  else if (strncmp(cmd, "LEVELS ", 7) == 0) {
+    long channelNum = strtol(&cmd[7], NULL, 10);
+    uint32_t bins[LEVELSTATS_BINS];
+    
+    if (channelNum < 1 || channelNum > AUDIO_OUTPUT_CHANNELS) {
+      UART_SendString("Invalid channel number\r\n");
+      return;
+    }
+    
+    LevelStats_GetHistogram(channelNum - 1, bins);
+    UART_Printf("Peak histogram ch%ld, blocks per 1 dB\r\n", channelNum);
+    for (uint32_t b = 0; b < LEVELSTATS_BINS - 1U; b++) {
+      if (bins[b] != 0U) {
+        UART_Printf(" %4ld to %4ld dBFS %10lu\r\n", -(long)b - 1L, -(long)b, (unsigned long)bins[b]);
+      }
+    }
+    UART_Printf(" below %4ld dBFS %10lu\r\n", -(long)LEVELSTATS_BINS + 1L,
+               (unsigned long)bins[LEVELSTATS_BINS - 1U]);
+  }
+  /* Command: CPU */
+  else if (strcmp(cmd, "CPU") == 0) {
+    CpuBudget_Report_TypeDef report;
+    CpuBudget_Rejection_TypeDef rejection;
+    
+    CpuBudget_GetReport(&report);
+    UART_Printf("Frame %lu cycles, limit %lu, used %lu, headroom %lu (%d%%)%s\r\n",
+               (unsigned long)report.frameCycles, (unsigned long)report.limitCycles,
+               (unsigned long)report.usedCycles, (unsigned long)report.headroomCycles,
+               CpuBudget_GetHeadroomPercent(), report.calibrated ? "" : ", estimated");
+    
+    for (uint8_t s = 0; s < CPUBUDGET_STAGE_COUNT; s++) {
+      UART_Printf(" %-10s %6lu cycles, model x%.2f\r\n", CpuBudget_GetStageName((CpuBudget_Stage_TypeDef)s),
+                 (unsigned long)report.stageCycles[s], report.stageScale[s]);
+    }
+    
+    if (CpuBudget_GetRejection(&rejection)) {
+      UART_Printf(" Last refused: %s", CpuBudget_GetStageName((CpuBudget_Stage_TypeDef)rejection.stage));
+      if (rejection.channel < AUDIO_OUTPUT_CHANNELS) {
+        UART_Printf(" ch%d", rejection.channel + 1);
+      }
+      UART_Printf(" at %lu ms, needed %lu, headroom %lu\r\n", (unsigned long)rejection.tick,
+                 (unsigned long)rejection.neededCycles, (unsigned long)rejection.headroomCycles);
+    }
+  }
+  /* Command: QUALITY */
+  else if (strcmp(cmd, "QUALITY") == 0) {
+    QualityScaler_Status_TypeDef quality;
+    QualityScaler_Event_TypeDef event;
+    
+    QualityScaler_GetStatus(&quality);
+    UART_Printf("Quality %s, slack %ld cycles (worst %ld) of %lu, %lu late frames\r\n",
+               QualityScaler_GetLevelName((QualityScaler_Level_TypeDef)quality.level),
+               (long)quality.windowSlackCycles, (long)quality.worstSlackCycles,
+               (unsigned long)quality.frameCycles, (unsigned long)quality.lateFrames);
+    
+    for (uint8_t i = 0; QualityScaler_GetEvent(i, &event); i++) {
+      UART_Printf(" %10lu ms %s -> %s, slack %ld, %d late\r\n", (unsigned long)event.tick,
+                 QualityScaler_GetLevelName((QualityScaler_Level_TypeDef)event.from),
+                 QualityScaler_GetLevelName((QualityScaler_Level_TypeDef)event.to),
+                 (long)event.slackCycles, event.lateFrames);
+    }
+  }
+  /* Command pattern: PARAM id [value] */
+  else if (strncmp(cmd, "PARAM ", 6) == 0) {
+    char *next;
+    uint16_t id = (uint16_t)strtoul(&cmd[6], &next, 0);
+    const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+    float value;
+    
+    if (entry == NULL) {
+      UART_SendString("Unknown parameter\r\n");
+      return;
+    }
+    
+    while (*next == ' ') {
+      next++;
+    }
+    
+    if (*next != '\0') {
+      HAL_StatusTypeDef status = ParamRegistry_Set(id, strtof(next, NULL));
+      
+      if (status == HAL_BUSY) {
+        UART_SendString("Refused, not enough CPU headroom\r\n");
+        return;
+      }
+      if (status != HAL_OK) {
+        float min, max;
+        
+        ParamRegistry_GetRange(id, &min, &max);
+        UART_Printf("Invalid value, %s takes %g to %g\r\n", entry->name, min, max);
+        return;
+      }
+    }
+    
+    ParamRegistry_Get(id, &value);
+    UART_Printf("%s ch%d", entry->name, PARAM_ID_CHANNEL(id) + 1);
+    if (entry->indices > 1U) {
+      UART_Printf(" band %d", PARAM_ID_INDEX(id) + 1);
+    }
+    UART_Printf(" = %g\r\n", value);
+  }
+  /* Command: PARAMS */
+  else if (strcmp(cmd, "PARAMS") == 0) {
+    static const char *const laws[] = { "linear", "log", "dB", "step" };
+    
+    for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+      const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_GetFamily((ParamRegistry_Family_TypeDef)f);
+      float min, max;
+      
+      /* Ranges that differ per channel are listed for the first one */
+      ParamRegistry_GetRange(PARAM_ID(f, 0, 0), &min, &max);
+      UART_Printf(" 0x%04X %-15s %dx%d %g to %g, %s\r\n", PARAM_ID(f, 0, 0), entry->name,
+                 entry->channels, entry->indices, min, max, laws[entry->law]);
+    }
+  }
+  /* Command pattern: CURVE x */
+  else if (strncmp(cmd, "CURVE ", 6) == 0) {
+    long channelNum = strtol(&cmd[6], NULL, 10);
+    float magnitudeDb[RESPCACHE_GRID_POINTS];
+    float phaseRad[RESPCACHE_GRID_POINTS];
+    
+    if (channelNum < 1 || channelNum > AUDIO_OUTPUT_CHANNELS) {
+      UART_SendString("Invalid channel number\r\n");
+      return;
+    }
+    
+    ResponseCache_GetCurve(channelNum - 1, magnitudeDb, phaseRad);
+    UART_Printf("Curve ch%ld, version %lu\r\n", channelNum,
+               (unsigned long)ResponseCache_GetVersion(channelNum - 1));
+    for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+      UART_Printf(" %8.1f Hz %+7.2f dB %+7.1f deg\r\n", ResponseCache_GetGridFrequency(i),
+                 magnitudeDb[i], phaseRad[i] * 57.29578f);
+    }
+  }
   /* Unknown command */
   else {
     UART_SendString("Unknown command. Type 'HELP' for available commands\r\n");
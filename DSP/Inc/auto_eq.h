@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file           : auto_eq.h
+  * @brief          : Background solver fitting PEQ bands to a measured response
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Given a measured magnitude response and a target curve on the solver's
+  * log-frequency grid (AutoEQ_GetGridFrequency), picks bell bands one by
+  * one at the largest smoothed deviation, then refines frequency, gain and
+  * Q of all bands together with Levenberg-Marquardt. Coefficients come from
+  * the batch designer (CoeffBatch_Design).
+  *
+  * The job runs from the main loop in slices: AutoEQ_Service() does work
+  * until its cycle budget is spent and returns, so audio and UI keep their
+  * timing. The finished bands are written with PEQ_ConfigureAllBands().
+  *
+  ******************************************************************************
+  */
+
+#ifndef __AUTO_EQ_H
+#define __AUTO_EQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define AUTOEQ_GRID_POINTS          64U         /* Log grid, about 1/6 octave */
+#define AUTOEQ_GRID_MIN_HZ          20.0f
+#define AUTOEQ_GRID_MAX_HZ          20000.0f
+#define AUTOEQ_MAX_BANDS            6U
+#define AUTOEQ_SERVICE_CYCLES       20000U      /* Main loop slice, 0.2 ms at 100 MHz */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Job state
+  */
+typedef enum {
+  AUTOEQ_IDLE = 0,
+  AUTOEQ_PICKING,               /* Greedy placement of bands */
+  AUTOEQ_REFINING,              /* Levenberg-Marquardt iterations */
+  AUTOEQ_DONE,
+  AUTOEQ_FAILED
+} AutoEQ_State_TypeDef;
+
+/**
+  * @brief  Fit setup
+  */
+typedef struct {
+  uint8_t channel;              /* Output channel to write */
+  uint8_t firstBand;            /* First PEQ band the solver may use */
+  uint8_t bandCount;            /* Bands available, up to AUTOEQ_MAX_BANDS */
+  uint8_t maxIterations;        /* Refinement iterations */
+  uint8_t apply;                /* Write the result to the running PEQ */
+  float fitLowHz;               /* Deviations outside this range are ignored */
+  float fitHighHz;
+  float maxBoostDb;             /* Boost is limited harder than cut */
+  float maxCutDb;
+  float minQ;
+  float maxQ;
+  float toleranceDb;            /* No new band below this deviation */
+} AutoEQ_Config_TypeDef;
+
+/**
+  * @brief  One fitted bell
+  */
+typedef struct {
+  float frequency;              /* Hz */
+  float gainDb;
+  float q;
+} AutoEQ_Band_TypeDef;
+
+/**
+  * @brief  Job outcome
+  */
+typedef struct {
+  AutoEQ_State_TypeDef state;
+  uint8_t bandsUsed;
+  uint8_t iterations;
+  float initialRmsDb;           /* Weighted RMS deviation before EQ */
+  float finalRmsDb;             /* Weighted RMS deviation with the fitted bands */
+  AutoEQ_Band_TypeDef bands[AUTOEQ_MAX_BANDS];
+} AutoEQ_Result_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void AutoEQ_GetDefaultConfig(AutoEQ_Config_TypeDef *config);
+float AutoEQ_GetGridFrequency(uint32_t index);
+HAL_StatusTypeDef AutoEQ_Start(const AutoEQ_Config_TypeDef *config, const float *measuredDb,
+                               const float *targetDb);
+AutoEQ_State_TypeDef AutoEQ_Service(uint32_t budgetCycles);
+void AutoEQ_Cancel(void);
+AutoEQ_State_TypeDef AutoEQ_GetState(void);
+void AutoEQ_GetResult(AutoEQ_Result_TypeDef *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUTO_EQ_H */
@@ -47,6 +47,13 @@ float DSP_Compressor_ProcessSample(uint8_t channelIndex, float sample);
  */
 HAL_StatusTypeDef DSP_Compressor_Process(uint8_t channelIndex, AudioBuffer_TypeDef* buffer);
 
+/**
+ * @brief Process one frame of all output channels through the compressor
+ * @param buffer Audio buffer, processed in place
+ * @return HAL status
+ */
+HAL_StatusTypeDef DSP_Compressor_ProcessAll(AudioBuffer_TypeDef* buffer);
+
 /**
  * @brief Enable or disable the compressor for specific channel
  * @param channelIndex Output channel index
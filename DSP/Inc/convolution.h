@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : convolution.h
+  * @brief          : Zero-latency partitioned FIR convolution
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Per-output FIR correction (room / driver) with no added latency. The
+  * first frame of taps is convolved directly, the rest by FFT partitions
+  * that double in size every two partitions. Work of the large partitions
+  * is spread over the frames of their period so the cost per frame stays
+  * flat next to the IIR chain.
+  *
+  * Taps are loaded in chunks (BeginLoad / LoadTaps / Commit) so a protocol
+  * or storage layer can stream them without a full-length staging buffer.
+  * Memory comes from one pool shared by all outputs, see CONV_POOL_FLOATS.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __CONVOLUTION_H
+#define __CONVOLUTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CONV_BLOCK_SIZE             AUDIO_FRAME_SIZE   /* Direct head length and frame size */
+#define CONV_MAX_PARTITION          512U    /* Largest partition (FFT size 1024) */
+#define CONV_MAX_LEVELS             5U      /* Partition sizes 32..512 */
+#define CONV_MAX_TAPS               8192U
+#define CONV_POOL_FLOATS            16384U  /* 64 KB: 2048 taps on one output, 1024 on two or 512 on four */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  CONV_STATE_OFF = 0,           /* Pass-through, no memory held */
+  CONV_STATE_LOADING,           /* Memory held, taps being written, pass-through */
+  CONV_STATE_ACTIVE             /* Convolving */
+} Convolution_State_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void Convolution_Init(void);
+HAL_StatusTypeDef Convolution_BeginLoad(uint8_t channel, uint32_t length);
+HAL_StatusTypeDef Convolution_LoadTaps(uint8_t channel, uint32_t offset, const float *taps, uint32_t count);
+HAL_StatusTypeDef Convolution_Commit(uint8_t channel);
+void Convolution_Disable(uint8_t channel);
+void Convolution_ResetState(uint8_t channel);
+Convolution_State_TypeDef Convolution_GetState(uint8_t channel);
+uint32_t Convolution_GetLength(uint8_t channel);
+uint32_t Convolution_GetRequiredFloats(uint32_t length);
+uint32_t Convolution_GetPoolFree(void);
+HAL_StatusTypeDef Convolution_Process(uint8_t channel, float *data, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CONVOLUTION_H */
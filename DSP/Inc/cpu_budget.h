@@ -0,0 +1,120 @@
+/**
+  ******************************************************************************
+  * @file           : cpu_budget.h
+  * @brief          : Per-stage CPU cost model and admission of parameter changes
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Every stage describes what it runs on an output (active, biquad
+  * sections or FIR levels, optional paths such as ISP or cubic delay taps)
+  * and the model turns that into cycles per frame. Setters that make a
+  * stage more expensive ask CpuBudget_Admit() first; a change that would
+  * push the frame past CPUBUDGET_LIMIT_PERCENT is refused with HAL_BUSY
+  * instead of causing dropouts. Cheaper changes always pass.
+  *
+  * The pipeline marks the DWT cycle counter after each stage. Windows of
+  * measured frames calibrate a scale factor per stage and replace the
+  * model estimate of the current load with the real worst frame, so only
+  * the change itself is predicted.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __CPU_BUDGET_H
+#define __CPU_BUDGET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CPUBUDGET_LIMIT_PERCENT     85U         /* Rest is kept for interrupts, UI and background jobs */
+#define CPUBUDGET_WINDOW_FRAMES     128U        /* Measured frames per calibration, 85 ms */
+
+/* Optional paths, CpuBudget_Load_TypeDef.options */
+#define CPUBUDGET_OPT_LOOKAHEAD     0x01U       /* Limiter: lookahead delay */
+#define CPUBUDGET_OPT_ISP           0x02U       /* Limiter: inter-sample peak prediction */
+#define CPUBUDGET_OPT_CUBIC         0x01U       /* Delay: cubic interpolation */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Costed stages, in processing order
+  */
+typedef enum {
+  CPUBUDGET_STAGE_CROSSOVER = 0,
+  CPUBUDGET_STAGE_EQ,
+  CPUBUDGET_STAGE_FIR,
+  CPUBUDGET_STAGE_COMPRESSOR,
+  CPUBUDGET_STAGE_LIMITER,
+  CPUBUDGET_STAGE_DELAY,
+  CPUBUDGET_STAGE_FIXED,        /* Input, routing, gain, meter and output conversion */
+  CPUBUDGET_STAGE_COUNT
+} CpuBudget_Stage_TypeDef;
+
+/**
+  * @brief  What a stage runs on one output
+  */
+typedef struct {
+  uint8_t active;               /* Stage does work on this output */
+  uint8_t options;              /* CPUBUDGET_OPT_x of the stage */
+  uint16_t units;               /* Biquad sections; FIR: partition levels */
+  uint16_t parts;               /* FIR: partitions, 0 elsewhere */
+} CpuBudget_Load_TypeDef;
+
+/**
+  * @brief  Budget summary for UI and protocol
+  */
+typedef struct {
+  uint32_t frameCycles;         /* Cycles between two frames */
+  uint32_t limitCycles;         /* Admission limit */
+  uint32_t usedCycles;          /* Worst measured frame plus changes since */
+  uint32_t headroomCycles;      /* limitCycles - usedCycles, 0 when over */
+  uint32_t stageCycles[CPUBUDGET_STAGE_COUNT];  /* Measured average per frame */
+  float stageScale[CPUBUDGET_STAGE_COUNT];      /* Measured / modelled */
+  uint8_t calibrated;           /* A measurement window has completed */
+} CpuBudget_Report_TypeDef;
+
+/**
+  * @brief  Last refused change
+  */
+typedef struct {
+  uint32_t tick;                /* HAL_GetTick() of the refusal */
+  uint32_t neededCycles;        /* Predicted extra cost of the change */
+  uint32_t headroomCycles;      /* Headroom at that moment */
+  uint8_t stage;                /* CpuBudget_Stage_TypeDef */
+  uint8_t channel;              /* Output, or AUDIO_OUTPUT_CHANNELS for all */
+} CpuBudget_Rejection_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void CpuBudget_Init(void);
+
+/* Control side */
+HAL_StatusTypeDef CpuBudget_Admit(CpuBudget_Stage_TypeDef stage, uint8_t channel,
+                                  const CpuBudget_Load_TypeDef *load);
+HAL_StatusTypeDef CpuBudget_AdmitStage(CpuBudget_Stage_TypeDef stage,
+                                       const CpuBudget_Load_TypeDef loads[AUDIO_OUTPUT_CHANNELS]);
+void CpuBudget_SetLoad(CpuBudget_Stage_TypeDef stage, uint8_t channel, const CpuBudget_Load_TypeDef *load);
+void CpuBudget_Update(void);
+uint32_t CpuBudget_GetHeadroom(void);
+uint8_t CpuBudget_GetHeadroomPercent(void);
+void CpuBudget_GetReport(CpuBudget_Report_TypeDef *report);
+uint8_t CpuBudget_GetRejection(CpuBudget_Rejection_TypeDef *rejection);
+const char *CpuBudget_GetStageName(CpuBudget_Stage_TypeDef stage);
+
+/* Audio side */
+void CpuBudget_BeginFrame(void);
+void CpuBudget_Mark(CpuBudget_Stage_TypeDef stage);
+void CpuBudget_EndFrame(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CPU_BUDGET_H */
@@ -19,6 +19,32 @@
 #include "crossover_types.h"
 #include "audio_config.h"
 
+/**
+  * @brief  Get the stored crossover settings of an output
+  * @param  channel: Output channel index (0-3)
+  * @param  config: Settings to fill
+  * @retval None
+  */
+void Crossover_Config_Get(uint8_t channel, CrossoverConfig_TypeDef *config);
+
+/**
+  * @brief  Validate, admit and apply the crossover settings of an output
+  * @param  channel: Output channel index (0-3)
+  * @param  config: New settings
+  * @retval HAL status, HAL_BUSY if the CPU budget refuses the filters
+  */
+HAL_StatusTypeDef Crossover_Config_Set(uint8_t channel, CrossoverConfig_TypeDef *config);
+
+/**
+  * @brief  Load designed sections into the high-pass or low-pass chain of an output
+  * @param  outputChannel: Output channel index
+  * @param  type: FILTER_TYPE_HIGHPASS or FILTER_TYPE_LOWPASS
+  * @param  sections: Section coefficients (a0 normalized to 1)
+  * @param  count: Number of sections, 0 clears the chain
+  * @retval None
+  */
+void Crossover_LoadSections(uint8_t outputChannel, FilterType_t type, const BiquadCoeff_t *sections, uint8_t count);
+
 /**
   * @brief  Initialize the crossover filter module
   * @param  sampleRate: Audio sample rate in Hz
@@ -33,6 +59,13 @@ void Crossover_Init(uint32_t sampleRate);
   */
 void Crossover_Reset(uint8_t channel);
 
+/**
+  * @brief  Clear the history of the compiled filter chains of an output
+  * @param  outputChannel: Output channel index
+  * @retval None
+  */
+void Crossover_ResetFilterState(uint8_t outputChannel);
+
 /**
   * @brief  Reset all crossover filter states
   * @retval None
@@ -157,14 +190,6 @@ uint8_t Crossover_Apply3Way(uint8_t channel, float freqLow, float freqHigh,
 uint8_t Crossover_ApplySubPlusFull(uint8_t channel, float frequency,
                                   CrossoverFilterType_t filterType, CrossoverSlope_t slope);
 
-/**
-  * @brief  Process a single sample through the crossover filters
-  * @param  channel: Channel index
-  * @param  input: Input sample
-  * @retval Output sample (mixed output of enabled bands)
-  */
-float Crossover_ProcessSample(uint8_t channel, float input);
-
 /**
   * @brief  Process multiple samples through the crossover filters
   * @param  channel: Channel index
@@ -175,6 +200,14 @@ float Crossover_ProcessSample(uint8_t channel, float input);
   */
 void Crossover_ProcessBuffer(uint8_t channel, float *input, float *output, uint16_t size);
 
+/**
+  * @brief  Process one frame of an output through the crossover, in place
+  * @param  outputChannel: Output channel index
+  * @param  buffer: Audio buffer
+  * @retval None
+  */
+void DSP_Crossover_Process(uint8_t outputChannel, AudioBuffer_TypeDef *buffer);
+
 /**
   * @brief  Get a specific band output (for visualization or multi-output use)
   * @param  channel: Channel index
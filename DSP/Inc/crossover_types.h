@@ -106,4 +106,42 @@ typedef struct {
   uint8_t initialized;                  /**< Initialization flag */
 } CrossoverState_t;
 
+/**
+  * @brief  Filter family of a configured output
+  */
+typedef enum {
+  CROSSOVER_TYPE_BUTTERWORTH = 0,   /**< Butterworth */
+  CROSSOVER_TYPE_LINKWITZ_RILEY,    /**< Linkwitz-Riley */
+  CROSSOVER_TYPE_BESSEL,            /**< Bessel */
+  CROSSOVER_TYPE_CHEBYSHEV1,        /**< Chebyshev I, passband ripple */
+  CROSSOVER_TYPE_CHEBYSHEV2,        /**< Chebyshev II, stopband zeros */
+  CROSSOVER_TYPE_ELLIPTIC,          /**< Elliptic, steepest transition */
+  CROSSOVER_TYPE_COUNT              /**< Number of filter types */
+} CrossoverType_TypeDef;
+
+/**
+  * @brief  Filter slope of a configured output
+  */
+typedef enum {
+  CROSSOVER_ORDER_6DB = 0,          /**< 1st order */
+  CROSSOVER_ORDER_12DB,             /**< 2nd order */
+  CROSSOVER_ORDER_18DB,             /**< 3rd order */
+  CROSSOVER_ORDER_24DB,             /**< 4th order */
+  CROSSOVER_ORDER_36DB,             /**< 6th order */
+  CROSSOVER_ORDER_48DB,             /**< 8th order */
+  CROSSOVER_ORDER_COUNT             /**< Number of filter orders */
+} CrossoverOrder_TypeDef;
+
+/**
+  * @brief  Stored crossover settings of one output
+  */
+typedef struct {
+  uint8_t isEnabled;                    /**< Crossover enabled flag */
+  CrossoverType_TypeDef filterType;     /**< Filter family */
+  CrossoverOrder_TypeDef filterOrder;   /**< Filter slope */
+  float highPassFreq;                   /**< High-pass corner (Hz), at the minimum it is off */
+  float lowPassFreq;                    /**< Low-pass corner (Hz), at the maximum it is off */
+  uint8_t bandPassEnabled;              /**< Run both filters */
+} CrossoverConfig_TypeDef;
+
 #endif /* CROSSOVER_TYPES_H */
\ No newline at end of file
@@ -23,11 +23,17 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "delay_types.h"
 #include "audio_config.h"
+#include "delay_store.h"
 
 /* Constants -----------------------------------------------------------------*/
 #define SPEED_OF_SOUND_CM_S   34300    /* Speed of sound in cm/s at 20°C */
 #define SPEED_OF_SOUND_IN_S   13504    /* Speed of sound in inches/s at 20°C */
 
+/* Each chunk is written before its taps are read, so the longest delay
+   leaves room for one chunk plus the cubic window (one tap before, two after) */
+#define DELAY_CHUNK_SIZE      AUDIO_FRAME_SIZE          /* Samples decoded per store access */
+#define DELAY_READ_MARGIN     (DELAY_CHUNK_SIZE + 3U)   /* Line samples no delay can reach */
+
 /* Exported functions prototypes ---------------------------------------------*/
 
 /**
@@ -186,6 +192,117 @@ HAL_StatusTypeDef DSP_Delay_GetConfig(uint8_t outputChannel, DelayParams_TypeDef
  */
 HAL_StatusTypeDef DSP_Delay_SetConfig(uint8_t outputChannel, DelayParams_TypeDef *pConfig);
 
+/**
+ * @brief Set latency alignment delay (owned by the latency manager)
+ * @param channel Output channel index
+ * @param samples Alignment delay in samples, added to the user delay
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_SetCompensation(uint8_t channel, uint32_t samples);
+
+/**
+ * @brief Select the sample format of a channel's delay memory
+ * @param channel Output channel index
+ * @param format Storage format, compact formats trade precision for delay length
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_SetStorageFormat(uint8_t channel, DelayStore_Format_TypeDef format);
+
+/**
+ * @brief Get the longest user delay the channel's memory holds
+ * @param channel Output channel index
+ * @retval Delay in milliseconds for the current storage format, less the alignment delay
+ */
+float Delay_GetMaxDelayMs(uint8_t channel);
+
+/**
+ * @brief Set the user delay as applied after temperature compensation
+ * @param channel Output channel index
+ * @param delayMs Compensated delay in milliseconds (0 to Delay_GetMaxDelayMs)
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_SetCompensatedTime(uint8_t channel, float delayMs);
+
+/**
+ * @brief Get the user delay as applied after temperature compensation
+ * @param channel Output channel index
+ * @retval Compensated delay in milliseconds
+ */
+float Delay_GetCompensatedTime(uint8_t channel);
+
+/**
+ * @brief Clear the delay line of a channel, keeping its settings
+ * @param channel Output channel index
+ * @retval None
+ */
+void Delay_ResetChannel(uint8_t channel);
+
+/**
+ * @brief Record the current cost of a delay line in the CPU budget
+ * @param channel Output channel index
+ * @retval None
+ */
+void Delay_ReportCpuLoad(uint8_t channel);
+
+/**
+ * @brief Allow or forbid cubic interpolation (quality scaler override)
+ * @param allowed 0 forces linear interpolation, the selected mode is kept
+ * @retval None
+ */
+void Delay_SetCubicAllowed(uint8_t allowed);
+
+/**
+ * @brief Initialize the delay lines of all outputs
+ * @param config Sample rate and longest delay to allocate for
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_Init(DelayConfig_TypeDef *config);
+
+/**
+ * @brief Free the delay lines
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_DeInit(void);
+
+/**
+ * @brief Configure the user delay of a channel and mark it active
+ * @param channel Output channel index
+ * @param config Delay value, unit, polarity and enable
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_ConfigChannel(uint8_t channel, DelayChannelConfig_TypeDef *config);
+
+/**
+ * @brief Get the delay line of a channel
+ * @param channel Output channel index
+ * @retval Delay instance, NULL before Delay_Init or for an invalid channel
+ */
+DelayInstance_TypeDef* Delay_GetInstance(uint8_t channel);
+
+/**
+ * @brief Recompute the read offset of a channel from its user and alignment delay
+ * @param channel Output channel index
+ * @retval None
+ */
+void Delay_ApplySettings(uint8_t channel);
+
+/**
+ * @brief Convert a distance to the time sound takes to travel it
+ * @param distance Distance value
+ * @param unit DELAY_UNIT_CM or DELAY_UNIT_INCH, other units are returned unchanged
+ * @retval Time in milliseconds
+ */
+float Delay_DistanceToMs(float distance, DelayUnit_TypeDef unit);
+
+/**
+ * @brief Run samples of a channel through its delay line, in place
+ * @param channel Output channel index
+ * @param pData Samples
+ * @param size Number of samples
+ * @retval HAL status
+ */
+HAL_StatusTypeDef Delay_Process(uint8_t channel, float *pData, uint32_t size);
+
 #ifdef __cplusplus
 }
 #endif
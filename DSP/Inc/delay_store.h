@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : delay_store.h
+  * @brief          : Compact sample storage for delay lines
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * A circular sample store over a fixed block of RAM, in one of:
+  *
+  *   FLOAT32     4 bytes/sample, lossless
+  *   INT24       3 bytes/sample, packed, full scale +/-1.0
+  *   INT16_BLOCK 2 bytes/sample + 1 exponent byte per 16 samples,
+  *               ~90 dB below the peak of each 16-sample block
+  *   FP16        2 bytes/sample, IEEE half, 11-bit precision
+  *
+  * The same RAM holds 1.33x (INT24) to 2x (FP16, INT16_BLOCK) the samples
+  * of FLOAT32. Reads and writes convert whole runs, so the delay line
+  * decodes the span a frame needs once instead of per tap.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __DELAY_STORE_H
+#define __DELAY_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define DELAY_STORE_BLOCK           16U     /* Samples sharing one exponent */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Sample storage formats
+  */
+typedef enum {
+  DELAY_STORE_FLOAT32 = 0,
+  DELAY_STORE_INT24,
+  DELAY_STORE_INT16_BLOCK,
+  DELAY_STORE_FP16,
+  DELAY_STORE_FORMAT_COUNT
+} DelayStore_Format_TypeDef;
+
+/**
+  * @brief  Circular store over caller-owned memory
+  */
+typedef struct {
+  uint8_t *mem;                 /* Sample data, exponents follow for INT16_BLOCK */
+  uint32_t bytes;               /* Size of mem */
+  uint32_t length;              /* Capacity in samples */
+  uint8_t format;               /* DelayStore_Format_TypeDef */
+} DelayStore_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t DelayStore_Capacity(DelayStore_Format_TypeDef format, uint32_t bytes);
+HAL_StatusTypeDef DelayStore_Init(DelayStore_TypeDef *store, void *mem, uint32_t bytes,
+                                  DelayStore_Format_TypeDef format);
+void DelayStore_Clear(DelayStore_TypeDef *store);
+void DelayStore_Write(DelayStore_TypeDef *store, uint32_t index, const float *src, uint32_t count);
+void DelayStore_Read(const DelayStore_TypeDef *store, int32_t index, float *dst, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DELAY_STORE_H */
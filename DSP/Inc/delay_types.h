@@ -21,19 +21,28 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include "dsp_common.h"
+#include "delay_store.h"
 
 /* Constants -----------------------------------------------------------------*/
 #define MAX_DELAY_MS           20        /* Maximum delay time in milliseconds */
 #define DELAY_BUFFER_SIZE      (MAX_DELAY_MS * (AUDIO_SAMPLE_RATE / 1000) + 1) /* Buffer size based on max delay */
+#define MAX_DELAY_CHANNELS     AUDIO_OUTPUT_CHANNELS     /* One delay line per output */
+#define SPEED_OF_SOUND_M_PER_SEC  343.0f /* Speed of sound in m/s at 20°C */
 
 /* Units for delay representation */
 typedef enum {
     DELAY_UNIT_MS,       /* Milliseconds */
     DELAY_UNIT_SAMPLES,  /* Samples */
     DELAY_UNIT_CM,       /* Centimeters (for distance-based time alignment) */
-    DELAY_UNIT_INCHES,   /* Inches (for distance-based time alignment) */
+    DELAY_UNIT_INCH,     /* Inches (for distance-based time alignment) */
 } DelayUnit_TypeDef;
 
+/* Fractional read interpolation of all delay lines */
+typedef enum {
+    DELAY_INTERPOLATION_LINEAR = 0, /* Two taps per sample */
+    DELAY_INTERPOLATION_CUBIC       /* Four taps per sample, less high-frequency loss */
+} DelayInterpolation_TypeDef;
+
 /**
  * @brief Delay state structure for runtime operation
  */
@@ -60,13 +69,46 @@ typedef struct {
 } DelayParams_TypeDef;
 
 /**
- * @brief Delay runtime configuration for a channel
+ * @brief Delay system configuration, see Delay_Init
  */
 typedef struct {
-    DelayState_TypeDef state;    /* Current runtime state */
-    DelayParams_TypeDef params;  /* User parameters */
+    uint32_t sampleRate;         /* Sample rate in Hz */
+    uint32_t maxDelayMs;         /* User delay each line must hold, alignment comes on top */
 } DelayConfig_TypeDef;
 
+/**
+ * @brief Delay settings of a channel, see Delay_ConfigChannel
+ */
+typedef struct {
+    float_t delayValue;          /* Delay in delayUnit (ms, cm or inches) */
+    DelayUnit_TypeDef delayUnit; /* Unit of delayValue */
+    uint8_t phaseInvert;         /* Phase inversion (0 = normal, 1 = inverted) */
+    uint8_t enabled;             /* User delay enabled */
+} DelayChannelConfig_TypeDef;
+
+/**
+ * @brief Delay line of a channel
+ */
+typedef struct {
+    uint8_t isActive;            /* Configured or carrying alignment delay */
+    uint8_t enabled;             /* User delay enabled */
+    uint8_t phaseInvert;         /* Phase inversion (0 = normal, 1 = inverted) */
+    DelayUnit_TypeDef delayUnit; /* Unit the user works in */
+    uint32_t sampleRate;         /* Sample rate in Hz */
+    uint32_t maxDelayMs;         /* User delay the line was sized for */
+    float_t currentDelayMs;      /* User delay before temperature compensation */
+    float_t currentDelayDistance; /* User delay as distance, for display */
+    float_t delaySamples;        /* Read offset incl. alignment, fractional */
+    uint32_t compensationSamples; /* Alignment delay from the latency manager */
+    float_t filterCoeff;         /* Output smoothing coefficient */
+    float_t prevSample;          /* Output smoothing history */
+    void *buffer;                /* Line memory */
+    uint32_t bufferBytes;        /* Size of the line memory */
+    uint32_t bufferSize;         /* Line length in samples for the storage format */
+    uint32_t writeIndex;         /* Next sample written */
+    DelayStore_TypeDef store;    /* Sample format of the line memory */
+} DelayInstance_TypeDef;
+
 #ifdef __cplusplus
 }
 #endif
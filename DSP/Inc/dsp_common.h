@@ -51,22 +51,6 @@ extern "C" {
 
 /* Type Definitions ----------------------------------------------------------*/
 
-/**
- * @brief Filter types enumeration
- */
-typedef enum {
-    FILTER_TYPE_NONE = 0,
-    FILTER_TYPE_LOWPASS,
-    FILTER_TYPE_HIGHPASS,
-    FILTER_TYPE_BANDPASS,
-    FILTER_TYPE_NOTCH,
-    FILTER_TYPE_PEAK,
-    FILTER_TYPE_LOWSHELF,
-    FILTER_TYPE_HIGHSHELF,
-    FILTER_TYPE_ALLPASS,
-    FILTER_TYPE_MAX
-} DSP_FilterType;
-
 /**
  * @brief Filter response types enumeration
  */
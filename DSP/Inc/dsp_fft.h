@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @file           : dsp_fft.h
+  * @brief          : Radix-2 real FFT with pass-level stepping
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * In-place real FFT built on a half-size complex FFT. Besides the one-shot
+  * transforms every step (bit reversal, each butterfly pass, real split and
+  * merge) is exported so long transforms can be spread over several audio
+  * frames.
+  *
+  * Packed spectrum of a real block of n samples (n floats):
+  *   [0] = X[0], [1] = X[n/2], [2k], [2k+1] = Re/Im X[k] for k = 1..n/2-1
+  *
+  ******************************************************************************
+  */
+
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Constants -----------------------------------------------------------------*/
+#define DSP_FFT_MAX_SIZE            1024U     /* Largest real transform */
+#define DSP_FFT_MIN_SIZE            8U        /* Smallest real transform */
+
+#define DSP_FFT_FORWARD             0
+#define DSP_FFT_INVERSE             1
+
+/* Function prototypes -------------------------------------------------------*/
+void DSP_FFT_Init(void);
+uint8_t DSP_FFT_IsValidSize(uint32_t n);
+uint8_t DSP_FFT_NumPasses(uint32_t n);
+
+/* Single steps, n is the real transform size */
+void DSP_FFT_BitReverse(float *data, uint32_t n);
+void DSP_FFT_Pass(float *data, uint32_t n, uint8_t pass, uint8_t direction);
+void DSP_FFT_RealSplit(float *data, uint32_t n);
+void DSP_FFT_RealMerge(float *data, uint32_t n);
+
+/* Complete transforms, inverse result is scaled by n/2 */
+void DSP_FFT_RealForward(float *data, uint32_t n);
+void DSP_FFT_RealInverse(float *data, uint32_t n);
+void DSP_FFT_MultiplyAccumulate(float *acc, const float *a, const float *b, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_FFT_H */
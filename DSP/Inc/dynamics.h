@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file           : dynamics.h
+  * @brief          : Multi-channel dynamics engine
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * One engine for gate, expander, compressor and limiter. Every mode is the
+  * same static curve with an upper (downward compression) and a lower
+  * (downward expansion) segment, so all output channels share one detector,
+  * one gain computer and one block processing loop.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __DYNAMICS_H
+#define __DYNAMICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define DYNAMICS_RATIO_OFF          1.0f      /* Segment inactive */
+#define DYNAMICS_RATIO_LIMIT        1000.0f   /* Treated as infinite ratio */
+#define DYNAMICS_MIN_RANGE_DB       -96.0f    /* Deepest attenuation of the curve */
+#define DYNAMICS_MAX_CONTROL_BLOCK  16U       /* Longest gain computer sub-block in samples */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Curve presets
+  */
+typedef enum {
+  DYNAMICS_MODE_COMPRESSOR = 0,
+  DYNAMICS_MODE_LIMITER,
+  DYNAMICS_MODE_EXPANDER,
+  DYNAMICS_MODE_GATE,
+  DYNAMICS_MODE_COUNT
+} Dynamics_Mode_TypeDef;
+
+/**
+  * @brief  Level detector
+  */
+typedef enum {
+  DYNAMICS_DETECT_PEAK = 0,
+  DYNAMICS_DETECT_RMS
+} Dynamics_Detector_TypeDef;
+
+/**
+  * @brief  Static curve and ballistics of one channel
+  * @note   Above upperThresholdDb the output rises 1/upperRatio dB per dB,
+  *         below lowerThresholdDb it falls lowerRatio dB per dB. Both knees
+  *         share kneeWidthDb and the total attenuation stops at rangeDb.
+  */
+typedef struct {
+  float upperThresholdDb;       /* Compression threshold */
+  float upperRatio;             /* Compression ratio (1 = off, >= 1000 = limit) */
+  float lowerThresholdDb;       /* Expansion threshold */
+  float lowerRatio;             /* Expansion ratio (1 = off, >= 1000 = gate) */
+  float kneeWidthDb;            /* Soft knee width (0 = hard knee) */
+  float rangeDb;                /* Maximum attenuation (negative) */
+  float makeupGainDb;           /* Gain added after the curve */
+  float attackMs;               /* Gain reduction attack time */
+  float releaseMs;              /* Gain reduction release time */
+  Dynamics_Detector_TypeDef detector;
+  uint8_t enabled;
+} Dynamics_Params_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void Dynamics_Init(float sampleRate);
+HAL_StatusTypeDef Dynamics_SetSampleRate(float sampleRate);
+void Dynamics_GetPreset(Dynamics_Mode_TypeDef mode, Dynamics_Params_TypeDef *params);
+HAL_StatusTypeDef Dynamics_SetParams(uint8_t channel, const Dynamics_Params_TypeDef *params);
+HAL_StatusTypeDef Dynamics_GetParams(uint8_t channel, Dynamics_Params_TypeDef *params);
+HAL_StatusTypeDef Dynamics_SetEnabled(uint8_t channel, uint8_t enabled);
+HAL_StatusTypeDef Dynamics_SetControlBlock(uint8_t samples);
+uint8_t Dynamics_GetControlBlock(void);
+uint8_t Dynamics_GetEnabled(uint8_t channel);
+void Dynamics_ResetChannel(uint8_t channel);
+float Dynamics_GetCurveGain(uint8_t channel, float levelDb);
+float Dynamics_GetGainReduction(uint8_t channel);
+void Dynamics_ProcessChannel(uint8_t channel, float *data, uint32_t blockSize);
+void Dynamics_ProcessBlock(float *const *data, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DYNAMICS_H */
@@ -0,0 +1,114 @@
+/**
+  ******************************************************************************
+  * @file           : iir_fit.h
+  * @brief          : Background Steiglitz-McBride IIR fit of a correction curve
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Fits a cascade of IIRFIT_MAX_SECTIONS or fewer biquads to a target
+  * response on the solver's log-frequency grid (IIRFit_GetGridFrequency).
+  * The target is a magnitude in dB plus a phase in radians, or a magnitude
+  * alone, which is then completed to minimum phase. A measured phase must
+  * have its bulk delay removed first.
+  *
+  * Eight fitted sections cost 40 multiply-adds per sample and fit on all
+  * four outputs, where the FIR pool holds 2048 taps for one output only.
+  *
+  * The fit runs on a frequency-warped axis (first-order all-pass, the
+  * warping factor of the config), which spreads the low octaves evenly.
+  * Each Steiglitz-McBride iteration solves a linear least-squares problem
+  * prefiltered by the previous denominator. Poles are then projected
+  * inside IIRFIT_MAX_POLE_RADIUS and scored by refitting the numerator to
+  * them; the best set found is kept.
+  *
+  * The job runs from the main loop in slices, like AutoEQ_Service(). Its
+  * workspace lives in the MEM_MODE_FIT overlay of the memory plan, so a
+  * fit cannot start while FIR filters are loaded. The finished sections
+  * are written to the correction slot of a PEQ channel.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __IIR_FIT_H
+#define __IIR_FIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "filter_types.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define IIRFIT_GRID_POINTS          128U        /* Log grid, about 1/13 octave */
+#define IIRFIT_GRID_MIN_HZ          20.0f
+#define IIRFIT_GRID_MAX_HZ          20000.0f
+#define IIRFIT_MAX_SECTIONS         12U
+#define IIRFIT_MAX_POLE_RADIUS      0.9999      /* Pole pairs are kept inside this radius */
+#define IIRFIT_CEPSTRUM_SIZE        1024U       /* Minimum-phase completion transform */
+#define IIRFIT_SERVICE_CYCLES       20000U      /* Main loop slice, 0.2 ms at 100 MHz */
+
+#define IIRFIT_MAX_ORDER            (2U * IIRFIT_MAX_SECTIONS)
+#define IIRFIT_MAX_UNKNOWNS         (2U * IIRFIT_MAX_ORDER + 1U)
+
+/* Overlay buffers in the memory plan */
+#define IIRFIT_MATRIX_BYTES         (IIRFIT_MAX_UNKNOWNS * IIRFIT_MAX_UNKNOWNS * sizeof(double))    /* Triangular factor */
+#define IIRFIT_CEPSTRUM_BYTES       (IIRFIT_CEPSTRUM_SIZE * sizeof(float))
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Job state
+  */
+typedef enum {
+  IIRFIT_IDLE = 0,
+  IIRFIT_SOLVING,
+  IIRFIT_DONE,
+  IIRFIT_FAILED
+} IIRFit_State_TypeDef;
+
+/**
+  * @brief  Fit setup
+  */
+typedef struct {
+  uint8_t channel;              /* Output channel to write */
+  uint8_t sections;             /* Biquads, order is twice this */
+  uint8_t maxIterations;        /* Steiglitz-McBride iterations */
+  uint8_t apply;                /* Write the result to the PEQ correction slot */
+  float fitLowHz;               /* Points outside this range are ignored */
+  float fitHighHz;
+  float warping;                /* All-pass warping factor, 0 for a linear axis */
+} IIRFit_Config_TypeDef;
+
+/**
+  * @brief  Job outcome
+  */
+typedef struct {
+  IIRFit_State_TypeDef state;
+  uint8_t sections;
+  uint8_t iterations;
+  uint8_t projectedPoles;       /* Poles moved by the stability projection */
+  float errorDb;                /* Weighted complex error relative to the target */
+  float gain;                   /* Output gain of the cascade */
+} IIRFit_Result_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void IIRFit_GetDefaultConfig(IIRFit_Config_TypeDef *config);
+float IIRFit_GetGridFrequency(uint32_t index);
+HAL_StatusTypeDef IIRFit_Start(const IIRFit_Config_TypeDef *config, const float *targetDb,
+                               const float *targetPhase);
+IIRFit_State_TypeDef IIRFit_Service(uint32_t budgetCycles);
+void IIRFit_Cancel(void);
+IIRFit_State_TypeDef IIRFit_GetState(void);
+uint8_t IIRFit_IsActive(void);
+void IIRFit_GetResult(IIRFit_Result_TypeDef *result);
+uint8_t IIRFit_GetSections(BiquadCoeff_t *sections, uint8_t maxSections, float *gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IIR_FIT_H */
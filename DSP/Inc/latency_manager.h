@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : latency_manager.h
+  * @brief          : Processing latency tracking and output alignment
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Every DSP stage that delays the signal (limiter lookahead, FIR crossover,
+  * oversampling, ...) reports its latency per output. The manager keeps all
+  * four outputs time-aligned by adding the missing samples to the existing
+  * per-output delay lines and reports the total I/O latency.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __LATENCY_MANAGER_H
+#define __LATENCY_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define LATENCY_MAX_STAGE_SAMPLES   4096U  /* Upper bound accepted for one stage */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Processing stages that may introduce latency
+  */
+typedef enum {
+  LATENCY_STAGE_INPUT = 0,      /* Input strip / resampling ahead of routing */
+  LATENCY_STAGE_CROSSOVER,      /* Crossover (FIR or linear-phase) */
+  LATENCY_STAGE_EQ,             /* Parametric EQ / convolution */
+  LATENCY_STAGE_DYNAMICS,       /* Compressor detector delay */
+  LATENCY_STAGE_LIMITER,        /* Limiter lookahead */
+  LATENCY_STAGE_OUTPUT,         /* Output path (oversampling, DAC skew) */
+  LATENCY_STAGE_COUNT
+} LatencyStage_TypeDef;
+
+/**
+  * @brief  Latency summary for UI and telemetry
+  */
+typedef struct {
+  uint32_t pathSamples[AUDIO_OUTPUT_CHANNELS];         /* Processing latency per output */
+  uint32_t compensationSamples[AUDIO_OUTPUT_CHANNELS]; /* Alignment delay added per output */
+  uint32_t alignedSamples;      /* Processing latency after alignment, of the slowest output */
+  uint8_t unalignedMask;        /* Outputs that could not take their compensation */
+  uint32_t totalSamples;        /* Total I/O latency incl. DMA buffering */
+  float totalMs;                /* Total I/O latency in milliseconds */
+} LatencyReport_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void Latency_Init(void);
+HAL_StatusTypeDef Latency_ReportStage(uint8_t channel, LatencyStage_TypeDef stage, uint32_t samples);
+uint32_t Latency_GetStage(uint8_t channel, LatencyStage_TypeDef stage);
+void Latency_Update(void);
+uint32_t Latency_GetCompensation(uint8_t channel);
+uint32_t Latency_GetTotalSamples(void);
+float Latency_GetTotalMs(void);
+void Latency_GetReport(LatencyReport_TypeDef *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LATENCY_MANAGER_H */
@@ -139,6 +139,20 @@ HAL_StatusTypeDef DSP_Limiter_GetConfig(uint8_t outputChannel, LimiterParams_Typ
  */
 HAL_StatusTypeDef DSP_Limiter_SetConfig(uint8_t outputChannel, LimiterParams_TypeDef *pConfig);
 
+/**
+ * @brief Clear the gain, envelope and lookahead state of a channel, keeping its settings
+ * @param channel Output channel index
+ * @retval LIMITER_OK, LIMITER_ERROR for an invalid channel
+ */
+LimiterStatus_TypeDef Limiter_Reset(uint8_t channel);
+
+/**
+ * @brief Allow or forbid inter-sample peak prediction (quality scaler override)
+ * @param allowed 0 turns ISP off on all channels, the configured setting is kept
+ * @retval None
+ */
+void Limiter_SetISPAllowed(uint8_t allowed);
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,8 +22,20 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "dsp_common.h"
 
+/* Constants -----------------------------------------------------------------*/
+#define MAX_LIMITER_LOOKAHEAD_MS       10        /* Longest lookahead time in milliseconds */
+#define MAX_LIMITER_LOOKAHEAD_SAMPLES  (MAX_LIMITER_LOOKAHEAD_MS * (AUDIO_SAMPLE_RATE / 1000))
+
 /* Exported types ------------------------------------------------------------*/
 
+/**
+ * @brief Result of the per-channel limiter calls
+ */
+typedef enum {
+    LIMITER_OK = 0,
+    LIMITER_ERROR
+} LimiterStatus_TypeDef;
+
 /**
  * @brief Limiter state structure for runtime operation
  */
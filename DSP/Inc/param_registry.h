@@ -0,0 +1,172 @@
+/**
+  ******************************************************************************
+  * @file           : param_registry.h
+  * @brief          : Central parameter table addressed by numeric ID
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Every user parameter has a 16-bit ID: family in the high byte, channel
+  * and index (PEQ band) in the two low nibbles. The family indexes a
+  * const table in flash with the type, range, scaling law, dirty group,
+  * image offset, setter and getter, so any ID resolves in one lookup and
+  * is validated in one place. Protocol, presets, UI and morphing all use
+  * the same path.
+  *
+  * Values are engineering units as float: Hz, dB, ms, ratio, or the
+  * integer value of an enum or flag.
+  *
+  * Between ParamRegistry_BeginBatch() and ParamRegistry_EndBatch() sets
+  * only land in a staging image. The end of the batch applies each
+  * dirty group once: all PEQ bands in one designer batch, one crossover
+  * update per channel, single setters for the rest. Values equal to the
+  * live ones are not marked dirty, so restoring a preset image only
+  * touches what differs.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __PARAM_REGISTRY_H
+#define __PARAM_REGISTRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define PARAM_PEQ_BANDS             5U          /* Bands per channel in the PEQ */
+
+/* Slots of the parameter image, one float per channel and index of every family */
+#define PARAM_IMAGE_SLOTS           (5U * AUDIO_OUTPUT_CHANNELS * PARAM_PEQ_BANDS + \
+                                     15U * AUDIO_OUTPUT_CHANNELS + 1U + 3U * AUDIO_INPUT_CHANNELS)
+
+/* Exported macro ------------------------------------------------------------*/
+#define PARAM_ID(family, channel, index) \
+  ((uint16_t)(((uint16_t)(family) << 8) | (((uint16_t)(channel) & 0x0FU) << 4) | ((uint16_t)(index) & 0x0FU)))
+#define PARAM_ID_FAMILY(id)         ((uint8_t)((id) >> 8))
+#define PARAM_ID_CHANNEL(id)        ((uint8_t)(((id) >> 4) & 0x0FU))
+#define PARAM_ID_INDEX(id)          ((uint8_t)((id) & 0x0FU))
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Parameter families, the high byte of an ID
+  * @note   Append only, IDs are stored in presets and used by the protocol
+  */
+typedef enum {
+  PARAM_PEQ_ENABLE = 0,         /* Per output and band */
+  PARAM_PEQ_TYPE,
+  PARAM_PEQ_FREQ,
+  PARAM_PEQ_GAIN,
+  PARAM_PEQ_Q,
+  PARAM_XOVER_ENABLE,           /* Per output */
+  PARAM_XOVER_TYPE,
+  PARAM_XOVER_ORDER,
+  PARAM_XOVER_BANDPASS,
+  PARAM_XOVER_HP_FREQ,
+  PARAM_XOVER_LP_FREQ,
+  PARAM_COMP_ENABLE,
+  PARAM_COMP_THRESHOLD,
+  PARAM_COMP_RATIO,
+  PARAM_COMP_ATTACK,
+  PARAM_COMP_RELEASE,
+  PARAM_COMP_MAKEUP,
+  PARAM_LIMIT_THRESHOLD,
+  PARAM_DELAY_TIME,
+  PARAM_OUTPUT_GAIN,
+  PARAM_MASTER_VOLUME,          /* Single value */
+  PARAM_INPUT_HPF_FREQ,         /* Per input */
+  PARAM_INPUT_DELAY,
+  PARAM_INPUT_INVERT,
+  PARAM_FAMILY_COUNT
+} ParamRegistry_Family_TypeDef;
+
+/**
+  * @brief  Value type
+  */
+typedef enum {
+  PARAM_TYPE_FLOAT = 0,
+  PARAM_TYPE_ENUM,              /* Integer from min to max */
+  PARAM_TYPE_BOOL
+} ParamRegistry_Type_TypeDef;
+
+/**
+  * @brief  Scaling law, for interpolation and UI mapping
+  */
+typedef enum {
+  PARAM_LAW_LINEAR = 0,
+  PARAM_LAW_LOG,                /* Frequencies, Q, times: equal steps are equal ratios */
+  PARAM_LAW_DB,                 /* Level in dB, linear in dB */
+  PARAM_LAW_STEP                /* Discrete, switches instead of moving */
+} ParamRegistry_Law_TypeDef;
+
+/**
+  * @brief  Dirty groups, applied together at the end of a batch
+  */
+typedef enum {
+  PARAM_GROUP_PEQ = 0,
+  PARAM_GROUP_CROSSOVER,
+  PARAM_GROUP_DYNAMICS,
+  PARAM_GROUP_LIMITER,
+  PARAM_GROUP_DELAY,
+  PARAM_GROUP_OUTPUT,
+  PARAM_GROUP_INPUT,
+  PARAM_GROUP_COUNT
+} ParamRegistry_Group_TypeDef;
+
+/**
+  * @brief  Table entry of one family, stored in flash
+  */
+typedef struct {
+  const char *name;
+  uint8_t type;                 /* ParamRegistry_Type_TypeDef */
+  uint8_t law;                  /* ParamRegistry_Law_TypeDef */
+  uint8_t group;                /* ParamRegistry_Group_TypeDef */
+  uint8_t channels;
+  uint8_t indices;
+  uint16_t offset;              /* First slot in the parameter image */
+  float min;
+  float max;
+  HAL_StatusTypeDef (*set)(uint8_t family, uint8_t channel, uint8_t index, float value);
+  float (*get)(uint8_t family, uint8_t channel, uint8_t index);
+} ParamRegistry_Entry_TypeDef;
+
+/**
+  * @brief  ID and value pair for batch updates
+  */
+typedef struct {
+  uint16_t id;
+  float value;
+} ParamRegistry_Value_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void ParamRegistry_Init(void);
+const ParamRegistry_Entry_TypeDef *ParamRegistry_Lookup(uint16_t id, uint16_t *slot);
+const ParamRegistry_Entry_TypeDef *ParamRegistry_GetFamily(ParamRegistry_Family_TypeDef family);
+
+HAL_StatusTypeDef ParamRegistry_GetRange(uint16_t id, float *min, float *max);
+HAL_StatusTypeDef ParamRegistry_Validate(uint16_t id, float value);
+HAL_StatusTypeDef ParamRegistry_Set(uint16_t id, float value);
+HAL_StatusTypeDef ParamRegistry_Get(uint16_t id, float *value);
+
+void ParamRegistry_BeginBatch(void);
+HAL_StatusTypeDef ParamRegistry_EndBatch(void);
+HAL_StatusTypeDef ParamRegistry_SetBatch(const ParamRegistry_Value_TypeDef *values, uint32_t count);
+
+void ParamRegistry_CaptureImage(float image[PARAM_IMAGE_SLOTS]);
+HAL_StatusTypeDef ParamRegistry_ApplyImage(const float image[PARAM_IMAGE_SLOTS]);
+
+float ParamRegistry_Interpolate(uint16_t id, float from, float to, float t);
+float ParamRegistry_ToNormalized(uint16_t id, float value);
+float ParamRegistry_FromNormalized(uint16_t id, float normalized);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PARAM_REGISTRY_H */
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file           : param_snapshot.h
+  * @brief          : Per-frame snapshot of the runtime parameters hot loops read
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Everything the per-sample code needs from the control side lives in one
+  * contiguous block. The control side edits a private copy and publishes it
+  * with ParamSnapshot_Publish(), the audio side picks up the latest block
+  * once per frame with ParamSnapshot_AcquireFrame() and reads it through
+  * ParamSnapshot_Frame() until the next frame. Three blocks rotate, so the
+  * one being read is never the one being written and a frame never sees a
+  * half-applied update.
+  *
+  * Values are stored ready to use: mutes are folded into the gains and
+  * time constants are per-sample coefficients.
+  *
+  * Scope: input and output gains, the limiter and the delay interpolation
+  * mode. PEQ and crossover coefficients, the dynamics bank and delay times
+  * are still written in place by their setters, so an edit landing mid
+  * frame can be seen half applied by that frame. Moving them here means a
+  * rotating copy of every biquad set and of the dynamics bank, and is left
+  * for when those stages get a publish step of their own.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __PARAM_SNAPSHOT_H
+#define __PARAM_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Limiter values read per sample
+  */
+typedef struct {
+  float threshold;              /* Linear threshold */
+  float knee;                   /* Knee width, linear */
+  float attackCoeff;            /* 1 / attack time in samples */
+  float releaseCoeff;           /* 1 / release time in samples */
+  uint16_t lookaheadTime;       /* Lookahead in samples, 0 = off */
+  uint8_t enableISP;            /* Inter-sample peak prediction */
+  uint8_t adaptiveRelease;
+} ParamSnapshot_Limiter_TypeDef;
+
+/**
+  * @brief  One published parameter set
+  */
+typedef struct {
+  uint32_t epoch;                                       /* Incremented per publish */
+  float inputGain[AUDIO_INPUT_CHANNELS];                /* 0 when muted */
+  float outputGain[AUDIO_OUTPUT_CHANNELS];              /* Master volume applied, 0 when muted */
+  ParamSnapshot_Limiter_TypeDef limiter[AUDIO_OUTPUT_CHANNELS];
+  uint8_t delayCubic;                                   /* Delay interpolation, 0 = linear */
+} ParamSnapshot_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void ParamSnapshot_Init(void);
+
+/* Control side */
+ParamSnapshot_TypeDef *ParamSnapshot_BeginUpdate(void);
+void ParamSnapshot_Publish(void);
+
+/* Audio side */
+const ParamSnapshot_TypeDef *ParamSnapshot_AcquireFrame(void);
+const ParamSnapshot_TypeDef *ParamSnapshot_Frame(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PARAM_SNAPSHOT_H */
@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include "audio_config.h"
 #include "peq_types.h"
+#include "filter_types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,7 +66,7 @@ uint8_t DSP_EQ_GetEnabled(uint8_t channelIndex);
 /**
  * @brief Configure a specific EQ band
  * @param channelIndex Output channel index
- * @param bandIndex Band index (0 to MAX_PEQ_BANDS_PER_CHANNEL-1)
+ * @param bandIndex Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
  * @param filterType Type of filter (PEQ_FilterType_t)
  * @param frequency Center/corner frequency in Hz (20-20000)
  * @param gain Gain in dB (-12 to +12)
@@ -79,7 +80,7 @@ HAL_StatusTypeDef DSP_EQ_ConfigureBand(uint8_t channelIndex, uint8_t bandIndex,
 /**
  * @brief Enable or disable a specific EQ band
  * @param channelIndex Output channel index
- * @param bandIndex Band index (0 to MAX_PEQ_BANDS_PER_CHANNEL-1)
+ * @param bandIndex Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
  * @param state Enable state (0: disable, 1: enable)
  * @return HAL status
  */
@@ -88,7 +89,7 @@ HAL_StatusTypeDef DSP_EQ_SetBandEnabled(uint8_t channelIndex, uint8_t bandIndex,
 /**
  * @brief Get EQ band configuration for specific channel and band
  * @param channelIndex Output channel index
- * @param bandIndex Band index (0 to MAX_PEQ_BANDS_PER_CHANNEL-1)
+ * @param bandIndex Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
  * @param [out] filterType Type of filter 
  * @param [out] frequency Center/corner frequency in Hz
  * @param [out] gain Gain in dB
@@ -135,6 +136,74 @@ const PEQ_Config_t* DSP_EQ_GetConfig(void);
  */
 HAL_StatusTypeDef DSP_EQ_SetConfig(const PEQ_Config_t* config);
 
+/**
+ * @brief Initialize the compiled PEQ path, every band disabled
+ */
+void PEQ_Init(void);
+
+/**
+ * @brief Configure a band of the compiled PEQ path
+ * @param channel Output channel index (0-3)
+ * @param band Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
+ * @param config Band settings, clamped to the supported range in place
+ * @return HAL status, HAL_BUSY if the CPU budget refuses the change
+ */
+HAL_StatusTypeDef PEQ_ConfigureBand(uint8_t channel, uint8_t band, PEQBand_TypeDef *config);
+
+/**
+ * @brief Configure every band of the compiled PEQ path in one batch
+ * @param config Band settings [channel][band]
+ * @return HAL status, HAL_BUSY if the CPU budget refuses the change
+ */
+HAL_StatusTypeDef PEQ_ConfigureAllBands(const PEQBand_TypeDef config[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL]);
+
+/**
+ * @brief Get the settings of a band of the compiled PEQ path
+ * @param channel Output channel index (0-3)
+ * @param band Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
+ * @param [out] config Band settings
+ * @return HAL status
+ */
+HAL_StatusTypeDef PEQ_GetBandConfig(uint8_t channel, uint8_t band, PEQBand_TypeDef *config);
+
+/**
+ * @brief Enable or disable a band of the compiled PEQ path
+ * @param channel Output channel index (0-3)
+ * @param band Band index (0 to PEQ_MAX_BANDS_PER_CHANNEL-1)
+ * @param enabled 1 to enable, 0 to disable
+ * @return HAL status, HAL_BUSY if the CPU budget refuses the change
+ */
+HAL_StatusTypeDef PEQ_SetBandEnabled(uint8_t channel, uint8_t band, uint8_t enabled);
+
+/**
+ * @brief Load fitted correction sections behind the bands of a channel
+ * @param channel Output channel index (0-3)
+ * @param sections Section coefficients (a0 normalized to 1)
+ * @param count Number of sections, 0 removes the correction
+ * @param gain Linear output gain of the correction
+ * @return HAL status, HAL_BUSY if the CPU budget refuses the change
+ */
+HAL_StatusTypeDef PEQ_SetCorrection(uint8_t channel, const BiquadCoeff_t *sections, uint8_t count, float gain);
+
+/**
+ * @brief Process one frame of a channel through its bands and fitted correction
+ * @param channel Output channel index (0-3)
+ * @param audioBuffer Audio buffer, processed in place
+ */
+void PEQ_ProcessChannel(uint8_t channel, AudioBuffer_TypeDef *audioBuffer);
+
+/**
+ * @brief Process one frame of every channel, sharing kernels between channels
+ * @param audioBuffer Audio buffer, processed in place
+ */
+void PEQ_ProcessAllChannels(AudioBuffer_TypeDef *audioBuffer);
+
+/**
+ * @brief Clear the filter history of a channel, keeping its bands
+ * @param channel Output channel index (0-3)
+ */
+void PEQ_ResetState(uint8_t channel);
+
 #ifdef __cplusplus
 }
 #endif
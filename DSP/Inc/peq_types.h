@@ -23,6 +23,11 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Bands per channel of the compiled PEQ path
+ */
+#define PEQ_MAX_BANDS_PER_CHANNEL    5
+
 /**
  * @brief EQ filter types
  */
@@ -66,7 +71,7 @@ typedef struct {
  * @brief PEQ channel configuration
  */
 typedef struct {
-  PEQ_Band_t bands[MAX_PEQ_BANDS_PER_CHANNEL]; /*!< EQ bands per channel */
+  PEQ_Band_t bands[PEQ_MAX_BANDS_PER_CHANNEL]; /*!< EQ bands per channel */
   float preGain;                               /*!< Pre-gain in dB */
   uint8_t enabled;                             /*!< EQ enabled flag */
   uint8_t numActiveBands;                      /*!< Number of active bands */
@@ -80,6 +85,29 @@ typedef struct {
   float sampleRate;                              /*!< Current sample rate */
 } PEQ_Config_t;
 
+/**
+ * @brief Filter types of the compiled PEQ path (peq_filter.c)
+ */
+typedef enum {
+  PEQ_TYPE_BELL = 0,        /*!< Bell/Peak filter */
+  PEQ_TYPE_LOW_SHELF,       /*!< Low shelf filter */
+  PEQ_TYPE_HIGH_SHELF,      /*!< High shelf filter */
+  PEQ_TYPE_LOW_PASS,        /*!< Low pass filter */
+  PEQ_TYPE_HIGH_PASS,       /*!< High pass filter */
+  PEQ_TYPE_MAX              /*!< Number of filter types */
+} PEQ_FilterType_TypeDef;
+
+/**
+ * @brief Band settings of the compiled PEQ path, coefficients are kept internally
+ */
+typedef struct {
+  PEQ_FilterType_TypeDef type;  /*!< Type of EQ filter */
+  float frequency;              /*!< Center/corner frequency in Hz (20-20000) */
+  float gain;                   /*!< Gain in dB (-12 to +12) */
+  float q;                      /*!< Q-factor (0.1 to 10.0) */
+  uint8_t enabled;              /*!< Band enabled flag */
+} PEQBand_TypeDef;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file           : preset_morph.h
+  * @brief          : Timed morph between two complete parameter scenes
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * A scene is every user parameter of the chain: PEQ bands, crossover
+  * corners, delays, limiter thresholds and output gains. Morphing moves
+  * the live chain from scene A to scene B over a set time. Continuous
+  * values are interpolated where they sound linear (frequencies and Q
+  * in log, levels in dB, delays in ms) and applied at control rate;
+  * the PEQ is redesigned in one batch per step. Only one chain runs.
+  *
+  * Discrete values (filter type, order, enables that are not a gain)
+  * cannot glide. They switch at the midpoint while the outputs are
+  * briefly faded to silence, so the switch never lands on a non-zero
+  * sample. A PEQ band enabled on one side only and of a gain type is
+  * morphed as a 0 dB band instead and needs no switch.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __PRESET_MORPH_H
+#define __PRESET_MORPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define MORPH_PEQ_BANDS             5U          /* Bands per channel in the PEQ */
+#define MORPH_CONTROL_MS            5U          /* Parameter update interval */
+#define MORPH_FADE_MS               5.0f        /* Fade around a discrete switch */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  One PEQ band of a scene
+  */
+typedef struct {
+  uint8_t type;                 /* PEQ_TYPE_x */
+  uint8_t enabled;
+  float frequency;              /* Hz */
+  float gainDb;
+  float q;
+} Morph_PeqBand_TypeDef;
+
+/**
+  * @brief  Crossover of one output in a scene
+  */
+typedef struct {
+  uint8_t enabled;
+  uint8_t filterType;           /* CROSSOVER_TYPE_x */
+  uint8_t filterOrder;          /* CROSSOVER_ORDER_x */
+  uint8_t bandPass;
+  float highPassHz;
+  float lowPassHz;
+} Morph_Crossover_TypeDef;
+
+/**
+  * @brief  Complete parameter scene
+  */
+typedef struct {
+  Morph_PeqBand_TypeDef peq[AUDIO_OUTPUT_CHANNELS][MORPH_PEQ_BANDS];
+  Morph_Crossover_TypeDef crossover[AUDIO_OUTPUT_CHANNELS];
+  float delayMs[AUDIO_OUTPUT_CHANNELS];
+  float limiterThresholdDb[AUDIO_OUTPUT_CHANNELS];
+  float outputGainDb[AUDIO_OUTPUT_CHANNELS];
+} Morph_Scene_TypeDef;
+
+/**
+  * @brief  Morph state
+  */
+typedef enum {
+  MORPH_IDLE = 0,
+  MORPH_RUNNING,
+  MORPH_SWITCHING,              /* Fading out for the discrete switch */
+  MORPH_DONE
+} Morph_State_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void Morph_Init(float sampleRate);
+void Morph_CaptureScene(Morph_Scene_TypeDef *scene);
+HAL_StatusTypeDef Morph_Start(const Morph_Scene_TypeDef *from, const Morph_Scene_TypeDef *to,
+                              uint32_t timeMs);
+HAL_StatusTypeDef Morph_StartTo(const Morph_Scene_TypeDef *to, uint32_t timeMs);
+void Morph_Abort(void);
+Morph_State_TypeDef Morph_GetState(void);
+float Morph_GetPosition(void);
+
+/* Control side, from the main loop */
+void Morph_Service(void);
+
+/* Audio side, after the chain and before the DAC */
+void Morph_ProcessFrame(AudioBuffer_TypeDef *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PRESET_MORPH_H */
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file           : quality_scaler.h
+  * @brief          : Graceful quality reduction when frames run out of slack
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Admission control keeps the configured settings inside the budget, but
+  * background slices and bursts can still push a frame past its DMA
+  * deadline. The scaler watches the slack of every frame, from the DMA
+  * signal to the last output write, and walks a ladder of cheaper modes:
+  *
+  *   FULL          everything as configured
+  *   NO_ANALYSIS   AutoEQ, analyzer and IIR fit services paused
+  *   CONTROL_RATE  dynamics gain computer once per sub-block
+  *   LINEAR_DELAY  delay taps linear instead of cubic
+  *   NO_ISP        limiter inter-sample peak prediction off
+  *
+  * Each rung keeps the reductions of the rungs above it. A late frame
+  * steps down on the next main loop pass without waiting for its window
+  * to fill, a full window with little slack steps down at its end;
+  * stepping up needs plenty of slack for QUALITY_UP_HOLD_MS. The user settings are never changed,
+  * the overrides are lifted on the way back up. Every transition is logged.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __QUALITY_SCALER_H
+#define __QUALITY_SCALER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define QUALITY_WINDOW_FRAMES       16U         /* Frames per decision, 10.7 ms */
+#define QUALITY_DOWN_SLACK_PERCENT  10U         /* Step down below this slack */
+#define QUALITY_UP_SLACK_PERCENT    30U         /* Step up above this slack... */
+#define QUALITY_UP_HOLD_MS          3000U       /* ...held this long */
+#define QUALITY_CONTROL_BLOCK       8U          /* Dynamics sub-block on CONTROL_RATE */
+#define QUALITY_EVENT_COUNT         8U          /* Transitions kept */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Ladder rungs, cheapest last
+  */
+typedef enum {
+  QUALITY_LEVEL_FULL = 0,
+  QUALITY_LEVEL_NO_ANALYSIS,
+  QUALITY_LEVEL_CONTROL_RATE,
+  QUALITY_LEVEL_LINEAR_DELAY,
+  QUALITY_LEVEL_NO_ISP,
+  QUALITY_LEVEL_COUNT
+} QualityScaler_Level_TypeDef;
+
+/**
+  * @brief  Scaler state for UI and protocol
+  */
+typedef struct {
+  uint8_t level;                /* QualityScaler_Level_TypeDef */
+  int32_t windowSlackCycles;    /* Smallest slack of the last window */
+  int32_t worstSlackCycles;     /* Smallest slack since start */
+  uint32_t frameCycles;         /* Deadline of one frame */
+  uint32_t lateFrames;          /* Frames past the deadline or lost */
+  uint32_t transitions;
+} QualityScaler_Status_TypeDef;
+
+/**
+  * @brief  One ladder transition
+  */
+typedef struct {
+  uint32_t tick;                /* HAL_GetTick() of the step */
+  int32_t slackCycles;          /* Window slack that caused it */
+  uint8_t from;
+  uint8_t to;
+  uint8_t lateFrames;           /* Late frames in that window */
+} QualityScaler_Event_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void QualityScaler_Init(void);
+
+/* Audio side */
+void QualityScaler_ReportFrame(uint32_t elapsedCycles, uint8_t overrun);
+
+/* Control side */
+void QualityScaler_Update(void);
+QualityScaler_Level_TypeDef QualityScaler_GetLevel(void);
+uint8_t QualityScaler_IsAnalysisAllowed(void);
+uint8_t QualityScaler_IsChainReduced(void);
+void QualityScaler_GetStatus(QualityScaler_Status_TypeDef *result);
+uint8_t QualityScaler_GetEvent(uint8_t index, QualityScaler_Event_TypeDef *event);
+const char *QualityScaler_GetLevelName(QualityScaler_Level_TypeDef level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __QUALITY_SCALER_H */
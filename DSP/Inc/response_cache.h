@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @file           : response_cache.h
+  * @brief          : Incremental magnitude and phase curves of every output
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Each output is described by a few slots: the PEQ bands, the correction
+  * cascade and the two crossover filters. A slot holds the magnitude and
+  * phase of all its sections on the AutoEQ grid (AutoEQ_GetGridFrequency),
+  * and every output keeps the sum over its enabled slots. When a module
+  * redesigns a slot only that slot is evaluated and its old curve is
+  * swapped out of the sum, so moving one band costs O(grid) however many
+  * sections the output runs. Switching a slot on or off does not evaluate
+  * anything.
+  *
+  * Curves are stored in fixed point, 1/256 dB and 1/65536 turn, and the
+  * sums are integers: subtracting a curve removes exactly what adding it
+  * put in, with no drift after any number of edits. Phase wraps by itself.
+  *
+  * The modules report their coefficients from the points where they design
+  * them; a slot whose coefficients and gain hash to the same value as
+  * before is skipped, so a batch redesign only evaluates what changed.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __RESPONSE_CACHE_H
+#define __RESPONSE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include "auto_eq.h"
+#include "filter_types.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define RESPCACHE_GRID_POINTS       AUTOEQ_GRID_POINTS
+#define RESPCACHE_PEQ_BANDS         5U          /* PEQ band slots per output */
+#define RESPCACHE_DB_SCALE          256.0f      /* Stored steps per dB */
+#define RESPCACHE_DB_LIMIT          127.0f      /* Slot curves are clipped to +-this */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Slots of an output, in signal order
+  */
+typedef enum {
+  RESPCACHE_SLOT_PEQ = 0,       /* First PEQ band, RESPCACHE_PEQ_BANDS slots */
+  RESPCACHE_SLOT_CORRECTION = RESPCACHE_PEQ_BANDS,
+  RESPCACHE_SLOT_XOVER_HP,      /* High-pass part, also of a band-pass */
+  RESPCACHE_SLOT_XOVER_LP,      /* Low-pass part, also of a band-pass */
+  RESPCACHE_SLOT_COUNT
+} ResponseCache_Slot_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void ResponseCache_Init(float sampleRate);
+float ResponseCache_GetGridFrequency(uint32_t index);
+
+/* Module side */
+void ResponseCache_SetSection(uint8_t channel, uint8_t slot, const BiquadCoeff_t *sections,
+                              uint8_t count, float gain);
+void ResponseCache_SetEnabled(uint8_t channel, uint8_t slot, uint8_t enabled);
+
+/* UI and protocol side */
+HAL_StatusTypeDef ResponseCache_GetCurve(uint8_t channel, float *magnitudeDb, float *phaseRad);
+HAL_StatusTypeDef ResponseCache_GetSlotCurve(uint8_t channel, uint8_t slot, float *magnitudeDb,
+                                             float *phaseRad);
+uint32_t ResponseCache_GetVersion(uint8_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RESPONSE_CACHE_H */
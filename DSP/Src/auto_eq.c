@@ -0,0 +1,723 @@
+/**
+  ******************************************************************************
+  * @file           : auto_eq.c
+  * @brief          : Background solver fitting PEQ bands to a measured response
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The fit minimizes the weighted squared dB error between the target
+  * correction (target - measured) and the summed response of the bands.
+  * Each band has three parameters: log2 frequency, gain in dB and log2 Q,
+  * so a step means the same thing anywhere in the audio range.
+  *
+  * Refinement never stores the Jacobian: the grid is walked in chunks and
+  * every point is folded straight into J'J and J'r. Finite differences use
+  * one extra section per parameter, designed in one batch per iteration.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "auto_eq.h"
+#include "peq.h"
+#include "coeff_batch.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define AUTOEQ_PARAMS_PER_BAND      3U
+#define AUTOEQ_MAX_PARAMS           (AUTOEQ_MAX_BANDS * AUTOEQ_PARAMS_PER_BAND)
+#define AUTOEQ_CHUNK_POINTS         8U          /* Grid points per unit of work */
+
+#define AUTOEQ_LAMBDA_START         1e-2f
+#define AUTOEQ_LAMBDA_MIN           1e-6f
+#define AUTOEQ_LAMBDA_MAX           1e4f
+#define AUTOEQ_MIN_IMPROVEMENT      1e-3f       /* Relative cost drop to keep iterating */
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  AUTOEQ_PHASE_PICK = 0,
+  AUTOEQ_PHASE_JACOBIAN,
+  AUTOEQ_PHASE_SOLVE,
+  AUTOEQ_PHASE_EVAL,
+  AUTOEQ_PHASE_APPLY
+} AutoEQ_Phase_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static AutoEQ_Config_TypeDef job;
+static AutoEQ_State_TypeDef state = AUTOEQ_IDLE;
+static AutoEQ_Phase_TypeDef phase;
+
+static float gridPhi[AUTOEQ_GRID_POINTS];           /* sin^2(w/2) per grid point */
+static float desired[AUTOEQ_GRID_POINTS];           /* target - measured, dB */
+static float weight[AUTOEQ_GRID_POINTS];
+static float eqDb[AUTOEQ_GRID_POINTS];              /* Response of the accepted bands */
+static float candidateDb[AUTOEQ_GRID_POINTS];       /* Response of the trial step */
+
+static uint8_t bandsUsed;
+static uint8_t iterations;
+static uint16_t cursor;                             /* Next grid point of the phase */
+static float lambda;
+static float cost;
+static float candidateCost;
+static float weightSum;
+static float initialRms;
+
+static float params[AUTOEQ_MAX_PARAMS];
+static float candidate[AUTOEQ_MAX_PARAMS];
+static BiquadCoeff_t sections[AUTOEQ_MAX_BANDS];
+static BiquadCoeff_t candidateSections[AUTOEQ_MAX_BANDS];
+static BiquadCoeff_t probeSections[AUTOEQ_MAX_PARAMS];
+static float jtj[AUTOEQ_MAX_PARAMS][AUTOEQ_MAX_PARAMS];
+static float jtr[AUTOEQ_MAX_PARAMS];
+
+/* Finite difference steps: octaves, dB, octaves of Q */
+static const float probeStep[AUTOEQ_PARAMS_PER_BAND] = { 0.02f, 0.1f, 0.02f };
+
+/* Private function prototypes -----------------------------------------------*/
+static float AutoEQ_SectionDb(const BiquadCoeff_t *c, uint32_t point);
+static void AutoEQ_Design(const float *p, uint8_t bands, BiquadCoeff_t *out);
+static void AutoEQ_DesignProbes(void);
+static void AutoEQ_Clamp(float *p);
+static void AutoEQ_PickBand(void);
+static void AutoEQ_StartRefine(void);
+static void AutoEQ_AccumulateChunk(void);
+static void AutoEQ_SolveStep(void);
+static void AutoEQ_EvaluateChunk(void);
+static void AutoEQ_Apply(void);
+static uint8_t AutoEQ_Cholesky(float a[][AUTOEQ_MAX_PARAMS], float *b, uint8_t n);
+static uint8_t AutoEQ_RunUnit(void);
+
+/**
+  * @brief  Fill a configuration with usable defaults
+  * @param  config: Configuration to fill
+  * @retval None
+  */
+void AutoEQ_GetDefaultConfig(AutoEQ_Config_TypeDef *config)
+{
+  if (config == NULL) {
+    return;
+  }
+
+  config->channel = 0;
+  config->firstBand = 0;
+  config->bandCount = 5;
+  config->maxIterations = 20;
+  config->apply = 1;
+  config->fitLowHz = 30.0f;
+  config->fitHighHz = 16000.0f;
+  config->maxBoostDb = 6.0f;
+  config->maxCutDb = 12.0f;
+  config->minQ = 0.3f;
+  config->maxQ = 8.0f;
+  config->toleranceDb = 0.5f;
+}
+
+/**
+  * @brief  Frequency of a solver grid point
+  * @param  index: Grid point, 0 to AUTOEQ_GRID_POINTS - 1
+  * @retval Frequency in Hz
+  */
+float AutoEQ_GetGridFrequency(uint32_t index)
+{
+  const float span = log2f(AUTOEQ_GRID_MAX_HZ / AUTOEQ_GRID_MIN_HZ);
+
+  if (index >= AUTOEQ_GRID_POINTS) {
+    index = AUTOEQ_GRID_POINTS - 1U;
+  }
+
+  return AUTOEQ_GRID_MIN_HZ * exp2f(span * (float)index / (float)(AUTOEQ_GRID_POINTS - 1U));
+}
+
+/**
+  * @brief  Start a fit
+  * @note   Inputs are copied, the caller's arrays may be reused at once
+  * @param  config: Fit setup
+  * @param  measuredDb: Measured response on the solver grid
+  * @param  targetDb: Target response on the solver grid, NULL for flat
+  * @retval HAL_StatusTypeDef: HAL_BUSY if a fit is running
+  */
+HAL_StatusTypeDef AutoEQ_Start(const AutoEQ_Config_TypeDef *config, const float *measuredDb,
+                               const float *targetDb)
+{
+  const float nyquist = 0.5f * CoeffBatch_GetSampleRate();
+  const float twoPiOverFs = 6.28318531f / CoeffBatch_GetSampleRate();
+
+  if (config == NULL || measuredDb == NULL || config->channel >= AUDIO_OUTPUT_CHANNELS ||
+      config->bandCount == 0 || config->bandCount > AUTOEQ_MAX_BANDS ||
+      config->firstBand + config->bandCount > PEQ_MAX_BANDS_PER_CHANNEL ||
+      config->minQ <= 0.0f || config->minQ > config->maxQ ||
+      !(config->fitLowHz > 0.0f && config->fitHighHz > config->fitLowHz)) {
+    return HAL_ERROR;
+  }
+
+  if (state == AUTOEQ_PICKING || state == AUTOEQ_REFINING) {
+    return HAL_BUSY;
+  }
+
+  job = *config;
+
+  weightSum = 0.0f;
+  cost = 0.0f;
+
+  for (uint32_t i = 0; i < AUTOEQ_GRID_POINTS; i++) {
+    const float f = AutoEQ_GetGridFrequency(i);
+    const float w = twoPiOverFs * f;
+
+    gridPhi[i] = sinf(0.5f * w) * sinf(0.5f * w);
+
+    desired[i] = ((targetDb != NULL) ? targetDb[i] : 0.0f) - measuredDb[i];
+    weight[i] = (f >= job.fitLowHz && f <= job.fitHighHz && f < nyquist) ? 1.0f : 0.0f;
+    eqDb[i] = 0.0f;
+
+    weightSum += weight[i];
+    cost += weight[i] * desired[i] * desired[i];
+  }
+
+  if (weightSum == 0.0f) {
+    return HAL_ERROR;
+  }
+
+  initialRms = sqrtf(cost / weightSum);
+  bandsUsed = 0;
+  iterations = 0;
+  cursor = 0;
+  phase = AUTOEQ_PHASE_PICK;
+  state = AUTOEQ_PICKING;
+
+  DEBUG_PRINT("AutoEQ: ch%d, %d bands, initial error %.2f dB RMS\r\n",
+              job.channel, job.bandCount, initialRms);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Advance the running fit
+  * @note   Call from the main loop. At least one unit of work is done per
+  *         call, then units run until the budget is spent.
+  * @param  budgetCycles: CPU cycles this call may use
+  * @retval State after the slice
+  */
+AutoEQ_State_TypeDef AutoEQ_Service(uint32_t budgetCycles)
+{
+  const uint32_t start = DWT->CYCCNT;
+
+  while (state == AUTOEQ_PICKING || state == AUTOEQ_REFINING) {
+    if (!AutoEQ_RunUnit()) {
+      break;
+    }
+
+    if ((DWT->CYCCNT - start) >= budgetCycles) {
+      break;
+    }
+  }
+
+  return state;
+}
+
+/**
+  * @brief  Abandon the running fit, nothing is written
+  * @retval None
+  */
+void AutoEQ_Cancel(void)
+{
+  if (state == AUTOEQ_PICKING || state == AUTOEQ_REFINING) {
+    state = AUTOEQ_IDLE;
+  }
+}
+
+/**
+  * @brief  Get the job state
+  * @retval AutoEQ_State_TypeDef
+  */
+AutoEQ_State_TypeDef AutoEQ_GetState(void)
+{
+  return state;
+}
+
+/**
+  * @brief  Get the bands and error of the last fit
+  * @note   Valid while running too, bands then show the current estimate
+  * @param  result: Structure to fill
+  * @retval None
+  */
+void AutoEQ_GetResult(AutoEQ_Result_TypeDef *result)
+{
+  if (result == NULL) {
+    return;
+  }
+
+  memset(result, 0, sizeof(*result));
+  result->state = state;
+  result->bandsUsed = bandsUsed;
+  result->iterations = iterations;
+  result->initialRmsDb = initialRms;
+  result->finalRmsDb = (weightSum > 0.0f) ? sqrtf(cost / weightSum) : 0.0f;
+
+  for (uint8_t b = 0; b < bandsUsed; b++) {
+    const float *p = &params[b * AUTOEQ_PARAMS_PER_BAND];
+
+    result->bands[b].frequency = exp2f(p[0]);
+    result->bands[b].gainDb = p[1];
+    result->bands[b].q = exp2f(p[2]);
+  }
+}
+
+/**
+  * @brief  Run one bounded piece of the current phase
+  * @retval 1 if more work remains
+  */
+static uint8_t AutoEQ_RunUnit(void)
+{
+  switch (phase) {
+    case AUTOEQ_PHASE_PICK:
+      AutoEQ_PickBand();
+      break;
+
+    case AUTOEQ_PHASE_JACOBIAN:
+      AutoEQ_AccumulateChunk();
+      break;
+
+    case AUTOEQ_PHASE_SOLVE:
+      AutoEQ_SolveStep();
+      break;
+
+    case AUTOEQ_PHASE_EVAL:
+      AutoEQ_EvaluateChunk();
+      break;
+
+    case AUTOEQ_PHASE_APPLY:
+    default:
+      AutoEQ_Apply();
+      break;
+  }
+
+  return (state == AUTOEQ_PICKING || state == AUTOEQ_REFINING) ? 1U : 0U;
+}
+
+/**
+  * @brief  Response of one section at a grid point
+  * @note   Written in sin^2(w/2): the cos(w) form cancels to noise in
+  *         float for low bands, where b0+b1+b2 and 1+a1+a2 are tiny
+  * @param  c: Section coefficients, a0 = 1
+  * @param  point: Grid point
+  * @retval Magnitude in dB
+  */
+static float AutoEQ_SectionDb(const BiquadCoeff_t *c, uint32_t point)
+{
+  const float phi = gridPhi[point];
+  const float bs = c->b0 + c->b1 + c->b2;
+  const float as = 1.0f + c->a1 + c->a2;
+  float num, den;
+
+  num = bs * bs - 4.0f * phi * (c->b0 * c->b1 + 4.0f * c->b0 * c->b2 + c->b1 * c->b2 -
+                                4.0f * c->b0 * c->b2 * phi);
+  den = as * as - 4.0f * phi * (c->a1 + 4.0f * c->a2 + c->a1 * c->a2 - 4.0f * c->a2 * phi);
+
+  if (num < 1e-20f) {
+    num = 1e-20f;
+  }
+  if (den < 1e-20f) {
+    den = 1e-20f;
+  }
+
+  return 10.0f * log10f(num / den);
+}
+
+/**
+  * @brief  Design the sections of a parameter vector
+  * @param  p: Parameters, three per band
+  * @param  bands: Number of bands
+  * @param  out: Coefficients, one section per band
+  * @retval None
+  */
+static void AutoEQ_Design(const float *p, uint8_t bands, BiquadCoeff_t *out)
+{
+  CoeffBatch_Band_TypeDef batch[AUTOEQ_MAX_BANDS];
+
+  for (uint8_t b = 0; b < bands; b++) {
+    batch[b].type = COEFF_BATCH_BELL;
+    batch[b].frequency = exp2f(p[b * AUTOEQ_PARAMS_PER_BAND]);
+    batch[b].gainDb = p[b * AUTOEQ_PARAMS_PER_BAND + 1U];
+    batch[b].q = exp2f(p[b * AUTOEQ_PARAMS_PER_BAND + 2U]);
+  }
+
+  CoeffBatch_Design(batch, out, bands);
+}
+
+/**
+  * @brief  Design one perturbed section per parameter
+  * @retval None
+  */
+static void AutoEQ_DesignProbes(void)
+{
+  CoeffBatch_Band_TypeDef batch[AUTOEQ_MAX_PARAMS];
+  const uint8_t count = bandsUsed * AUTOEQ_PARAMS_PER_BAND;
+
+  for (uint8_t j = 0; j < count; j++) {
+    const float *p = &params[(j / AUTOEQ_PARAMS_PER_BAND) * AUTOEQ_PARAMS_PER_BAND];
+    const uint8_t k = j % AUTOEQ_PARAMS_PER_BAND;
+
+    batch[j].type = COEFF_BATCH_BELL;
+    batch[j].frequency = exp2f(p[0] + ((k == 0U) ? probeStep[0] : 0.0f));
+    batch[j].gainDb = p[1] + ((k == 1U) ? probeStep[1] : 0.0f);
+    batch[j].q = exp2f(p[2] + ((k == 2U) ? probeStep[2] : 0.0f));
+  }
+
+  CoeffBatch_Design(batch, probeSections, count);
+}
+
+/**
+  * @brief  Keep every band inside the configured limits
+  * @param  p: Parameters, bandsUsed bands
+  * @retval None
+  */
+static void AutoEQ_Clamp(float *p)
+{
+  const float fMin = log2f(job.fitLowHz);
+  const float fMax = log2f(job.fitHighHz);
+  const float qMin = log2f(job.minQ);
+  const float qMax = log2f(job.maxQ);
+
+  for (uint8_t b = 0; b < bandsUsed; b++) {
+    float *band = &p[b * AUTOEQ_PARAMS_PER_BAND];
+
+    band[0] = fminf(fmaxf(band[0], fMin), fMax);
+    band[1] = fminf(fmaxf(band[1], -job.maxCutDb), job.maxBoostDb);
+    band[2] = fminf(fmaxf(band[2], qMin), qMax);
+  }
+}
+
+/**
+  * @brief  Place the next band on the largest remaining deviation
+  * @note   Width comes from where the deviation falls to half its peak;
+  *         refinement corrects the rough first guess
+  * @retval None
+  */
+static void AutoEQ_PickBand(void)
+{
+  float smooth[AUTOEQ_GRID_POINTS];
+  float peak = 0.0f;
+  uint32_t at = 0;
+  uint32_t lo, hi;
+
+  for (uint32_t i = 0; i < AUTOEQ_GRID_POINTS; i++) {
+    const float prev = (i > 0U) ? weight[i - 1U] * (desired[i - 1U] - eqDb[i - 1U]) : 0.0f;
+    const float here = weight[i] * (desired[i] - eqDb[i]);
+    const float next = (i + 1U < AUTOEQ_GRID_POINTS) ? weight[i + 1U] * (desired[i + 1U] - eqDb[i + 1U]) : 0.0f;
+
+    smooth[i] = weight[i] * 0.25f * (prev + 2.0f * here + next);
+
+    if (fabsf(smooth[i]) > fabsf(peak)) {
+      peak = smooth[i];
+      at = i;
+    }
+  }
+
+  if (fabsf(peak) < job.toleranceDb || bandsUsed >= job.bandCount) {
+    AutoEQ_StartRefine();
+    return;
+  }
+
+  /* Half-deviation bandwidth, same sign only */
+  lo = at;
+  hi = at;
+  while (lo > 0U && smooth[lo - 1U] * peak > 0.5f * peak * peak) {
+    lo--;
+  }
+  while (hi + 1U < AUTOEQ_GRID_POINTS && smooth[hi + 1U] * peak > 0.5f * peak * peak) {
+    hi++;
+  }
+
+  {
+    float *p = &params[bandsUsed * AUTOEQ_PARAMS_PER_BAND];
+    const float octaves = fmaxf(log2f(AutoEQ_GetGridFrequency(hi + 1U) /
+                                      AutoEQ_GetGridFrequency(lo)), 0.1f);
+    const float ratio = exp2f(octaves);
+
+    p[0] = log2f(AutoEQ_GetGridFrequency(at));
+    p[1] = peak;
+    p[2] = log2f(sqrtf(ratio) / (ratio - 1.0f));
+
+    bandsUsed++;
+    AutoEQ_Clamp(params);
+
+    AutoEQ_Design(p, 1, &sections[bandsUsed - 1U]);
+  }
+
+  cost = 0.0f;
+  for (uint32_t i = 0; i < AUTOEQ_GRID_POINTS; i++) {
+    float e;
+
+    eqDb[i] += AutoEQ_SectionDb(&sections[bandsUsed - 1U], i);
+    e = desired[i] - eqDb[i];
+    cost += weight[i] * e * e;
+  }
+}
+
+/**
+  * @brief  Leave greedy placement and set up the first iteration
+  * @retval None
+  */
+static void AutoEQ_StartRefine(void)
+{
+  if (bandsUsed == 0U || job.maxIterations == 0U) {
+    phase = AUTOEQ_PHASE_APPLY;
+    return;
+  }
+
+  state = AUTOEQ_REFINING;
+  lambda = AUTOEQ_LAMBDA_START;
+  AutoEQ_DesignProbes();
+  memset(jtj, 0, sizeof(jtj));
+  memset(jtr, 0, sizeof(jtr));
+  cursor = 0;
+  phase = AUTOEQ_PHASE_JACOBIAN;
+}
+
+/**
+  * @brief  Fold the next chunk of grid points into J'J and J'r
+  * @retval None
+  */
+static void AutoEQ_AccumulateChunk(void)
+{
+  const uint8_t n = bandsUsed * AUTOEQ_PARAMS_PER_BAND;
+  const uint32_t end = (cursor + AUTOEQ_CHUNK_POINTS < AUTOEQ_GRID_POINTS) ?
+                       cursor + AUTOEQ_CHUNK_POINTS : AUTOEQ_GRID_POINTS;
+  float row[AUTOEQ_MAX_PARAMS];
+
+  for (uint32_t i = cursor; i < end; i++) {
+    float r;
+
+    if (weight[i] == 0.0f) {
+      continue;
+    }
+
+    r = desired[i] - eqDb[i];
+
+    for (uint8_t b = 0; b < bandsUsed; b++) {
+      const float base = AutoEQ_SectionDb(&sections[b], i);
+
+      for (uint8_t k = 0; k < AUTOEQ_PARAMS_PER_BAND; k++) {
+        const uint8_t j = b * AUTOEQ_PARAMS_PER_BAND + k;
+        row[j] = (AutoEQ_SectionDb(&probeSections[j], i) - base) / probeStep[k];
+      }
+    }
+
+    for (uint8_t a = 0; a < n; a++) {
+      const float wa = weight[i] * row[a];
+
+      jtr[a] += wa * r;
+      for (uint8_t c = a; c < n; c++) {
+        jtj[a][c] += wa * row[c];
+      }
+    }
+  }
+
+  cursor = (uint16_t)end;
+
+  if (cursor >= AUTOEQ_GRID_POINTS) {
+    phase = AUTOEQ_PHASE_SOLVE;
+  }
+}
+
+/**
+  * @brief  Solve the damped normal equations for a trial step
+  * @retval None
+  */
+static void AutoEQ_SolveStep(void)
+{
+  const uint8_t n = bandsUsed * AUTOEQ_PARAMS_PER_BAND;
+  float a[AUTOEQ_MAX_PARAMS][AUTOEQ_MAX_PARAMS];
+  float step[AUTOEQ_MAX_PARAMS];
+
+  for (uint8_t r = 0; r < n; r++) {
+    for (uint8_t c = r; c < n; c++) {
+      a[r][c] = jtj[r][c];
+    }
+    a[r][r] += lambda * jtj[r][r] + 1e-9f;
+    step[r] = jtr[r];
+  }
+
+  if (!AutoEQ_Cholesky(a, step, n)) {
+    lambda *= 10.0f;
+    if (lambda > AUTOEQ_LAMBDA_MAX) {
+      phase = AUTOEQ_PHASE_APPLY;
+    }
+    return;
+  }
+
+  for (uint8_t j = 0; j < n; j++) {
+    candidate[j] = params[j] + step[j];
+  }
+  AutoEQ_Clamp(candidate);
+  AutoEQ_Design(candidate, bandsUsed, candidateSections);
+
+  candidateCost = 0.0f;
+  cursor = 0;
+  phase = AUTOEQ_PHASE_EVAL;
+}
+
+/**
+  * @brief  Evaluate the trial step on the next chunk, then accept or reject
+  * @retval None
+  */
+static void AutoEQ_EvaluateChunk(void)
+{
+  const uint32_t end = (cursor + AUTOEQ_CHUNK_POINTS < AUTOEQ_GRID_POINTS) ?
+                       cursor + AUTOEQ_CHUNK_POINTS : AUTOEQ_GRID_POINTS;
+  float improvement;
+
+  for (uint32_t i = cursor; i < end; i++) {
+    float sum = 0.0f;
+    float e;
+
+    for (uint8_t b = 0; b < bandsUsed; b++) {
+      sum += AutoEQ_SectionDb(&candidateSections[b], i);
+    }
+
+    candidateDb[i] = sum;
+    e = desired[i] - sum;
+    candidateCost += weight[i] * e * e;
+  }
+
+  cursor = (uint16_t)end;
+
+  if (cursor < AUTOEQ_GRID_POINTS) {
+    return;
+  }
+
+  if (candidateCost >= cost) {
+    /* Rejected: same linearization, shorter step */
+    lambda *= 4.0f;
+    phase = (lambda > AUTOEQ_LAMBDA_MAX) ? AUTOEQ_PHASE_APPLY : AUTOEQ_PHASE_SOLVE;
+    return;
+  }
+
+  improvement = (cost > 0.0f) ? (cost - candidateCost) / cost : 0.0f;
+
+  memcpy(params, candidate, sizeof(params));
+  memcpy(sections, candidateSections, sizeof(sections));
+  memcpy(eqDb, candidateDb, sizeof(eqDb));
+  cost = candidateCost;
+  lambda = fmaxf(lambda / 3.0f, AUTOEQ_LAMBDA_MIN);
+  iterations++;
+
+  if (improvement < AUTOEQ_MIN_IMPROVEMENT || iterations >= job.maxIterations) {
+    phase = AUTOEQ_PHASE_APPLY;
+    return;
+  }
+
+  AutoEQ_DesignProbes();
+  memset(jtj, 0, sizeof(jtj));
+  memset(jtr, 0, sizeof(jtr));
+  cursor = 0;
+  phase = AUTOEQ_PHASE_JACOBIAN;
+}
+
+/**
+  * @brief  Write the fitted bands and disable the unused ones of the range
+  * @note   All bands go to the running PEQ in one PEQ_ConfigureAllBands()
+  *         call, so the channel never plays a half-written fit and the CPU
+  *         budget admits or refuses the result as a whole
+  * @retval None
+  */
+static void AutoEQ_Apply(void)
+{
+  static PEQBand_TypeDef bands[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL];
+  AutoEQ_State_TypeDef result = AUTOEQ_DONE;
+
+  if (job.apply) {
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS && result == AUTOEQ_DONE; ch++) {
+      for (uint8_t b = 0; b < PEQ_MAX_BANDS_PER_CHANNEL; b++) {
+        if (PEQ_GetBandConfig(ch, b, &bands[ch][b]) != HAL_OK) {
+          result = AUTOEQ_FAILED;
+          break;
+        }
+      }
+    }
+
+    for (uint8_t b = 0; b < job.bandCount && result == AUTOEQ_DONE; b++) {
+      PEQBand_TypeDef *band = &bands[job.channel][job.firstBand + b];
+
+      if (b < bandsUsed) {
+        const float *p = &params[b * AUTOEQ_PARAMS_PER_BAND];
+
+        band->type = PEQ_TYPE_BELL;
+        band->frequency = exp2f(p[0]);
+        band->gain = p[1];
+        band->q = exp2f(p[2]);
+        band->enabled = 1;
+      } else {
+        band->enabled = 0;
+      }
+    }
+
+    if (result == AUTOEQ_DONE && PEQ_ConfigureAllBands(bands) != HAL_OK) {
+      result = AUTOEQ_FAILED;
+    }
+  }
+
+  state = result;
+
+  DEBUG_PRINT("AutoEQ: %d bands, %d iterations, error %.2f -> %.2f dB RMS\r\n",
+              bandsUsed, iterations, initialRms, sqrtf(cost / weightSum));
+}
+
+/**
+  * @brief  Solve a symmetric positive definite system in place
+  * @note   Only the upper triangle of a is read; a is overwritten
+  * @param  a: Matrix, upper triangle
+  * @param  b: Right-hand side, replaced by the solution
+  * @param  n: Size
+  * @retval 1 on success, 0 if the matrix is not positive definite
+  */
+static uint8_t AutoEQ_Cholesky(float a[][AUTOEQ_MAX_PARAMS], float *b, uint8_t n)
+{
+  /* Factor a = U'U, U stored in the upper triangle */
+  for (uint8_t i = 0; i < n; i++) {
+    float d = a[i][i];
+
+    for (uint8_t k = 0; k < i; k++) {
+      d -= a[k][i] * a[k][i];
+    }
+    if (d <= 0.0f) {
+      return 0;
+    }
+    a[i][i] = sqrtf(d);
+
+    for (uint8_t j = i + 1U; j < n; j++) {
+      float s = a[i][j];
+
+      for (uint8_t k = 0; k < i; k++) {
+        s -= a[k][i] * a[k][j];
+      }
+      a[i][j] = s / a[i][i];
+    }
+  }
+
+  /* U'y = b */
+  for (uint8_t i = 0; i < n; i++) {
+    float s = b[i];
+
+    for (uint8_t k = 0; k < i; k++) {
+      s -= a[k][i] * b[k];
+    }
+    b[i] = s / a[i][i];
+  }
+
+  /* Ux = y */
+  for (int32_t i = (int32_t)n - 1; i >= 0; i--) {
+    float s = b[i];
+
+    for (uint8_t k = (uint8_t)(i + 1); k < n; k++) {
+      s -= a[i][k] * b[k];
+    }
+    b[i] = s / a[i][i];
+  }
+
+  return 1;
+}
@@ -12,7 +12,11 @@
   * - Variable ratio (1:1 to 20:1)
   * - Adjustable attack and release
   * - Soft/Hard knee
-  * - Make-up gain 
+  * - Make-up gain
+  *
+  * The compressor is a front end for the dynamics engine (dynamics.c), which
+  * holds the coefficients and detector state of all channels. This file only
+  * keeps the user-facing configuration and maps it onto the engine curve.
   *
   ******************************************************************************
   */
@@ -20,463 +24,447 @@
 /* Includes ------------------------------------------------------------------*/
 #include "compressor.h"
 #include "compressor_types.h"
-#include "math_utils.h"
+#include "dynamics.h"
 #include "debug.h"
-#include <math.h>
 #include <string.h>
 
-/* Private typedef -----------------------------------------------------------*/
-
 /* Private defines -----------------------------------------------------------*/
-#define COMP_DB_MIN                 -120.0f    /* Minimum dB level (considered as silence) */
-#define COMP_ENVELOPE_INIT          -120.0f    /* Initial envelope value */
-#define COMP_GAIN_SMOOTHING_COEF    0.9995f    /* Smoothing coefficient for gain changes */
-#define COMP_RMS_WINDOW_SIZE        32         /* Window size for RMS calculation */
-#define COMP_MIN_GAIN_DB            -60.0f     /* Minimum gain in dB */
-#define COMP_MAX_GAIN_DB            0.0f       /* Maximum gain in dB */
-
-/* Private macro -------------------------------------------------------------*/
-#define DB_TO_LINEAR(x)             ((x) <= COMP_DB_MIN ? 0.0f : powf(10.0f, (x) / 20.0f))
-#define LINEAR_TO_DB(x)             ((x) <= 0.0f ? COMP_DB_MIN : 20.0f * log10f(x))
-#define MAX(a,b)                    ((a) > (b) ? (a) : (b))
-#define MIN(a,b)                    ((a) < (b) ? (a) : (b))
-#define CLAMP(x, min, max)          (MIN(MAX((x), (min)), (max)))
+#define COMP_MIN_THRESHOLD_DB     -60.0f
+#define COMP_MAX_THRESHOLD_DB     0.0f
+#define COMP_MIN_RATIO            1.0f
+#define COMP_MAX_RATIO            20.0f
+#define COMP_MIN_ATTACK_MS        0.1f
+#define COMP_MAX_ATTACK_MS        100.0f
+#define COMP_MIN_RELEASE_MS       10.0f
+#define COMP_MAX_RELEASE_MS       1000.0f
+#define COMP_MIN_MAKEUP_DB        0.0f
+#define COMP_MAX_MAKEUP_DB        24.0f
+#define COMP_SOFT_KNEE_DB         6.0f      /* Knee width used for COMP_KNEE_SOFT */
 
 /* Private variables ---------------------------------------------------------*/
-/* Compressor states for all output channels */
-static CompressorState_TypeDef compressorState[AUDIO_OUTPUT_CHANNELS];
-
-/* RMS calculation buffers */
-static float rmsBuffer[AUDIO_OUTPUT_CHANNELS][COMP_RMS_WINDOW_SIZE];
-static uint16_t rmsBufferIndex[AUDIO_OUTPUT_CHANNELS];
+/* User-facing configuration, processing state lives in the dynamics engine */
+static Compressor_Config_t compressorConfig;
 
 /* Private function prototypes -----------------------------------------------*/
-static float Compressor_CalculateRMS(uint8_t channel, float sample);
-static float Compressor_CalculateEnvelope(uint8_t channel, float level_db);
-static float Compressor_CalculateGain(uint8_t channel, float envelope_db);
-static float Compressor_ApplySoftKnee(CompressorParameters_TypeDef *params, float input_db);
+static HAL_StatusTypeDef Compressor_ApplyChannel(uint8_t channelIndex);
+static void Compressor_LoadDefaults(Compressor_Channel_t *channel, float sampleRate);
+static float Compressor_Clamp(float value, float min, float max);
 
 /**
   * @brief  Initialize the compressor module
-  * @param  None
-  * @retval None
+  * @param  sampleRate: Current audio sample rate
+  * @retval HAL status
   */
-void Compressor_Init(void)
+HAL_StatusTypeDef DSP_Compressor_Init(float sampleRate)
 {
   DEBUG_PRINT("Initializing compressor module\r\n");
-  
-  /* Initialize compressor states for all channels */
+
+  Dynamics_Init(sampleRate);
+
   for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
-    /* Initialize envelope */
-    compressorState[channel].envelope_db = COMP_ENVELOPE_INIT;
-    compressorState[channel].currentGain = 1.0f;
-    compressorState[channel].prevGainDb = 0.0f;
-    compressorState[channel].rmsValue = 0.0f;
-    
-    /* Clear RMS buffer */
-    memset(rmsBuffer[channel], 0, sizeof(float) * COMP_RMS_WINDOW_SIZE);
-    rmsBufferIndex[channel] = 0;
-    
-    /* Initialize with default parameters */
-    CompressorParameters_TypeDef *params = &compressorState[channel].params;
-    params->enabled = 0;
-    params->threshold_db = -20.0f;
-    params->ratio = 4.0f;
-    params->attackTime_ms = 20.0f;
-    params->releaseTime_ms = 200.0f;
-    params->makeupGain_db = 0.0f;
-    params->kneeWidth_db = 6.0f;  /* Default soft knee */
-    params->useSoftKnee = 1;      /* Enable soft knee by default */
-    params->useRMS = 1;           /* Use RMS detection by default */
-    
-    /* Calculate attack and release coefficients */
-    Compressor_UpdateParameters(channel);
+    Compressor_LoadDefaults(&compressorConfig.channels[channel], sampleRate);
+    if (Compressor_ApplyChannel(channel) != HAL_OK) {
+      return HAL_ERROR;
+    }
   }
-  
+
   DEBUG_PRINT("Compressor module initialized\r\n");
+  return HAL_OK;
 }
 
 /**
-  * @brief  Update compressor parameters for a specific channel
-  * @param  channel: Channel index
-  * @retval None
+  * @brief  Process a single sample through the compressor
+  * @param  channelIndex: Output channel index
+  * @param  sample: Input sample
+  * @retval Processed sample
+  */
+float DSP_Compressor_ProcessSample(uint8_t channelIndex, float sample)
+{
+  Dynamics_ProcessChannel(channelIndex, &sample, 1);
+  return sample;
+}
+
+/**
+  * @brief  Process one frame of a channel through the compressor
+  * @param  channelIndex: Output channel index
+  * @param  buffer: Audio buffer, processed in place
+  * @retval HAL status
   */
-void Compressor_UpdateParameters(uint8_t channel)
+HAL_StatusTypeDef DSP_Compressor_Process(uint8_t channelIndex, AudioBuffer_TypeDef* buffer)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS) {
-    return;
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS || buffer == NULL) {
+    return HAL_ERROR;
   }
-  
-  CompressorParameters_TypeDef *params = &compressorState[channel].params;
-  
-  /* Calculate attack coefficient: e^(-1/(sampleRate * attackTime)) */
-  float attackCoeff;
-  if (params->attackTime_ms <= 0.1f) {
-    /* Very fast attack, almost immediate */
-    attackCoeff = 0.0f;
-  } else {
-    attackCoeff = expf(-1.0f / (AUDIO_SAMPLE_RATE * params->attackTime_ms / 1000.0f));
+
+  Dynamics_ProcessChannel(channelIndex, buffer->samples[channelIndex], AUDIO_FRAME_SIZE);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Process one frame of all channels through the compressor
+  * @param  buffer: Audio buffer, processed in place
+  * @retval HAL status
+  */
+HAL_StatusTypeDef DSP_Compressor_ProcessAll(AudioBuffer_TypeDef* buffer)
+{
+  float *channels[AUDIO_OUTPUT_CHANNELS];
+
+  if (buffer == NULL) {
+    return HAL_ERROR;
   }
-  compressorState[channel].attackCoeff = attackCoeff;
-  
-  /* Calculate release coefficient: e^(-1/(sampleRate * releaseTime)) */
-  float releaseCoeff;
-  if (params->releaseTime_ms <= 0.1f) {
-    /* Very fast release, almost immediate */
-    releaseCoeff = 0.0f;
-  } else {
-    releaseCoeff = expf(-1.0f / (AUDIO_SAMPLE_RATE * params->releaseTime_ms / 1000.0f));
+
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    channels[channel] = buffer->samples[channel];
   }
-  compressorState[channel].releaseCoeff = releaseCoeff;
-  
-  DEBUG_PRINT("Updated compressor ch%d: thr=%.1f, ratio=%.1f, att=%.1f, rel=%.1f\r\n", 
-               channel, params->threshold_db, params->ratio, 
-               params->attackTime_ms, params->releaseTime_ms);
+
+  Dynamics_ProcessBlock(channels, AUDIO_FRAME_SIZE);
+  return HAL_OK;
 }
 
 /**
-  * @brief  Set compressor parameters for a specific channel
-  * @param  channel: Channel index
-  * @param  params: Pointer to compressor parameters
-  * @retval None
+  * @brief  Enable or disable the compressor for a channel
+  * @param  channelIndex: Output channel index
+  * @param  state: Enable state (0: disable, 1: enable)
+  * @retval HAL status
   */
-void Compressor_SetParameters(uint8_t channel, CompressorParameters_TypeDef *params)
+HAL_StatusTypeDef DSP_Compressor_SetEnabled(uint8_t channelIndex, uint8_t state)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS || params == NULL) {
-    return;
+  HAL_StatusTypeDef status;
+
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
+  }
+
+  /* The engine may refuse when the frame budget is full */
+  status = Dynamics_SetEnabled(channelIndex, state);
+  if (status != HAL_OK) {
+    return status;
   }
-  
-  /* Copy parameters */
-  memcpy(&compressorState[channel].params, params, sizeof(CompressorParameters_TypeDef));
-  
-  /* Update coefficients */
-  Compressor_UpdateParameters(channel);
+
+  compressorConfig.channels[channelIndex].enabled = state ? 1 : 0;
+
+  DEBUG_PRINT("Compressor channel %d %s\r\n", channelIndex, state ? "enabled" : "disabled");
+  return HAL_OK;
 }
 
 /**
-  * @brief  Get compressor parameters for a specific channel
-  * @param  channel: Channel index
-  * @param  params: Pointer to store compressor parameters
-  * @retval None
+  * @brief  Get the enabled state of the compressor for a channel
+  * @param  channelIndex: Output channel index
+  * @retval Enabled state (0: disabled, 1: enabled)
   */
-void Compressor_GetParameters(uint8_t channel, CompressorParameters_TypeDef *params)
+uint8_t DSP_Compressor_GetEnabled(uint8_t channelIndex)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS || params == NULL) {
-    return;
-  }
-  
-  /* Copy parameters */
-  memcpy(params, &compressorState[channel].params, sizeof(CompressorParameters_TypeDef));
+  return Dynamics_GetEnabled(channelIndex);
 }
 
 /**
-  * @brief  Enable/disable compressor for a specific channel
-  * @param  channel: Channel index
-  * @param  enabled: Enable (1) or disable (0)
-  * @retval None
+  * @brief  Set compressor threshold level
+  * @param  channelIndex: Output channel index
+  * @param  thresholdDb: Threshold level in dB (-60 to 0)
+  * @retval HAL status
   */
-void Compressor_SetEnabled(uint8_t channel, uint8_t enabled)
+HAL_StatusTypeDef DSP_Compressor_SetThreshold(uint8_t channelIndex, float thresholdDb)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS) {
-    return;
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  compressorState[channel].params.enabled = enabled;
-  
-  /* Reset state when disabling to avoid gain jumping when re-enabled */
-  if (!enabled) {
-    compressorState[channel].envelope_db = COMP_ENVELOPE_INIT;
-    compressorState[channel].currentGain = 1.0f;
-    compressorState[channel].prevGainDb = 0.0f;
-  }
-  
-  DEBUG_PRINT("Compressor channel %d %s\r\n", channel, enabled ? "enabled" : "disabled");
+
+  compressorConfig.channels[channelIndex].threshold =
+    Compressor_Clamp(thresholdDb, COMP_MIN_THRESHOLD_DB, COMP_MAX_THRESHOLD_DB);
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Process audio samples through the compressor
-  * @param  channel: Channel index
-  * @param  audioBuffer: Pointer to audio buffer
-  * @retval None
+  * @brief  Set compressor ratio
+  * @param  channelIndex: Output channel index
+  * @param  ratio: Compression ratio (1.0 to 20.0)
+  * @retval HAL status
   */
-void Compressor_Process(uint8_t channel, AudioBuffer_TypeDef *audioBuffer)
+HAL_StatusTypeDef DSP_Compressor_SetRatio(uint8_t channelIndex, float ratio)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS || audioBuffer == NULL) {
-    return;
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  /* Quick return if compressor is disabled */
-  if (!compressorState[channel].params.enabled) {
-    return;
+
+  compressorConfig.channels[channelIndex].ratio =
+    Compressor_Clamp(ratio, COMP_MIN_RATIO, COMP_MAX_RATIO);
+  return Compressor_ApplyChannel(channelIndex);
+}
+
+/**
+  * @brief  Set compressor attack time
+  * @param  channelIndex: Output channel index
+  * @param  attackMs: Attack time in milliseconds (0.1 to 100)
+  * @retval HAL status
+  */
+HAL_StatusTypeDef DSP_Compressor_SetAttack(uint8_t channelIndex, float attackMs)
+{
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  CompressorParameters_TypeDef *params = &compressorState[channel].params;
-  
-  /* Process each sample */
-  for (uint16_t i = 0; i < audioBuffer->size; i++) {
-    float sample = audioBuffer->data[channel][i];
-    float level;
-    
-    /* Calculate signal level - RMS or peak based on configuration */
-    if (params->useRMS) {
-      level = Compressor_CalculateRMS(channel, sample);
-    } else {
-      /* Peak detection */
-      level = fabsf(sample);
-    }
-    
-    /* Convert to dB */
-    float level_db = level > 0.0f ? LINEAR_TO_DB(level) : COMP_DB_MIN;
-    
-    /* Calculate envelope */
-    float envelope_db = Compressor_CalculateEnvelope(channel, level_db);
-    
-    /* Calculate gain reduction */
-    float gain_db = Compressor_CalculateGain(channel, envelope_db);
-    
-    /* Apply makeup gain */
-    gain_db += params->makeupGain_db;
-    
-    /* Smooth gain changes to avoid artifacts */
-    compressorState[channel].prevGainDb = compressorState[channel].prevGainDb * COMP_GAIN_SMOOTHING_COEF + 
-                                          gain_db * (1.0f - COMP_GAIN_SMOOTHING_COEF);
-    
-    /* Convert back to linear gain */
-    float gain = DB_TO_LINEAR(compressorState[channel].prevGainDb);
-    compressorState[channel].currentGain = gain;
-    
-    /* Apply gain to the sample */
-    audioBuffer->data[channel][i] = sample * gain;
+
+  compressorConfig.channels[channelIndex].attackTime =
+    Compressor_Clamp(attackMs, COMP_MIN_ATTACK_MS, COMP_MAX_ATTACK_MS);
+  return Compressor_ApplyChannel(channelIndex);
+}
+
+/**
+  * @brief  Set compressor release time
+  * @param  channelIndex: Output channel index
+  * @param  releaseMs: Release time in milliseconds (10 to 1000)
+  * @retval HAL status
+  */
+HAL_StatusTypeDef DSP_Compressor_SetRelease(uint8_t channelIndex, float releaseMs)
+{
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  /* Store statistics for metering and monitoring */
-  compressorState[channel].stats.gainReduction_db = -compressorState[channel].prevGainDb + params->makeupGain_db;
-  compressorState[channel].stats.inputLevel_db = LINEAR_TO_DB(compressorState[channel].rmsValue);
-  compressorState[channel].stats.outputLevel_db = compressorState[channel].stats.inputLevel_db - 
-                                                 compressorState[channel].stats.gainReduction_db;
+
+  compressorConfig.channels[channelIndex].releaseTime =
+    Compressor_Clamp(releaseMs, COMP_MIN_RELEASE_MS, COMP_MAX_RELEASE_MS);
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Calculate RMS value of audio samples using a moving window
-  * @param  channel: Channel index
-  * @param  sample: New sample to add to the RMS calculation
-  * @retval RMS value
+  * @brief  Set compressor makeup gain
+  * @param  channelIndex: Output channel index
+  * @param  gainDb: Makeup gain in dB (0 to 24)
+  * @retval HAL status
   */
-static float Compressor_CalculateRMS(uint8_t channel, float sample)
+HAL_StatusTypeDef DSP_Compressor_SetMakeupGain(uint8_t channelIndex, float gainDb)
 {
-  /* Replace oldest sample with new sample */
-  rmsBuffer[channel][rmsBufferIndex[channel]] = sample * sample;
-  
-  /* Update index */
-  rmsBufferIndex[channel] = (rmsBufferIndex[channel] + 1) % COMP_RMS_WINDOW_SIZE;
-  
-  /* Calculate sum of squares */
-  float sum = 0.0f;
-  for (uint16_t i = 0; i < COMP_RMS_WINDOW_SIZE; i++) {
-    sum += rmsBuffer[channel][i];
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  /* Calculate RMS */
-  float rms = sqrtf(sum / COMP_RMS_WINDOW_SIZE);
-  
-  /* Store for statistics */
-  compressorState[channel].rmsValue = rms;
-  
-  return rms;
+
+  compressorConfig.channels[channelIndex].makeupGain =
+    Compressor_Clamp(gainDb, COMP_MIN_MAKEUP_DB, COMP_MAX_MAKEUP_DB);
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Calculate envelope with attack and release time
-  * @param  channel: Channel index
-  * @param  level_db: Current signal level in dB
-  * @retval Envelope value in dB
+  * @brief  Set compressor knee type
+  * @param  channelIndex: Output channel index
+  * @param  kneeType: COMP_KNEE_HARD or COMP_KNEE_SOFT
+  * @retval HAL status
   */
-static float Compressor_CalculateEnvelope(uint8_t channel, float level_db)
+HAL_StatusTypeDef DSP_Compressor_SetKneeType(uint8_t channelIndex, Compressor_KneeType_t kneeType)
 {
-  float envelope_db = compressorState[channel].envelope_db;
-  
-  /* Apply attack or release based on whether level is above envelope */
-  if (level_db > envelope_db) {
-    /* Attack phase */
-    envelope_db = compressorState[channel].attackCoeff * envelope_db + 
-                  (1.0f - compressorState[channel].attackCoeff) * level_db;
-  } else {
-    /* Release phase */
-    envelope_db = compressorState[channel].releaseCoeff * envelope_db + 
-                  (1.0f - compressorState[channel].releaseCoeff) * level_db;
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS || kneeType >= COMP_KNEE_MAX) {
+    return HAL_ERROR;
   }
-  
-  /* Update state */
-  compressorState[channel].envelope_db = envelope_db;
-  
-  return envelope_db;
+
+  compressorConfig.channels[channelIndex].kneeType = kneeType;
+  compressorConfig.channels[channelIndex].kneeWidth =
+    (kneeType == COMP_KNEE_SOFT) ? COMP_SOFT_KNEE_DB : 0.0f;
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Calculate gain based on envelope and compressor parameters
-  * @param  channel: Channel index
-  * @param  envelope_db: Signal envelope in dB
-  * @retval Gain in dB
+  * @brief  Set compressor detection mode
+  * @param  channelIndex: Output channel index
+  * @param  detectionMode: COMP_DETECTION_RMS or COMP_DETECTION_PEAK
+  * @retval HAL status
   */
-static float Compressor_CalculateGain(uint8_t channel, float envelope_db)
+HAL_StatusTypeDef DSP_Compressor_SetDetectionMode(uint8_t channelIndex, Compressor_DetectionMode_t detectionMode)
 {
-  CompressorParameters_TypeDef *params = &compressorState[channel].params;
-  float threshold_db = params->threshold_db;
-  float gain_db = 0.0f;  /* No gain reduction by default */
-  
-  /* Determine if signal is above threshold */
-  if (params->useSoftKnee) {
-    /* Soft knee implementation */
-    gain_db = Compressor_ApplySoftKnee(params, envelope_db);
-  } else {
-    /* Hard knee (standard) implementation */
-    if (envelope_db > threshold_db) {
-      /* Calculate gain reduction */
-      float excess_db = envelope_db - threshold_db;
-      gain_db = excess_db - (excess_db / params->ratio);
-      
-      /* Apply gain (negative value for reduction) */
-      gain_db = -gain_db;
-    }
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS || detectionMode >= COMP_DETECTION_MAX) {
+    return HAL_ERROR;
   }
-  
-  /* Limit gain reduction */
-  gain_db = CLAMP(gain_db, COMP_MIN_GAIN_DB, COMP_MAX_GAIN_DB);
-  
-  return gain_db;
+
+  compressorConfig.channels[channelIndex].detectionMode = detectionMode;
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Apply soft knee to compressor curve
-  * @param  params: Compressor parameters
-  * @param  input_db: Input level in dB
-  * @retval Output gain in dB
+  * @brief  Get current compressor configuration of a channel
+  * @param  channelIndex: Output channel index
+  * @param  threshold: Threshold level in dB
+  * @param  ratio: Compression ratio
+  * @param  attackMs: Attack time in milliseconds
+  * @param  releaseMs: Release time in milliseconds
+  * @param  makeupGain: Makeup gain in dB
+  * @param  kneeType: Knee type
+  * @param  detectionMode: Detection mode
+  * @retval HAL status
   */
-static float Compressor_ApplySoftKnee(CompressorParameters_TypeDef *params, float input_db)
+HAL_StatusTypeDef DSP_Compressor_GetConfig(uint8_t channelIndex, float* threshold,
+                                           float* ratio, float* attackMs,
+                                           float* releaseMs, float* makeupGain,
+                                           Compressor_KneeType_t* kneeType,
+                                           Compressor_DetectionMode_t* detectionMode)
 {
-  float threshold_db = params->threshold_db;
-  float knee_width = params->kneeWidth_db;
-  float knee_lower = threshold_db - (knee_width / 2.0f);
-  float knee_upper = threshold_db + (knee_width / 2.0f);
-  float gain_db = 0.0f;
-  
-  if (input_db < knee_lower) {
-    /* Below knee - no compression */
-    gain_db = 0.0f;
-  } else if (input_db > knee_upper) {
-    /* Above knee - full compression based on ratio */
-    float excess_db = input_db - threshold_db;
-    gain_db = excess_db - (excess_db / params->ratio);
-    gain_db = -gain_db;  /* Convert to gain reduction (negative) */
-  } else {
-    /* Within knee - gradual transition */
-    float knee_position = (input_db - knee_lower) / knee_width;  /* 0 to 1 */
-    float transition_ratio = 1.0f + ((params->ratio - 1.0f) * knee_position);
-    float excess_db = input_db - knee_lower;
-    gain_db = excess_db - (excess_db / transition_ratio);
-    gain_db = -gain_db;  /* Convert to gain reduction (negative) */
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  return gain_db;
+
+  const Compressor_Channel_t *channel = &compressorConfig.channels[channelIndex];
+
+  if (threshold != NULL) *threshold = channel->threshold;
+  if (ratio != NULL) *ratio = channel->ratio;
+  if (attackMs != NULL) *attackMs = channel->attackTime;
+  if (releaseMs != NULL) *releaseMs = channel->releaseTime;
+  if (makeupGain != NULL) *makeupGain = channel->makeupGain;
+  if (kneeType != NULL) *kneeType = channel->kneeType;
+  if (detectionMode != NULL) *detectionMode = channel->detectionMode;
+
+  return HAL_OK;
 }
 
 /**
-  * @brief  Get compressor statistics for metering
-  * @param  channel: Channel index
-  * @param  stats: Pointer to store statistics
-  * @retval None
+  * @brief  Get current gain reduction of a channel
+  * @param  channelIndex: Output channel index
+  * @retval Gain reduction in dB (negative value)
+  */
+float DSP_Compressor_GetGainReduction(uint8_t channelIndex)
+{
+  return Dynamics_GetGainReduction(channelIndex);
+}
+
+/**
+  * @brief  Reset compressor of a channel to default settings
+  * @param  channelIndex: Output channel index
+  * @retval HAL status
   */
-void Compressor_GetStatistics(uint8_t channel, CompressorStatistics_TypeDef *stats)
+HAL_StatusTypeDef DSP_Compressor_Reset(uint8_t channelIndex)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS || stats == NULL) {
-    return;
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
   }
-  
-  /* Copy statistics */
-  memcpy(stats, &compressorState[channel].stats, sizeof(CompressorStatistics_TypeDef));
+
+  Compressor_LoadDefaults(&compressorConfig.channels[channelIndex],
+                          compressorConfig.channels[channelIndex].sampleRate);
+  Dynamics_ResetChannel(channelIndex);
+
+  DEBUG_PRINT("Compressor channel %d reset\r\n", channelIndex);
+  return Compressor_ApplyChannel(channelIndex);
 }
 
 /**
-  * @brief  Reset compressor state for all channels
-  * @param  None
-  * @retval None
+  * @brief  Update sample rate and recalculate time constants
+  * @param  sampleRate: New sample rate in Hz
+  * @retval HAL status
   */
-void Compressor_Reset(void)
+HAL_StatusTypeDef DSP_Compressor_UpdateSampleRate(float sampleRate)
 {
   for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
-    /* Reset envelope and gain */
-    compressorState[channel].envelope_db = COMP_ENVELOPE_INIT;
-    compressorState[channel].currentGain = 1.0f;
-    compressorState[channel].prevGainDb = 0.0f;
-    compressorState[channel].rmsValue = 0.0f;
-    
-    /* Clear RMS buffer */
-    memset(rmsBuffer[channel], 0, sizeof(float) * COMP_RMS_WINDOW_SIZE);
-    rmsBufferIndex[channel] = 0;
-    
-    /* Reset statistics */
-    memset(&compressorState[channel].stats, 0, sizeof(CompressorStatistics_TypeDef));
+    compressorConfig.channels[channel].sampleRate = sampleRate;
   }
-  
-  DEBUG_PRINT("Compressor states reset\r\n");
+
+  return Dynamics_SetSampleRate(sampleRate);
 }
 
 /**
-  * @brief  Reset compressor state for a specific channel
-  * @param  channel: Channel index
-  * @retval None
+  * @brief  Get configuration of all channels
+  * @retval Pointer to the compressor configuration
   */
-void Compressor_ResetChannel(uint8_t channel)
+const Compressor_Config_t* DSP_Compressor_GetAllConfig(void)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS) {
-    return;
+  /* Refresh metering fields before handing out the snapshot */
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    compressorConfig.channels[channel].gainReduction = Dynamics_GetGainReduction(channel);
   }
-  
-  /* Reset envelope and gain */
-  compressorState[channel].envelope_db = COMP_ENVELOPE_INIT;
-  compressorState[channel].currentGain = 1.0f;
-  compressorState[channel].prevGainDb = 0.0f;
-  compressorState[channel].rmsValue = 0.0f;
-  
-  /* Clear RMS buffer */
-  memset(rmsBuffer[channel], 0, sizeof(float) * COMP_RMS_WINDOW_SIZE);
-  rmsBufferIndex[channel] = 0;
-  
-  /* Reset statistics */
-  memset(&compressorState[channel].stats, 0, sizeof(CompressorStatistics_TypeDef));
-  
-  DEBUG_PRINT("Compressor channel %d reset\r\n", channel);
+
+  return &compressorConfig;
 }
 
 /**
-  * @brief  Get real-time compression factor for metering
-  * @param  channel: Channel index
-  * @retval Compression factor (0.0 to 1.0, where 1.0 is max compression)
+  * @brief  Set configuration of all channels from a saved preset
+  * @param  config: Pointer to configuration with preset values
+  * @retval HAL status
   */
-float Compressor_GetCompressionFactor(uint8_t channel)
+HAL_StatusTypeDef DSP_Compressor_SetAllConfig(const Compressor_Config_t* config)
 {
-  if (channel >= AUDIO_OUTPUT_CHANNELS || !compressorState[channel].params.enabled) {
-    return 0.0f;
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (config == NULL) {
+    return HAL_ERROR;
   }
-  
-  /* Convert gain reduction from dB to linear scale 0-1 */
-  float reduction_db = compressorState[channel].stats.gainReduction_db;
-  
-  /* Map typical range (0-20dB) to 0-1 for display */
-  float factor = reduction_db / 20.0f;
-  factor = CLAMP(factor, 0.0f, 1.0f);
-  
-  return factor;
+
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    const Compressor_Channel_t *src = &config->channels[channel];
+    Compressor_Channel_t *dst = &compressorConfig.channels[channel];
+
+    dst->threshold = Compressor_Clamp(src->threshold, COMP_MIN_THRESHOLD_DB, COMP_MAX_THRESHOLD_DB);
+    dst->ratio = Compressor_Clamp(src->ratio, COMP_MIN_RATIO, COMP_MAX_RATIO);
+    dst->attackTime = Compressor_Clamp(src->attackTime, COMP_MIN_ATTACK_MS, COMP_MAX_ATTACK_MS);
+    dst->releaseTime = Compressor_Clamp(src->releaseTime, COMP_MIN_RELEASE_MS, COMP_MAX_RELEASE_MS);
+    dst->makeupGain = Compressor_Clamp(src->makeupGain, COMP_MIN_MAKEUP_DB, COMP_MAX_MAKEUP_DB);
+    dst->kneeType = (src->kneeType < COMP_KNEE_MAX) ? src->kneeType : COMP_KNEE_SOFT;
+    dst->kneeWidth = (dst->kneeType == COMP_KNEE_SOFT) ? COMP_SOFT_KNEE_DB : 0.0f;
+    dst->detectionMode = (src->detectionMode < COMP_DETECTION_MAX) ? src->detectionMode : COMP_DETECTION_RMS;
+    dst->enabled = src->enabled ? 1 : 0;
+
+    if (Compressor_ApplyChannel(channel) != HAL_OK) {
+      status = HAL_ERROR;
+    }
+  }
+
+  return status;
 }
 
 /**
-  * @brief  This function is called by DSP_Compressor_Process in audio_processing.c
-  * @param  channel: Channel index
-  * @param  audioBuffer: Pointer to audio buffer
+  * @brief  Push the configuration of a channel into the dynamics engine
+  * @note   A compressor is the engine curve with the lower (expansion)
+  *         segment switched off
+  * @param  channelIndex: Output channel index
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Compressor_ApplyChannel(uint8_t channelIndex)
+{
+  const Compressor_Channel_t *channel = &compressorConfig.channels[channelIndex];
+  Dynamics_Params_TypeDef params;
+
+  Dynamics_GetPreset(DYNAMICS_MODE_COMPRESSOR, &params);
+  params.upperThresholdDb = channel->threshold;
+  params.upperRatio = channel->ratio;
+  params.kneeWidthDb = channel->kneeWidth;
+  params.makeupGainDb = channel->makeupGain;
+  params.attackMs = channel->attackTime;
+  params.releaseMs = channel->releaseTime;
+  params.detector = (channel->detectionMode == COMP_DETECTION_PEAK) ?
+                    DYNAMICS_DETECT_PEAK : DYNAMICS_DETECT_RMS;
+  params.enabled = channel->enabled;
+
+  return Dynamics_SetParams(channelIndex, &params);
+}
+
+/**
+  * @brief  Fill a channel configuration with defaults (disabled)
+  * @param  channel: Pointer to channel configuration
+  * @param  sampleRate: Audio sample rate
   * @retval None
   */
-void DSP_Compressor_ProcessChannel(uint8_t channel, AudioBuffer_TypeDef *audioBuffer)
+static void Compressor_LoadDefaults(Compressor_Channel_t *channel, float sampleRate)
 {
-  /* Call the main process function */
-  Compressor_Process(channel, audioBuffer);
-}
\ No newline at end of file
+  memset(channel, 0, sizeof(Compressor_Channel_t));
+
+  channel->threshold = -20.0f;
+  channel->ratio = 4.0f;
+  channel->attackTime = 20.0f;
+  channel->releaseTime = 200.0f;
+  channel->makeupGain = 0.0f;
+  channel->kneeType = COMP_KNEE_SOFT;
+  channel->kneeWidth = COMP_SOFT_KNEE_DB;
+  channel->detectionMode = COMP_DETECTION_RMS;
+  channel->sampleRate = sampleRate;
+  channel->enabled = 0;
+}
+
+/**
+  * @brief  Limit a value to a range
+  * @param  value: Input value
+  * @param  min: Lower bound
+  * @param  max: Upper bound
+  * @retval Clamped value
+  */
+static float Compressor_Clamp(float value, float min, float max)
+{
+  if (value < min) {
+    return min;
+  }
+  if (value > max) {
+    return max;
+  }
+  return value;
+}
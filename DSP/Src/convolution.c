@@ -0,0 +1,570 @@
+/**
+  ******************************************************************************
+  * @file           : convolution.c
+  * @brief          : Zero-latency partitioned FIR convolution
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Partition layout for a frame of B samples:
+  *   head      taps [0, B)            direct form, every frame
+  *   level k   taps [2S - B, 4S - B)  two partitions of S = B * 2^k
+  *             (up to five when that covers the remaining taps)
+  *   top level taps [2S - B, length)  all remaining partitions of S = 512
+  *
+  * A level starts a job each S samples on the last 2S input samples
+  * (overlap-save, FFT size 2S) and has S/B frames to finish it. The job is a
+  * fixed list of work units (bit reversal, each FFT pass, the real split,
+  * one complex MAC per partition, the inverse steps, output copy) handed out
+  * evenly over those frames. The result is played during the following
+  * period, which is exactly what the 2S - B start offset of the level allows.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "convolution.h"
+#include "dsp_fft.h"
+#include "mem_plan.h"
+#include "cpu_budget.h"
+#include "debug.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CONV_LEVEL_MAX_TAIL         5U      /* Partitions a level may hold before the next opens */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  One partition size level; offsets are relative to the channel base
+  */
+typedef struct {
+  uint32_t hOffset;             /* Partition spectra, parts * 2S floats */
+  uint32_t fdlOffset;           /* Input spectra (frequency-domain delay line) */
+  uint32_t accOffset;           /* Spectrum accumulator / inverse FFT buffer, 2S */
+  uint32_t outOffset;           /* Finished output block, S */
+  uint16_t size;                /* Partition size S */
+  uint16_t parts;               /* Partitions in this level */
+  uint16_t frames;              /* Frames per job period, S / B */
+  uint16_t units;               /* Work units per job */
+  uint16_t frame;               /* Frame index within the current period */
+  uint16_t fdlHead;             /* FDL slot of the newest input spectrum */
+  uint8_t passes;               /* Complex FFT passes */
+  uint8_t outputValid;          /* out holds a finished block */
+} ConvLevel_TypeDef;
+
+/**
+  * @brief  Convolution state of one output
+  */
+typedef struct {
+  float head[CONV_BLOCK_SIZE];
+  ConvLevel_TypeDef level[CONV_MAX_LEVELS];
+  uint32_t base;                /* Region start in the pool */
+  uint32_t floats;              /* Region size */
+  uint32_t ringMask;            /* Input history size - 1 (ring at region start) */
+  uint32_t ringPos;             /* Next write position in the input history */
+  uint32_t length;              /* Taps */
+  uint8_t numLevels;
+  Convolution_State_TypeDef state;
+} ConvChannel_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static float *convPool;                 /* Overlay in the memory plan, FIR mode */
+static uint32_t convPoolUsed = 0;
+static ConvChannel_TypeDef convChannels[AUDIO_OUTPUT_CHANNELS];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Convolution_Plan(ConvChannel_TypeDef *conv, uint32_t length);
+static void Convolution_Release(uint8_t channel);
+static void Convolution_RunUnit(ConvChannel_TypeDef *conv, ConvLevel_TypeDef *lvl, uint16_t unit);
+static void Convolution_CopyHistory(const ConvChannel_TypeDef *conv, float *dst, uint32_t count);
+
+/**
+  * @brief  Initialize convolution, all outputs pass-through
+  * @retval None
+  */
+void Convolution_Init(void)
+{
+  DSP_FFT_Init();
+
+  memset(convChannels, 0, sizeof(convChannels));
+  convPool = (float *)MemPlan_GetBuffer(MEM_BUF_CONV_POOL);
+  convPoolUsed = 0;
+
+  DEBUG_PRINT("Convolution initialized, pool %lu floats\r\n", (unsigned long)CONV_POOL_FLOATS);
+}
+
+/**
+  * @brief  Reserve memory for a new filter and start loading taps
+  * @note   The output passes audio through unchanged until Convolution_Commit();
+  *         if the pool cannot hold the filter the previous one stays active
+  * @param  channel: Output channel (0-3)
+  * @param  length: Number of taps (1 to CONV_MAX_TAPS)
+  * @retval HAL status, HAL_ERROR if the pool cannot hold the filter,
+  *         HAL_BUSY while a measurement holds the memory
+  */
+HAL_StatusTypeDef Convolution_BeginLoad(uint8_t channel, uint32_t length)
+{
+  ConvChannel_TypeDef plan;
+  uint32_t floats;
+  uint32_t available;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || length == 0U || length > CONV_MAX_TAPS) {
+    DEBUG_PRINT("Convolution_BeginLoad: Invalid channel %d or length %lu\r\n",
+                channel, (unsigned long)length);
+    return HAL_ERROR;
+  }
+
+  /* The pool shares its RAM with the analyzer capture */
+  if (MemPlan_Enter(MEM_MODE_FIR) != HAL_OK) {
+    return HAL_BUSY;
+  }
+
+  /* The old filter keeps playing unless the new one is sure to fit in its place */
+  memset(&plan, 0, sizeof(plan));
+  floats = Convolution_Plan(&plan, length);
+  available = CONV_POOL_FLOATS - convPoolUsed;
+  if (convChannels[channel].state != CONV_STATE_OFF) {
+    available += convChannels[channel].floats;
+  }
+  if (floats > available) {
+    DEBUG_PRINT("Convolution_BeginLoad: %lu taps need %lu floats, %lu free\r\n",
+                (unsigned long)length, (unsigned long)floats, (unsigned long)available);
+    return HAL_ERROR;
+  }
+
+  Convolution_Release(channel);
+
+  plan.base = convPoolUsed;
+  plan.floats = floats;
+  plan.state = CONV_STATE_LOADING;
+  convPoolUsed += floats;
+
+  memset(&convPool[plan.base], 0, floats * sizeof(float));
+  convChannels[channel] = plan;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Write a chunk of taps
+  * @param  channel: Output channel (0-3)
+  * @param  offset: Index of the first tap in the chunk
+  * @param  taps: Tap values
+  * @param  count: Number of taps in the chunk
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Convolution_LoadTaps(uint8_t channel, uint32_t offset, const float *taps, uint32_t count)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || taps == NULL) {
+    return HAL_ERROR;
+  }
+
+  ConvChannel_TypeDef *conv = &convChannels[channel];
+
+  if (conv->state != CONV_STATE_LOADING || offset + count > conv->length) {
+    DEBUG_PRINT("Convolution_LoadTaps: Chunk %lu+%lu rejected\r\n",
+                (unsigned long)offset, (unsigned long)count);
+    return HAL_ERROR;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t tap = offset + i;
+
+    if (tap < CONV_BLOCK_SIZE) {
+      conv->head[tap] = taps[i];
+      continue;
+    }
+
+    /* Time-domain taps go to the first half of their partition slot */
+    for (uint8_t l = 0; l < conv->numLevels; l++) {
+      const ConvLevel_TypeDef *lvl = &conv->level[l];
+      uint32_t start = 2U * lvl->size - CONV_BLOCK_SIZE;
+      uint32_t rel = tap - start;
+
+      if (tap >= start && rel < (uint32_t)lvl->parts * lvl->size) {
+        uint32_t part = rel / lvl->size;
+        convPool[conv->base + lvl->hOffset + part * 2U * lvl->size + rel % lvl->size] = taps[i];
+        break;
+      }
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Transform loaded partitions and start convolving
+  * @note   A filter the frame budget cannot carry stays loaded but inactive
+  * @param  channel: Output channel (0-3)
+  * @retval HAL status, HAL_BUSY if the CPU budget refused the filter
+  */
+HAL_StatusTypeDef Convolution_Commit(uint8_t channel)
+{
+  CpuBudget_Load_TypeDef load = { 1U, 0U, 0U, 0U };
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || convChannels[channel].state != CONV_STATE_LOADING) {
+    return HAL_ERROR;
+  }
+
+  ConvChannel_TypeDef *conv = &convChannels[channel];
+
+  /* Each level costs a pair of FFTs per period, each partition one complex MAC */
+  load.units = conv->numLevels;
+  for (uint8_t l = 0; l < conv->numLevels; l++) {
+    load.parts += conv->level[l].parts;
+  }
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_FIR, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+
+  for (uint8_t l = 0; l < conv->numLevels; l++) {
+    ConvLevel_TypeDef *lvl = &conv->level[l];
+    const uint32_t n = 2U * lvl->size;
+    /* Inverse FFT returns S times the result, fold 1/S into the filter */
+    const float scale = 1.0f / (float)lvl->size;
+
+    for (uint16_t p = 0; p < lvl->parts; p++) {
+      float *part = &convPool[conv->base + lvl->hOffset + p * n];
+
+      for (uint32_t i = 0; i < lvl->size; i++) {
+        part[i] *= scale;
+      }
+      DSP_FFT_RealForward(part, n);
+    }
+
+    lvl->frame = 0;
+    lvl->fdlHead = 0;
+    lvl->outputValid = 0;
+  }
+
+  conv->ringPos = 0;
+  conv->state = CONV_STATE_ACTIVE;
+
+  DEBUG_PRINT("Convolution ch%d: %lu taps in %d levels, %lu floats\r\n", channel,
+              (unsigned long)conv->length, conv->numLevels, (unsigned long)conv->floats);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Remove the filter of an output and return its memory
+  * @param  channel: Output channel (0-3)
+  * @retval None
+  */
+void Convolution_Disable(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return;
+  }
+
+  Convolution_Release(channel);
+}
+
+/**
+  * @brief  Clear the input history and pending blocks of an output
+  * @note   The filter stays loaded; output restarts as after Convolution_Commit()
+  * @param  channel: Output channel (0-3)
+  * @retval None
+  */
+void Convolution_ResetState(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || convChannels[channel].state != CONV_STATE_ACTIVE) {
+    return;
+  }
+
+  ConvChannel_TypeDef *conv = &convChannels[channel];
+
+  memset(&convPool[conv->base], 0, (conv->ringMask + 1U) * sizeof(float));
+
+  for (uint8_t l = 0; l < conv->numLevels; l++) {
+    ConvLevel_TypeDef *lvl = &conv->level[l];
+
+    /* FDL, accumulator and output block follow the partitions back to back */
+    memset(&convPool[conv->base + lvl->fdlOffset], 0,
+           (lvl->outOffset + lvl->size - lvl->fdlOffset) * sizeof(float));
+    lvl->frame = 0;
+    lvl->fdlHead = 0;
+    lvl->outputValid = 0;
+  }
+
+  conv->ringPos = 0;
+}
+
+/**
+  * @brief  Get convolution state of an output
+  * @param  channel: Output channel (0-3)
+  * @retval State
+  */
+Convolution_State_TypeDef Convolution_GetState(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return CONV_STATE_OFF;
+  }
+
+  return convChannels[channel].state;
+}
+
+/**
+  * @brief  Get filter length of an output
+  * @param  channel: Output channel (0-3)
+  * @retval Number of taps, 0 if off
+  */
+uint32_t Convolution_GetLength(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return 0;
+  }
+
+  return convChannels[channel].length;
+}
+
+/**
+  * @brief  Pool memory a filter of a given length would take
+  * @param  length: Number of taps
+  * @retval Floats needed
+  */
+uint32_t Convolution_GetRequiredFloats(uint32_t length)
+{
+  ConvChannel_TypeDef plan;
+
+  if (length == 0U || length > CONV_MAX_TAPS) {
+    return 0;
+  }
+
+  memset(&plan, 0, sizeof(plan));
+  return Convolution_Plan(&plan, length);
+}
+
+/**
+  * @brief  Get unused pool memory
+  * @retval Free floats
+  */
+uint32_t Convolution_GetPoolFree(void)
+{
+  return CONV_POOL_FLOATS - convPoolUsed;
+}
+
+/**
+  * @brief  Convolve one frame in place
+  * @param  channel: Output channel (0-3)
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples, must be CONV_BLOCK_SIZE
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Convolution_Process(uint8_t channel, float *data, uint32_t blockSize)
+{
+  float out[CONV_BLOCK_SIZE];
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || data == NULL) {
+    return HAL_ERROR;
+  }
+
+  ConvChannel_TypeDef *conv = &convChannels[channel];
+
+  if (conv->state != CONV_STATE_ACTIVE) {
+    return HAL_OK;
+  }
+  if (blockSize != CONV_BLOCK_SIZE) {
+    return HAL_ERROR;
+  }
+
+  float *ring = &convPool[conv->base];
+  const uint32_t mask = conv->ringMask;
+
+  /* Append the frame to the input history */
+  for (uint32_t i = 0; i < CONV_BLOCK_SIZE; i++) {
+    ring[(conv->ringPos + i) & mask] = data[i];
+  }
+
+  /* Head, direct form over the first frame of taps */
+  for (uint32_t i = 0; i < CONV_BLOCK_SIZE; i++) {
+    const uint32_t newest = conv->ringPos + i;
+    float acc = 0.0f;
+
+    for (uint32_t k = 0; k < CONV_BLOCK_SIZE; k++) {
+      acc += conv->head[k] * ring[(newest - k) & mask];
+    }
+    out[i] = acc;
+  }
+  conv->ringPos = (conv->ringPos + CONV_BLOCK_SIZE) & mask;
+
+  /* Partition levels: play the previous job, advance the current one */
+  for (uint8_t l = 0; l < conv->numLevels; l++) {
+    ConvLevel_TypeDef *lvl = &conv->level[l];
+    const uint16_t frame = lvl->frame;
+
+    if (lvl->outputValid) {
+      const float *blk = &convPool[conv->base + lvl->outOffset + (uint32_t)frame * CONV_BLOCK_SIZE];
+      for (uint32_t i = 0; i < CONV_BLOCK_SIZE; i++) {
+        out[i] += blk[i];
+      }
+    }
+
+    /* Units [U*f/F, U*(f+1)/F) of this period */
+    const uint16_t first = (uint16_t)(((uint32_t)lvl->units * frame) / lvl->frames);
+    const uint16_t last = (uint16_t)(((uint32_t)lvl->units * (frame + 1U)) / lvl->frames);
+    for (uint16_t u = first; u < last; u++) {
+      Convolution_RunUnit(conv, lvl, u);
+    }
+
+    lvl->frame = (uint16_t)((frame + 1U == lvl->frames) ? 0U : frame + 1U);
+  }
+
+  memcpy(data, out, sizeof(out));
+  return HAL_OK;
+}
+
+/**
+  * @brief  Split a filter length into levels and lay out its memory
+  * @param  conv: Channel to fill (offsets relative to its base)
+  * @param  length: Number of taps
+  * @retval Floats needed
+  */
+static uint32_t Convolution_Plan(ConvChannel_TypeDef *conv, uint32_t length)
+{
+  uint32_t size = CONV_BLOCK_SIZE;
+  uint32_t ring = 2U * CONV_BLOCK_SIZE;
+  uint32_t covered = CONV_BLOCK_SIZE;
+  uint32_t offset;
+  uint8_t count = 0;
+
+  /* Levels first, the input history size depends on the largest one */
+  while (count < CONV_MAX_LEVELS && covered < length) {
+    ConvLevel_TypeDef *lvl = &conv->level[count];
+    uint32_t start = 2U * size - CONV_BLOCK_SIZE;
+    uint32_t parts = (length - start + size - 1U) / size;
+
+    /* Two partitions per size; a short remainder stays at this size since
+       a level of the next size costs more memory than three extra partitions */
+    if (parts > CONV_LEVEL_MAX_TAIL && size < CONV_MAX_PARTITION) {
+      parts = 2U;
+    }
+    covered = start + parts * size;
+
+    lvl->size = (uint16_t)size;
+    lvl->parts = (uint16_t)parts;
+    lvl->frames = (uint16_t)(size / CONV_BLOCK_SIZE);
+    lvl->passes = DSP_FFT_NumPasses(2U * size);
+    /* Bit reversal, passes, split, MACs, merge + bit reversal, passes, copy */
+    lvl->units = (uint16_t)(2U * lvl->passes + parts + 4U);
+
+    ring = 2U * size;
+    size *= 2U;
+    count++;
+  }
+
+  conv->numLevels = count;
+  conv->length = length;
+  conv->ringMask = ring - 1U;
+
+  offset = ring;
+  for (uint8_t l = 0; l < count; l++) {
+    ConvLevel_TypeDef *lvl = &conv->level[l];
+    const uint32_t n = 2U * lvl->size;
+
+    lvl->hOffset = offset;
+    offset += n * lvl->parts;
+    lvl->fdlOffset = offset;
+    offset += n * lvl->parts;
+    lvl->accOffset = offset;
+    offset += n;
+    lvl->outOffset = offset;
+    offset += lvl->size;
+  }
+
+  return offset;
+}
+
+/**
+  * @brief  Free the pool region of a channel and compact the pool
+  * @note   Runs in the same context as Convolution_Process()
+  * @param  channel: Output channel (0-3)
+  * @retval None
+  */
+static void Convolution_Release(uint8_t channel)
+{
+  static const CpuBudget_Load_TypeDef idle = { 0U, 0U, 0U, 0U };
+  ConvChannel_TypeDef *conv = &convChannels[channel];
+  const uint32_t base = conv->base;
+  const uint32_t floats = conv->floats;
+
+  if (conv->state != CONV_STATE_OFF && floats > 0U) {
+    memmove(&convPool[base], &convPool[base + floats],
+            (convPoolUsed - base - floats) * sizeof(float));
+    convPoolUsed -= floats;
+
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+      if (convChannels[ch].state != CONV_STATE_OFF && convChannels[ch].base > base) {
+        convChannels[ch].base -= floats;
+      }
+    }
+  }
+
+  memset(conv, 0, sizeof(ConvChannel_TypeDef));
+  CpuBudget_SetLoad(CPUBUDGET_STAGE_FIR, channel, &idle);
+}
+
+/**
+  * @brief  Execute one work unit of a level job
+  * @param  conv: Channel
+  * @param  lvl: Level
+  * @param  unit: Unit index, 0 to lvl->units - 1
+  * @retval None
+  */
+static void Convolution_RunUnit(ConvChannel_TypeDef *conv, ConvLevel_TypeDef *lvl, uint16_t unit)
+{
+  const uint32_t n = 2U * lvl->size;
+  const uint16_t passes = lvl->passes;
+  const uint16_t parts = lvl->parts;
+  float *fdl = &convPool[conv->base + lvl->fdlOffset];
+  float *acc = &convPool[conv->base + lvl->accOffset];
+
+  if (unit == 0U) {
+    /* New job: last 2S input samples into the next FDL slot */
+    lvl->fdlHead = (uint16_t)((lvl->fdlHead + 1U == parts) ? 0U : lvl->fdlHead + 1U);
+    float *slot = &fdl[(uint32_t)lvl->fdlHead * n];
+    Convolution_CopyHistory(conv, slot, n);
+    DSP_FFT_BitReverse(slot, n);
+  } else if (unit <= passes) {
+    DSP_FFT_Pass(&fdl[(uint32_t)lvl->fdlHead * n], n, (uint8_t)(unit - 1U), DSP_FFT_FORWARD);
+  } else if (unit == passes + 1U) {
+    DSP_FFT_RealSplit(&fdl[(uint32_t)lvl->fdlHead * n], n);
+  } else if (unit < passes + 2U + parts) {
+    /* Partition p pairs with the input spectrum from p periods ago */
+    uint16_t p = (uint16_t)(unit - passes - 2U);
+    uint16_t slot = (uint16_t)((lvl->fdlHead + parts - p) % parts);
+
+    if (p == 0U) {
+      memset(acc, 0, n * sizeof(float));
+    }
+    DSP_FFT_MultiplyAccumulate(acc, &fdl[(uint32_t)slot * n],
+                               &convPool[conv->base + lvl->hOffset + (uint32_t)p * n], n);
+  } else if (unit == passes + 2U + parts) {
+    DSP_FFT_RealMerge(acc, n);
+    DSP_FFT_BitReverse(acc, n);
+  } else if (unit < 2U * passes + 3U + parts) {
+    DSP_FFT_Pass(acc, n, (uint8_t)(unit - passes - 3U - parts), DSP_FFT_INVERSE);
+  } else {
+    /* Overlap-save: the second half is the valid output */
+    memcpy(&convPool[conv->base + lvl->outOffset], &acc[lvl->size], lvl->size * sizeof(float));
+    lvl->outputValid = 1;
+  }
+}
+
+/**
+  * @brief  Copy the newest input samples in time order
+  * @param  conv: Channel
+  * @param  dst: Destination
+  * @param  count: Number of samples, at most the history size
+  * @retval None
+  */
+static void Convolution_CopyHistory(const ConvChannel_TypeDef *conv, float *dst, uint32_t count)
+{
+  const float *ring = &convPool[conv->base];
+  uint32_t pos = (conv->ringPos - count) & conv->ringMask;
+
+  for (uint32_t i = 0; i < count; i++) {
+    dst[i] = ring[pos];
+    pos = (pos + 1U) & conv->ringMask;
+  }
+}
@@ -0,0 +1,450 @@
+/**
+  ******************************************************************************
+  * @file           : cpu_budget.c
+  * @brief          : Per-stage CPU cost model and admission of parameter changes
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Model: cycles per frame of a stage on one output are
+  *   active + units * perUnit + parts * perPart + cost of each option,
+  * taken from the nominal table below and multiplied by the calibrated
+  * scale of the stage. The nominal values are M4F estimates for a 32
+  * sample frame; the scales absorb compiler and memory effects.
+  *
+  * Current load: before the first measurement window it is the model sum
+  * plus the nominal fixed cost. Afterwards it is the worst frame of the
+  * last window plus the predicted cost of every change admitted since.
+  * An admitted change restarts the window, so a window never mixes frames
+  * from before and after a change.
+  *
+  * Marks and admission both run in the main loop context (the pipeline is
+  * called from the main loop), so no locking is needed.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "cpu_budget.h"
+#include "debug.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CPUBUDGET_FIXED_CYCLES      9000U       /* Nominal fixed cost until measured */
+#define CPUBUDGET_MIN_MODEL_CYCLES  256U        /* Smaller stages are too noisy to calibrate */
+#define CPUBUDGET_SCALE_RATE        0.25f       /* Step of the scale toward each measurement */
+#define CPUBUDGET_SCALE_MIN         0.25f
+#define CPUBUDGET_SCALE_MAX         4.0f
+#define CPUBUDGET_OPTIONS           2U
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Nominal cycles per frame of one stage on one output
+  */
+typedef struct {
+  uint16_t active;
+  uint16_t perUnit;
+  uint16_t perPart;
+  uint16_t option[CPUBUDGET_OPTIONS];   /* Bit 0, bit 1 of CpuBudget_Load_TypeDef.options */
+} CpuBudget_Cost_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const CpuBudget_Cost_TypeDef nominalCost[CPUBUDGET_STAGE_COUNT] = {
+  /* Crossover: call and copy, 8 cycles per sample per biquad section */
+  { 64U, 256U, 0U, { 0U, 0U } },
+  /* EQ: same cascade code as the crossover */
+  { 64U, 256U, 0U, { 0U, 0U } },
+  /* FIR: direct head, forward and inverse FFT share per level, one complex MAC per partition */
+  { 1400U, 3500U, 320U, { 0U, 0U } },
+  /* Compressor: detector and fast log/exp curve; peak is the RMS path with a unit coefficient */
+  { 960U, 0U, 0U, { 0U, 0U } },
+  /* Limiter: envelope and gain; lookahead ring; 4x polyphase ISP estimate */
+  { 800U, 0U, 0U, { 200U, 1300U } },
+  /* Delay: store and linear read; cubic adds two taps and the polynomial */
+  { 400U, 0U, 0U, { 400U, 0U } },
+  /* Fixed part is measured, never modelled per output */
+  { 0U, 0U, 0U, { 0U, 0U } }
+};
+
+static const char *const stageNames[CPUBUDGET_STAGE_COUNT] = {
+  "CROSSOVER", "EQ", "FIR", "COMPRESSOR", "LIMITER", "DELAY", "FIXED"
+};
+
+static CpuBudget_Load_TypeDef loads[CPUBUDGET_STAGE_COUNT][AUDIO_OUTPUT_CHANNELS];
+static float scale[CPUBUDGET_STAGE_COUNT];
+static uint32_t frameCycles;
+static uint32_t limitCycles;
+
+/* Measurement */
+static uint32_t lastMark;
+static uint32_t frameStage[CPUBUDGET_STAGE_COUNT];
+static uint32_t windowStage[CPUBUDGET_STAGE_COUNT];
+static uint32_t windowPeak;
+static uint32_t windowFrames;
+static uint32_t stageAverage[CPUBUDGET_STAGE_COUNT];
+static uint32_t measuredCycles;
+static int32_t pendingCycles;
+static uint8_t calibrated;
+
+/* Refusals */
+static CpuBudget_Rejection_TypeDef rejection;
+static uint8_t hasRejection;
+
+/* Private function prototypes -----------------------------------------------*/
+static float CpuBudget_LoadCost(CpuBudget_Stage_TypeDef stage, const CpuBudget_Load_TypeDef *load);
+static float CpuBudget_StageCost(CpuBudget_Stage_TypeDef stage);
+static uint32_t CpuBudget_Used(void);
+static HAL_StatusTypeDef CpuBudget_Apply(CpuBudget_Stage_TypeDef stage, uint8_t channel,
+                                         const CpuBudget_Load_TypeDef *proposed);
+static void CpuBudget_RestartWindow(void);
+
+/**
+  * @brief  Reset the model to nominal costs and empty loads
+  * @note   Call after the system clock is set and before any stage
+  *         reports its load
+  * @retval None
+  */
+void CpuBudget_Init(void)
+{
+  memset(loads, 0, sizeof(loads));
+  memset(stageAverage, 0, sizeof(stageAverage));
+  for (uint8_t s = 0; s < CPUBUDGET_STAGE_COUNT; s++) {
+    scale[s] = 1.0f;
+  }
+
+  frameCycles = (SystemCoreClock / AUDIO_SAMPLE_RATE) * AUDIO_FRAME_SIZE;
+  limitCycles = (uint32_t)(((uint64_t)frameCycles * CPUBUDGET_LIMIT_PERCENT) / 100U);
+  measuredCycles = 0;
+  pendingCycles = 0;
+  calibrated = 0;
+  hasRejection = 0;
+  lastMark = DWT->CYCCNT;
+  CpuBudget_RestartWindow();
+
+  DEBUG_PRINT("CPU budget: %lu cycles per frame, admission limit %lu\r\n",
+              (unsigned long)frameCycles, (unsigned long)limitCycles);
+}
+
+/**
+  * @brief  Admit a new load of one stage on one output
+  * @note   Call before the change is applied; on HAL_OK the load is
+  *         recorded and the caller must apply the change
+  * @param  stage: Stage being changed
+  * @param  channel: Output channel (0-3)
+  * @param  load: What the stage will run on this output
+  * @retval HAL_OK if admitted, HAL_BUSY if it would overrun the frame,
+  *         HAL_ERROR on invalid arguments
+  */
+HAL_StatusTypeDef CpuBudget_Admit(CpuBudget_Stage_TypeDef stage, uint8_t channel,
+                                  const CpuBudget_Load_TypeDef *load)
+{
+  CpuBudget_Load_TypeDef proposed[AUDIO_OUTPUT_CHANNELS];
+
+  if (stage >= CPUBUDGET_STAGE_FIXED || channel >= AUDIO_OUTPUT_CHANNELS || load == NULL) {
+    return HAL_ERROR;
+  }
+
+  memcpy(proposed, loads[stage], sizeof(proposed));
+  proposed[channel] = *load;
+
+  return CpuBudget_Apply(stage, channel, proposed);
+}
+
+/**
+  * @brief  Admit new loads of one stage on all outputs at once
+  * @note   For global modes (delay interpolation) and preset loads
+  * @param  stage: Stage being changed
+  * @param  newLoads: Load per output
+  * @retval HAL_OK if admitted, HAL_BUSY if it would overrun the frame,
+  *         HAL_ERROR on invalid arguments
+  */
+HAL_StatusTypeDef CpuBudget_AdmitStage(CpuBudget_Stage_TypeDef stage,
+                                       const CpuBudget_Load_TypeDef newLoads[AUDIO_OUTPUT_CHANNELS])
+{
+  if (stage >= CPUBUDGET_STAGE_FIXED || newLoads == NULL) {
+    return HAL_ERROR;
+  }
+
+  return CpuBudget_Apply(stage, AUDIO_OUTPUT_CHANNELS, newLoads);
+}
+
+/**
+  * @brief  Record the load of a stage without a check
+  * @note   For module init and for changes that cannot be refused
+  * @param  stage: Stage
+  * @param  channel: Output channel (0-3)
+  * @param  load: What the stage runs on this output
+  * @retval None
+  */
+void CpuBudget_SetLoad(CpuBudget_Stage_TypeDef stage, uint8_t channel, const CpuBudget_Load_TypeDef *load)
+{
+  if (stage >= CPUBUDGET_STAGE_FIXED || channel >= AUDIO_OUTPUT_CHANNELS || load == NULL) {
+    return;
+  }
+
+  if (calibrated) {
+    pendingCycles += (int32_t)(CpuBudget_LoadCost(stage, load) - CpuBudget_LoadCost(stage, &loads[stage][channel]));
+    CpuBudget_RestartWindow();
+  }
+  loads[stage][channel] = *load;
+}
+
+/**
+  * @brief  Fold a finished measurement window into the model
+  * @note   Call from the main loop; does nothing until a window is full
+  * @retval None
+  */
+void CpuBudget_Update(void)
+{
+  if (windowFrames < CPUBUDGET_WINDOW_FRAMES) {
+    return;
+  }
+
+  for (uint8_t s = 0; s < CPUBUDGET_STAGE_COUNT; s++) {
+    const float model = CpuBudget_StageCost((CpuBudget_Stage_TypeDef)s) / scale[s];
+
+    stageAverage[s] = windowStage[s] / windowFrames;
+
+    if (model >= (float)CPUBUDGET_MIN_MODEL_CYCLES) {
+      float next = scale[s] + ((float)stageAverage[s] / model - scale[s]) * CPUBUDGET_SCALE_RATE;
+
+      next = (next < CPUBUDGET_SCALE_MIN) ? CPUBUDGET_SCALE_MIN : next;
+      scale[s] = (next > CPUBUDGET_SCALE_MAX) ? CPUBUDGET_SCALE_MAX : next;
+    }
+  }
+
+  measuredCycles = windowPeak;
+  pendingCycles = 0;
+  calibrated = 1;
+  CpuBudget_RestartWindow();
+}
+
+/**
+  * @brief  Get the cycles left under the admission limit
+  * @retval Cycles per frame, 0 when over the limit
+  */
+uint32_t CpuBudget_GetHeadroom(void)
+{
+  const uint32_t used = CpuBudget_Used();
+
+  return (used < limitCycles) ? (limitCycles - used) : 0U;
+}
+
+/**
+  * @brief  Get the headroom as a share of the frame
+  * @retval Percent of the frame still admissible
+  */
+uint8_t CpuBudget_GetHeadroomPercent(void)
+{
+  return (frameCycles > 0U) ? (uint8_t)(((uint64_t)CpuBudget_GetHeadroom() * 100U) / frameCycles) : 0U;
+}
+
+/**
+  * @brief  Get the budget summary
+  * @param  report: Summary
+  * @retval None
+  */
+void CpuBudget_GetReport(CpuBudget_Report_TypeDef *report)
+{
+  if (report == NULL) {
+    return;
+  }
+
+  report->frameCycles = frameCycles;
+  report->limitCycles = limitCycles;
+  report->usedCycles = CpuBudget_Used();
+  report->headroomCycles = CpuBudget_GetHeadroom();
+  memcpy(report->stageCycles, stageAverage, sizeof(report->stageCycles));
+  memcpy(report->stageScale, scale, sizeof(report->stageScale));
+  report->calibrated = calibrated;
+}
+
+/**
+  * @brief  Get the last refused change
+  * @param  result: Refusal
+  * @retval 1 if a change has been refused since init
+  */
+uint8_t CpuBudget_GetRejection(CpuBudget_Rejection_TypeDef *result)
+{
+  if (!hasRejection || result == NULL) {
+    return 0;
+  }
+
+  *result = rejection;
+  return 1;
+}
+
+/**
+  * @brief  Get the name of a stage
+  * @param  stage: CPUBUDGET_STAGE_x
+  * @retval Name string
+  */
+const char *CpuBudget_GetStageName(CpuBudget_Stage_TypeDef stage)
+{
+  return (stage < CPUBUDGET_STAGE_COUNT) ? stageNames[stage] : "?";
+}
+
+/**
+  * @brief  Start timing a processed frame
+  * @retval None
+  */
+void CpuBudget_BeginFrame(void)
+{
+  memset(frameStage, 0, sizeof(frameStage));
+  lastMark = DWT->CYCCNT;
+}
+
+/**
+  * @brief  Charge the cycles since the previous mark to a stage
+  * @note   Marks after each channel add up, so per-channel calls are fine
+  * @param  stage: Stage that just ran
+  * @retval None
+  */
+void CpuBudget_Mark(CpuBudget_Stage_TypeDef stage)
+{
+  const uint32_t now = DWT->CYCCNT;
+
+  if (stage < CPUBUDGET_STAGE_COUNT) {
+    frameStage[stage] += now - lastMark;
+  }
+  lastMark = now;
+}
+
+/**
+  * @brief  Finish a frame that ran the whole chain
+  * @note   Frames that skip the chain (analyzer, silent inputs) must not
+  *         call this, they would calibrate the stages toward zero
+  * @retval None
+  */
+void CpuBudget_EndFrame(void)
+{
+  uint32_t total = 0;
+
+  CpuBudget_Mark(CPUBUDGET_STAGE_FIXED);
+
+  if (windowFrames >= CPUBUDGET_WINDOW_FRAMES) {
+    return;
+  }
+
+  for (uint8_t s = 0; s < CPUBUDGET_STAGE_COUNT; s++) {
+    windowStage[s] += frameStage[s];
+    total += frameStage[s];
+  }
+  windowPeak = (total > windowPeak) ? total : windowPeak;
+  windowFrames++;
+}
+
+/**
+  * @brief  Modelled cost of one stage on one output
+  * @param  stage: Stage
+  * @param  load: Load of the output
+  * @retval Cycles per frame, calibrated
+  */
+static float CpuBudget_LoadCost(CpuBudget_Stage_TypeDef stage, const CpuBudget_Load_TypeDef *load)
+{
+  const CpuBudget_Cost_TypeDef *cost = &nominalCost[stage];
+  uint32_t cycles;
+
+  if (!load->active) {
+    return 0.0f;
+  }
+
+  cycles = cost->active + (uint32_t)load->units * cost->perUnit + (uint32_t)load->parts * cost->perPart;
+  for (uint8_t i = 0; i < CPUBUDGET_OPTIONS; i++) {
+    if (load->options & (1U << i)) {
+      cycles += cost->option[i];
+    }
+  }
+
+  return (float)cycles * scale[stage];
+}
+
+/**
+  * @brief  Modelled cost of one stage over all outputs
+  * @param  stage: Stage
+  * @retval Cycles per frame, calibrated
+  */
+static float CpuBudget_StageCost(CpuBudget_Stage_TypeDef stage)
+{
+  float cycles = 0.0f;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    cycles += CpuBudget_LoadCost(stage, &loads[stage][ch]);
+  }
+
+  return cycles;
+}
+
+/**
+  * @brief  Current frame cost the admission works against
+  * @retval Cycles per frame
+  */
+static uint32_t CpuBudget_Used(void)
+{
+  float model = (float)CPUBUDGET_FIXED_CYCLES;
+  int32_t used;
+
+  if (calibrated) {
+    used = (int32_t)measuredCycles + pendingCycles;
+    return (used > 0) ? (uint32_t)used : 0U;
+  }
+
+  for (uint8_t s = 0; s < CPUBUDGET_STAGE_FIXED; s++) {
+    model += CpuBudget_StageCost((CpuBudget_Stage_TypeDef)s);
+  }
+
+  return (uint32_t)model;
+}
+
+/**
+  * @brief  Check proposed loads of a stage against the budget and record them
+  * @param  stage: Stage being changed
+  * @param  channel: Changed output, AUDIO_OUTPUT_CHANNELS for all (report only)
+  * @param  proposed: Loads of all outputs after the change
+  * @retval HAL_OK if admitted, HAL_BUSY if refused
+  */
+static HAL_StatusTypeDef CpuBudget_Apply(CpuBudget_Stage_TypeDef stage, uint8_t channel,
+                                         const CpuBudget_Load_TypeDef *proposed)
+{
+  float delta = 0.0f;
+  uint32_t headroom;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    delta += CpuBudget_LoadCost(stage, &proposed[ch]) - CpuBudget_LoadCost(stage, &loads[stage][ch]);
+  }
+
+  headroom = CpuBudget_GetHeadroom();
+  if (delta > (float)headroom) {
+    rejection.tick = HAL_GetTick();
+    rejection.neededCycles = (uint32_t)delta;
+    rejection.headroomCycles = headroom;
+    rejection.stage = (uint8_t)stage;
+    rejection.channel = channel;
+    hasRejection = 1;
+
+    DEBUG_PRINT("CPU budget: %s change needs %lu cycles, %lu left, refused\r\n",
+                stageNames[stage], (unsigned long)delta, (unsigned long)headroom);
+    return HAL_BUSY;
+  }
+
+  memcpy(loads[stage], proposed, sizeof(loads[stage]));
+
+  if (calibrated && delta != 0.0f) {
+    pendingCycles += (int32_t)delta;
+    CpuBudget_RestartWindow();
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Drop the partial measurement window
+  * @retval None
+  */
+static void CpuBudget_RestartWindow(void)
+{
+  memset(windowStage, 0, sizeof(windowStage));
+  windowPeak = 0;
+  windowFrames = 0;
+}
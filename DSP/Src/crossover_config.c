@@ -21,8 +21,10 @@
 #include "linkwitz_riley.h"
 #include "bessel.h"
 #include "eeprom_driver.h"
+#include "cpu_budget.h"
 #include "math_utils.h"
 #include "debug.h"
+#include <string.h>
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -32,6 +34,9 @@
 #define MIN_CROSSOVER_FREQ            20      /* Minimum crossover frequency in Hz */
 #define MAX_CROSSOVER_FREQ            20000   /* Maximum crossover frequency in Hz */
 
+#define CROSSOVER_STEEP_RIPPLE_DB     0.5f    /* Passband ripple of the Chebyshev I/elliptic types */
+#define CROSSOVER_STEEP_STOPBAND_DB   60.0f   /* Stopband floor of the Chebyshev II/elliptic types */
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static CrossoverConfig_TypeDef crossoverConfig[AUDIO_OUTPUT_CHANNELS];
@@ -80,7 +85,10 @@ static const CrossoverConfig_TypeDef defaultCrossoverConfig[AUDIO_OUTPUT_CHANNEL
 static const char* crossoverTypeNames[] = {
     "BUT", /* Butterworth */
     "L-R", /* Linkwitz-Riley */
-    "BES"  /* Bessel */
+    "BES", /* Bessel */
+    "CH1", /* Chebyshev I */
+    "CH2", /* Chebyshev II */
+    "ELL"  /* Elliptic */
 };
 
 static const char* crossoverOrderNames[] = {
@@ -92,8 +100,30 @@ static const char* crossoverOrderNames[] = {
     "48dB"   /* 8th order */
 };
 
+/* Filter order of each slope */
+static const uint8_t crossoverOrderValues[] = {
+    1, 2, 3, 4, 6, 8
+};
+
+/* Biquad sections of one filter path for each order */
+static const uint8_t crossoverOrderSections[] = {
+    1,  /* 1st order */
+    1,  /* 2nd order */
+    2,  /* 3rd order */
+    2,  /* 4th order */
+    3,  /* 6th order */
+    4   /* 8th order */
+};
+
 /* Private function prototypes -----------------------------------------------*/
 static void Crossover_UpdateFilters(uint8_t channel);
+static HAL_StatusTypeDef Crossover_ApplyConfig(uint8_t channel, const CrossoverConfig_TypeDef* config);
+static HAL_StatusTypeDef Crossover_CommitConfig(uint8_t channel, const CrossoverConfig_TypeDef* config);
+static void Crossover_DesignSteep(uint8_t channel, const CrossoverConfig_TypeDef* config,
+                                  FilterType_t type, float freq);
+static uint8_t Crossover_UsesHighPass(const CrossoverConfig_TypeDef* config);
+static uint8_t Crossover_UsesLowPass(const CrossoverConfig_TypeDef* config);
+static void Crossover_FillCpuLoad(const CrossoverConfig_TypeDef* config, CpuBudget_Load_TypeDef* load);
 static float Crossover_ClampFrequency(float freq);
 static uint8_t Crossover_ValidateConfig(CrossoverConfig_TypeDef* config);
 
@@ -106,6 +136,8 @@ static uint8_t Crossover_ValidateConfig(CrossoverConfig_TypeDef* config);
   */
 void Crossover_Config_Init(void)
 {
+    CpuBudget_Load_TypeDef load;
+    
     /* Try to load configuration from EEPROM */
     if (EEPROM_ReadData(CROSSOVER_CONFIG_ADDR_BASE, (uint8_t*)crossoverConfig, CROSSOVER_CONFIG_SIZE) != HAL_OK) {
         DEBUG_PRINT("Failed to load crossover config from EEPROM, using defaults\r\n");
@@ -125,6 +157,9 @@ void Crossover_Config_Init(void)
         
         /* Update filters with current configuration */
         Crossover_UpdateFilters(i);
+        
+        Crossover_FillCpuLoad(&crossoverConfig[i], &load);
+        CpuBudget_SetLoad(CPUBUDGET_STAGE_CROSSOVER, i, &load);
     }
     
     DEBUG_PRINT("Crossover configuration initialized\r\n");
@@ -165,9 +200,12 @@ void Crossover_Config_Get(uint8_t channel, CrossoverConfig_TypeDef* config)
 
 /**
   * @brief  Set crossover configuration for a channel
+  * @note   Does not log: the parameter registry calls this on every morph
+  *         step and passes the status on to its caller
   * @param  channel: Channel index (0-3)
   * @param  config: Pointer to configuration structure
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_Set(uint8_t channel, CrossoverConfig_TypeDef* config)
 {
@@ -181,20 +219,8 @@ HAL_StatusTypeDef Crossover_Config_Set(uint8_t channel, CrossoverConfig_TypeDef*
         return HAL_ERROR;
     }
     
-    /* Copy configuration */
-    memcpy(&crossoverConfig[channel], config, sizeof(CrossoverConfig_TypeDef));
-    
-    /* Update filters */
-    Crossover_UpdateFilters(channel);
-    
-    DEBUG_PRINT("Crossover config updated for channel %d - HP: %.1fHz, LP: %.1fHz, Type: %s, Order: %s\r\n",
-               channel, 
-               config->highPassFreq, 
-               config->lowPassFreq,
-               crossoverTypeNames[config->filterType],
-               crossoverOrderNames[config->filterOrder]);
-    
-    return HAL_OK;
+    /* Copy configuration and update filters */
+    return Crossover_CommitConfig(channel, config);
 }
 
 /**
@@ -222,10 +248,14 @@ HAL_StatusTypeDef Crossover_Config_SetEnable(uint8_t channel, uint8_t enable)
   * @brief  Set high-pass frequency for a channel
   * @param  channel: Channel index (0-3)
   * @param  freq: High-pass frequency in Hz
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_SetHighPassFreq(uint8_t channel, float freq)
 {
+    CrossoverConfig_TypeDef next;
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS) {
         return HAL_ERROR;
     }
@@ -241,10 +271,14 @@ HAL_StatusTypeDef Crossover_Config_SetHighPassFreq(uint8_t channel, float freq)
         return HAL_ERROR;
     }
     
-    crossoverConfig[channel].highPassFreq = freq;
+    next = crossoverConfig[channel];
+    next.highPassFreq = freq;
     
     /* Update filters */
-    Crossover_UpdateFilters(channel);
+    status = Crossover_ApplyConfig(channel, &next);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d HP freq set to %.1f Hz\r\n", channel, freq);
     
@@ -255,10 +289,14 @@ HAL_StatusTypeDef Crossover_Config_SetHighPassFreq(uint8_t channel, float freq)
   * @brief  Set low-pass frequency for a channel
   * @param  channel: Channel index (0-3)
   * @param  freq: Low-pass frequency in Hz
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_SetLowPassFreq(uint8_t channel, float freq)
 {
+    CrossoverConfig_TypeDef next;
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS) {
         return HAL_ERROR;
     }
@@ -274,10 +312,14 @@ HAL_StatusTypeDef Crossover_Config_SetLowPassFreq(uint8_t channel, float freq)
         return HAL_ERROR;
     }
     
-    crossoverConfig[channel].lowPassFreq = freq;
+    next = crossoverConfig[channel];
+    next.lowPassFreq = freq;
     
     /* Update filters */
-    Crossover_UpdateFilters(channel);
+    status = Crossover_ApplyConfig(channel, &next);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d LP freq set to %.1f Hz\r\n", channel, freq);
     
@@ -288,19 +330,27 @@ HAL_StatusTypeDef Crossover_Config_SetLowPassFreq(uint8_t channel, float freq)
   * @brief  Set filter type for a channel
   * @param  channel: Channel index (0-3)
   * @param  type: Filter type (CROSSOVER_TYPE_xxx)
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_SetFilterType(uint8_t channel, CrossoverType_TypeDef type)
 {
+    CrossoverConfig_TypeDef next;
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS || 
         type >= CROSSOVER_TYPE_COUNT) {
         return HAL_ERROR;
     }
     
-    crossoverConfig[channel].filterType = type;
+    next = crossoverConfig[channel];
+    next.filterType = type;
     
     /* Update filters */
-    Crossover_UpdateFilters(channel);
+    status = Crossover_ApplyConfig(channel, &next);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d filter type set to %s\r\n", 
                channel, 
@@ -313,19 +363,27 @@ HAL_StatusTypeDef Crossover_Config_SetFilterType(uint8_t channel, CrossoverType_
   * @brief  Set filter order for a channel
   * @param  channel: Channel index (0-3)
   * @param  order: Filter order (CROSSOVER_ORDER_xxx)
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_SetFilterOrder(uint8_t channel, CrossoverOrder_TypeDef order)
 {
+    CrossoverConfig_TypeDef next;
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS || 
         order >= CROSSOVER_ORDER_COUNT) {
         return HAL_ERROR;
     }
     
-    crossoverConfig[channel].filterOrder = order;
+    next = crossoverConfig[channel];
+    next.filterOrder = order;
     
     /* Update filters */
-    Crossover_UpdateFilters(channel);
+    status = Crossover_ApplyConfig(channel, &next);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d filter order set to %s\r\n", 
                channel, 
@@ -338,10 +396,14 @@ HAL_StatusTypeDef Crossover_Config_SetFilterOrder(uint8_t channel, CrossoverOrde
   * @brief  Set bandpass mode for a channel
   * @param  channel: Channel index (0-3)
   * @param  enable: 1 to enable bandpass, 0 for high/low pass only
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_SetBandPassMode(uint8_t channel, uint8_t enable)
 {
+    CrossoverConfig_TypeDef next;
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS) {
         return HAL_ERROR;
     }
@@ -355,10 +417,14 @@ HAL_StatusTypeDef Crossover_Config_SetBandPassMode(uint8_t channel, uint8_t enab
         return HAL_ERROR;
     }
     
-    crossoverConfig[channel].bandPassEnabled = enable ? 1 : 0;
+    next = crossoverConfig[channel];
+    next.bandPassEnabled = enable ? 1 : 0;
     
     /* Update filters */
-    Crossover_UpdateFilters(channel);
+    status = Crossover_ApplyConfig(channel, &next);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d set to %s mode\r\n", 
                channel,
@@ -400,19 +466,22 @@ const char* Crossover_Config_GetFilterOrderString(uint8_t channel)
 /**
   * @brief  Reset crossover configuration for a channel to default
   * @param  channel: Channel index (0-3)
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_ResetToDefault(uint8_t channel)
 {
+    HAL_StatusTypeDef status;
+    
     if (channel >= AUDIO_OUTPUT_CHANNELS) {
         return HAL_ERROR;
     }
     
-    /* Copy default configuration */
-    memcpy(&crossoverConfig[channel], &defaultCrossoverConfig[channel], sizeof(CrossoverConfig_TypeDef));
-    
-    /* Update filters */
-    Crossover_UpdateFilters(channel);
+    /* Copy default configuration and update filters */
+    status = Crossover_ApplyConfig(channel, &defaultCrossoverConfig[channel]);
+    if (status != HAL_OK) {
+        return status;
+    }
     
     DEBUG_PRINT("Channel %d crossover reset to default\r\n", channel);
     
@@ -422,10 +491,15 @@ HAL_StatusTypeDef Crossover_Config_ResetToDefault(uint8_t channel)
 /**
   * @brief  Apply a preset configuration to all channels
   * @param  preset: Preset index (0-4)
-  * @retval HAL_OK if successful, HAL_ERROR otherwise
+  * @note   The preset is admitted for all channels at once, a refusal
+  *         leaves every channel unchanged
+  * @retval HAL_OK if successful, HAL_BUSY if the CPU budget has no room
+  *         for the filters, HAL_ERROR otherwise
   */
 HAL_StatusTypeDef Crossover_Config_ApplyPreset(uint8_t preset)
 {
+    CpuBudget_Load_TypeDef loads[AUDIO_OUTPUT_CHANNELS];
+    
     /* Preset configurations for common setups */
     static const CrossoverConfig_TypeDef presetConfigs[][AUDIO_OUTPUT_CHANNELS] = {
         /* Preset 0: Standard 2-way */
@@ -633,6 +707,13 @@ HAL_StatusTypeDef Crossover_Config_ApplyPreset(uint8_t preset)
         return HAL_ERROR;
     }
     
+    for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
+        Crossover_FillCpuLoad(&presetConfigs[preset][i], &loads[i]);
+    }
+    if (CpuBudget_AdmitStage(CPUBUDGET_STAGE_CROSSOVER, loads) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    
     /* Copy preset configuration to working config */
     for (uint8_t i = 0; i < AUDIO_OUTPUT_CHANNELS; i++) {
         memcpy(&crossoverConfig[i], &presetConfigs[preset][i], sizeof(CrossoverConfig_TypeDef));
@@ -662,7 +743,7 @@ static void Crossover_UpdateFilters(uint8_t channel)
     CrossoverConfig_TypeDef* config = &crossoverConfig[channel];
     
     /* Update high-pass filter if enabled */
-    if (config->isEnabled && (config->highPassFreq > MIN_CROSSOVER_FREQ || config->bandPassEnabled)) {
+    if (Crossover_UsesHighPass(config)) {
         switch (config->filterType) {
             case CROSSOVER_TYPE_BUTTERWORTH:
                 Butterworth_HighPassInit(channel, config->highPassFreq, config->filterOrder);
@@ -676,6 +757,12 @@ static void Crossover_UpdateFilters(uint8_t channel)
                 Bessel_HighPassInit(channel, config->highPassFreq, config->filterOrder);
                 break;
                 
+            case CROSSOVER_TYPE_CHEBYSHEV1:
+            case CROSSOVER_TYPE_CHEBYSHEV2:
+            case CROSSOVER_TYPE_ELLIPTIC:
+                Crossover_DesignSteep(channel, config, FILTER_TYPE_HIGHPASS, config->highPassFreq);
+                break;
+                
             default:
                 /* Should not reach here */
                 break;
@@ -686,7 +773,7 @@ static void Crossover_UpdateFilters(uint8_t channel)
     }
     
     /* Update low-pass filter if enabled */
-    if (config->isEnabled && (config->lowPassFreq < MAX_CROSSOVER_FREQ || config->bandPassEnabled)) {
+    if (Crossover_UsesLowPass(config)) {
         switch (config->filterType) {
             case CROSSOVER_TYPE_BUTTERWORTH:
                 Butterworth_LowPassInit(channel, config->lowPassFreq, config->filterOrder);
@@ -700,6 +787,12 @@ static void Crossover_UpdateFilters(uint8_t channel)
                 Bessel_LowPassInit(channel, config->lowPassFreq, config->filterOrder);
                 break;
                 
+            case CROSSOVER_TYPE_CHEBYSHEV1:
+            case CROSSOVER_TYPE_CHEBYSHEV2:
+            case CROSSOVER_TYPE_ELLIPTIC:
+                Crossover_DesignSteep(channel, config, FILTER_TYPE_LOWPASS, config->lowPassFreq);
+                break;
+                
             default:
                 /* Should not reach here */
                 break;
@@ -710,6 +803,116 @@ static void Crossover_UpdateFilters(uint8_t channel)
     }
 }
 
+/**
+  * @brief  Admit a configuration against the CPU budget and apply it
+  * @param  channel: Channel index (0-3)
+  * @param  config: Validated configuration
+  * @retval HAL_OK if applied, HAL_BUSY if the budget has no room for it
+  */
+static HAL_StatusTypeDef Crossover_ApplyConfig(uint8_t channel, const CrossoverConfig_TypeDef* config)
+{
+    HAL_StatusTypeDef status = Crossover_CommitConfig(channel, config);
+    
+    if (status != HAL_OK) {
+        DEBUG_PRINT("Crossover change for channel %d refused, no CPU headroom\r\n", channel);
+    }
+    
+    return status;
+}
+
+/**
+  * @brief  Admit a configuration against the CPU budget and apply it, without logging
+  * @param  channel: Channel index (0-3)
+  * @param  config: Validated configuration
+  * @retval HAL_OK if applied, HAL_BUSY if the budget has no room for it
+  */
+static HAL_StatusTypeDef Crossover_CommitConfig(uint8_t channel, const CrossoverConfig_TypeDef* config)
+{
+    CpuBudget_Load_TypeDef load;
+    
+    Crossover_FillCpuLoad(config, &load);
+    if (CpuBudget_Admit(CPUBUDGET_STAGE_CROSSOVER, channel, &load) != HAL_OK) {
+        return HAL_BUSY;
+    }
+    
+    memcpy(&crossoverConfig[channel], config, sizeof(CrossoverConfig_TypeDef));
+    Crossover_UpdateFilters(channel);
+    
+    return HAL_OK;
+}
+
+/**
+  * @brief  Design a Chebyshev or elliptic path and load it into the filter
+  * @note   The slope table stops at 8th order, inside FILTER_STEEP_MAX_ORDER
+  * @param  channel: Channel index (0-3)
+  * @param  config: Configuration of the channel
+  * @param  type: FILTER_TYPE_HIGHPASS or FILTER_TYPE_LOWPASS
+  * @param  freq: Passband edge in Hz
+  * @retval None
+  */
+static void Crossover_DesignSteep(uint8_t channel, const CrossoverConfig_TypeDef* config,
+                                  FilterType_t type, float freq)
+{
+    BiquadCoeff_t sections[FILTER_STEEP_MAX_SECTIONS];
+    FilterSteepSpec_t spec;
+    
+    spec.family = (config->filterType == CROSSOVER_TYPE_CHEBYSHEV1) ? FILTER_FAMILY_CHEBYSHEV1 :
+                  (config->filterType == CROSSOVER_TYPE_CHEBYSHEV2) ? FILTER_FAMILY_CHEBYSHEV2 :
+                                                                      FILTER_FAMILY_ELLIPTIC;
+    spec.type = type;
+    spec.frequency = freq;
+    spec.passRippleDb = CROSSOVER_STEEP_RIPPLE_DB;
+    spec.stopAttenDb = CROSSOVER_STEEP_STOPBAND_DB;
+    spec.order = crossoverOrderValues[config->filterOrder];
+    spec.sampleRate = (float)AUDIO_SAMPLE_RATE;
+    
+    if (FilterDesign_CreateSteep(sections, FILTER_STEEP_MAX_SECTIONS, &spec) != FILTER_DESIGN_SUCCESS) {
+        DEBUG_PRINT("Crossover ch%d: %s design failed at %.1f Hz\r\n",
+                    channel, crossoverTypeNames[config->filterType], freq);
+        Crossover_LoadSections(channel, type, NULL, 0);
+        return;
+    }
+    
+    Crossover_LoadSections(channel, type, sections, (uint8_t)((spec.order + 1U) / 2U));
+}
+
+/**
+  * @brief  Check if a configuration runs the high-pass path
+  * @param  config: Configuration
+  * @retval 1 if the high-pass filter is used, 0 otherwise
+  */
+static uint8_t Crossover_UsesHighPass(const CrossoverConfig_TypeDef* config)
+{
+    return (config->isEnabled && (config->highPassFreq > MIN_CROSSOVER_FREQ || config->bandPassEnabled)) ? 1 : 0;
+}
+
+/**
+  * @brief  Check if a configuration runs the low-pass path
+  * @param  config: Configuration
+  * @retval 1 if the low-pass filter is used, 0 otherwise
+  */
+static uint8_t Crossover_UsesLowPass(const CrossoverConfig_TypeDef* config)
+{
+    return (config->isEnabled && (config->lowPassFreq < MAX_CROSSOVER_FREQ || config->bandPassEnabled)) ? 1 : 0;
+}
+
+/**
+  * @brief  Cost of a configuration for the CPU budget
+  * @param  config: Configuration
+  * @param  load: Filled with the sections of the paths that run
+  * @retval None
+  */
+static void Crossover_FillCpuLoad(const CrossoverConfig_TypeDef* config, CpuBudget_Load_TypeDef* load)
+{
+    uint8_t paths = Crossover_UsesHighPass(config) + Crossover_UsesLowPass(config);
+    uint8_t sections = (config->filterOrder < CROSSOVER_ORDER_COUNT) ?
+                       crossoverOrderSections[config->filterOrder] : 0;
+    
+    memset(load, 0, sizeof(*load));
+    load->active = (paths > 0) ? 1 : 0;
+    load->units = (uint16_t)(paths * sections);
+}
+
 /**
   * @brief  Clamp frequency to valid range
   * @param  freq: Frequency in Hz
@@ -23,6 +23,9 @@
 #include "linkwitz_riley.h"
 #include "bessel.h"
 #include "biquad.h"
+#include "biquad_cascade.h"
+#include "cpu_budget.h"
+#include "response_cache.h"
 #include "math_utils.h"
 #include "debug.h"
 #include <math.h>
@@ -37,9 +40,9 @@
 
 /* Private typedefs ----------------------------------------------------------*/
 typedef struct {
-    BiquadFilter_TypeDef stages[MAX_FILTER_STAGES];
     uint8_t numStages;
     float gain;
+    BiquadCascade_TypeDef cascade;    // Compiled stages, run by the audio path
 } FilterChain_TypeDef;
 
 /* Private variables ---------------------------------------------------------*/
@@ -53,8 +56,11 @@ static FilterChain_TypeDef bandpassLowFilters[AUDIO_OUTPUT_CHANNELS];
 static void CalculateFilterCoefficients(uint8_t outputChannel);
 static uint8_t GetNumStagesForOrder(uint8_t order);
 static void ClearFilterHistory(FilterChain_TypeDef* filter);
-static float ProcessFilterChain(FilterChain_TypeDef* filter, float input);
+static void ProcessFilterChain(FilterChain_TypeDef* filter, float* data, uint16_t size);
+static void CompileFilterChain(FilterChain_TypeDef* filter, const BiquadCoeff_t* coeffs);
+static void StoreStageCoeffs(BiquadCoeff_t* dst, const BiquadCoeff_TypeDef* src);
 static float ComputeGainCompensation(CrossoverFilterType_TypeDef filterType, uint8_t order);
+static void FillCpuLoad(CrossoverFilterMode_TypeDef mode, uint8_t order, CpuBudget_Load_TypeDef* load);
 
 /**
   * @brief  Inisialisasi filter crossover
@@ -63,6 +69,8 @@ static float ComputeGainCompensation(CrossoverFilterType_TypeDef filterType, uin
   */
 void Crossover_Filter_Init(uint8_t outputChannel)
 {
+    CpuBudget_Load_TypeDef load;
+    
     if (outputChannel >= AUDIO_OUTPUT_CHANNELS) {
         DEBUG_PRINT("Crossover_Filter_Init: Invalid output channel\r\n");
         return;
@@ -90,6 +98,10 @@ void Crossover_Filter_Init(uint8_t outputChannel)
     /* Calculate initial coefficients */
     CalculateFilterCoefficients(outputChannel);
     
+    /* Laporkan beban awal ke model CPU */
+    FillCpuLoad(crossoverConfig[outputChannel].filterMode, crossoverConfig[outputChannel].order, &load);
+    CpuBudget_SetLoad(CPUBUDGET_STAGE_CROSSOVER, outputChannel, &load);
+    
     DEBUG_PRINT("Crossover filter initialized for channel %d\r\n", outputChannel);
 }
 
@@ -101,6 +113,8 @@ void Crossover_Filter_Init(uint8_t outputChannel)
   */
 uint8_t Crossover_SetFilterMode(uint8_t outputChannel, CrossoverFilterMode_TypeDef mode)
 {
+    CpuBudget_Load_TypeDef load;
+    
     if (outputChannel >= AUDIO_OUTPUT_CHANNELS) {
         return 1;
     }
@@ -109,6 +123,12 @@ uint8_t Crossover_SetFilterMode(uint8_t outputChannel, CrossoverFilterMode_TypeD
         return 1;
     }
     
+    /* Bandpass menggandakan jumlah stage, cek dulu anggaran CPU */
+    FillCpuLoad(mode, crossoverConfig[outputChannel].order, &load);
+    if (CpuBudget_Admit(CPUBUDGET_STAGE_CROSSOVER, outputChannel, &load) != HAL_OK) {
+        return 1;
+    }
+    
     crossoverConfig[outputChannel].filterMode = mode;
     CalculateFilterCoefficients(outputChannel); // Recalculate coefficients
     
@@ -196,6 +216,8 @@ uint8_t Crossover_SetFrequency(uint8_t outputChannel, CrossoverFrequencyType_Typ
   */
 uint8_t Crossover_SetOrder(uint8_t outputChannel, uint8_t order)
 {
+    CpuBudget_Load_TypeDef load;
+    
     if (outputChannel >= AUDIO_OUTPUT_CHANNELS) {
         return 1;
     }
@@ -210,6 +232,12 @@ uint8_t Crossover_SetOrder(uint8_t outputChannel, uint8_t order)
         order = (order + 1) & ~1; // Round up to next even number
     }
     
+    /* Orde lebih tinggi berarti lebih banyak stage per sampel */
+    FillCpuLoad(crossoverConfig[outputChannel].filterMode, order, &load);
+    if (CpuBudget_Admit(CPUBUDGET_STAGE_CROSSOVER, outputChannel, &load) != HAL_OK) {
+        return 1;
+    }
+    
     crossoverConfig[outputChannel].order = order;
     CalculateFilterCoefficients(outputChannel); // Recalculate coefficients
     
@@ -236,42 +264,96 @@ uint8_t Crossover_GetConfig(uint8_t outputChannel, CrossoverConfig_TypeDef* conf
 }
 
 /**
-  * @brief  Proses sinyal audio melalui filter crossover
+  * @brief  Memproses satu blok sampel melalui filter crossover
   * @param  outputChannel: Channel output (0-3)
-  * @param  input: Nilai input sampel audio
-  * @retval Nilai output yang telah diproses
+  * @param  input: Buffer input
+  * @param  output: Buffer output (boleh sama dengan input)
+  * @param  size: Jumlah sampel
+  * @retval None
   */
-float Crossover_ProcessSample(uint8_t outputChannel, float input)
+void Crossover_ProcessBuffer(uint8_t outputChannel, float *input, float *output, uint16_t size)
 {
-    float output = 0.0f;
+    if (outputChannel >= AUDIO_OUTPUT_CHANNELS || input == NULL || output == NULL) {
+        return;
+    }
     
-    if (outputChannel >= AUDIO_OUTPUT_CHANNELS) {
-        return input; // Return unprocessed sample on invalid channel
+    if (output != input) {
+        memcpy(output, input, size * sizeof(float));
     }
-
-    /* Process based on filter mode */
+    
     switch (crossoverConfig[outputChannel].filterMode) {
         case CROSSOVER_MODE_LOWPASS:
-            output = ProcessFilterChain(&lowpassFilters[outputChannel], input);
+            ProcessFilterChain(&lowpassFilters[outputChannel], output, size);
             break;
             
         case CROSSOVER_MODE_HIGHPASS:
-            output = ProcessFilterChain(&highpassFilters[outputChannel], input);
+            ProcessFilterChain(&highpassFilters[outputChannel], output, size);
             break;
             
         case CROSSOVER_MODE_BANDPASS:
-            /* Bandpass is implemented as cascaded high-pass and low-pass */
-            output = ProcessFilterChain(&bandpassHighFilters[outputChannel], input);
-            output = ProcessFilterChain(&bandpassLowFilters[outputChannel], output);
+            /* Bandpass = high-pass lalu low-pass, masing-masing satu blok penuh */
+            ProcessFilterChain(&bandpassHighFilters[outputChannel], output, size);
+            ProcessFilterChain(&bandpassLowFilters[outputChannel], output, size);
             break;
             
         case CROSSOVER_MODE_FULLRANGE:
         default:
-            output = input; // Bypass processing
             break;
     }
+}
+
+/**
+  * @brief  Proses satu frame audio dari sebuah output melalui crossover
+  * @param  outputChannel: Channel output (0-3)
+  * @param  buffer: Buffer audio, diproses in-place
+  * @retval None
+  */
+void DSP_Crossover_Process(uint8_t outputChannel, AudioBuffer_TypeDef *buffer)
+{
+    if (outputChannel >= AUDIO_OUTPUT_CHANNELS || buffer == NULL) {
+        return;
+    }
+    
+    Crossover_ProcessBuffer(outputChannel, buffer->samples[outputChannel],
+                            buffer->samples[outputChannel], AUDIO_FRAME_SIZE);
+}
+
+/**
+  * @brief  Muat section hasil desain ke chain high-pass atau low-pass
+  * @note   Dipakai untuk tipe yang didesain di luar modul ini (Chebyshev,
+  *         elliptic); pada mode bandpass yang dimuat chain bandpass
+  * @param  outputChannel: Channel output (0-3)
+  * @param  type: FILTER_TYPE_HIGHPASS atau FILTER_TYPE_LOWPASS
+  * @param  sections: Koefisien tiap section
+  * @param  count: Jumlah section, 0 mengosongkan chain
+  * @retval None
+  */
+void Crossover_LoadSections(uint8_t outputChannel, FilterType_t type, const BiquadCoeff_t *sections, uint8_t count)
+{
+    FilterChain_TypeDef* filter;
+    uint8_t bandpass;
+    
+    if (outputChannel >= AUDIO_OUTPUT_CHANNELS || count > MAX_FILTER_STAGES ||
+        (sections == NULL && count > 0)) {
+        return;
+    }
+    
+    bandpass = (crossoverConfig[outputChannel].filterMode == CROSSOVER_MODE_BANDPASS) ? 1 : 0;
+    if (type == FILTER_TYPE_HIGHPASS) {
+        filter = bandpass ? &bandpassHighFilters[outputChannel] : &highpassFilters[outputChannel];
+    } else {
+        filter = bandpass ? &bandpassLowFilters[outputChannel] : &lowpassFilters[outputChannel];
+    }
+    
+    filter->numStages = count;
+    filter->gain = 1.0f;
+    CompileFilterChain(filter, sections);
+    ResponseCache_SetSection(outputChannel,
+                             (type == FILTER_TYPE_HIGHPASS) ? RESPCACHE_SLOT_XOVER_HP : RESPCACHE_SLOT_XOVER_LP,
+                             sections, count, 1.0f);
     
-    return output;
+    /* Hindari transien dari history filter lama */
+    ClearFilterHistory(filter);
 }
 
 /**
@@ -308,6 +390,7 @@ static void CalculateFilterCoefficients(uint8_t outputChannel)
     
     uint8_t numStages = GetNumStagesForOrder(order);
     BiquadCoeff_TypeDef coeffs;
+    BiquadCoeff_t stageCoeffs[MAX_FILTER_STAGES];
     
     /* Clear old filter configurations */
     highpassFilters[outputChannel].numStages = 0;
@@ -338,9 +421,11 @@ static void CalculateFilterCoefficients(uint8_t outputChannel)
                         break;
                 }
                 
-                /* Initialize biquad filter with calculated coefficients */
-                Biquad_Init(&lowpassFilters[outputChannel].stages[stage], &coeffs);
+                StoreStageCoeffs(&stageCoeffs[stage], &coeffs);
             }
+            CompileFilterChain(&lowpassFilters[outputChannel], stageCoeffs);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_LP, stageCoeffs, numStages, gainCompensation);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_HP, NULL, 0, 1.0f);
             break;
             
         case CROSSOVER_MODE_HIGHPASS:
@@ -361,9 +446,11 @@ static void CalculateFilterCoefficients(uint8_t outputChannel)
                         break;
                 }
                 
-                /* Initialize biquad filter with calculated coefficients */
-                Biquad_Init(&highpassFilters[outputChannel].stages[stage], &coeffs);
+                StoreStageCoeffs(&stageCoeffs[stage], &coeffs);
             }
+            CompileFilterChain(&highpassFilters[outputChannel], stageCoeffs);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_HP, stageCoeffs, numStages, gainCompensation);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_LP, NULL, 0, 1.0f);
             break;
             
         case CROSSOVER_MODE_BANDPASS:
@@ -387,9 +474,10 @@ static void CalculateFilterCoefficients(uint8_t outputChannel)
                         break;
                 }
                 
-                /* Initialize biquad filter with calculated coefficients */
-                Biquad_Init(&bandpassHighFilters[outputChannel].stages[stage], &coeffs);
+                StoreStageCoeffs(&stageCoeffs[stage], &coeffs);
             }
+            CompileFilterChain(&bandpassHighFilters[outputChannel], stageCoeffs);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_HP, stageCoeffs, numStages, gainCompensation);
             
             /* Calculate coefficients for low-pass part */
             for (uint8_t stage = 0; stage < numStages; stage++) {
@@ -405,14 +493,17 @@ static void CalculateFilterCoefficients(uint8_t outputChannel)
                         break;
                 }
                 
-                /* Initialize biquad filter with calculated coefficients */
-                Biquad_Init(&bandpassLowFilters[outputChannel].stages[stage], &coeffs);
+                StoreStageCoeffs(&stageCoeffs[stage], &coeffs);
             }
+            CompileFilterChain(&bandpassLowFilters[outputChannel], stageCoeffs);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_LP, stageCoeffs, numStages, 1.0f);
             break;
             
         case CROSSOVER_MODE_FULLRANGE:
         default:
             /* No filters needed for full range */
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_HP, NULL, 0, 1.0f);
+            ResponseCache_SetSection(outputChannel, RESPCACHE_SLOT_XOVER_LP, NULL, 0, 1.0f);
             break;
     }
     
@@ -454,34 +545,51 @@ static void ClearFilterHistory(FilterChain_TypeDef* filter)
         return;
     }
     
-    for (uint8_t i = 0; i < filter->numStages; i++) {
-        Biquad_Reset(&filter->stages[i]);
-    }
+    BiquadCascade_Reset(&filter->cascade);
 }
 
 /**
-  * @brief  Memproses sampel audio dengan filter chain
+  * @brief  Memproses satu blok sampel dengan filter chain (in-place)
   * @param  filter: Pointer ke filter chain
-  * @param  input: Nilai sampel input
-  * @retval Nilai sampel output
+  * @param  data: Buffer sampel
+  * @param  size: Jumlah sampel
+  * @retval None
   */
-static float ProcessFilterChain(FilterChain_TypeDef* filter, float input)
+static void ProcessFilterChain(FilterChain_TypeDef* filter, float* data, uint16_t size)
 {
-    float output = input;
-    
     if (filter == NULL || filter->numStages == 0) {
-        return input;
-    }
-    
-    /* Process through each biquad stage */
-    for (uint8_t i = 0; i < filter->numStages; i++) {
-        output = Biquad_Process(&filter->stages[i], output);
+        return;
     }
     
-    /* Apply gain compensation */
-    output *= filter->gain;
-    
-    return output;
+    /* Compiled kernel runs all stages and the gain compensation */
+    BiquadCascade_Process(&filter->cascade, data, size);
+}
+
+/**
+  * @brief  Compile filter chain ke kernel cascade sesuai jumlah stage
+  * @param  filter: Pointer ke filter chain
+  * @param  coeffs: Koefisien tiap stage (numStages elemen)
+  * @retval None
+  */
+static void CompileFilterChain(FilterChain_TypeDef* filter, const BiquadCoeff_t* coeffs)
+{
+    filter->cascade.gain = filter->gain;
+    BiquadCascade_Compile(&filter->cascade, coeffs, NULL, filter->numStages, 0);
+}
+
+/**
+  * @brief  Salin koefisien stage hasil desain untuk proses compile
+  * @param  dst: Koefisien tujuan
+  * @param  src: Koefisien hasil desain filter
+  * @retval None
+  */
+static void StoreStageCoeffs(BiquadCoeff_t* dst, const BiquadCoeff_TypeDef* src)
+{
+    dst->b0 = src->b0;
+    dst->b1 = src->b1;
+    dst->b2 = src->b2;
+    dst->a1 = src->a1;
+    dst->a2 = src->a2;
 }
 
 /**
@@ -528,6 +636,22 @@ static float ComputeGainCompensation(CrossoverFilterType_TypeDef filterType, uin
     return gain;
 }
 
+/**
+  * @brief  Isi beban CPU untuk mode dan orde tertentu
+  * @param  mode: Mode filter
+  * @param  order: Orde filter
+  * @param  load: Beban yang dilaporkan ke model CPU
+  * @retval None
+  */
+static void FillCpuLoad(CrossoverFilterMode_TypeDef mode, uint8_t order, CpuBudget_Load_TypeDef* load)
+{
+    uint8_t numStages = GetNumStagesForOrder(order);
+    
+    memset(load, 0, sizeof(*load));
+    load->active = (mode != CROSSOVER_MODE_FULLRANGE) ? 1 : 0;
+    load->units = (mode == CROSSOVER_MODE_BANDPASS) ? (2U * numStages) : numStages;
+}
+
 /**
   * @brief  Fungsi helper untuk mendapatkan nama tipe filter dalam string
   * @param  type: Tipe filter
@@ -539,6 +663,9 @@ const char* Crossover_GetFilterTypeName(CrossoverFilterType_TypeDef type)
         case CROSSOVER_TYPE_BUTTERWORTH:  return "BUT";
         case CROSSOVER_TYPE_LINKWITZ_RILEY: return "LR";
         case CROSSOVER_TYPE_BESSEL:       return "BES";
+        case CROSSOVER_TYPE_CHEBYSHEV1:   return "CH1";
+        case CROSSOVER_TYPE_CHEBYSHEV2:   return "CH2";
+        case CROSSOVER_TYPE_ELLIPTIC:     return "ELL";
         default:                          return "???";
     }
 }
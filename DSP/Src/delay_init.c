@@ -16,15 +16,16 @@
 /* Includes ------------------------------------------------------------------*/
 #include "delay_types.h"
 #include "delay.h"
+#include "delay_store.h"
 #include "math_utils.h"
 #include "debug.h"
+#include <math.h>
 #include <string.h>
 #include <stdlib.h>
 
 /* Private defines -----------------------------------------------------------*/
 #define MAX_TEMP_COMP_ADJUSTMENT_US  50     /* Maximum temperature compensation in microseconds */
 #define DELAY_BUFFER_ALIGNMENT       8      /* Memory alignment for delay buffer (bytes) */
-#define MINIMUM_BUFFER_PADDING       16     /* Safety padding for buffer boundaries */
 
 /* Private variables --------------------------------------------------------*/
 static DelayInstance_TypeDef delayInstances[MAX_DELAY_CHANNELS];
@@ -33,8 +34,6 @@ static float tempCompensationFactor = 1.0f;  /* Temperature compensation factor
 
 /* Private function prototypes -----------------------------------------------*/
 static uint32_t CalculateBufferSizeBytes(uint32_t maxDelayMs, uint32_t sampleRate);
-static void ApplyDelaySettings(uint8_t channel);
-static float ConvertDistanceToTime(float distance, DelayUnit_TypeDef unit);
 static HAL_StatusTypeDef AllocateDelayBuffer(uint8_t channel);
 
 /**
@@ -54,7 +53,7 @@ HAL_StatusTypeDef Delay_Init(DelayConfig_TypeDef *config)
   uint32_t maxDelayMs = config->maxDelayMs;
   
   DEBUG_PRINT("Delay_Init: Initializing delay system. Sample rate: %lu Hz, Max delay: %lu ms\r\n", 
-              sampleRate, maxDelayMs);
+              (unsigned long)sampleRate, (unsigned long)maxDelayMs);
 
   /* Initialize all delay instances */
   for (uint8_t i = 0; i < MAX_DELAY_CHANNELS; i++) {
@@ -71,16 +70,15 @@ HAL_StatusTypeDef Delay_Init(DelayConfig_TypeDef *config)
     delayInstances[i].enabled = 0;
     delayInstances[i].filterCoeff = 0.7f;  /* Default low pass filter coefficient for interpolation */
     delayInstances[i].prevSample = 0.0f;
+    delayInstances[i].compensationSamples = 0;
+    Delay_ReportCpuLoad(i);
     
-    /* Allocate delay buffer for this channel */
+    /* Allocate delay buffer for this channel, cleared, full precision */
     if (AllocateDelayBuffer(i) != HAL_OK) {
       DEBUG_PRINT("Delay_Init: Failed to allocate buffer for channel %d\r\n", i);
       Delay_DeInit();  /* Clean up already allocated resources */
       return HAL_ERROR;
     }
-    
-    /* Clear delay buffer */
-    memset(delayInstances[i].buffer, 0, delayInstances[i].bufferSize * sizeof(float));
   }
   
   /* Set temperature compensation factor based on ambient temperature */
@@ -150,7 +148,7 @@ HAL_StatusTypeDef Delay_ConfigChannel(uint8_t channel, DelayChannelConfig_TypeDe
   if (config->delayUnit == DELAY_UNIT_CM || config->delayUnit == DELAY_UNIT_INCH) {
     /* Convert distance to time */
     delayInstances[channel].currentDelayDistance = config->delayValue;
-    delayInstances[channel].currentDelayMs = ConvertDistanceToTime(config->delayValue, config->delayUnit);
+    delayInstances[channel].currentDelayMs = Delay_DistanceToMs(config->delayValue, config->delayUnit);
   } else {
     /* Direct time value */
     delayInstances[channel].currentDelayMs = config->delayValue;
@@ -163,10 +161,11 @@ HAL_StatusTypeDef Delay_ConfigChannel(uint8_t channel, DelayChannelConfig_TypeDe
   delayInstances[channel].enabled = config->enabled;
   
   /* Apply settings to update read indices */
-  ApplyDelaySettings(channel);
+  Delay_ApplySettings(channel);
   
   /* Mark channel as active */
   delayInstances[channel].isActive = 1;
+  Delay_ReportCpuLoad(channel);
   
   return HAL_OK;
 }
@@ -195,11 +194,156 @@ void Delay_UpdateTemperatureCompensation(float temperatureC)
   /* Re-apply settings for all active channels to update timing */
   for (uint8_t i = 0; i < MAX_DELAY_CHANNELS; i++) {
     if (delayInstances[i].isActive && delayInstances[i].enabled) {
-      ApplyDelaySettings(i);
+      Delay_ApplySettings(i);
     }
   }
 }
 
+/**
+  * @brief  Set the user delay as the line applies it, after temperature compensation
+  * @note   Parameter registry and morph scenes work in this domain, so a value
+  *         read with Delay_GetCompensatedTime() restores the same delay
+  * @param  channel: Output channel index (0-3)
+  * @param  delayMs: Compensated delay in milliseconds
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Delay_SetCompensatedTime(uint8_t channel, float delayMs)
+{
+  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+    DEBUG_PRINT("Delay_SetCompensatedTime: Invalid channel %d\r\n", channel);
+    return HAL_ERROR;
+  }
+  
+  /* The line holds compensated samples, so the limit applies here directly */
+  if (delayMs < 0.0f || delayMs > Delay_GetMaxDelayMs(channel)) {
+    DEBUG_PRINT("Delay_SetCompensatedTime: Invalid delay time %.2f ms (max: %.2f)\r\n", 
+                delayMs, Delay_GetMaxDelayMs(channel));
+    return HAL_ERROR;
+  }
+  
+  delayInstances[channel].currentDelayMs = delayMs * tempCompensationFactor;
+  delayInstances[channel].delayUnit = DELAY_UNIT_MS;
+  delayInstances[channel].currentDelayDistance = 
+    delayInstances[channel].currentDelayMs * SPEED_OF_SOUND_M_PER_SEC / 1000.0f * 100.0f; /* Convert to cm */
+  
+  Delay_ApplySettings(channel);
+  
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the user delay as the line applies it, after temperature compensation
+  * @param  channel: Output channel index (0-3)
+  * @retval Compensated delay in milliseconds, alignment delay not included
+  */
+float Delay_GetCompensatedTime(uint8_t channel)
+{
+  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+    return 0.0f;
+  }
+  
+  return delayInstances[channel].currentDelayMs / tempCompensationFactor;
+}
+
+/**
+  * @brief  Set latency alignment delay for a channel
+  * @note   Added on top of the user delay in the same delay line. Owned by
+  *         the latency manager, not exposed to the user interface.
+  * @param  channel: Output channel index (0-3)
+  * @param  samples: Alignment delay in samples
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Delay_SetCompensation(uint8_t channel, uint32_t samples)
+{
+  if (channel >= MAX_DELAY_CHANNELS || !isDelaySystemInitialized) {
+    DEBUG_PRINT("Delay_SetCompensation: Invalid channel %d\r\n", channel);
+    return HAL_ERROR;
+  }
+  
+  /* User delay and compensation share one buffer, the user delay only
+     takes what it uses while enabled */
+  uint32_t userSamples = 0;
+  if (delayInstances[channel].enabled) {
+    userSamples = (uint32_t)ceilf(delayInstances[channel].currentDelayMs / tempCompensationFactor *
+                                  (float)delayInstances[channel].sampleRate / 1000.0f);
+  }
+  /* Retried by the latency manager every pass, which logs the refusal once */
+  if (userSamples + samples + DELAY_READ_MARGIN > delayInstances[channel].bufferSize) {
+    return HAL_ERROR;
+  }
+  
+  delayInstances[channel].compensationSamples = samples;
+  
+  /* Compensation must run even when the user delay is off */
+  if (samples > 0) {
+    delayInstances[channel].isActive = 1;
+  }
+  
+  Delay_ApplySettings(channel);
+  Delay_ReportCpuLoad(channel);
+  
+  return HAL_OK;
+}
+
+/**
+  * @brief  Select the sample format of a channel's delay memory
+  * @note   The RAM per channel stays the same, a compact format holds more
+  *         samples: INT24 1.33x, INT16_BLOCK 1.94x, FP16 2x the FLOAT32
+  *         delay. The line is flushed, so change it while configuring.
+  * @param  channel: Output channel index (0-3)
+  * @param  format: Storage format
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Delay_SetStorageFormat(uint8_t channel, DelayStore_Format_TypeDef format)
+{
+  if (channel >= MAX_DELAY_CHANNELS || !isDelaySystemInitialized || format >= DELAY_STORE_FORMAT_COUNT) {
+    DEBUG_PRINT("Delay_SetStorageFormat: Invalid channel %d or format %d\r\n", channel, format);
+    return HAL_ERROR;
+  }
+  
+  DelayInstance_TypeDef *instance = &delayInstances[channel];
+  
+  /* Alignment delay must still fit in the resized line */
+  if (instance->compensationSamples + DELAY_READ_MARGIN > 
+      DelayStore_Capacity(format, instance->bufferBytes)) {
+    DEBUG_PRINT("Delay_SetStorageFormat: Compensation does not fit on channel %d\r\n", channel);
+    return HAL_ERROR;
+  }
+  
+  if (DelayStore_Init(&instance->store, instance->buffer, instance->bufferBytes, format) != HAL_OK) {
+    return HAL_ERROR;
+  }
+  
+  instance->bufferSize = instance->store.length;
+  instance->writeIndex = 0;
+  instance->prevSample = 0.0f;
+  
+  /* Re-clamp the delay to the new length */
+  Delay_ApplySettings(channel);
+  
+  DEBUG_PRINT("Delay_SetStorageFormat: Channel %d format %d, max %.1f ms\r\n", 
+              channel, format, Delay_GetMaxDelayMs(channel));
+  
+  return HAL_OK;
+}
+
+/**
+  * @brief  Longest user delay the channel's memory holds in its current format
+  * @note   The alignment delay set by the latency manager is taken off
+  * @param  channel: Output channel index (0-3)
+  * @retval Delay in milliseconds
+  */
+float Delay_GetMaxDelayMs(uint8_t channel)
+{
+  if (channel >= MAX_DELAY_CHANNELS || !isDelaySystemInitialized) {
+    return 0.0f;
+  }
+  
+  return (float)(delayInstances[channel].bufferSize - DELAY_READ_MARGIN -
+                 delayInstances[channel].compensationSamples) * 1000.0f / 
+         (float)delayInstances[channel].sampleRate;
+}
+
 /**
   * @brief  Get delay instance for direct access
   * @param  channel: Output channel index (0-3)
@@ -226,7 +370,7 @@ static uint32_t CalculateBufferSizeBytes(uint32_t maxDelayMs, uint32_t sampleRat
   uint32_t maxDelaySamples = (maxDelayMs * sampleRate) / 1000;
   
   /* Add safety margin to buffer */
-  uint32_t bufferSize = maxDelaySamples + MINIMUM_BUFFER_PADDING;
+  uint32_t bufferSize = maxDelaySamples + DELAY_READ_MARGIN;
   
   return bufferSize;
 }
@@ -243,15 +387,21 @@ static HAL_StatusTypeDef AllocateDelayBuffer(uint8_t channel)
     delayInstances[channel].sampleRate
   );
   
+  /* RAM budget is sized for float samples, compact formats fit more into it */
+  uint32_t bufferBytes = bufferSize * sizeof(float);
+  
   /* Allocate memory for delay buffer */
-  delayInstances[channel].buffer = (float*)malloc(bufferSize * sizeof(float));
+  delayInstances[channel].buffer = malloc(bufferBytes);
   
   if (delayInstances[channel].buffer == NULL) {
     DEBUG_PRINT("AllocateDelayBuffer: Memory allocation failed for channel %d\r\n", channel);
     return HAL_ERROR;
   }
   
-  delayInstances[channel].bufferSize = bufferSize;
+  delayInstances[channel].bufferBytes = bufferBytes;
+  DelayStore_Init(&delayInstances[channel].store, delayInstances[channel].buffer, bufferBytes,
+                  DELAY_STORE_FLOAT32);
+  delayInstances[channel].bufferSize = delayInstances[channel].store.length;
   return HAL_OK;
 }
 
@@ -260,7 +410,7 @@ static HAL_StatusTypeDef AllocateDelayBuffer(uint8_t channel)
   * @param  channel: Channel index
   * @retval None
   */
-static void ApplyDelaySettings(uint8_t channel)
+void Delay_ApplySettings(uint8_t channel)
 {
   if (channel >= MAX_DELAY_CHANNELS || !isDelaySystemInitialized) {
     return;
@@ -269,13 +419,25 @@ static void ApplyDelaySettings(uint8_t channel)
   /* Apply compensation factor for temperature */
   float compensatedDelayMs = delayInstances[channel].currentDelayMs / tempCompensationFactor;
   
-  /* Calculate delay in samples */
-  float delaySamplesFloat = (compensatedDelayMs * delayInstances[channel].sampleRate) / 1000.0f;
+  /* Calculate delay in samples, user delay only counts while enabled */
+  float delaySamplesFloat = 0.0f;
+  if (delayInstances[channel].enabled) {
+    delaySamplesFloat = (compensatedDelayMs * delayInstances[channel].sampleRate) / 1000.0f;
+  }
+  
+  /* Add latency alignment from the latency manager */
+  delaySamplesFloat += (float)delayInstances[channel].compensationSamples;
+  
+  /* Keep the read position inside the line, its length depends on the storage format */
+  float maxDelaySamples = (float)(delayInstances[channel].bufferSize - DELAY_READ_MARGIN);
+  if (delaySamplesFloat > maxDelaySamples) {
+    delaySamplesFloat = maxDelaySamples;
+  }
   
   /* Store delay samples as fractional for interpolation */
   delayInstances[channel].delaySamples = delaySamplesFloat;
   
-  DEBUG_PRINT("ApplyDelaySettings: Channel %d delay set to %.2f ms (%.2f samples)\r\n", 
+  DEBUG_PRINT("Delay_ApplySettings: Channel %d delay set to %.2f ms (%.2f samples)\r\n", 
               channel, compensatedDelayMs, delaySamplesFloat);
 }
 
@@ -285,7 +447,7 @@ static void ApplyDelaySettings(uint8_t channel)
   * @param  unit: Distance unit (cm or inch)
   * @retval Time in milliseconds
   */
-static float ConvertDistanceToTime(float distance, DelayUnit_TypeDef unit)
+float Delay_DistanceToMs(float distance, DelayUnit_TypeDef unit)
 {
   float meters;
   
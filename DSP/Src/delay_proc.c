@@ -16,24 +16,28 @@
 /* Includes ------------------------------------------------------------------*/
 #include "delay_types.h"
 #include "delay.h"
+#include "param_snapshot.h"
+#include "delay_store.h"
 #include "audio_config.h"
 #include "math_utils.h"
+#include "cpu_budget.h"
 #include "debug.h"
 #include <string.h>
 #include <math.h>
 
 /* Private defines -----------------------------------------------------------*/
-#define INTERPOLATION_MODE      DELAY_INTERPOLATION_LINEAR  /* Default interpolation mode */
 #define LOW_PASS_COEFF_DEFAULT  0.7f                        /* Default smoothing coefficient */
 
-/* Private variables ---------------------------------------------------------*/
-static DelayInterpolation_TypeDef interpolationMode = INTERPOLATION_MODE;
+/* Private variables --------------------------------------------------------*/
+static uint8_t delayCubicMode = 0;                          /* Control-side copy of the interpolation mode */
+static uint8_t delayCubicAllowed = 1;                       /* Cleared by the quality scaler under overload */
 
 /* Private function prototypes -----------------------------------------------*/
-static float ProcessSampleWithDelay(uint8_t channel, float input);
-static float InterpolateLinear(float *buffer, uint32_t bufferSize, uint32_t readIndex, float fraction);
-static float InterpolateCubic(float *buffer, uint32_t bufferSize, uint32_t readIndex, float fraction);
-static inline uint32_t ModuloBufferSize(int32_t index, uint32_t bufferSize);
+static void ProcessBlockWithDelay(DelayInstance_TypeDef *instance, const float *input, float *output,
+                                  uint32_t size, uint8_t cubic);
+static inline float InterpolateLinear(const float *taps, float fraction);
+static inline float InterpolateCubic(const float *taps, float fraction);
+static void FillDelayCpuLoad(uint8_t channel, uint8_t enabled, uint8_t cubic, CpuBudget_Load_TypeDef *load);
 
 /**
   * @brief  Process audio data through delay line
@@ -45,27 +49,43 @@ static inline uint32_t ModuloBufferSize(int32_t index, uint32_t bufferSize);
 HAL_StatusTypeDef Delay_Process(uint8_t channel, float *pData, uint32_t size)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || pData == NULL || size == 0) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || pData == NULL || size == 0) {
     DEBUG_PRINT("Delay_Process: Invalid parameters\r\n");
     return HAL_ERROR;
   }
   
-  DelayInstance_TypeDef *instance = &delayInstances[channel];
-  
-  /* Check if delay is enabled and active */
-  if (!instance->isActive || !instance->enabled) {
+  /* Check if delay is enabled and active, alignment delay keeps the line running */
+  if (!instance->isActive || (!instance->enabled && instance->compensationSamples == 0)) {
     /* Delay is disabled, pass-through audio data */
     return HAL_OK;
   }
   
-  /* Process each sample through delay line */
-  for (uint32_t i = 0; i < size; i++) {
-    pData[i] = ProcessSampleWithDelay(channel, pData[i]);
-  }
+  /* Interpolation mode of this frame */
+  const uint8_t cubic = ParamSnapshot_Frame()->delayCubic;
+  
+  /* Process the block through the delay line, in place */
+  ProcessBlockWithDelay(instance, pData, pData, size, cubic);
   
   return HAL_OK;
 }
 
+/**
+  * @brief  Process one frame of an output through its delay line
+  * @note   Pipeline entry point, see Delay_Process()
+  * @param  outputChannel: Output channel index (0-3)
+  * @param  pAudioBuffer: Audio buffer, processed in place
+  * @retval None
+  */
+void DSP_Delay_Process(uint8_t outputChannel, AudioBuffer_TypeDef *pAudioBuffer)
+{
+  if (outputChannel >= MAX_DELAY_CHANNELS || pAudioBuffer == NULL) {
+    return;
+  }
+  
+  Delay_Process(outputChannel, pAudioBuffer->samples[outputChannel], AUDIO_FRAME_SIZE);
+}
+
 /**
   * @brief  Process one frame of audio data through delay line
   * @param  channel: Output channel index (0-3)
@@ -78,28 +98,27 @@ HAL_StatusTypeDef Delay_ProcessFrame(uint8_t channel,
                                     AudioBuffer_TypeDef *outputBuffer)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || inputBuffer == NULL || outputBuffer == NULL) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || inputBuffer == NULL || outputBuffer == NULL) {
     DEBUG_PRINT("Delay_ProcessFrame: Invalid parameters\r\n");
     return HAL_ERROR;
   }
   
-  DelayInstance_TypeDef *instance = &delayInstances[channel];
-  
   /* Check if delay is enabled */
-  if (!instance->isActive || !instance->enabled) {
+  if (!instance->isActive || (!instance->enabled && instance->compensationSamples == 0)) {
     /* Delay is disabled, pass-through audio data */
     /* Copy input to output */
-    memcpy(outputBuffer->data[channel], inputBuffer->data[channel], 
-           sizeof(float) * inputBuffer->size);
+    memcpy(outputBuffer->samples[channel], inputBuffer->samples[channel], 
+           sizeof(float) * AUDIO_FRAME_SIZE);
     return HAL_OK;
   }
   
-  /* Process each sample in the frame */
-  for (uint32_t i = 0; i < inputBuffer->size; i++) {
-    outputBuffer->data[channel][i] = ProcessSampleWithDelay(
-      channel, inputBuffer->data[channel][i]
-    );
-  }
+  /* Interpolation mode of this frame */
+  const uint8_t cubic = ParamSnapshot_Frame()->delayCubic;
+  
+  /* Process the frame through the delay line */
+  ProcessBlockWithDelay(instance, inputBuffer->samples[channel], outputBuffer->samples[channel],
+                        AUDIO_FRAME_SIZE, cubic);
   
   return HAL_OK;
 }
@@ -113,27 +132,30 @@ HAL_StatusTypeDef Delay_ProcessFrame(uint8_t channel,
 HAL_StatusTypeDef Delay_SetTime(uint8_t channel, float delayMs)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
     DEBUG_PRINT("Delay_SetTime: Invalid channel %d\r\n", channel);
     return HAL_ERROR;
   }
   
-  if (delayMs < 0.0f || delayMs > delayInstances[channel].maxDelayMs) {
+  /* The line length depends on the storage format */
+  const float maxDelayMs = Delay_GetMaxDelayMs(channel);
+  if (delayMs < 0.0f || delayMs > maxDelayMs) {
     DEBUG_PRINT("Delay_SetTime: Invalid delay time %.2f ms (max: %.2f)\r\n", 
-                delayMs, delayInstances[channel].maxDelayMs);
+                delayMs, maxDelayMs);
     return HAL_ERROR;
   }
   
   /* Update delay settings */
-  delayInstances[channel].currentDelayMs = delayMs;
-  delayInstances[channel].delayUnit = DELAY_UNIT_MS;
+  instance->currentDelayMs = delayMs;
+  instance->delayUnit = DELAY_UNIT_MS;
   
   /* Calculate equivalent distance for reference */
-  delayInstances[channel].currentDelayDistance = 
+  instance->currentDelayDistance = 
     delayMs * SPEED_OF_SOUND_M_PER_SEC / 1000.0f * 100.0f; /* Convert to cm */
   
   /* Apply the new delay settings */
-  ApplyDelaySettings(channel);
+  Delay_ApplySettings(channel);
   
   return HAL_OK;
 }
@@ -148,7 +170,8 @@ HAL_StatusTypeDef Delay_SetTime(uint8_t channel, float delayMs)
 HAL_StatusTypeDef Delay_SetDistance(uint8_t channel, float distance, DelayUnit_TypeDef unit)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
     DEBUG_PRINT("Delay_SetDistance: Invalid channel %d\r\n", channel);
     return HAL_ERROR;
   }
@@ -159,22 +182,23 @@ HAL_StatusTypeDef Delay_SetDistance(uint8_t channel, float distance, DelayUnit_T
   }
   
   /* Convert distance to time */
-  float delayMs = ConvertDistanceToTime(distance, unit);
+  float delayMs = Delay_DistanceToMs(distance, unit);
   
   /* Check if resulting delay is within limits */
-  if (delayMs < 0.0f || delayMs > delayInstances[channel].maxDelayMs) {
+  const float maxDelayMs = Delay_GetMaxDelayMs(channel);
+  if (delayMs < 0.0f || delayMs > maxDelayMs) {
     DEBUG_PRINT("Delay_SetDistance: Resulting delay %.2f ms exceeds limit (max: %.2f)\r\n", 
-                delayMs, delayInstances[channel].maxDelayMs);
+                delayMs, maxDelayMs);
     return HAL_ERROR;
   }
   
   /* Update delay settings */
-  delayInstances[channel].currentDelayMs = delayMs;
-  delayInstances[channel].currentDelayDistance = distance;
-  delayInstances[channel].delayUnit = unit;
+  instance->currentDelayMs = delayMs;
+  instance->currentDelayDistance = distance;
+  instance->delayUnit = unit;
   
   /* Apply the new delay settings */
-  ApplyDelaySettings(channel);
+  Delay_ApplySettings(channel);
   
   return HAL_OK;
 }
@@ -188,13 +212,14 @@ HAL_StatusTypeDef Delay_SetDistance(uint8_t channel, float distance, DelayUnit_T
 HAL_StatusTypeDef Delay_SetPhaseInvert(uint8_t channel, uint8_t invert)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
     DEBUG_PRINT("Delay_SetPhaseInvert: Invalid channel %d\r\n", channel);
     return HAL_ERROR;
   }
   
   /* Update phase inversion setting */
-  delayInstances[channel].phaseInvert = invert ? 1 : 0;
+  instance->phaseInvert = invert ? 1 : 0;
   
   DEBUG_PRINT("Delay_SetPhaseInvert: Channel %d phase %s\r\n", 
               channel, invert ? "inverted" : "normal");
@@ -211,13 +236,24 @@ HAL_StatusTypeDef Delay_SetPhaseInvert(uint8_t channel, uint8_t invert)
 HAL_StatusTypeDef Delay_SetEnable(uint8_t channel, uint8_t enable)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
     DEBUG_PRINT("Delay_SetEnable: Invalid channel %d\r\n", channel);
     return HAL_ERROR;
   }
   
+  /* A running line costs a tap read per sample, check it fits */
+  CpuBudget_Load_TypeDef load;
+  FillDelayCpuLoad(channel, enable ? 1 : 0, delayCubicMode, &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_DELAY, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  
   /* Update enabled state */
-  delayInstances[channel].enabled = enable ? 1 : 0;
+  instance->enabled = enable ? 1 : 0;
+  
+  /* Recompute read offset, user delay is dropped while disabled */
+  Delay_ApplySettings(channel);
   
   DEBUG_PRINT("Delay_SetEnable: Channel %d delay %s\r\n", 
               channel, enable ? "enabled" : "disabled");
@@ -227,6 +263,8 @@ HAL_StatusTypeDef Delay_SetEnable(uint8_t channel, uint8_t enable)
 
 /**
   * @brief  Set interpolation mode for delay lines
+  * @note   Cubic taps cost more on every running line, the switch is
+  *         refused with HAL_BUSY when the frame budget cannot take it
   * @param  mode: Interpolation mode (linear or cubic)
   * @retval HAL status
   */
@@ -237,7 +275,21 @@ HAL_StatusTypeDef Delay_SetInterpolationMode(DelayInterpolation_TypeDef mode)
     return HAL_ERROR;
   }
   
-  interpolationMode = mode;
+  /* The mode is shared, so all lines are admitted together */
+  const uint8_t cubic = (mode == DELAY_INTERPOLATION_CUBIC) ? 1 : 0;
+  CpuBudget_Load_TypeDef loads[AUDIO_OUTPUT_CHANNELS];
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    const DelayInstance_TypeDef *instance = Delay_GetInstance(ch);
+    FillDelayCpuLoad(ch, (instance != NULL) ? instance->enabled : 0U, cubic, &loads[ch]);
+  }
+  if (CpuBudget_AdmitStage(CPUBUDGET_STAGE_DELAY, loads) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  delayCubicMode = cubic;
+  
+  /* Takes effect from the next audio frame */
+  ParamSnapshot_BeginUpdate()->delayCubic = cubic & delayCubicAllowed;
+  ParamSnapshot_Publish();
   
   DEBUG_PRINT("Delay_SetInterpolationMode: Set to %s\r\n", 
               mode == DELAY_INTERPOLATION_LINEAR ? "linear" : "cubic");
@@ -246,89 +298,151 @@ HAL_StatusTypeDef Delay_SetInterpolationMode(DelayInterpolation_TypeDef mode)
 }
 
 /**
-  * @brief  Process a single sample through the delay line
-  * @param  channel: Channel index
-  * @param  input: Input sample
-  * @retval Processed output sample
+  * @brief  Allow or forbid cubic interpolation regardless of the selected mode
+  * @note   The selected mode is kept and applies again once allowed
+  * @param  allowed: 0 forces linear interpolation
+  * @retval None
   */
-static float ProcessSampleWithDelay(uint8_t channel, float input)
+void Delay_SetCubicAllowed(uint8_t allowed)
 {
-  DelayInstance_TypeDef *instance = &delayInstances[channel];
-  float output;
-  
-  /* Store input sample in circular buffer */
-  instance->buffer[instance->writeIndex] = input;
-  
-  /* Calculate read position with fractional delay */
-  float readPos = (float)instance->writeIndex - instance->delaySamples;
-  
-  /* Handle buffer wrap-around */
-  while (readPos < 0) {
-    readPos += (float)instance->bufferSize;
-  }
-  
-  /* Split into integer and fractional parts */
-  int32_t readIndex = (int32_t)readPos;
-  float fraction = readPos - (float)readIndex;
+  delayCubicAllowed = allowed ? 1 : 0;
   
-  /* Ensure read index is within buffer bounds */
-  readIndex = ModuloBufferSize(readIndex, instance->bufferSize);
+  ParamSnapshot_BeginUpdate()->delayCubic = delayCubicMode & delayCubicAllowed;
+  ParamSnapshot_Publish();
+}
+
+/**
+  * @brief  Record the current cost of a delay line in the CPU budget
+  * @note   For setup and alignment changes that cannot be refused; user
+  *         changes are admitted by Delay_SetEnable and
+  *         Delay_SetInterpolationMode
+  * @param  channel: Output channel index (0-3)
+  * @retval None
+  */
+void Delay_ReportCpuLoad(uint8_t channel)
+{
+  CpuBudget_Load_TypeDef load;
   
-  /* Perform interpolation based on mode */
-  if (interpolationMode == DELAY_INTERPOLATION_LINEAR) {
-    output = InterpolateLinear(instance->buffer, instance->bufferSize, readIndex, fraction);
-  } else {
-    output = InterpolateCubic(instance->buffer, instance->bufferSize, readIndex, fraction);
+  if (channel >= MAX_DELAY_CHANNELS) {
+    return;
   }
   
-  /* Apply phase inversion if needed */
-  if (instance->phaseInvert) {
-    output = -output;
+  const DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  FillDelayCpuLoad(channel, (instance != NULL) ? instance->enabled : 0U, delayCubicMode, &load);
+  CpuBudget_SetLoad(CPUBUDGET_STAGE_DELAY, channel, &load);
+}
+
+/**
+  * @brief  Describe a delay line to the CPU cost model
+  * @note   Alignment delay keeps a line running even when the user delay
+  *         is off, the same test as Delay_Process
+  * @param  channel: Output channel index (0-3)
+  * @param  enabled: User delay enabled
+  * @param  cubic: Cubic interpolation selected
+  * @param  load: Load to fill
+  * @retval None
+  */
+static void FillDelayCpuLoad(uint8_t channel, uint8_t enabled, uint8_t cubic, CpuBudget_Load_TypeDef *load)
+{
+  const DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  
+  /* Lines are reported while Delay_Init sets them up, before they can be fetched */
+  load->active = (instance != NULL && instance->isActive &&
+                  (enabled || instance->compensationSamples > 0)) ? 1 : 0;
+  load->options = cubic ? CPUBUDGET_OPT_CUBIC : 0U;
+  load->units = 0;
+  load->parts = 0;
+}
+
+/**
+  * @brief  Run a block of samples through a delay line
+  * @note   Each chunk is stored first, then every tap the chunk needs is
+  *         decoded in one DelayStore_Read, so compact formats convert once
+  *         per sample on the way in and once on the way out
+  * @param  instance: Delay line
+  * @param  input: Input samples
+  * @param  output: Output samples, may be the same as input
+  * @param  size: Number of samples
+  * @param  cubic: 1 for cubic interpolation, 0 for linear
+  * @retval None
+  */
+static void ProcessBlockWithDelay(DelayInstance_TypeDef *instance, const float *input, float *output,
+                                  uint32_t size, uint8_t cubic)
+{
+  /* span[k] holds the sample at readIndex - 1 + k, cubic needs one before and two after */
+  float span[DELAY_CHUNK_SIZE + 3];
+  
+  /* Split the delay into whole samples and a fraction, same for the whole block */
+  const int32_t whole = (int32_t)instance->delaySamples;
+  const float frac = instance->delaySamples - (float)whole;
+  const float fraction = (frac > 0.0f) ? (1.0f - frac) : 0.0f;
+  const int32_t lag = (frac > 0.0f) ? whole + 1 : whole;
+  
+  while (size > 0) {
+    const uint32_t n = (size < DELAY_CHUNK_SIZE) ? size : DELAY_CHUNK_SIZE;
+    
+    /* Store input samples in the circular buffer */
+    DelayStore_Write(&instance->store, instance->writeIndex, input, n);
+    
+    /* Decode the taps of all n outputs */
+    DelayStore_Read(&instance->store, (int32_t)instance->writeIndex - lag - 1, span, n + 3);
+    
+    for (uint32_t i = 0; i < n; i++) {
+      float out;
+      
+      /* Perform interpolation based on mode */
+      if (!cubic) {
+        out = InterpolateLinear(&span[i + 1], fraction);
+      } else {
+        out = InterpolateCubic(&span[i], fraction);
+      }
+      
+      /* Apply phase inversion if needed */
+      if (instance->phaseInvert) {
+        out = -out;
+      }
+      
+      /* Apply low-pass filter for smoothing if needed */
+      out = out * (1.0f - instance->filterCoeff) + instance->prevSample * instance->filterCoeff;
+      instance->prevSample = out;
+      
+      output[i] = out;
+    }
+    
+    /* Update write index for the next chunk */
+    instance->writeIndex = (instance->writeIndex + n) % instance->bufferSize;
+    
+    input += n;
+    output += n;
+    size -= n;
   }
-  
-  /* Apply low-pass filter for smoothing if needed */
-  output = output * (1.0f - instance->filterCoeff) + instance->prevSample * instance->filterCoeff;
-  instance->prevSample = output;
-  
-  /* Update write index for next sample */
-  instance->writeIndex = ModuloBufferSize(instance->writeIndex + 1, instance->bufferSize);
-  
-  return output;
 }
 
 /**
   * @brief  Linear interpolation between samples
-  * @param  buffer: Sample buffer
-  * @param  bufferSize: Buffer size
-  * @param  readIndex: Integer read index
+  * @param  taps: Samples at the read position and the one after
   * @param  fraction: Fractional part of read position
   * @retval Interpolated sample
   */
-static float InterpolateLinear(float *buffer, uint32_t bufferSize, uint32_t readIndex, float fraction)
+static inline float InterpolateLinear(const float *taps, float fraction)
 {
-  /* Get two samples for linear interpolation */
-  float sample1 = buffer[readIndex];
-  float sample2 = buffer[ModuloBufferSize(readIndex + 1, bufferSize)];
-  
   /* Perform linear interpolation: y = y1 + fraction * (y2 - y1) */
-  return sample1 + fraction * (sample2 - sample1);
+  return taps[0] + fraction * (taps[1] - taps[0]);
 }
 
 /**
   * @brief  Cubic interpolation between samples (higher quality)
-  * @param  buffer: Sample buffer
-  * @param  bufferSize: Buffer size
-  * @param  readIndex: Integer read index
+  * @param  taps: One sample before the read position and three from it
   * @param  fraction: Fractional part of read position
   * @retval Interpolated sample
   */
-static float InterpolateCubic(float *buffer, uint32_t bufferSize, uint32_t readIndex, float fraction)
+static inline float InterpolateCubic(const float *taps, float fraction)
 {
   /* Get four samples for cubic interpolation */
-  float y0 = buffer[ModuloBufferSize(readIndex - 1, bufferSize)];
-  float y1 = buffer[readIndex];
-  float y2 = buffer[ModuloBufferSize(readIndex + 1, bufferSize)];
-  float y3 = buffer[ModuloBufferSize(readIndex + 2, bufferSize)];
+  float y0 = taps[0];
+  float y1 = taps[1];
+  float y2 = taps[2];
+  float y3 = taps[3];
   
   /* Cubic interpolation coefficients */
   float a0 = y3 - y2 - y0 + y1;
@@ -343,22 +457,6 @@ static float InterpolateCubic(float *buffer, uint32_t bufferSize, uint32_t readI
   return result;
 }
 
-/**
-  * @brief  Calculate modulo for circular buffer operations
-  * @param  index: Buffer index (can be negative)
-  * @param  bufferSize: Size of the buffer
-  * @retval Index wrapped to buffer bounds
-  */
-static inline uint32_t ModuloBufferSize(int32_t index, uint32_t bufferSize)
-{
-  /* Handle negative indices for circular buffer */
-  if (index < 0) {
-    index += bufferSize;
-  }
-  
-  return index % bufferSize;
-}
-
 /**
   * @brief  Get current delay settings for display or configuration
   * @param  channel: Output channel index (0-3)
@@ -368,20 +466,21 @@ static inline uint32_t ModuloBufferSize(int32_t index, uint32_t bufferSize)
 HAL_StatusTypeDef Delay_GetSettings(uint8_t channel, DelayChannelConfig_TypeDef *config)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive || config == NULL) {
+  const DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive || config == NULL) {
     return HAL_ERROR;
   }
   
   /* Fill configuration structure with current settings */
-  config->enabled = delayInstances[channel].enabled;
-  config->delayUnit = delayInstances[channel].delayUnit;
-  config->phaseInvert = delayInstances[channel].phaseInvert;
+  config->enabled = instance->enabled;
+  config->delayUnit = instance->delayUnit;
+  config->phaseInvert = instance->phaseInvert;
   
   /* Return the value in proper units */
   if (config->delayUnit == DELAY_UNIT_MS) {
-    config->delayValue = delayInstances[channel].currentDelayMs;
+    config->delayValue = instance->currentDelayMs;
   } else {
-    config->delayValue = delayInstances[channel].currentDelayDistance;
+    config->delayValue = instance->currentDelayDistance;
   }
   
   return HAL_OK;
@@ -395,38 +494,52 @@ HAL_StatusTypeDef Delay_GetSettings(uint8_t channel, DelayChannelConfig_TypeDef
 HAL_StatusTypeDef Delay_FlushBuffer(uint8_t channel)
 {
   /* Validate parameters */
-  if (channel >= MAX_DELAY_CHANNELS || !delayInstances[channel].isActive) {
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
     DEBUG_PRINT("Delay_FlushBuffer: Invalid channel %d\r\n", channel);
     return HAL_ERROR;
   }
   
-  /* Clear delay buffer to zeros */
-  memset(delayInstances[channel].buffer, 0, 
-         delayInstances[channel].bufferSize * sizeof(float));
-  
-  /* Reset state variables */
-  delayInstances[channel].writeIndex = 0;
-  delayInstances[channel].prevSample = 0.0f;
+  /* Clear delay buffer and state variables */
+  Delay_ResetChannel(channel);
   
   DEBUG_PRINT("Delay_FlushBuffer: Channel %d buffer cleared\r\n", channel);
   
   return HAL_OK;
 }
 
+/**
+  * @brief  Clear the line and interpolation history of a channel, keeping its settings
+  * @note   No logging, safe from the audio path (health recovery)
+  * @param  channel: Output channel index (0-3)
+  * @retval None
+  */
+void Delay_ResetChannel(uint8_t channel)
+{
+  DelayInstance_TypeDef *instance = Delay_GetInstance(channel);
+  if (instance == NULL || !instance->isActive) {
+    return;
+  }
+  
+  DelayStore_Clear(&instance->store);
+  instance->writeIndex = 0;
+  instance->prevSample = 0.0f;
+}
+
 /**
   * @brief  Reset all delay buffers and state variables
   * @retval HAL status
   */
 HAL_StatusTypeDef Delay_ResetAll(void)
 {
-  if (!isDelaySystemInitialized) {
+  if (Delay_GetInstance(0) == NULL) {
     DEBUG_PRINT("Delay_ResetAll: Delay system not initialized\r\n");
     return HAL_ERROR;
   }
   
   /* Reset all channels */
   for (uint8_t i = 0; i < MAX_DELAY_CHANNELS; i++) {
-    if (delayInstances[i].isActive) {
+    if (Delay_GetInstance(i)->isActive) {
       Delay_FlushBuffer(i);
     }
   }
@@ -0,0 +1,448 @@
+/**
+  ******************************************************************************
+  * @file           : delay_store.c
+  * @brief          : Compact sample storage for delay lines
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Every access is split into runs that do not wrap, each run goes through
+  * one tight conversion loop for the format. INT16_BLOCK lengths are a
+  * multiple of DELAY_STORE_BLOCK so a block never straddles the wrap; a
+  * write that covers only part of a block decodes it, merges and re-encodes
+  * it with a new exponent.
+  *
+  * FP16 uses the VCVTB half conversions when the compiler provides __fp16
+  * (-mfp16-format=ieee), a bit-exact software conversion otherwise.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "delay_store.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define DELAY_STORE_INT24_SCALE     8388607.0f
+#define DELAY_STORE_INT16_MAX       32767.0f
+#define DELAY_STORE_EXP_MAX         15      /* Block gain up to 2^15 */
+
+/* Private macro -------------------------------------------------------------*/
+#define DELAY_STORE_MIN(a, b)       (((a) < (b)) ? (a) : (b))
+
+/* Private function prototypes -----------------------------------------------*/
+static void DelayStore_EncodeRun(DelayStore_TypeDef *store, uint32_t pos, const float *src, uint32_t n);
+static void DelayStore_DecodeRun(const DelayStore_TypeDef *store, uint32_t pos, float *dst, uint32_t n);
+static void DelayStore_EncodeBlock(int16_t *mant, uint8_t *exponent, const float *src);
+static void DelayStore_DecodeBlock(const int16_t *mant, uint8_t exponent, float *dst, uint32_t first,
+                                   uint32_t n);
+#if !defined(__ARM_FP16_FORMAT_IEEE)
+static uint16_t DelayStore_FloatToHalf(float x);
+static float DelayStore_HalfToFloat(uint16_t h);
+#endif
+
+/**
+  * @brief  Number of samples a memory block holds in a format
+  * @param  format: Storage format
+  * @param  bytes: Memory size in bytes
+  * @retval Capacity in samples
+  */
+uint32_t DelayStore_Capacity(DelayStore_Format_TypeDef format, uint32_t bytes)
+{
+  switch (format) {
+    case DELAY_STORE_FLOAT32:
+      return bytes / sizeof(float);
+    case DELAY_STORE_INT24:
+      return bytes / 3U;
+    case DELAY_STORE_INT16_BLOCK:
+      return (bytes / (DELAY_STORE_BLOCK * sizeof(int16_t) + 1U)) * DELAY_STORE_BLOCK;
+    case DELAY_STORE_FP16:
+      return bytes / sizeof(uint16_t);
+    default:
+      return 0;
+  }
+}
+
+/**
+  * @brief  Set up a store over a memory block and clear it
+  * @param  store: Store to initialize
+  * @param  mem: Memory, 4-byte aligned
+  * @param  bytes: Memory size in bytes
+  * @param  format: Storage format
+  * @retval HAL_ERROR if the format is unknown or the memory holds no sample
+  */
+HAL_StatusTypeDef DelayStore_Init(DelayStore_TypeDef *store, void *mem, uint32_t bytes,
+                                  DelayStore_Format_TypeDef format)
+{
+  const uint32_t length = DelayStore_Capacity(format, bytes);
+
+  if (store == NULL || mem == NULL || length == 0U) {
+    return HAL_ERROR;
+  }
+
+  store->mem = (uint8_t *)mem;
+  store->bytes = bytes;
+  store->length = length;
+  store->format = (uint8_t)format;
+
+  DelayStore_Clear(store);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Fill the store with silence
+  * @param  store: Store to clear
+  * @retval None
+  */
+void DelayStore_Clear(DelayStore_TypeDef *store)
+{
+  /* All-zero bytes decode to 0.0 in every format */
+  memset(store->mem, 0, store->bytes);
+}
+
+/**
+  * @brief  Write samples, wrapping at the end of the store
+  * @param  store: Store to write
+  * @param  index: Position of the first sample
+  * @param  src: Samples to store
+  * @param  count: Number of samples, at most the store length
+  * @retval None
+  */
+void DelayStore_Write(DelayStore_TypeDef *store, uint32_t index, const float *src, uint32_t count)
+{
+  uint32_t pos = index % store->length;
+
+  while (count > 0U) {
+    const uint32_t n = DELAY_STORE_MIN(count, store->length - pos);
+
+    DelayStore_EncodeRun(store, pos, src, n);
+    src += n;
+    count -= n;
+    pos = 0;
+  }
+}
+
+/**
+  * @brief  Read samples, wrapping at both ends of the store
+  * @param  store: Store to read
+  * @param  index: Position of the first sample, may be negative
+  * @param  dst: Destination for the decoded samples
+  * @param  count: Number of samples, at most the store length
+  * @retval None
+  */
+void DelayStore_Read(const DelayStore_TypeDef *store, int32_t index, float *dst, uint32_t count)
+{
+  int32_t wrapped = index % (int32_t)store->length;
+  uint32_t pos;
+
+  if (wrapped < 0) {
+    wrapped += (int32_t)store->length;
+  }
+  pos = (uint32_t)wrapped;
+
+  while (count > 0U) {
+    const uint32_t n = DELAY_STORE_MIN(count, store->length - pos);
+
+    DelayStore_DecodeRun(store, pos, dst, n);
+    dst += n;
+    count -= n;
+    pos = 0;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Convert a run that does not wrap into the storage format
+  * @param  store: Store to write
+  * @param  pos: First sample position
+  * @param  src: Samples
+  * @param  n: Run length
+  * @retval None
+  */
+static void DelayStore_EncodeRun(DelayStore_TypeDef *store, uint32_t pos, const float *src, uint32_t n)
+{
+  switch (store->format) {
+    case DELAY_STORE_FLOAT32:
+      memcpy((float *)store->mem + pos, src, n * sizeof(float));
+      break;
+
+    case DELAY_STORE_INT24: {
+      uint8_t *p = store->mem + 3U * pos;
+
+      for (uint32_t i = 0; i < n; i++) {
+        float x = src[i];
+        int32_t v;
+
+        if (x > 1.0f) x = 1.0f;
+        if (x < -1.0f) x = -1.0f;
+        v = (int32_t)(x * DELAY_STORE_INT24_SCALE);
+
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p += 3;
+      }
+      break;
+    }
+
+    case DELAY_STORE_INT16_BLOCK: {
+      int16_t *mant = (int16_t *)store->mem;
+      uint8_t *exponents = (uint8_t *)(mant + store->length);
+
+      while (n > 0U) {
+        const uint32_t block = pos / DELAY_STORE_BLOCK;
+        const uint32_t first = pos % DELAY_STORE_BLOCK;
+        const uint32_t part = DELAY_STORE_MIN(n, DELAY_STORE_BLOCK - first);
+        int16_t *blockMant = mant + block * DELAY_STORE_BLOCK;
+
+        if (part == DELAY_STORE_BLOCK) {
+          DelayStore_EncodeBlock(blockMant, &exponents[block], src);
+        } else {
+          /* Partial block: merge with what it holds and pick a new exponent */
+          float tmp[DELAY_STORE_BLOCK];
+
+          DelayStore_DecodeBlock(blockMant, exponents[block], tmp, 0, DELAY_STORE_BLOCK);
+          memcpy(&tmp[first], src, part * sizeof(float));
+          DelayStore_EncodeBlock(blockMant, &exponents[block], tmp);
+        }
+
+        src += part;
+        pos += part;
+        n -= part;
+      }
+      break;
+    }
+
+    case DELAY_STORE_FP16: {
+      uint16_t *h = (uint16_t *)store->mem + pos;
+
+      for (uint32_t i = 0; i < n; i++) {
+#if defined(__ARM_FP16_FORMAT_IEEE)
+        __fp16 v = (__fp16)src[i];
+        memcpy(&h[i], &v, sizeof(h[i]));
+#else
+        h[i] = DelayStore_FloatToHalf(src[i]);
+#endif
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  Convert a run that does not wrap back to float
+  * @param  store: Store to read
+  * @param  pos: First sample position
+  * @param  dst: Destination
+  * @param  n: Run length
+  * @retval None
+  */
+static void DelayStore_DecodeRun(const DelayStore_TypeDef *store, uint32_t pos, float *dst, uint32_t n)
+{
+  switch (store->format) {
+    case DELAY_STORE_FLOAT32:
+      memcpy(dst, (const float *)store->mem + pos, n * sizeof(float));
+      break;
+
+    case DELAY_STORE_INT24: {
+      const uint8_t *p = store->mem + 3U * pos;
+      const float scale = 1.0f / DELAY_STORE_INT24_SCALE;
+
+      for (uint32_t i = 0; i < n; i++) {
+        /* Assemble in the top 24 bits, the arithmetic shift sign-extends */
+        const int32_t v = (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) |
+                                    ((uint32_t)p[2] << 24)) >> 8;
+
+        dst[i] = (float)v * scale;
+        p += 3;
+      }
+      break;
+    }
+
+    case DELAY_STORE_INT16_BLOCK: {
+      const int16_t *mant = (const int16_t *)store->mem;
+      const uint8_t *exponents = (const uint8_t *)(mant + store->length);
+
+      while (n > 0U) {
+        const uint32_t block = pos / DELAY_STORE_BLOCK;
+        const uint32_t first = pos % DELAY_STORE_BLOCK;
+        const uint32_t part = DELAY_STORE_MIN(n, DELAY_STORE_BLOCK - first);
+
+        DelayStore_DecodeBlock(mant + block * DELAY_STORE_BLOCK, exponents[block], dst, first, part);
+
+        dst += part;
+        pos += part;
+        n -= part;
+      }
+      break;
+    }
+
+    case DELAY_STORE_FP16: {
+      const uint16_t *h = (const uint16_t *)store->mem + pos;
+
+      for (uint32_t i = 0; i < n; i++) {
+#if defined(__ARM_FP16_FORMAT_IEEE)
+        __fp16 v;
+        memcpy(&v, &h[i], sizeof(v));
+        dst[i] = (float)v;
+#else
+        dst[i] = DelayStore_HalfToFloat(h[i]);
+#endif
+      }
+      break;
+    }
+
+    default:
+      memset(dst, 0, n * sizeof(float));
+      break;
+  }
+}
+
+/**
+  * @brief  Encode one full block with a shared exponent
+  * @note   The exponent scales the block peak just below int16 full scale,
+  *         peaks at or above 1.0 saturate
+  * @param  mant: Block mantissas
+  * @param  exponent: Block exponent
+  * @param  src: DELAY_STORE_BLOCK samples
+  * @retval None
+  */
+static void DelayStore_EncodeBlock(int16_t *mant, uint8_t *exponent, const float *src)
+{
+  float peak = 0.0f;
+  float scale;
+  int e = 0;
+
+  for (uint32_t i = 0; i < DELAY_STORE_BLOCK; i++) {
+    peak = fmaxf(peak, fabsf(src[i]));
+  }
+
+  if (peak > 0.0f && peak < 1.0f) {
+    /* peak = f * 2^e with f in [0.5, 1), e <= 0 */
+    (void)frexpf(peak, &e);
+    e = -e;
+    if (e > DELAY_STORE_EXP_MAX) {
+      e = DELAY_STORE_EXP_MAX;
+    }
+  } else {
+    e = 0;
+  }
+
+  scale = ldexpf(DELAY_STORE_INT16_MAX, e);
+
+  for (uint32_t i = 0; i < DELAY_STORE_BLOCK; i++) {
+    float v = src[i] * scale;
+
+    if (v > DELAY_STORE_INT16_MAX) v = DELAY_STORE_INT16_MAX;
+    if (v < -DELAY_STORE_INT16_MAX) v = -DELAY_STORE_INT16_MAX;
+    mant[i] = (int16_t)v;
+  }
+
+  *exponent = (uint8_t)e;
+}
+
+/**
+  * @brief  Decode part of a block
+  * @param  mant: Block mantissas
+  * @param  exponent: Block exponent
+  * @param  dst: Destination
+  * @param  first: First sample within the block
+  * @param  n: Samples to decode
+  * @retval None
+  */
+static void DelayStore_DecodeBlock(const int16_t *mant, uint8_t exponent, float *dst, uint32_t first,
+                                   uint32_t n)
+{
+  const float scale = ldexpf(1.0f / DELAY_STORE_INT16_MAX, -(int)exponent);
+
+  for (uint32_t i = 0; i < n; i++) {
+    dst[i] = (float)mant[first + i] * scale;
+  }
+}
+
+#if !defined(__ARM_FP16_FORMAT_IEEE)
+/**
+  * @brief  Float to IEEE half, round to nearest even
+  * @note   Overflow and NaN become infinity, both never occur after the limiter
+  * @param  x: Value
+  * @retval Half precision bits
+  */
+static uint16_t DelayStore_FloatToHalf(float x)
+{
+  uint32_t u, mant, half, rem;
+  uint32_t sign;
+  int32_t exp;
+
+  memcpy(&u, &x, sizeof(u));
+  sign = (u >> 16) & 0x8000U;
+  exp = (int32_t)((u >> 23) & 0xFFU) - 127 + 15;
+  mant = u & 0x7FFFFFU;
+
+  if (exp >= 31) {
+    return (uint16_t)(sign | 0x7C00U);
+  }
+
+  if (exp <= 0) {
+    /* Subnormal half: value = m * 2^-24 */
+    uint32_t shift, mid;
+
+    if (exp < -10) {
+      return (uint16_t)sign;
+    }
+    mant |= 0x800000U;
+    shift = (uint32_t)(14 - exp);
+    half = mant >> shift;
+    rem = mant & ((1U << shift) - 1U);
+    mid = 1U << (shift - 1U);
+    if (rem > mid || (rem == mid && (half & 1U))) {
+      half++;
+    }
+    return (uint16_t)(sign | half);
+  }
+
+  half = ((uint32_t)exp << 10) | (mant >> 13);
+  rem = mant & 0x1FFFU;
+  if (rem > 0x1000U || (rem == 0x1000U && (half & 1U))) {
+    /* A carry into the exponent is still the correctly rounded value */
+    half++;
+  }
+
+  return (uint16_t)(sign | half);
+}
+
+/**
+  * @brief  IEEE half to float
+  * @param  h: Half precision bits
+  * @retval Value
+  */
+static float DelayStore_HalfToFloat(uint16_t h)
+{
+  const uint32_t sign = ((uint32_t)h & 0x8000U) << 16;
+  const uint32_t exp = ((uint32_t)h >> 10) & 0x1FU;
+  const uint32_t mant = (uint32_t)h & 0x3FFU;
+  uint32_t u;
+  float x;
+
+  if (exp == 0U) {
+    /* Zero or subnormal */
+    x = (float)mant * 5.9604645e-8f;
+    return (sign != 0U) ? -x : x;
+  }
+
+  if (exp == 31U) {
+    u = sign | 0x7F800000U | (mant << 13);
+  } else {
+    u = sign | ((exp + 112U) << 23) | (mant << 13);
+  }
+
+  memcpy(&x, &u, sizeof(x));
+  return x;
+}
+#endif /* !__ARM_FP16_FORMAT_IEEE */
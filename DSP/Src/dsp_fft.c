@@ -0,0 +1,268 @@
+/**
+  ******************************************************************************
+  * @file           : dsp_fft.c
+  * @brief          : Radix-2 real FFT with pass-level stepping
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * A real block x of n samples is viewed as n/2 complex values
+  * z[m] = x[2m] + j*x[2m+1]. The complex FFT is decimation in time after a
+  * bit-reversal permutation; RealSplit turns Z into the packed spectrum of x
+  * and RealMerge undoes it before the inverse passes. All sizes share one
+  * twiddle table computed for DSP_FFT_MAX_SIZE.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dsp_fft.h"
+#include "dsp_common.h"
+
+/* Private variables ---------------------------------------------------------*/
+/* e^(-j*2*pi*k/DSP_FFT_MAX_SIZE) for k < DSP_FFT_MAX_SIZE/2, as {cos, sin} */
+static float twiddle[DSP_FFT_MAX_SIZE];
+static uint8_t twiddleReady = 0;
+
+/**
+  * @brief  Compute the shared twiddle table
+  * @retval None
+  */
+void DSP_FFT_Init(void)
+{
+  if (twiddleReady) {
+    return;
+  }
+
+  for (uint32_t k = 0; k < DSP_FFT_MAX_SIZE / 2U; k++) {
+    float phase = -DSP_TWOPI * (float)k / (float)DSP_FFT_MAX_SIZE;
+    twiddle[2U * k] = cosf(phase);
+    twiddle[2U * k + 1U] = sinf(phase);
+  }
+
+  twiddleReady = 1;
+}
+
+/**
+  * @brief  Check that a real transform size is supported
+  * @param  n: Real transform size
+  * @retval 1 if n is a power of two within the supported range
+  */
+uint8_t DSP_FFT_IsValidSize(uint32_t n)
+{
+  return (n >= DSP_FFT_MIN_SIZE && n <= DSP_FFT_MAX_SIZE && (n & (n - 1U)) == 0U) ? 1 : 0;
+}
+
+/**
+  * @brief  Number of butterfly passes of the complex FFT behind size n
+  * @param  n: Real transform size
+  * @retval log2(n/2)
+  */
+uint8_t DSP_FFT_NumPasses(uint32_t n)
+{
+  uint8_t passes = 0;
+
+  for (uint32_t m = n / 2U; m > 1U; m >>= 1) {
+    passes++;
+  }
+
+  return passes;
+}
+
+/**
+  * @brief  Bit-reversal permutation of the n/2 complex values
+  * @param  data: Interleaved complex buffer (n floats)
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_BitReverse(float *data, uint32_t n)
+{
+  const uint32_t m = n / 2U;
+  uint32_t j = 0;
+
+  for (uint32_t i = 0; i < m - 1U; i++) {
+    if (i < j) {
+      float re = data[2U * i];
+      float im = data[2U * i + 1U];
+      data[2U * i] = data[2U * j];
+      data[2U * i + 1U] = data[2U * j + 1U];
+      data[2U * j] = re;
+      data[2U * j + 1U] = im;
+    }
+
+    uint32_t bit = m >> 1;
+    while (j & bit) {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j |= bit;
+  }
+}
+
+/**
+  * @brief  One radix-2 butterfly pass of the complex FFT
+  * @param  data: Interleaved complex buffer in bit-reversed order (n floats)
+  * @param  n: Real transform size
+  * @param  pass: Pass index, 0 to DSP_FFT_NumPasses(n) - 1
+  * @param  direction: DSP_FFT_FORWARD or DSP_FFT_INVERSE
+  * @retval None
+  */
+void DSP_FFT_Pass(float *data, uint32_t n, uint8_t pass, uint8_t direction)
+{
+  const uint32_t m = n / 2U;
+  const uint32_t half = 1UL << pass;
+  const uint32_t span = half << 1;
+  const uint32_t stride = DSP_FFT_MAX_SIZE / span;
+  const float sign = (direction == DSP_FFT_INVERSE) ? -1.0f : 1.0f;
+
+  for (uint32_t k = 0; k < half; k++) {
+    const float wr = twiddle[2U * k * stride];
+    const float wi = sign * twiddle[2U * k * stride + 1U];
+
+    for (uint32_t i = k; i < m; i += span) {
+      float *a = &data[2U * i];
+      float *b = &data[2U * (i + half)];
+      const float tr = wr * b[0] - wi * b[1];
+      const float ti = wr * b[1] + wi * b[0];
+
+      b[0] = a[0] - tr;
+      b[1] = a[1] - ti;
+      a[0] += tr;
+      a[1] += ti;
+    }
+  }
+}
+
+/**
+  * @brief  Convert the half-size complex spectrum into the packed real spectrum
+  * @param  data: Complex FFT output (n floats), packed spectrum on return
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_RealSplit(float *data, uint32_t n)
+{
+  const uint32_t m = n / 2U;
+  const uint32_t stride = DSP_FFT_MAX_SIZE / n;
+  const float z0r = data[0];
+  const float z0i = data[1];
+
+  /* DC and Nyquist are real, packed into the first complex slot */
+  data[0] = z0r + z0i;
+  data[1] = z0r - z0i;
+
+  for (uint32_t k = 1; k <= m / 2U; k++) {
+    float *zk = &data[2U * k];
+    float *zm = &data[2U * (m - k)];
+    const float wr = twiddle[2U * k * stride];
+    const float wi = twiddle[2U * k * stride + 1U];
+
+    /* E = (Z[k] + conj Z[m-k]) / 2, O = -j (Z[k] - conj Z[m-k]) / 2 */
+    const float er = 0.5f * (zk[0] + zm[0]);
+    const float ei = 0.5f * (zk[1] - zm[1]);
+    const float or_ = 0.5f * (zk[1] + zm[1]);
+    const float oi = -0.5f * (zk[0] - zm[0]);
+
+    /* X[k] = E + W O, X[m-k] = conj(E - W O) */
+    const float tr = wr * or_ - wi * oi;
+    const float ti = wr * oi + wi * or_;
+
+    zk[0] = er + tr;
+    zk[1] = ei + ti;
+    zm[0] = er - tr;
+    zm[1] = ti - ei;
+  }
+}
+
+/**
+  * @brief  Convert a packed real spectrum back into the half-size complex spectrum
+  * @note   Exact inverse of DSP_FFT_RealSplit
+  * @param  data: Packed spectrum (n floats), complex spectrum on return
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_RealMerge(float *data, uint32_t n)
+{
+  const uint32_t m = n / 2U;
+  const uint32_t stride = DSP_FFT_MAX_SIZE / n;
+  const float x0 = data[0];
+  const float xm = data[1];
+
+  data[0] = 0.5f * (x0 + xm);
+  data[1] = 0.5f * (x0 - xm);
+
+  for (uint32_t k = 1; k <= m / 2U; k++) {
+    float *xk = &data[2U * k];
+    float *xr = &data[2U * (m - k)];
+    const float wr = twiddle[2U * k * stride];
+    const float wi = twiddle[2U * k * stride + 1U];
+
+    /* E = (X[k] + conj X[m-k]) / 2, O = (X[k] - conj X[m-k]) conj(W) / 2 */
+    const float er = 0.5f * (xk[0] + xr[0]);
+    const float ei = 0.5f * (xk[1] - xr[1]);
+    const float dr = 0.5f * (xk[0] - xr[0]);
+    const float di = 0.5f * (xk[1] + xr[1]);
+    const float or_ = dr * wr + di * wi;
+    const float oi = di * wr - dr * wi;
+
+    /* Z[k] = E + j O, Z[m-k] = conj E + j conj O */
+    xk[0] = er - oi;
+    xk[1] = ei + or_;
+    xr[0] = er + oi;
+    xr[1] = or_ - ei;
+  }
+}
+
+/**
+  * @brief  In-place forward real FFT
+  * @param  data: Real block in, packed spectrum out (n floats)
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_RealForward(float *data, uint32_t n)
+{
+  const uint8_t passes = DSP_FFT_NumPasses(n);
+
+  DSP_FFT_BitReverse(data, n);
+  for (uint8_t p = 0; p < passes; p++) {
+    DSP_FFT_Pass(data, n, p, DSP_FFT_FORWARD);
+  }
+  DSP_FFT_RealSplit(data, n);
+}
+
+/**
+  * @brief  In-place inverse real FFT
+  * @note   Output is scaled by n/2, callers fold 2/n into their data
+  * @param  data: Packed spectrum in, real block out (n floats)
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_RealInverse(float *data, uint32_t n)
+{
+  const uint8_t passes = DSP_FFT_NumPasses(n);
+
+  DSP_FFT_RealMerge(data, n);
+  DSP_FFT_BitReverse(data, n);
+  for (uint8_t p = 0; p < passes; p++) {
+    DSP_FFT_Pass(data, n, p, DSP_FFT_INVERSE);
+  }
+}
+
+/**
+  * @brief  Accumulate the product of two packed spectra
+  * @param  acc: Packed accumulator (n floats)
+  * @param  a: Packed spectrum
+  * @param  b: Packed spectrum
+  * @param  n: Real transform size
+  * @retval None
+  */
+void DSP_FFT_MultiplyAccumulate(float *acc, const float *a, const float *b, uint32_t n)
+{
+  acc[0] += a[0] * b[0];
+  acc[1] += a[1] * b[1];
+
+  for (uint32_t i = 2; i < n; i += 2U) {
+    acc[i] += a[i] * b[i] - a[i + 1U] * b[i + 1U];
+    acc[i + 1U] += a[i] * b[i + 1U] + a[i + 1U] * b[i];
+  }
+}
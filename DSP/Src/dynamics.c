@@ -0,0 +1,654 @@
+/**
+  ******************************************************************************
+  * @file           : dynamics.c
+  * @brief          : Multi-channel dynamics engine
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Parameters and state of all channels live in one structure of arrays.
+  * The gain computer works in the log domain with polynomial log2/exp2
+  * approximations (< 0.03 dB error), so the per-sample cost is a few
+  * multiply-adds instead of logf()/powf() calls.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dynamics.h"
+#include "cpu_budget.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define DYNAMICS_RMS_WINDOW_MS      10.0f     /* RMS detector averaging time */
+#define DYNAMICS_DB_PER_LOG2        6.0205999f  /* 20 * log10(2) */
+#define DYNAMICS_LOG2_PER_DB        0.1660964f  /* 1 / (20 * log10(2)) */
+#define DYNAMICS_MS_FLOOR           1.0e-20f  /* Mean square floor (-200 dB) */
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  Derived coefficients and state of every channel
+  * @note   Slopes are attenuation per dB past the threshold; knee coefficients
+  *         are slope / (2 * kneeWidth) for the quadratic knee segment
+  */
+typedef struct {
+  /* Gain computer */
+  float upperThreshold[AUDIO_OUTPUT_CHANNELS];
+  float upperSlope[AUDIO_OUTPUT_CHANNELS];
+  float upperKneeCoeff[AUDIO_OUTPUT_CHANNELS];
+  float lowerThreshold[AUDIO_OUTPUT_CHANNELS];
+  float lowerSlope[AUDIO_OUTPUT_CHANNELS];
+  float lowerKneeCoeff[AUDIO_OUTPUT_CHANNELS];
+  float halfKnee[AUDIO_OUTPUT_CHANNELS];
+  float range[AUDIO_OUTPUT_CHANNELS];
+  float makeup[AUDIO_OUTPUT_CHANNELS];
+  /* Ballistics */
+  float attackCoeff[AUDIO_OUTPUT_CHANNELS];
+  float releaseCoeff[AUDIO_OUTPUT_CHANNELS];
+  float detectCoeff[AUDIO_OUTPUT_CHANNELS];  /* 1.0 turns the RMS detector into peak */
+  float attackBlock[AUDIO_OUTPUT_CHANNELS];  /* Ballistics over one control sub-block */
+  float releaseBlock[AUDIO_OUTPUT_CHANNELS];
+  uint32_t controlBlock;                     /* Samples per gain computer run */
+  /* State */
+  float meanSquare[AUDIO_OUTPUT_CHANNELS];
+  float upperGainDb[AUDIO_OUTPUT_CHANNELS];  /* Smoothed upper segment gain */
+  float lowerGainDb[AUDIO_OUTPUT_CHANNELS];  /* Smoothed lower segment gain */
+  uint8_t enabled[AUDIO_OUTPUT_CHANNELS];
+} DynamicsBank_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static DynamicsBank_TypeDef bank;
+static Dynamics_Params_TypeDef dynamicsParams[AUDIO_OUTPUT_CHANNELS];
+static float dynamicsSampleRate = (float)AUDIO_SAMPLE_RATE;
+
+/* Preset curves indexed by Dynamics_Mode_TypeDef */
+static const Dynamics_Params_TypeDef dynamicsPresets[DYNAMICS_MODE_COUNT] = {
+  /* upperThr  upperRatio            lowerThr  lowerRatio            knee  range   makeup attack release detector              enabled */
+  { -20.0f,    4.0f,                 -96.0f,   DYNAMICS_RATIO_OFF,   6.0f, -40.0f, 0.0f,  10.0f,  100.0f, DYNAMICS_DETECT_RMS,  1 },
+  {  -1.0f,    DYNAMICS_RATIO_LIMIT, -96.0f,   DYNAMICS_RATIO_OFF,   0.0f, -40.0f, 0.0f,  0.1f,   50.0f,  DYNAMICS_DETECT_PEAK, 1 },
+  {   0.0f,    DYNAMICS_RATIO_OFF,   -50.0f,   2.0f,                 6.0f, -40.0f, 0.0f,  1.0f,   150.0f, DYNAMICS_DETECT_RMS,  1 },
+  {   0.0f,    DYNAMICS_RATIO_OFF,   -60.0f,   DYNAMICS_RATIO_LIMIT, 0.0f, -80.0f, 0.0f,  0.5f,   200.0f, DYNAMICS_DETECT_PEAK, 1 }
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void Dynamics_UpdateCoefficients(uint8_t channel);
+static float Dynamics_TimeToCoeff(float timeMs);
+static inline float Dynamics_Segment(float over, float halfKnee, float slope, float kneeCoeff);
+static inline float Dynamics_FastLog2(float x);
+static inline float Dynamics_FastExp2(float p);
+static void Dynamics_ProcessSubBlocks(uint8_t channel, float *data, uint32_t blockSize);
+static void Dynamics_ProcessInterleaved(const uint8_t *active, uint32_t count,
+                                        float *const *data, uint32_t blockSize);
+static inline float Dynamics_ComputeGain(uint8_t channel, float levelDb, float attack, float release,
+                                         float *upperDb, float *lowerDb);
+static inline float Dynamics_ClampGain(uint8_t channel, float gainDb);
+
+/**
+  * @brief  Initialize all channels with the compressor preset, disabled
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void Dynamics_Init(float sampleRate)
+{
+  const CpuBudget_Load_TypeDef load = { 0U, 0U, 0U, 0U };
+
+  memset(&bank, 0, sizeof(bank));
+  bank.controlBlock = 1U;
+  dynamicsSampleRate = (sampleRate > 0.0f) ? sampleRate : (float)AUDIO_SAMPLE_RATE;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    dynamicsParams[ch] = dynamicsPresets[DYNAMICS_MODE_COMPRESSOR];
+    dynamicsParams[ch].enabled = 0;
+    Dynamics_UpdateCoefficients(ch);
+    Dynamics_ResetChannel(ch);
+    CpuBudget_SetLoad(CPUBUDGET_STAGE_COMPRESSOR, ch, &load);
+  }
+
+  DEBUG_PRINT("Dynamics engine initialized at %.0f Hz\r\n", dynamicsSampleRate);
+}
+
+/**
+  * @brief  Change sample rate and recompute time constants
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Dynamics_SetSampleRate(float sampleRate)
+{
+  if (sampleRate <= 0.0f) {
+    return HAL_ERROR;
+  }
+
+  dynamicsSampleRate = sampleRate;
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    Dynamics_UpdateCoefficients(ch);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the default curve of a mode
+  * @param  mode: Curve preset
+  * @param  params: Pointer to store the preset
+  * @retval None
+  */
+void Dynamics_GetPreset(Dynamics_Mode_TypeDef mode, Dynamics_Params_TypeDef *params)
+{
+  if (params == NULL) {
+    return;
+  }
+
+  if (mode >= DYNAMICS_MODE_COUNT) {
+    mode = DYNAMICS_MODE_COMPRESSOR;
+  }
+
+  *params = dynamicsPresets[mode];
+}
+
+/**
+  * @brief  Set curve and ballistics of a channel
+  * @param  channel: Output channel (0-3)
+  * @param  params: Pointer to parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Dynamics_SetParams(uint8_t channel, const Dynamics_Params_TypeDef *params)
+{
+  CpuBudget_Load_TypeDef load = { 0U, 0U, 0U, 0U };
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || params == NULL) {
+    DEBUG_PRINT("Dynamics_SetParams: Invalid parameters\r\n");
+    return HAL_ERROR;
+  }
+
+  if (params->upperRatio < DYNAMICS_RATIO_OFF || params->lowerRatio < DYNAMICS_RATIO_OFF ||
+      params->kneeWidthDb < 0.0f || params->rangeDb > 0.0f) {
+    DEBUG_PRINT("Dynamics_SetParams: Curve out of range on channel %d\r\n", channel);
+    return HAL_ERROR;
+  }
+
+  load.active = params->enabled ? 1U : 0U;
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_COMPRESSOR, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+
+  dynamicsParams[channel] = *params;
+  if (dynamicsParams[channel].rangeDb < DYNAMICS_MIN_RANGE_DB) {
+    dynamicsParams[channel].rangeDb = DYNAMICS_MIN_RANGE_DB;
+  }
+  if (dynamicsParams[channel].lowerThresholdDb > dynamicsParams[channel].upperThresholdDb) {
+    dynamicsParams[channel].lowerThresholdDb = dynamicsParams[channel].upperThresholdDb;
+  }
+
+  Dynamics_UpdateCoefficients(channel);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get curve and ballistics of a channel
+  * @param  channel: Output channel (0-3)
+  * @param  params: Pointer to store parameters
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Dynamics_GetParams(uint8_t channel, Dynamics_Params_TypeDef *params)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || params == NULL) {
+    return HAL_ERROR;
+  }
+
+  *params = dynamicsParams[channel];
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Enable or bypass a channel
+  * @param  channel: Output channel (0-3)
+  * @param  enabled: 1 to enable, 0 to bypass
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Dynamics_SetEnabled(uint8_t channel, uint8_t enabled)
+{
+  CpuBudget_Load_TypeDef load = { 0U, 0U, 0U, 0U };
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
+  }
+
+  load.active = enabled ? 1U : 0U;
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_COMPRESSOR, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+
+  /* Start from unity gain so re-enabling does not jump */
+  if (enabled && !bank.enabled[channel]) {
+    Dynamics_ResetChannel(channel);
+  }
+
+  dynamicsParams[channel].enabled = enabled ? 1 : 0;
+  bank.enabled[channel] = dynamicsParams[channel].enabled;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get enable state of a channel
+  * @param  channel: Output channel (0-3)
+  * @retval 1 if enabled, 0 otherwise
+  */
+uint8_t Dynamics_GetEnabled(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return 0;
+  }
+
+  return bank.enabled[channel];
+}
+
+/**
+  * @brief  Run the gain computer once per sub-block instead of per sample
+  * @note   Detection stays per sample (peak mode takes the sub-block maximum),
+  *         the gain is ramped across each sub-block. Saves the log/exp of
+  *         all but one sample per sub-block at the cost of a slightly later
+  *         attack. Used by the quality scaler under overload.
+  * @param  samples: Sub-block length, power of two up to DYNAMICS_MAX_CONTROL_BLOCK
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Dynamics_SetControlBlock(uint8_t samples)
+{
+  if (samples == 0U || samples > DYNAMICS_MAX_CONTROL_BLOCK || (samples & (samples - 1U)) != 0U) {
+    return HAL_ERROR;
+  }
+
+  bank.controlBlock = samples;
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    bank.attackBlock[ch] = powf(bank.attackCoeff[ch], (float)samples);
+    bank.releaseBlock[ch] = powf(bank.releaseCoeff[ch], (float)samples);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the gain computer sub-block length
+  * @retval Samples per gain computer run, 1 at full quality
+  */
+uint8_t Dynamics_GetControlBlock(void)
+{
+  return (uint8_t)bank.controlBlock;
+}
+
+/**
+  * @brief  Clear detector and gain state of a channel
+  * @param  channel: Output channel (0-3)
+  * @retval None
+  */
+void Dynamics_ResetChannel(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return;
+  }
+
+  bank.meanSquare[channel] = 0.0f;
+  bank.upperGainDb[channel] = 0.0f;
+  bank.lowerGainDb[channel] = 0.0f;
+}
+
+/**
+  * @brief  Evaluate the static curve of a channel
+  * @note   Used for curve display; includes makeup gain
+  * @param  channel: Output channel (0-3)
+  * @param  levelDb: Detector level in dBFS
+  * @retval Gain in dB
+  */
+float Dynamics_GetCurveGain(uint8_t channel, float levelDb)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return 0.0f;
+  }
+
+  float gain = -Dynamics_Segment(levelDb - bank.upperThreshold[channel], bank.halfKnee[channel],
+                                 bank.upperSlope[channel], bank.upperKneeCoeff[channel])
+               -Dynamics_Segment(bank.lowerThreshold[channel] - levelDb, bank.halfKnee[channel],
+                                 bank.lowerSlope[channel], bank.lowerKneeCoeff[channel]);
+  if (gain < bank.range[channel]) {
+    gain = bank.range[channel];
+  }
+
+  return gain + bank.makeup[channel];
+}
+
+/**
+  * @brief  Get current gain reduction of a channel
+  * @param  channel: Output channel (0-3)
+  * @retval Gain reduction in dB (zero or negative)
+  */
+float Dynamics_GetGainReduction(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || !bank.enabled[channel]) {
+    return 0.0f;
+  }
+
+  return Dynamics_ClampGain(channel, bank.upperGainDb[channel] + bank.lowerGainDb[channel]);
+}
+
+/**
+  * @brief  Process one channel in place
+  * @param  channel: Output channel (0-3)
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples
+  * @retval None
+  */
+void Dynamics_ProcessChannel(uint8_t channel, float *data, uint32_t blockSize)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || data == NULL || !bank.enabled[channel]) {
+    return;
+  }
+
+  if (bank.controlBlock > 1U && (blockSize % bank.controlBlock) == 0U) {
+    Dynamics_ProcessSubBlocks(channel, data, blockSize);
+    return;
+  }
+
+  Dynamics_ProcessInterleaved(&channel, 1U, &data, blockSize);
+}
+
+/**
+  * @brief  Process all output channels in place
+  * @note   At full quality the enabled channels run side by side in one
+  *         sample loop; at a reduced control rate each channel runs its
+  *         own sub-block loop
+  * @param  data: Array of AUDIO_OUTPUT_CHANNELS sample buffers
+  * @param  blockSize: Number of samples per channel
+  * @retval None
+  */
+void Dynamics_ProcessBlock(float *const *data, uint32_t blockSize)
+{
+  uint8_t active[AUDIO_OUTPUT_CHANNELS];
+  float *buffers[AUDIO_OUTPUT_CHANNELS];
+  uint32_t count = 0;
+
+  if (data == NULL) {
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    if (bank.enabled[ch] && data[ch] != NULL) {
+      active[count] = ch;
+      buffers[count] = data[ch];
+      count++;
+    }
+  }
+
+  if (count == 0U) {
+    return;
+  }
+
+  if (bank.controlBlock > 1U && (blockSize % bank.controlBlock) == 0U) {
+    for (uint32_t k = 0; k < count; k++) {
+      Dynamics_ProcessSubBlocks(active[k], buffers[k], blockSize);
+    }
+    return;
+  }
+
+  Dynamics_ProcessInterleaved(active, count, buffers, blockSize);
+}
+
+/**
+  * @brief  Run the per-sample gain computer of several channels in one loop
+  * @note   State of the listed channels is held in locals for the whole
+  *         block; the inner loop walks the bank arrays across channels
+  * @param  active: Channels to process
+  * @param  count: Number of channels in active
+  * @param  data: Sample buffer of each listed channel
+  * @param  blockSize: Number of samples per channel
+  * @retval None
+  */
+static void Dynamics_ProcessInterleaved(const uint8_t *active, uint32_t count,
+                                        float *const *data, uint32_t blockSize)
+{
+  float ms[AUDIO_OUTPUT_CHANNELS];
+  float upperDb[AUDIO_OUTPUT_CHANNELS];
+  float lowerDb[AUDIO_OUTPUT_CHANNELS];
+
+  for (uint32_t k = 0; k < count; k++) {
+    ms[k] = bank.meanSquare[active[k]];
+    upperDb[k] = bank.upperGainDb[active[k]];
+    lowerDb[k] = bank.lowerGainDb[active[k]];
+  }
+
+  for (uint32_t i = 0; i < blockSize; i++) {
+    for (uint32_t k = 0; k < count; k++) {
+      const uint8_t ch = active[k];
+      const float x = data[k][i];
+
+      /* Level detector, mean square in dB (peak when detect == 1) */
+      ms[k] += bank.detectCoeff[ch] * (x * x - ms[k]);
+      const float levelDb = 0.5f * DYNAMICS_DB_PER_LOG2 * Dynamics_FastLog2(ms[k] + DYNAMICS_MS_FLOOR);
+
+      const float gainDb = Dynamics_ComputeGain(ch, levelDb, bank.attackCoeff[ch], bank.releaseCoeff[ch],
+                                                &upperDb[k], &lowerDb[k]);
+      data[k][i] = x * Dynamics_FastExp2(gainDb * DYNAMICS_LOG2_PER_DB);
+    }
+  }
+
+  for (uint32_t k = 0; k < count; k++) {
+    bank.meanSquare[active[k]] = ms[k];
+    bank.upperGainDb[active[k]] = upperDb[k];
+    bank.lowerGainDb[active[k]] = lowerDb[k];
+  }
+}
+
+/**
+  * @brief  Process one channel with the gain computer at control rate
+  * @param  channel: Output channel (0-3)
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples, a multiple of the control block
+  * @retval None
+  */
+static void Dynamics_ProcessSubBlocks(uint8_t channel, float *data, uint32_t blockSize)
+{
+  const uint32_t step = bank.controlBlock;
+  const float invStep = 1.0f / (float)step;
+  const float attack = bank.attackBlock[channel];
+  const float release = bank.releaseBlock[channel];
+  const float detect = bank.detectCoeff[channel];
+  const uint8_t peak = (detect >= 1.0f) ? 1U : 0U;
+  float ms = bank.meanSquare[channel];
+  float upperDb = bank.upperGainDb[channel];
+  float lowerDb = bank.lowerGainDb[channel];
+  float gain = Dynamics_FastExp2((Dynamics_ClampGain(channel, upperDb + lowerDb) + bank.makeup[channel]) *
+                                 DYNAMICS_LOG2_PER_DB);
+
+  for (uint32_t i = 0; i < blockSize; i += step) {
+    float *x = &data[i];
+    float maxSquare = 0.0f;
+
+    /* Detector per sample, a peak must not fall between two gain updates */
+    for (uint32_t k = 0; k < step; k++) {
+      const float square = x[k] * x[k];
+      ms += detect * (square - ms);
+      if (square > maxSquare) {
+        maxSquare = square;
+      }
+    }
+    const float level = peak ? maxSquare : ms;
+    const float levelDb = 0.5f * DYNAMICS_DB_PER_LOG2 * Dynamics_FastLog2(level + DYNAMICS_MS_FLOOR);
+
+    const float gainDb = Dynamics_ComputeGain(channel, levelDb, attack, release, &upperDb, &lowerDb);
+
+    /* Ramp to the new gain, steps in gain would be audible as zipper noise */
+    const float next = Dynamics_FastExp2(gainDb * DYNAMICS_LOG2_PER_DB);
+    const float delta = (next - gain) * invStep;
+    for (uint32_t k = 0; k < step; k++) {
+      gain += delta;
+      x[k] *= gain;
+    }
+    gain = next;
+  }
+
+  bank.meanSquare[channel] = ms;
+  bank.upperGainDb[channel] = upperDb;
+  bank.lowerGainDb[channel] = lowerDb;
+}
+
+/**
+  * @brief  Static curve and ballistics of a channel for one detector level
+  * @note   The two segments are smoothed apart so that each uses its attack
+  *         on its way into action: the upper one while its reduction grows,
+  *         the lower one while the gate or expander opens
+  * @param  channel: Output channel (0-3)
+  * @param  levelDb: Detector level in dBFS
+  * @param  attack: Attack coefficient for one gain computer run
+  * @param  release: Release coefficient for one gain computer run
+  * @param  upperDb: Smoothed upper segment gain, updated
+  * @param  lowerDb: Smoothed lower segment gain, updated
+  * @retval Gain in dB including makeup
+  */
+static inline float Dynamics_ComputeGain(uint8_t channel, float levelDb, float attack, float release,
+                                         float *upperDb, float *lowerDb)
+{
+  const float halfKnee = bank.halfKnee[channel];
+  const float range = bank.range[channel];
+  float upper = -Dynamics_Segment(levelDb - bank.upperThreshold[channel], halfKnee,
+                                  bank.upperSlope[channel], bank.upperKneeCoeff[channel]);
+  float lower = -Dynamics_Segment(bank.lowerThreshold[channel] - levelDb, halfKnee,
+                                  bank.lowerSlope[channel], bank.lowerKneeCoeff[channel]);
+
+  if (upper < range) {
+    upper = range;
+  }
+  if (lower < range) {
+    lower = range;
+  }
+
+  upper += ((upper < *upperDb) ? attack : release) * (*upperDb - upper);
+  lower += ((lower > *lowerDb) ? attack : release) * (*lowerDb - lower);
+  *upperDb = upper;
+  *lowerDb = lower;
+
+  return Dynamics_ClampGain(channel, upper + lower) + bank.makeup[channel];
+}
+
+/**
+  * @brief  Limit the combined curve gain of a channel to its range
+  * @param  channel: Output channel (0-3)
+  * @param  gainDb: Sum of both segment gains
+  * @retval Gain in dB, not below the range
+  */
+static inline float Dynamics_ClampGain(uint8_t channel, float gainDb)
+{
+  return (gainDb < bank.range[channel]) ? bank.range[channel] : gainDb;
+}
+
+/**
+  * @brief  Derive curve and ballistics coefficients of a channel
+  * @param  channel: Output channel (0-3)
+  * @retval None
+  */
+static void Dynamics_UpdateCoefficients(uint8_t channel)
+{
+  const Dynamics_Params_TypeDef *p = &dynamicsParams[channel];
+  float halfKnee = 0.5f * p->kneeWidthDb;
+
+  bank.upperThreshold[channel] = p->upperThresholdDb;
+  bank.upperSlope[channel] = 1.0f - (1.0f / p->upperRatio);
+  bank.lowerThreshold[channel] = p->lowerThresholdDb;
+  bank.lowerSlope[channel] = p->lowerRatio - 1.0f;
+  bank.halfKnee[channel] = halfKnee;
+
+  if (halfKnee > 0.0f) {
+    bank.upperKneeCoeff[channel] = bank.upperSlope[channel] / (4.0f * halfKnee);
+    bank.lowerKneeCoeff[channel] = bank.lowerSlope[channel] / (4.0f * halfKnee);
+  } else {
+    bank.upperKneeCoeff[channel] = 0.0f;
+    bank.lowerKneeCoeff[channel] = 0.0f;
+  }
+
+  bank.range[channel] = p->rangeDb;
+  bank.makeup[channel] = p->makeupGainDb;
+  bank.attackCoeff[channel] = Dynamics_TimeToCoeff(p->attackMs);
+  bank.releaseCoeff[channel] = Dynamics_TimeToCoeff(p->releaseMs);
+  bank.attackBlock[channel] = powf(bank.attackCoeff[channel], (float)bank.controlBlock);
+  bank.releaseBlock[channel] = powf(bank.releaseCoeff[channel], (float)bank.controlBlock);
+  bank.detectCoeff[channel] = (p->detector == DYNAMICS_DETECT_RMS) ?
+                              (1.0f - Dynamics_TimeToCoeff(DYNAMICS_RMS_WINDOW_MS)) : 1.0f;
+  bank.enabled[channel] = p->enabled;
+}
+
+/**
+  * @brief  One-pole smoothing coefficient for a time constant
+  * @param  timeMs: Time constant in milliseconds
+  * @retval Coefficient (0 = instantaneous)
+  */
+static float Dynamics_TimeToCoeff(float timeMs)
+{
+  if (timeMs <= 0.0f) {
+    return 0.0f;
+  }
+
+  return expf(-1000.0f / (timeMs * dynamicsSampleRate));
+}
+
+/**
+  * @brief  Attenuation of one curve segment
+  * @param  over: Level past the threshold in dB (positive inside the segment)
+  * @param  halfKnee: Half knee width in dB
+  * @param  slope: Attenuation per dB past the threshold
+  * @param  kneeCoeff: Quadratic knee coefficient
+  * @retval Attenuation in dB (zero or positive)
+  */
+static inline float Dynamics_Segment(float over, float halfKnee, float slope, float kneeCoeff)
+{
+  if (over <= -halfKnee) {
+    return 0.0f;
+  }
+  if (over >= halfKnee) {
+    return slope * over;
+  }
+
+  over += halfKnee;
+  return kneeCoeff * over * over;
+}
+
+/**
+  * @brief  Approximate log2 from exponent bits and a quadratic on the mantissa
+  * @param  x: Positive normal value
+  * @retval log2(x), absolute error below 0.005
+  */
+static inline float Dynamics_FastLog2(float x)
+{
+  union { float f; uint32_t i; } v = { x };
+  float e = (float)((int32_t)((v.i >> 23) & 0xFFU) - 128);
+
+  v.i = (v.i & 0x007FFFFFU) | 0x3F800000U;
+  return e + (-0.34484843f * v.f + 2.02466578f) * v.f - 0.67487759f;
+}
+
+/**
+  * @brief  Approximate 2^p from a cubic on the fraction and exponent bits
+  * @param  p: Exponent, clamped to -126
+  * @retval 2^p, relative error below 0.07%
+  */
+static inline float Dynamics_FastExp2(float p)
+{
+  union { float f; uint32_t i; } v;
+  int32_t w;
+  float z;
+
+  if (p < -126.0f) {
+    p = -126.0f;
+  }
+
+  w = (int32_t)p;
+  if ((float)w > p) {
+    w--;
+  }
+  z = p - (float)w;
+
+  v.i = (uint32_t)(w + 127) << 23;
+  return v.f * (1.0f + z * (0.69583356f + z * (0.22606716f + z * 0.07944023f)));
+}
@@ -0,0 +1,1447 @@
+/**
+  ******************************************************************************
+  * @file           : iir_fit.c
+  * @brief          : Background Steiglitz-McBride IIR fit of a correction curve
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The model lives in the warped delay y = (z^-1 - l)/(1 - l z^-1). With
+  * the poles p_k of the previous iteration as a basis,
+  * phi_k = 1 / (1 - p_k y), each iteration fits
+  *
+  *   d + sum c_k phi_k  ~  T (1 + sum e_k phi_k)
+  *
+  * in least squares. Both sides share the denominator A_prev, so this is
+  * the Steiglitz-McBride step min |A T - B|^2 / |A_prev|^2 in partial
+  * fractions (the vector fitting form), and the zeros of
+  * 1 + sum e_k phi_k are the new poles. Polynomial coefficients of order
+  * 16 and up lose every digit of a double to cancellation; this basis
+  * does not. After the last iteration d and c_k are refitted to the final
+  * poles alone, and the zeros of that model are the section numerators.
+  *
+  * The least-squares rows are rotated into a triangular factor one at a
+  * time (Givens), so the normal equations and their squared condition
+  * number never appear. Zeros come from Aberth iterations on the partial
+  * fractions. A warped root r maps to the z-plane factor
+  * (1 + l r) - (r + l) z^-1: poles are projected there and mapped back,
+  * and the sections are built there directly.
+  *
+  * The solver works in double. Every unit of work (one basis row, one
+  * rotation, one back-substitution row, one root update) stays within a
+  * few tens of thousands of cycles on the M4.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "iir_fit.h"
+#include "peq.h"
+#include "mem_plan.h"
+#include "coeff_batch.h"
+#include "dsp_fft.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define IIRFIT_CHUNK_POINTS         2U          /* Grid points per evaluation unit */
+#define IIRFIT_LOGMAG_CHUNK         16U         /* Cepstrum bins per unit of work */
+#define IIRFIT_ROOT_SWEEPS          200U
+#define IIRFIT_ROOT_TOLERANCE       1e-13
+#define IIRFIT_REAL_TOLERANCE       1e-9        /* Imaginary part of a real root */
+#define IIRFIT_CONVERGED            1e-6        /* Relative change of the residual */
+#define IIRFIT_RANK_TOLERANCE       1e-13       /* Smallest pivot, relative to the largest */
+#define IIRFIT_LEAD_FLOOR           1e-6        /* Smallest leading numerator coefficient */
+#define IIRFIT_START_DAMPING        0.01        /* Starting pole radius exp(-0.01 angle) */
+#define IIRFIT_SEED_OFFSET          0.02        /* Root finder starts this far inside the poles */
+#define IIRFIT_PI                   3.14159265358979323846
+
+#define IIRFIT_R(r, c)              matrix[(r) * IIRFIT_MAX_UNKNOWNS + (c)]
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  IIRFIT_PHASE_LOGMAG = 0,      /* Log magnitude on the warped cepstrum grid */
+  IIRFIT_PHASE_CEPSTRUM,
+  IIRFIT_PHASE_MINPHASE,
+  IIRFIT_PHASE_TARGET,          /* Minimum phase back onto the fit grid */
+  IIRFIT_PHASE_BASIS,           /* Least-squares rows of one grid point */
+  IIRFIT_PHASE_ROTATE,          /* Rows into the triangular factor */
+  IIRFIT_PHASE_SOLVE,
+  IIRFIT_PHASE_ROOTS,
+  IIRFIT_PHASE_PROJECT,
+  IIRFIT_PHASE_SECTIONS,
+  IIRFIT_PHASE_LEVELS,
+  IIRFIT_PHASE_EVAL,
+  IIRFIT_PHASE_APPLY
+} IIRFit_Phase_TypeDef;
+
+typedef enum {
+  IIRFIT_POLE_REAL = 0,
+  IIRFIT_POLE_UPPER,            /* Positive imaginary part, its conjugate follows */
+  IIRFIT_POLE_LOWER
+} IIRFit_PoleKind_TypeDef;
+
+typedef struct {
+  double re;
+  double im;
+} IIRFit_Complex_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static IIRFit_Config_TypeDef job;
+static IIRFit_State_TypeDef state = IIRFIT_IDLE;
+static IIRFit_Phase_TypeDef phase;
+
+static double *matrix;                              /* Triangular factor R, arena */
+static float *cepstrum;                             /* Minimum-phase completion, arena */
+
+static float magnitudeDb[IIRFIT_GRID_POINTS];
+static float targetRe[IIRFIT_GRID_POINTS];
+static float targetIm[IIRFIT_GRID_POINTS];
+static float weight[IIRFIT_GRID_POINTS];
+static double warped[IIRFIT_GRID_POINTS];           /* Warped angular frequency */
+static float weightSum;
+
+static uint8_t order;
+static uint8_t unknowns;                            /* Columns of the current problem */
+static uint8_t residuesOnly;                        /* Scoring pass, poles held fixed */
+static uint8_t iterations;
+static uint8_t projected;
+static uint8_t column;                              /* Next rotation */
+static uint8_t rowPart;                             /* 0 real row, 1 imaginary row */
+static uint16_t cursor;                             /* Grid point, row or root */
+static uint16_t sweeps;
+static double sweepStep;
+
+static IIRFit_Complex_TypeDef poles[IIRFIT_MAX_ORDER];      /* Warped, conjugates adjacent */
+static uint8_t poleKind[IIRFIT_MAX_ORDER];
+static IIRFit_Complex_TypeDef bestPoles[IIRFIT_MAX_ORDER];
+static uint8_t bestKind[IIRFIT_MAX_ORDER];
+static IIRFit_Complex_TypeDef residues[IIRFIT_MAX_ORDER];   /* Of the function being factored */
+static IIRFit_Complex_TypeDef bestResidues[IIRFIT_MAX_ORDER];
+static double constant;
+static double bestConstant;
+static IIRFit_Complex_TypeDef roots[IIRFIT_MAX_ORDER];      /* New poles, then the zeros */
+
+static double rowRe[IIRFIT_MAX_UNKNOWNS + 1U];      /* Basis row, the target last */
+static double rowIm[IIRFIT_MAX_UNKNOWNS + 1U];
+static double rhs[IIRFIT_MAX_UNKNOWNS];             /* Q'T, then the solution */
+static double pivotFloor;
+static double residual;                             /* Squared target left outside R */
+static double prevResidual;
+static double bestResidual;                         /* Output error of the best model */
+static double targetPower;
+
+static BiquadCoeff_t sections[IIRFIT_MAX_SECTIONS];
+static double sectionLog[IIRFIT_MAX_SECTIONS];
+static double crossSum;
+static double modelPower;
+static float outputGain;
+static float errorDb;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t IIRFit_RunUnit(void);
+static double IIRFit_Warp(double w, double lambda);
+static void IIRFit_SetTarget(uint32_t point, float phaseRad);
+static void IIRFit_LogMagChunk(void);
+static float IIRFit_GridDb(float pos);
+static void IIRFit_Cepstrum(void);
+static void IIRFit_MinPhase(void);
+static void IIRFit_TargetPhase(void);
+static void IIRFit_StartPoles(void);
+static void IIRFit_BeginPass(void);
+static void IIRFit_BasisRow(void);
+static void IIRFit_RotateStep(void);
+static void IIRFit_EndPass(void);
+static void IIRFit_SolveRow(void);
+static void IIRFit_Unpack(void);
+static void IIRFit_SeedRoots(void);
+static void IIRFit_RootStep(void);
+static void IIRFit_Project(void);
+static void IIRFit_Score(void);
+static void IIRFit_FinishIterations(void);
+static void IIRFit_BuildSections(void);
+static void IIRFit_LevelChunk(void);
+static void IIRFit_EvaluateChunk(void);
+static void IIRFit_Apply(void);
+static IIRFit_Complex_TypeDef IIRFit_SectionResponse(const BiquadCoeff_t *c, uint32_t point);
+static void IIRFit_SetPoles(IIRFit_Complex_TypeDef pairs[][2]);
+static void IIRFit_PairRoots(const IIRFit_Complex_TypeDef *r, IIRFit_Complex_TypeDef pairs[][2]);
+static void IIRFit_Quadratic(const IIRFit_Complex_TypeDef *pair, double *q, IIRFit_Complex_TypeDef *at);
+static IIRFit_Complex_TypeDef IIRFit_Mul(IIRFit_Complex_TypeDef a, IIRFit_Complex_TypeDef b);
+static IIRFit_Complex_TypeDef IIRFit_Div(IIRFit_Complex_TypeDef a, IIRFit_Complex_TypeDef b);
+static double IIRFit_Abs2(IIRFit_Complex_TypeDef a);
+
+/**
+  * @brief  Fill a configuration with usable defaults
+  * @param  config: Configuration to fill
+  * @retval None
+  */
+void IIRFit_GetDefaultConfig(IIRFit_Config_TypeDef *config)
+{
+  if (config == NULL) {
+    return;
+  }
+
+  config->channel = 0;
+  config->sections = 8;
+  config->maxIterations = 10;
+  config->apply = 1;
+  config->fitLowHz = 20.0f;
+  config->fitHighHz = 20000.0f;
+  config->warping = 0.9f;       /* Spreads the bass, where corrections are narrowest */
+}
+
+/**
+  * @brief  Frequency of a solver grid point
+  * @param  index: Grid point, 0 to IIRFIT_GRID_POINTS - 1
+  * @retval Frequency in Hz
+  */
+float IIRFit_GetGridFrequency(uint32_t index)
+{
+  const float span = log2f(IIRFIT_GRID_MAX_HZ / IIRFIT_GRID_MIN_HZ);
+
+  if (index >= IIRFIT_GRID_POINTS) {
+    index = IIRFIT_GRID_POINTS - 1U;
+  }
+
+  return IIRFIT_GRID_MIN_HZ * exp2f(span * (float)index / (float)(IIRFIT_GRID_POINTS - 1U));
+}
+
+/**
+  * @brief  Start a fit
+  * @note   Inputs are copied, the caller's arrays may be reused at once
+  * @param  config: Fit setup
+  * @param  targetDb: Target magnitude on the solver grid
+  * @param  targetPhase: Target phase in radians on the solver grid, NULL
+  *         for minimum phase
+  * @retval HAL_StatusTypeDef: HAL_BUSY if a fit is running or the memory
+  *         plan overlay is held by another mode
+  */
+HAL_StatusTypeDef IIRFit_Start(const IIRFit_Config_TypeDef *config, const float *targetDb,
+                               const float *targetPhase)
+{
+  const float fs = CoeffBatch_GetSampleRate();
+
+  if (config == NULL || targetDb == NULL || config->sections == 0U || config->maxIterations == 0U ||
+      config->sections > IIRFIT_MAX_SECTIONS || config->fitLowHz >= config->fitHighHz ||
+      fabsf(config->warping) >= 1.0f) {
+    return HAL_ERROR;
+  }
+
+  if (state == IIRFIT_SOLVING) {
+    return HAL_BUSY;
+  }
+
+  if (MemPlan_Enter(MEM_MODE_FIT) != HAL_OK) {
+    return HAL_BUSY;
+  }
+
+  matrix = (double *)MemPlan_GetBuffer(MEM_BUF_IIRFIT_MATRIX);
+  cepstrum = (float *)MemPlan_GetBuffer(MEM_BUF_IIRFIT_CEPSTRUM);
+
+  job = *config;
+  order = 2U * job.sections;
+  weightSum = 0.0f;
+
+  for (uint32_t i = 0; i < IIRFIT_GRID_POINTS; i++) {
+    const float f = IIRFit_GetGridFrequency(i);
+
+    warped[i] = IIRFit_Warp(2.0 * IIRFIT_PI * (double)f / (double)fs, job.warping);
+    magnitudeDb[i] = targetDb[i];
+    weight[i] = (f >= job.fitLowHz && f <= job.fitHighHz && f < 0.5f * fs) ? 1.0f : 0.0f;
+    weightSum += weight[i];
+
+    if (targetPhase != NULL) {
+      IIRFit_SetTarget(i, targetPhase[i]);
+    }
+  }
+
+  if (weightSum == 0.0f) {
+    return HAL_ERROR;
+  }
+
+  IIRFit_StartPoles();
+
+  bestResidual = HUGE_VAL;
+  prevResidual = 0.0;
+  residuesOnly = 0;
+  iterations = 0;
+  projected = 0;
+  errorDb = 0.0f;
+  outputGain = 1.0f;
+
+  if (targetPhase != NULL) {
+    IIRFit_BeginPass();
+  } else {
+    DSP_FFT_Init();
+    cursor = 0;
+    phase = IIRFIT_PHASE_LOGMAG;
+  }
+
+  state = IIRFIT_SOLVING;
+
+  DEBUG_PRINT("IIRFit: ch%d, %d sections, %s target\r\n", job.channel, job.sections,
+              (targetPhase != NULL) ? "complex" : "minimum-phase");
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Advance the running fit
+  * @note   Call from the main loop. At least one unit of work is done per
+  *         call, then units run until the budget is spent.
+  * @param  budgetCycles: CPU cycles this call may use
+  * @retval State after the slice
+  */
+IIRFit_State_TypeDef IIRFit_Service(uint32_t budgetCycles)
+{
+  const uint32_t start = DWT->CYCCNT;
+
+  while (state == IIRFIT_SOLVING) {
+    if (!IIRFit_RunUnit()) {
+      break;
+    }
+
+    if ((DWT->CYCCNT - start) >= budgetCycles) {
+      break;
+    }
+  }
+
+  return state;
+}
+
+/**
+  * @brief  Abandon the running fit, nothing is written
+  * @retval None
+  */
+void IIRFit_Cancel(void)
+{
+  if (state == IIRFIT_SOLVING) {
+    state = IIRFIT_IDLE;
+  }
+}
+
+/**
+  * @brief  Get the job state
+  * @retval IIRFit_State_TypeDef
+  */
+IIRFit_State_TypeDef IIRFit_GetState(void)
+{
+  return state;
+}
+
+/**
+  * @brief  Check whether the fit still uses its memory plan overlay
+  * @retval 1 while solving
+  */
+uint8_t IIRFit_IsActive(void)
+{
+  return (state == IIRFIT_SOLVING) ? 1U : 0U;
+}
+
+/**
+  * @brief  Get the outcome of the last fit
+  * @param  result: Structure to fill
+  * @retval None
+  */
+void IIRFit_GetResult(IIRFit_Result_TypeDef *result)
+{
+  if (result == NULL) {
+    return;
+  }
+
+  memset(result, 0, sizeof(*result));
+  result->state = state;
+  result->sections = (state == IIRFIT_DONE) ? job.sections : 0U;
+  result->iterations = iterations;
+  result->projectedPoles = projected;
+  result->errorDb = errorDb;
+  result->gain = outputGain;
+}
+
+/**
+  * @brief  Copy the fitted sections
+  * @param  out: Coefficients, a0 = 1
+  * @param  maxSections: Capacity of out
+  * @param  gain: Output gain of the cascade, may be NULL
+  * @retval Number of sections copied, 0 unless a fit has finished
+  */
+uint8_t IIRFit_GetSections(BiquadCoeff_t *out, uint8_t maxSections, float *gain)
+{
+  uint8_t count;
+
+  if (out == NULL || state != IIRFIT_DONE) {
+    return 0;
+  }
+
+  count = (job.sections < maxSections) ? job.sections : maxSections;
+  memcpy(out, sections, count * sizeof(BiquadCoeff_t));
+
+  if (gain != NULL) {
+    *gain = outputGain;
+  }
+
+  return count;
+}
+
+/**
+  * @brief  Run one bounded piece of the current phase
+  * @retval 1 if more work remains
+  */
+static uint8_t IIRFit_RunUnit(void)
+{
+  switch (phase) {
+    case IIRFIT_PHASE_LOGMAG:
+      IIRFit_LogMagChunk();
+      break;
+
+    case IIRFIT_PHASE_CEPSTRUM:
+      IIRFit_Cepstrum();
+      break;
+
+    case IIRFIT_PHASE_MINPHASE:
+      IIRFit_MinPhase();
+      break;
+
+    case IIRFIT_PHASE_TARGET:
+      IIRFit_TargetPhase();
+      break;
+
+    case IIRFIT_PHASE_BASIS:
+      IIRFit_BasisRow();
+      break;
+
+    case IIRFIT_PHASE_ROTATE:
+      IIRFit_RotateStep();
+      break;
+
+    case IIRFIT_PHASE_SOLVE:
+      IIRFit_SolveRow();
+      break;
+
+    case IIRFIT_PHASE_ROOTS:
+      IIRFit_RootStep();
+      break;
+
+    case IIRFIT_PHASE_PROJECT:
+      IIRFit_Project();
+      break;
+
+    case IIRFIT_PHASE_SECTIONS:
+      IIRFit_BuildSections();
+      break;
+
+    case IIRFIT_PHASE_LEVELS:
+      IIRFit_LevelChunk();
+      break;
+
+    case IIRFIT_PHASE_EVAL:
+      IIRFit_EvaluateChunk();
+      break;
+
+    case IIRFIT_PHASE_APPLY:
+    default:
+      IIRFit_Apply();
+      break;
+  }
+
+  return (state == IIRFIT_SOLVING) ? 1U : 0U;
+}
+
+/**
+  * @brief  Frequency seen through the warping all-pass
+  * @param  w: Angular frequency, 0 to pi
+  * @param  lambda: Warping factor, the negative value inverts the mapping
+  * @retval Warped angular frequency
+  */
+static double IIRFit_Warp(double w, double lambda)
+{
+  return w + 2.0 * atan2(lambda * sin(w), 1.0 - lambda * cos(w));
+}
+
+/**
+  * @brief  Set the complex target of a grid point
+  * @param  point: Grid point
+  * @param  phaseRad: Phase in radians
+  * @retval None
+  */
+static void IIRFit_SetTarget(uint32_t point, float phaseRad)
+{
+  const float m = powf(10.0f, magnitudeDb[point] / 20.0f);
+
+  targetRe[point] = m * cosf(phaseRad);
+  targetIm[point] = m * sinf(phaseRad);
+}
+
+/**
+  * @brief  Sample the log magnitude evenly on the warped axis
+  * @note   Warping maps minimum phase to minimum phase, and the warped axis
+  *         resolves the low octaves the fit cares about
+  * @retval None
+  */
+static void IIRFit_LogMagChunk(void)
+{
+  const uint32_t half = IIRFIT_CEPSTRUM_SIZE / 2U;
+  const float fs = CoeffBatch_GetSampleRate();
+  const float span = log2f(IIRFIT_GRID_MAX_HZ / IIRFIT_GRID_MIN_HZ);
+  const uint32_t end = (cursor + IIRFIT_LOGMAG_CHUNK <= half) ? cursor + IIRFIT_LOGMAG_CHUNK : half + 1U;
+
+  for (uint32_t k = cursor; k < end; k++) {
+    const double w = IIRFit_Warp(IIRFIT_PI * (double)k / (double)half, -job.warping);
+    const float f = (float)(w * (double)fs / (2.0 * IIRFIT_PI));
+    float pos = 0.0f;
+    float ln;
+
+    /* Held flat beyond the ends of the grid */
+    if (f > IIRFIT_GRID_MIN_HZ) {
+      pos = fminf(log2f(f / IIRFIT_GRID_MIN_HZ) / span * (float)(IIRFIT_GRID_POINTS - 1U),
+                  (float)(IIRFIT_GRID_POINTS - 1U));
+    }
+    ln = 0.115129255f * IIRFit_GridDb(pos);
+
+    if (k == 0U) {
+      cepstrum[0] = ln;
+    } else if (k == half) {
+      cepstrum[1] = ln;
+    } else {
+      cepstrum[2U * k] = ln;
+      cepstrum[2U * k + 1U] = 0.0f;
+    }
+  }
+
+  cursor = (uint16_t)end;
+
+  if (cursor > half) {
+    phase = IIRFIT_PHASE_CEPSTRUM;
+  }
+}
+
+/**
+  * @brief  Target magnitude between grid points, Catmull-Rom
+  * @note   A linear interpolation flattens narrow peaks, and the minimum
+  *         phase of the flattened curve is off around them
+  * @param  pos: Fractional grid index, 0 to IIRFIT_GRID_POINTS - 1
+  * @retval Magnitude in dB
+  */
+static float IIRFit_GridDb(float pos)
+{
+  const uint32_t last = IIRFIT_GRID_POINTS - 1U;
+  const uint32_t i = (pos < (float)last) ? (uint32_t)pos : last - 1U;
+  const float t = pos - (float)i;
+  const float p0 = magnitudeDb[(i > 0U) ? i - 1U : 0U];
+  const float p1 = magnitudeDb[i];
+  const float p2 = magnitudeDb[i + 1U];
+  const float p3 = magnitudeDb[(i + 2U <= last) ? i + 2U : last];
+
+  return p1 + 0.5f * t * ((p2 - p0) + t * ((2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) +
+                                           t * (3.0f * (p1 - p2) + p3 - p0)));
+}
+
+/**
+  * @brief  Real cepstrum, folded onto positive quefrencies
+  * @retval None
+  */
+static void IIRFit_Cepstrum(void)
+{
+  const uint32_t half = IIRFIT_CEPSTRUM_SIZE / 2U;
+  const float scale = 2.0f / (float)IIRFIT_CEPSTRUM_SIZE;
+
+  DSP_FFT_RealInverse(cepstrum, IIRFIT_CEPSTRUM_SIZE);
+
+  cepstrum[0] *= scale;
+  for (uint32_t n = 1; n < half; n++) {
+    cepstrum[n] *= 2.0f * scale;
+  }
+  cepstrum[half] *= scale;
+  memset(&cepstrum[half + 1U], 0, (half - 1U) * sizeof(float));
+
+  phase = IIRFIT_PHASE_MINPHASE;
+}
+
+/**
+  * @brief  Back to the spectrum, the imaginary part is the minimum phase
+  * @retval None
+  */
+static void IIRFit_MinPhase(void)
+{
+  DSP_FFT_RealForward(cepstrum, IIRFIT_CEPSTRUM_SIZE);
+  phase = IIRFIT_PHASE_TARGET;
+}
+
+/**
+  * @brief  Interpolate the minimum phase onto the fit grid
+  * @retval None
+  */
+static void IIRFit_TargetPhase(void)
+{
+  const uint32_t half = IIRFIT_CEPSTRUM_SIZE / 2U;
+
+  for (uint32_t i = 0; i < IIRFIT_GRID_POINTS; i++) {
+    const float pos = (float)(warped[i] / IIRFIT_PI) * (float)half;
+    const uint32_t k = (pos < (float)(half - 1U)) ? (uint32_t)pos : half - 1U;
+    const float frac = fminf(pos - (float)k, 1.0f);
+    /* DC and Nyquist bins carry no phase */
+    const float p0 = (k == 0U) ? 0.0f : cepstrum[2U * k + 1U];
+    const float p1 = (k + 1U >= half) ? 0.0f : cepstrum[2U * k + 3U];
+
+    IIRFit_SetTarget(i, p0 + frac * (p1 - p0));
+  }
+
+  IIRFit_BeginPass();
+}
+
+/**
+  * @brief  Weakly damped pole pairs spread evenly over the warped fit band
+  * @retval None
+  */
+static void IIRFit_StartPoles(void)
+{
+  const double fs = (double)CoeffBatch_GetSampleRate();
+  const double low = IIRFit_Warp(2.0 * IIRFIT_PI * fmax(job.fitLowHz, IIRFIT_GRID_MIN_HZ) / fs,
+                                 job.warping);
+  const double high = IIRFit_Warp(2.0 * IIRFIT_PI * fmin(fmin(job.fitHighHz, IIRFIT_GRID_MAX_HZ), 0.5 * fs) / fs,
+                                  job.warping);
+  const uint8_t pairs = order / 2U;
+
+  for (uint8_t s = 0; s < pairs; s++) {
+    const double angle = low + (high - low) * ((double)s + 0.5) / (double)pairs;
+    const double radius = fmin(exp(-IIRFIT_START_DAMPING * angle), IIRFIT_MAX_POLE_RADIUS);
+
+    poles[2U * s].re = radius * cos(angle);
+    poles[2U * s].im = radius * sin(angle);
+    poles[2U * s + 1U].re = poles[2U * s].re;
+    poles[2U * s + 1U].im = -poles[2U * s].im;
+    poleKind[2U * s] = IIRFIT_POLE_UPPER;
+    poleKind[2U * s + 1U] = IIRFIT_POLE_LOWER;
+  }
+
+  memcpy(bestPoles, poles, sizeof(poles));
+  memcpy(bestKind, poleKind, sizeof(poleKind));
+}
+
+/**
+  * @brief  Clear the factor and start a pass over the grid
+  * @retval None
+  */
+static void IIRFit_BeginPass(void)
+{
+  unknowns = residuesOnly ? (uint8_t)(order + 1U) : (uint8_t)(2U * order + 1U);
+
+  for (uint8_t r = 0; r < unknowns; r++) {
+    memset(&IIRFIT_R(r, 0), 0, unknowns * sizeof(double));
+  }
+  memset(rhs, 0, sizeof(rhs));
+
+  residual = 0.0;
+  targetPower = 0.0;
+  cursor = 0;
+  phase = IIRFIT_PHASE_BASIS;
+}
+
+/**
+  * @brief  Real and imaginary least-squares rows of the next grid point
+  * @note   Columns are d, then c_k, then e_k. A conjugate pair takes the
+  *         real basis phi + phi' and j (phi - phi'), whose coefficients
+  *         are the real and imaginary parts of the residue at the upper pole.
+  * @retval None
+  */
+static void IIRFit_BasisRow(void)
+{
+  const IIRFit_Complex_TypeDef one = { 1.0, 0.0 };
+  IIRFit_Complex_TypeDef y, t;
+  double s;
+
+  while (cursor < IIRFIT_GRID_POINTS && weight[cursor] == 0.0f) {
+    cursor++;
+  }
+
+  if (cursor >= IIRFIT_GRID_POINTS) {
+    IIRFit_EndPass();
+    return;
+  }
+
+  y.re = cos(warped[cursor]);
+  y.im = -sin(warped[cursor]);
+  t.re = targetRe[cursor];
+  t.im = targetIm[cursor];
+  s = sqrt((double)weight[cursor]);
+
+  rowRe[0] = s;
+  rowIm[0] = 0.0;
+
+  for (uint8_t k = 0; k < order; k++) {
+    IIRFit_Complex_TypeDef d = { 1.0 - (poles[k].re * y.re - poles[k].im * y.im),
+                                 -(poles[k].re * y.im + poles[k].im * y.re) };
+    IIRFit_Complex_TypeDef g = IIRFit_Div(one, d);
+
+    if (poleKind[k] == IIRFIT_POLE_UPPER) {
+      IIRFit_Complex_TypeDef h;
+
+      d.re = 1.0 - (poles[k].re * y.re + poles[k].im * y.im);
+      d.im = -(poles[k].re * y.im - poles[k].im * y.re);
+      h = IIRFit_Div(one, d);
+
+      rowRe[1U + k] = s * (g.re + h.re);
+      rowIm[1U + k] = s * (g.im + h.im);
+      rowRe[2U + k] = -s * (g.im - h.im);
+      rowIm[2U + k] = s * (g.re - h.re);
+      k++;
+    } else {
+      rowRe[1U + k] = s * g.re;
+      rowIm[1U + k] = s * g.im;
+    }
+  }
+
+  if (!residuesOnly) {
+    for (uint8_t k = 1; k <= order; k++) {
+      rowRe[order + k] = -(t.re * rowRe[k] - t.im * rowIm[k]);
+      rowIm[order + k] = -(t.re * rowIm[k] + t.im * rowRe[k]);
+    }
+  }
+
+  rowRe[unknowns] = s * t.re;
+  rowIm[unknowns] = s * t.im;
+  targetPower += (double)weight[cursor] * IIRFit_Abs2(t);
+
+  column = 0;
+  rowPart = 0;
+  phase = IIRFIT_PHASE_ROTATE;
+}
+
+/**
+  * @brief  One Givens rotation of the current row into R
+  * @retval None
+  */
+static void IIRFit_RotateStep(void)
+{
+  double *row = (rowPart == 0U) ? rowRe : rowIm;
+  const uint8_t j = column;
+
+  if (row[j] != 0.0) {
+    const double a = IIRFIT_R(j, j);
+    const double h = sqrt(a * a + row[j] * row[j]);
+    const double c = a / h;
+    const double s = row[j] / h;
+    double r;
+
+    IIRFIT_R(j, j) = h;
+
+    for (uint8_t k = j + 1U; k < unknowns; k++) {
+      r = IIRFIT_R(j, k);
+      IIRFIT_R(j, k) = c * r + s * row[k];
+      row[k] = c * row[k] - s * r;
+    }
+
+    r = rhs[j];
+    rhs[j] = c * r + s * row[unknowns];
+    row[unknowns] = c * row[unknowns] - s * r;
+  }
+
+  column++;
+
+  if (column < unknowns) {
+    return;
+  }
+
+  /* What is left of the target is the row's share of the residual */
+  residual += row[unknowns] * row[unknowns];
+  column = 0;
+
+  if (rowPart == 0U) {
+    rowPart = 1;
+  } else {
+    cursor++;
+    phase = IIRFIT_PHASE_BASIS;
+  }
+}
+
+/**
+  * @brief  All rows are in, set up the back substitution
+  * @retval None
+  */
+static void IIRFit_EndPass(void)
+{
+  double largest = 0.0;
+
+  if (targetPower <= 0.0) {
+    state = IIRFIT_FAILED;
+    return;
+  }
+
+  for (uint8_t r = 0; r < unknowns; r++) {
+    largest = fmax(largest, IIRFIT_R(r, r));
+  }
+  pivotFloor = IIRFIT_RANK_TOLERANCE * largest;
+
+  cursor = unknowns;
+  phase = IIRFIT_PHASE_SOLVE;
+}
+
+/**
+  * @brief  One row of R x = Q'T, bottom up
+  * @note   A column the data cannot tell apart from the others gets zero
+  * @retval None
+  */
+static void IIRFit_SolveRow(void)
+{
+  const uint8_t i = (uint8_t)(cursor - 1U);
+  double s = rhs[i];
+
+  for (uint8_t k = i + 1U; k < unknowns; k++) {
+    s -= IIRFIT_R(i, k) * rhs[k];
+  }
+  rhs[i] = (IIRFIT_R(i, i) > pivotFloor) ? s / IIRFIT_R(i, i) : 0.0;
+
+  cursor--;
+
+  if (cursor == 0U) {
+    IIRFit_Unpack();
+  }
+}
+
+/**
+  * @brief  Turn the solution into partial-fraction residues
+  * @note   A pole pass gives 1 + sum e_k phi_k, whose zeros are the new
+  *         poles; a scoring pass gives the model d + sum c_k phi_k
+  * @retval None
+  */
+static void IIRFit_Unpack(void)
+{
+  const uint8_t base = residuesOnly ? 1U : (uint8_t)(order + 1U);
+
+  constant = residuesOnly ? rhs[0] : 1.0;
+
+  for (uint8_t k = 0; k < order; k++) {
+    residues[k].re = rhs[base + k];
+    residues[k].im = 0.0;
+
+    if (poleKind[k] == IIRFIT_POLE_UPPER) {
+      residues[k].im = rhs[base + k + 1U];
+      residues[k + 1U].re = residues[k].re;
+      residues[k + 1U].im = -residues[k].im;
+      k++;
+    }
+  }
+
+  if (residuesOnly) {
+    IIRFit_Score();
+  } else {
+    IIRFit_SeedRoots();
+  }
+}
+
+/**
+  * @brief  Set up the root finder on the current residues
+  * @retval None
+  */
+static void IIRFit_SeedRoots(void)
+{
+  double lead = constant;
+  double size = fabs(constant);
+
+  for (uint8_t k = 0; k < order; k++) {
+    lead += residues[k].re;
+    size += sqrt(IIRFit_Abs2(residues[k]));
+  }
+
+  if (size == 0.0) {
+    state = IIRFIT_FAILED;
+    DEBUG_PRINT("IIRFit: no response to fit\r\n");
+    return;
+  }
+
+  /* The q^order coefficient of the numerator; at zero one root leaves for
+     infinity, so hold it at a large radius */
+  if (fabs(lead) < IIRFIT_LEAD_FLOOR * size) {
+    constant += ((lead < 0.0) ? -IIRFIT_LEAD_FLOOR : IIRFIT_LEAD_FLOOR) * size - lead;
+  }
+
+  /* Start just inside the poles, where most zeros are found */
+  for (uint8_t k = 0; k < order; k++) {
+    roots[k].re = (1.0 - IIRFIT_SEED_OFFSET) * poles[k].re + 1e-3 * cos(0.4 + (double)k);
+    roots[k].im = (1.0 - IIRFIT_SEED_OFFSET) * poles[k].im + 1e-3 * sin(0.4 + (double)k);
+  }
+
+  sweeps = 0;
+  sweepStep = 0.0;
+  cursor = 0;
+  phase = IIRFIT_PHASE_ROOTS;
+}
+
+/**
+  * @brief  One Aberth update of one zero of constant + sum r_k q / (q - p_k)
+  * @note   q = 1/y is the warped pole plane, where the function times
+  *         prod (q - p_k) is a polynomial of degree order
+  * @retval None
+  */
+static void IIRFit_RootStep(void)
+{
+  const IIRFit_Complex_TypeDef one = { 1.0, 0.0 };
+  IIRFit_Complex_TypeDef *z = &roots[cursor];
+  IIRFit_Complex_TypeDef f = { constant, 0.0 };
+  IIRFit_Complex_TypeDef df = { 0.0, 0.0 };
+  IIRFit_Complex_TypeDef poleSum = { 0.0, 0.0 };
+  IIRFit_Complex_TypeDef rootSum = { 0.0, 0.0 };
+  IIRFit_Complex_TypeDef step, d, g;
+  uint8_t onPole = 0;
+
+  for (uint8_t k = 0; k < order; k++) {
+    d.re = z->re - poles[k].re;
+    d.im = z->im - poles[k].im;
+
+    if (IIRFit_Abs2(d) == 0.0) {
+      onPole = 1;
+      break;
+    }
+
+    d = IIRFit_Div(one, d);
+    g = IIRFit_Mul(residues[k], d);
+    step = IIRFit_Mul(g, *z);
+    f.re += step.re;
+    f.im += step.im;
+    g = IIRFit_Mul(IIRFit_Mul(g, d), poles[k]);
+    df.re -= g.re;
+    df.im -= g.im;
+    poleSum.re += d.re;
+    poleSum.im += d.im;
+  }
+
+  /* Newton ratio of the polynomial: f / (f' + f sum 1/(q - p_k)) */
+  g = IIRFit_Mul(f, poleSum);
+  g.re += df.re;
+  g.im += df.im;
+
+  if (!onPole && IIRFit_Abs2(g) > 0.0) {
+    const IIRFit_Complex_TypeDef ratio = IIRFit_Div(f, g);
+
+    for (uint8_t j = 0; j < order; j++) {
+      d.re = z->re - roots[j].re;
+      d.im = z->im - roots[j].im;
+
+      if (j != cursor && IIRFit_Abs2(d) > 0.0) {
+        d = IIRFit_Div(one, d);
+        rootSum.re += d.re;
+        rootSum.im += d.im;
+      }
+    }
+
+    d = IIRFit_Mul(ratio, rootSum);
+    d.re = 1.0 - d.re;
+    d.im = -d.im;
+    step = IIRFit_Div(ratio, d);
+  } else {
+    /* Stationary point or a pole, nudge off it */
+    step.re = 1e-3;
+    step.im = 1e-3;
+  }
+
+  z->re -= step.re;
+  z->im -= step.im;
+  sweepStep = fmax(sweepStep, sqrt(IIRFit_Abs2(step) / (1.0 + IIRFit_Abs2(*z))));
+
+  cursor++;
+
+  if (cursor < order) {
+    return;
+  }
+
+  cursor = 0;
+  sweeps++;
+
+  if (sweepStep < IIRFIT_ROOT_TOLERANCE || sweeps >= IIRFIT_ROOT_SWEEPS) {
+    phase = residuesOnly ? IIRFIT_PHASE_SECTIONS : IIRFIT_PHASE_PROJECT;
+  }
+  sweepStep = 0.0;
+}
+
+/**
+  * @brief  Take the new poles, pull unstable or near-unit ones inside,
+  *         decide whether to iterate again
+  * @note   The residual of this pass scores the poles it was built on
+  * @retval None
+  */
+static void IIRFit_Project(void)
+{
+  const double l = job.warping;
+  IIRFit_Complex_TypeDef pairs[IIRFIT_MAX_SECTIONS][2];
+
+  IIRFit_PairRoots(roots, pairs);
+  IIRFit_SetPoles(pairs);
+
+  projected = 0;
+
+  for (uint8_t k = 0; k < order; k++) {
+    const IIRFit_Complex_TypeDef r = poles[k];
+    const IIRFit_Complex_TypeDef u = { 1.0 + l * r.re, l * r.im };
+    const IIRFit_Complex_TypeDef v = { r.re + l, r.im };
+    IIRFit_Complex_TypeDef z;
+    double mag;
+
+    if (poleKind[k] == IIRFIT_POLE_LOWER) {
+      poles[k].re = poles[k - 1U].re;
+      poles[k].im = -poles[k - 1U].im;
+      continue;
+    }
+
+    z = IIRFit_Div(v, u);
+    mag = sqrt(IIRFit_Abs2(z));
+
+    if (mag <= IIRFIT_MAX_POLE_RADIUS) {
+      continue;
+    }
+
+    /* Reflection keeps the magnitude response, the clamp keeps Q finite */
+    if (mag > 1.0) {
+      z.re /= mag * mag;
+      z.im /= mag * mag;
+      mag = 1.0 / mag;
+    }
+    if (mag > IIRFIT_MAX_POLE_RADIUS) {
+      z.re *= IIRFIT_MAX_POLE_RADIUS / mag;
+      z.im *= IIRFIT_MAX_POLE_RADIUS / mag;
+    }
+
+    /* Back to the warped plane: r = (z - l) / (1 - l z) */
+    {
+      const IIRFit_Complex_TypeDef zn = { z.re - l, z.im };
+      const IIRFit_Complex_TypeDef zd = { 1.0 - l * z.re, -l * z.im };
+
+      poles[k] = IIRFit_Div(zn, zd);
+    }
+    projected += (poleKind[k] == IIRFIT_POLE_UPPER) ? 2U : 1U;
+  }
+
+  iterations++;
+
+  /* Score the new poles with their own residues */
+  residuesOnly = 1;
+  IIRFit_BeginPass();
+}
+
+/**
+  * @brief  Keep the best model so far, decide whether to iterate again
+  * @note   The residual of a scoring pass is the output error of the model
+  * @retval None
+  */
+static void IIRFit_Score(void)
+{
+  const uint8_t converged = (iterations > 1U && fabs(prevResidual - residual) <= IIRFIT_CONVERGED * prevResidual) ? 1U : 0U;
+
+  if (residual < bestResidual) {
+    bestResidual = residual;
+    bestConstant = constant;
+    memcpy(bestPoles, poles, sizeof(poles));
+    memcpy(bestKind, poleKind, sizeof(poleKind));
+    memcpy(bestResidues, residues, sizeof(residues));
+  }
+  prevResidual = residual;
+
+  if (converged || iterations >= job.maxIterations) {
+    IIRFit_FinishIterations();
+  } else {
+    residuesOnly = 0;
+    IIRFit_BeginPass();
+  }
+}
+
+/**
+  * @brief  Stop iterating, factor the numerator of the best model
+  * @retval None
+  */
+static void IIRFit_FinishIterations(void)
+{
+  constant = bestConstant;
+  memcpy(poles, bestPoles, sizeof(poles));
+  memcpy(poleKind, bestKind, sizeof(poleKind));
+  memcpy(residues, bestResidues, sizeof(residues));
+  IIRFit_SeedRoots();
+}
+
+/**
+  * @brief  Group roots into sections
+  * @note   Each pole pair takes the nearest zero pair, pole pairs closest
+  *         to the unit circle first; sections run in ascending pole radius
+  * @retval None
+  */
+static void IIRFit_BuildSections(void)
+{
+  const uint8_t count = job.sections;
+  IIRFit_Complex_TypeDef polePairs[IIRFIT_MAX_SECTIONS][2];
+  IIRFit_Complex_TypeDef zeroPairs[IIRFIT_MAX_SECTIONS][2];
+  IIRFit_Complex_TypeDef poleAt[IIRFIT_MAX_SECTIONS];
+  IIRFit_Complex_TypeDef zeroAt[IIRFIT_MAX_SECTIONS];
+  double poleQuad[IIRFIT_MAX_SECTIONS][3];
+  double zeroQuad[IIRFIT_MAX_SECTIONS][3];
+  double radius[IIRFIT_MAX_SECTIONS];
+  uint8_t byRadius[IIRFIT_MAX_SECTIONS];
+  uint8_t partner[IIRFIT_MAX_SECTIONS];
+  uint8_t taken[IIRFIT_MAX_SECTIONS];
+
+  IIRFit_PairRoots(poles, polePairs);
+  IIRFit_PairRoots(roots, zeroPairs);
+
+  for (uint8_t s = 0; s < count; s++) {
+    double first;
+
+    IIRFit_Quadratic(polePairs[s], poleQuad[s], &poleAt[s]);
+    IIRFit_Quadratic(zeroPairs[s], zeroQuad[s], &zeroAt[s]);
+
+    /* Larger magnitude of the two poles, the second from their product a2 */
+    first = sqrt(IIRFit_Abs2(poleAt[s]));
+    radius[s] = fmin(fmax(first, fabs(poleQuad[s][2]) / fmax(first, 1e-300)), 1.0);
+    byRadius[s] = s;
+    taken[s] = 0;
+  }
+
+  /* Insertion sort, descending radius */
+  for (uint8_t s = 1; s < count; s++) {
+    const uint8_t key = byRadius[s];
+    int32_t j = (int32_t)s - 1;
+
+    while (j >= 0 && radius[byRadius[j]] < radius[key]) {
+      byRadius[j + 1] = byRadius[j];
+      j--;
+    }
+    byRadius[j + 1] = key;
+  }
+
+  for (uint8_t s = 0; s < count; s++) {
+    const uint8_t p = byRadius[s];
+    double nearest = HUGE_VAL;
+
+    partner[p] = 0;
+    for (uint8_t z = 0; z < count; z++) {
+      IIRFit_Complex_TypeDef d;
+
+      if (taken[z]) {
+        continue;
+      }
+
+      d.re = zeroAt[z].re - poleAt[p].re;
+      d.im = zeroAt[z].im - poleAt[p].im;
+      if (IIRFit_Abs2(d) < nearest) {
+        nearest = IIRFit_Abs2(d);
+        partner[p] = z;
+      }
+    }
+    taken[partner[p]] = 1;
+  }
+
+  for (uint8_t s = 0; s < count; s++) {
+    const uint8_t p = byRadius[count - 1U - s];
+    const double *zq = zeroQuad[partner[p]];
+
+    sections[s].b0 = (float)zq[0];
+    sections[s].b1 = (float)zq[1];
+    sections[s].b2 = (float)zq[2];
+    sections[s].a1 = (float)poleQuad[p][1];
+    sections[s].a2 = (float)poleQuad[p][2];
+    sectionLog[s] = 0.0;
+  }
+
+  cursor = 0;
+  phase = IIRFIT_PHASE_LEVELS;
+}
+
+/**
+  * @brief  Average level of every float section over the fit range
+  * @note   Each section is scaled to 0 dB on average once the grid is
+  *         done; the remainder goes to the cascade output gain
+  * @retval None
+  */
+static void IIRFit_LevelChunk(void)
+{
+  const uint32_t end = (cursor + IIRFIT_CHUNK_POINTS < IIRFIT_GRID_POINTS) ?
+                       cursor + IIRFIT_CHUNK_POINTS : IIRFIT_GRID_POINTS;
+
+  for (uint32_t i = cursor; i < end; i++) {
+    if (weight[i] == 0.0f) {
+      continue;
+    }
+
+    for (uint8_t s = 0; s < job.sections; s++) {
+      const IIRFit_Complex_TypeDef hs = IIRFit_SectionResponse(&sections[s], i);
+
+      sectionLog[s] += 0.5 * weight[i] * log(fmax(IIRFit_Abs2(hs), 1e-300));
+    }
+  }
+
+  cursor = (uint16_t)end;
+
+  if (cursor < IIRFIT_GRID_POINTS) {
+    return;
+  }
+
+  for (uint8_t s = 0; s < job.sections; s++) {
+    const double level = exp(sectionLog[s] / (double)weightSum);
+
+    sections[s].b0 = (float)(sections[s].b0 / level);
+    sections[s].b1 = (float)(sections[s].b1 / level);
+    sections[s].b2 = (float)(sections[s].b2 / level);
+  }
+
+  crossSum = 0.0;
+  modelPower = 0.0;
+  cursor = 0;
+  phase = IIRFIT_PHASE_EVAL;
+}
+
+/**
+  * @brief  Response of the float sections on the next grid points
+  * @note   Gathers the least-squares output gain; the response is kept
+  *         for the error, the cepstrum buffer is free by now
+  * @retval None
+  */
+static void IIRFit_EvaluateChunk(void)
+{
+  const uint32_t end = (cursor + IIRFIT_CHUNK_POINTS < IIRFIT_GRID_POINTS) ?
+                       cursor + IIRFIT_CHUNK_POINTS : IIRFIT_GRID_POINTS;
+
+  for (uint32_t i = cursor; i < end; i++) {
+    IIRFit_Complex_TypeDef h = { 1.0, 0.0 };
+
+    if (weight[i] == 0.0f) {
+      continue;
+    }
+
+    for (uint8_t s = 0; s < job.sections; s++) {
+      h = IIRFit_Mul(h, IIRFit_SectionResponse(&sections[s], i));
+    }
+
+    crossSum += weight[i] * (targetRe[i] * h.re + targetIm[i] * h.im);
+    modelPower += weight[i] * IIRFit_Abs2(h);
+    cepstrum[2U * i] = (float)h.re;
+    cepstrum[2U * i + 1U] = (float)h.im;
+  }
+
+  cursor = (uint16_t)end;
+
+  if (cursor >= IIRFIT_GRID_POINTS) {
+    phase = IIRFIT_PHASE_APPLY;
+  }
+}
+
+/**
+  * @brief  Set the output gain, score the cascade and write it
+  * @retval None
+  */
+static void IIRFit_Apply(void)
+{
+  IIRFit_State_TypeDef result = IIRFIT_DONE;
+  double error = 0.0;
+  float gain;
+
+  if (modelPower <= 0.0) {
+    state = IIRFIT_FAILED;
+    return;
+  }
+
+  gain = (float)(crossSum / modelPower);
+
+  for (uint32_t i = 0; i < IIRFIT_GRID_POINTS; i++) {
+    const float er = targetRe[i] - gain * cepstrum[2U * i];
+    const float ei = targetIm[i] - gain * cepstrum[2U * i + 1U];
+
+    if (weight[i] != 0.0f) {
+      error += (double)(weight[i] * (er * er + ei * ei));
+    }
+  }
+
+  errorDb = (float)(10.0 * log10(fmax(error, 1e-30) / targetPower));
+  outputGain = gain;
+
+  if (job.apply && PEQ_SetCorrection(job.channel, sections, job.sections, outputGain) != HAL_OK) {
+    result = IIRFIT_FAILED;
+  }
+
+  state = result;
+
+  DEBUG_PRINT("IIRFit: %d sections, %d iterations, %d poles projected, error %.1f dB\r\n",
+              job.sections, iterations, projected, errorDb);
+}
+
+/**
+  * @brief  Response of one float section at a grid point
+  * @param  c: Section
+  * @param  point: Grid point
+  * @retval H(e^jw)
+  */
+static IIRFit_Complex_TypeDef IIRFit_SectionResponse(const BiquadCoeff_t *c, uint32_t point)
+{
+  const double w = 2.0 * IIRFIT_PI * (double)IIRFit_GetGridFrequency(point) /
+                   (double)CoeffBatch_GetSampleRate();
+  const IIRFit_Complex_TypeDef n = { c->b0 + c->b1 * cos(w) + c->b2 * cos(2.0 * w),
+                                     -c->b1 * sin(w) - c->b2 * sin(2.0 * w) };
+  const IIRFit_Complex_TypeDef d = { 1.0 + c->a1 * cos(w) + c->a2 * cos(2.0 * w),
+                                     -c->a1 * sin(w) - c->a2 * sin(2.0 * w) };
+
+  return IIRFit_Div(n, d);
+}
+
+/**
+  * @brief  Rebuild the pole list from root pairs
+  * @param  pairs: order/2 pairs from IIRFit_PairRoots()
+  * @retval None
+  */
+static void IIRFit_SetPoles(IIRFit_Complex_TypeDef pairs[][2])
+{
+  for (uint8_t s = 0; s < order / 2U; s++) {
+    const uint8_t k = 2U * s;
+
+    if (pairs[s][0].im != 0.0) {
+      poles[k].re = pairs[s][0].re;
+      poles[k].im = fabs(pairs[s][0].im);
+      poles[k + 1U].re = poles[k].re;
+      poles[k + 1U].im = -poles[k].im;
+      poleKind[k] = IIRFIT_POLE_UPPER;
+      poleKind[k + 1U] = IIRFIT_POLE_LOWER;
+    } else {
+      poles[k] = pairs[s][0];
+      poles[k + 1U] = pairs[s][1];
+      poleKind[k] = IIRFIT_POLE_REAL;
+      poleKind[k + 1U] = IIRFIT_POLE_REAL;
+    }
+  }
+}
+
+/**
+  * @brief  Split the roots of a real polynomial into conjugate or real pairs
+  * @note   Complex roots take their nearest conjugate, largest imaginary
+  *         part first; the rest are real and paired in sorted order. Pairs
+  *         come out exactly conjugate or exactly real.
+  * @param  r: order roots
+  * @param  pairs: order/2 pairs
+  * @retval None
+  */
+static void IIRFit_PairRoots(const IIRFit_Complex_TypeDef *r, IIRFit_Complex_TypeDef pairs[][2])
+{
+  uint8_t taken[IIRFIT_MAX_ORDER];
+  double reals[IIRFIT_MAX_ORDER];
+  uint8_t count = 0;
+  uint8_t realCount = 0;
+
+  memset(taken, 0, sizeof(taken));
+
+  for (;;) {
+    uint8_t top = 0xFFU;
+    uint8_t mate = 0xFFU;
+    double best = HUGE_VAL;
+
+    for (uint8_t k = 0; k < order; k++) {
+      if (!taken[k] && (top == 0xFFU || fabs(r[k].im) > fabs(r[top].im))) {
+        top = k;
+      }
+    }
+
+    if (top == 0xFFU || fabs(r[top].im) <= IIRFIT_REAL_TOLERANCE * (1.0 + fabs(r[top].re))) {
+      break;
+    }
+
+    for (uint8_t k = 0; k < order; k++) {
+      const IIRFit_Complex_TypeDef d = { r[k].re - r[top].re, r[k].im + r[top].im };
+
+      if (k != top && !taken[k] && IIRFit_Abs2(d) < best) {
+        best = IIRFit_Abs2(d);
+        mate = k;
+      }
+    }
+
+    taken[top] = 1;
+    taken[mate] = 1;
+    pairs[count][0] = r[top];
+    pairs[count][1].re = r[top].re;
+    pairs[count][1].im = -r[top].im;
+    count++;
+  }
+
+  for (uint8_t k = 0; k < order; k++) {
+    if (!taken[k]) {
+      int32_t j = (int32_t)realCount - 1;
+
+      while (j >= 0 && reals[j] > r[k].re) {
+        reals[j + 1] = reals[j];
+        j--;
+      }
+      reals[j + 1] = r[k].re;
+      realCount++;
+    }
+  }
+
+  for (uint8_t k = 0; k + 1U < realCount; k += 2U) {
+    pairs[count][0].re = reals[k];
+    pairs[count][0].im = 0.0;
+    pairs[count][1].re = reals[k + 1U];
+    pairs[count][1].im = 0.0;
+    count++;
+  }
+}
+
+/**
+  * @brief  z-plane quadratic of a warped root pair
+  * @note   Warped factor (1 - r y) is (1 + l r) - (r + l) z^-1 up to a
+  *         common all-pass denominator, which cancels between B and A
+  * @param  pair: Two warped roots, conjugate or real
+  * @param  q: {q0, q1, q2} of q0 + q1 z^-1 + q2 z^-2, scaled so q0 = 1
+  *         when possible, else so the largest term is 1
+  * @param  at: z-plane location of the first root
+  * @retval None
+  */
+static void IIRFit_Quadratic(const IIRFit_Complex_TypeDef *pair, double *q, IIRFit_Complex_TypeDef *at)
+{
+  const double l = job.warping;
+  const IIRFit_Complex_TypeDef u0 = { 1.0 + l * pair[0].re, l * pair[0].im };
+  const IIRFit_Complex_TypeDef v0 = { pair[0].re + l, pair[0].im };
+  const IIRFit_Complex_TypeDef u1 = { 1.0 + l * pair[1].re, l * pair[1].im };
+  const IIRFit_Complex_TypeDef v1 = { pair[1].re + l, pair[1].im };
+  const IIRFit_Complex_TypeDef uu = IIRFit_Mul(u0, u1);
+  const IIRFit_Complex_TypeDef uv = IIRFit_Mul(u0, v1);
+  const IIRFit_Complex_TypeDef vu = IIRFit_Mul(v0, u1);
+  const IIRFit_Complex_TypeDef vv = IIRFit_Mul(v0, v1);
+  const double peak = fmax(fabs(uu.re), fmax(fabs(uv.re + vu.re), fabs(vv.re)));
+  const double scale = (fabs(uu.re) > 1e-9 * peak) ? uu.re : peak;
+
+  q[0] = uu.re / scale;
+  q[1] = -(uv.re + vu.re) / scale;
+  q[2] = vv.re / scale;
+
+  if (IIRFit_Abs2(u0) > 1e-24 * IIRFit_Abs2(v0)) {
+    *at = IIRFit_Div(v0, u0);
+  } else {
+    at->re = 1e12;
+    at->im = 0.0;
+  }
+}
+
+/**
+  * @brief  Complex product
+  * @retval a * b
+  */
+static IIRFit_Complex_TypeDef IIRFit_Mul(IIRFit_Complex_TypeDef a, IIRFit_Complex_TypeDef b)
+{
+  const IIRFit_Complex_TypeDef r = { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+
+  return r;
+}
+
+/**
+  * @brief  Complex quotient
+  * @retval a / b
+  */
+static IIRFit_Complex_TypeDef IIRFit_Div(IIRFit_Complex_TypeDef a, IIRFit_Complex_TypeDef b)
+{
+  const double d = b.re * b.re + b.im * b.im;
+  const IIRFit_Complex_TypeDef r = { (a.re * b.re + a.im * b.im) / d, (a.im * b.re - a.re * b.im) / d };
+
+  return r;
+}
+
+/**
+  * @brief  Squared magnitude
+  * @retval |a|^2
+  */
+static double IIRFit_Abs2(IIRFit_Complex_TypeDef a)
+{
+  return a.re * a.re + a.im * a.im;
+}
@@ -0,0 +1,217 @@
+/**
+  ******************************************************************************
+  * @file           : latency_manager.c
+  * @brief          : Processing latency tracking and output alignment
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Collects the latency reported by each DSP stage, computes the delay each
+  * output needs to line up with the slowest one and folds it into the delay
+  * module. Recalculation is deferred to Latency_Update() so reports coming
+  * from parameter setters never touch the delay lines from the audio path.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "latency_manager.h"
+#ifndef AUDIO_SIM
+#include "audio_driver.h"   /* DMA frame size, the simulator streams audio_config.h frames */
+#endif
+#include "delay.h"
+#include "debug.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+/* Fixed latency outside the DSP chain: one DMA half-buffer on each side */
+#define LATENCY_IO_BUFFER_SAMPLES   (2U * AUDIO_FRAME_SIZE)
+#define LATENCY_ADC_GROUP_DELAY     17U   /* PCM1808 decimation filter, ~17.4/fs */
+#define LATENCY_DAC_GROUP_DELAY     20U   /* PCM5102A interpolation filter, ~20/fs */
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t stageLatency[AUDIO_OUTPUT_CHANNELS][LATENCY_STAGE_COUNT];
+static uint32_t pathLatency[AUDIO_OUTPUT_CHANNELS];
+static uint32_t compensation[AUDIO_OUTPUT_CHANNELS];
+static uint32_t alignedLatency = 0;
+static uint8_t unalignedMask = 0;       /* Outputs whose last compensation was refused */
+static volatile uint8_t latencyDirty = 0;
+
+/**
+  * @brief  Initialize latency manager, all stages report zero latency
+  * @retval None
+  */
+void Latency_Init(void)
+{
+  memset(stageLatency, 0, sizeof(stageLatency));
+  memset(pathLatency, 0, sizeof(pathLatency));
+  memset(compensation, 0, sizeof(compensation));
+  alignedLatency = 0;
+  unalignedMask = 0;
+  latencyDirty = 1;
+
+  DEBUG_PRINT("Latency manager initialized, I/O base latency %lu samples\r\n",
+              (unsigned long)(LATENCY_IO_BUFFER_SAMPLES + LATENCY_ADC_GROUP_DELAY + LATENCY_DAC_GROUP_DELAY));
+}
+
+/**
+  * @brief  Report the latency a stage adds on one output
+  * @note   Safe to call from parameter setters; alignment is applied on the
+  *         next Latency_Update() call
+  * @param  channel: Output channel (0-3)
+  * @param  stage: Stage reporting its latency
+  * @param  samples: Latency in samples at the DSP sample rate
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Latency_ReportStage(uint8_t channel, LatencyStage_TypeDef stage, uint32_t samples)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || stage >= LATENCY_STAGE_COUNT) {
+    DEBUG_PRINT("Latency_ReportStage: Invalid channel %d or stage %d\r\n", channel, stage);
+    return HAL_ERROR;
+  }
+
+  if (samples > LATENCY_MAX_STAGE_SAMPLES) {
+    DEBUG_PRINT("Latency_ReportStage: %lu samples exceeds limit\r\n", (unsigned long)samples);
+    return HAL_ERROR;
+  }
+
+  if (stageLatency[channel][stage] != samples) {
+    stageLatency[channel][stage] = samples;
+    latencyDirty = 1;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the latency last reported by a stage
+  * @param  channel: Output channel (0-3)
+  * @param  stage: Stage to query
+  * @retval Latency in samples
+  */
+uint32_t Latency_GetStage(uint8_t channel, LatencyStage_TypeDef stage)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS || stage >= LATENCY_STAGE_COUNT) {
+    return 0;
+  }
+
+  return stageLatency[channel][stage];
+}
+
+/**
+  * @brief  Recompute alignment and push compensation into the delay lines
+  * @note   Call from the main loop; does nothing unless a stage changed or
+  *         an output refused its compensation, which is retried every pass
+  * @retval None
+  */
+void Latency_Update(void)
+{
+  uint32_t maxLatency = 0;
+  uint32_t reached = 0;
+  uint8_t refused = 0;
+
+  if (!latencyDirty) {
+    return;
+  }
+  latencyDirty = 0;
+
+  /* Sum stage latencies per output and find the slowest path */
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    uint32_t sum = 0;
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+      sum += stageLatency[ch][stage];
+    }
+    pathLatency[ch] = sum;
+    if (sum > maxLatency) {
+      maxLatency = sum;
+    }
+  }
+
+  /* Delay faster outputs so that every output matches the slowest one */
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    uint32_t needed = maxLatency - pathLatency[ch];
+
+    /* A refused value leaves the delay line, and so the report, as it was */
+    if (needed != compensation[ch] && Delay_SetCompensation(ch, needed) != HAL_OK) {
+      if ((unalignedMask & (1U << ch)) == 0U) {
+        DEBUG_PRINT("Latency_Update: Channel %d cannot absorb %lu samples, keeps %lu\r\n",
+                    ch, (unsigned long)needed, (unsigned long)compensation[ch]);
+      }
+      refused |= (uint8_t)(1U << ch);
+    } else {
+      compensation[ch] = needed;
+    }
+
+    /* What this output actually runs at, stale compensation included */
+    if (pathLatency[ch] + compensation[ch] > reached) {
+      reached = pathLatency[ch] + compensation[ch];
+    }
+  }
+
+  /* Try the refused outputs again, a smaller user delay may make room */
+  unalignedMask = refused;
+  if (refused != 0U) {
+    latencyDirty = 1;
+  }
+
+  if (reached != alignedLatency) {
+    DEBUG_PRINT("Latency_Update: Processing latency %lu samples, unaligned outputs 0x%X\r\n",
+                (unsigned long)reached, refused);
+  }
+  alignedLatency = reached;
+}
+
+/**
+  * @brief  Get alignment delay applied to an output
+  * @param  channel: Output channel (0-3)
+  * @retval Compensation in samples
+  */
+uint32_t Latency_GetCompensation(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return 0;
+  }
+
+  return compensation[channel];
+}
+
+/**
+  * @brief  Get total input-to-output latency
+  * @retval Latency in samples
+  */
+uint32_t Latency_GetTotalSamples(void)
+{
+  return LATENCY_IO_BUFFER_SAMPLES + LATENCY_ADC_GROUP_DELAY +
+         LATENCY_DAC_GROUP_DELAY + alignedLatency;
+}
+
+/**
+  * @brief  Get total input-to-output latency
+  * @retval Latency in milliseconds
+  */
+float Latency_GetTotalMs(void)
+{
+  return (float)Latency_GetTotalSamples() * 1000.0f / (float)AUDIO_SAMPLE_RATE;
+}
+
+/**
+  * @brief  Fill latency summary for UI and telemetry
+  * @param  report: Pointer to report structure
+  * @retval None
+  */
+void Latency_GetReport(LatencyReport_TypeDef *report)
+{
+  if (report == NULL) {
+    return;
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    report->pathSamples[ch] = pathLatency[ch];
+    report->compensationSamples[ch] = compensation[ch];
+  }
+  report->alignedSamples = alignedLatency;
+  report->unalignedMask = unalignedMask;
+  report->totalSamples = Latency_GetTotalSamples();
+  report->totalMs = Latency_GetTotalMs();
+}
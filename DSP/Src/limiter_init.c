@@ -288,7 +288,7 @@ LimiterInstance_TypeDef* Limiter_GetInstance(uint8_t channel)
   * @param  instance: Pointer to the limiter instance
   * @retval None
   */
-void Limiter_Reset(LimiterInstance_TypeDef *instance)
+void Limiter_ResetInstance(LimiterInstance_TypeDef *instance)
 {
   if (instance == NULL) {
     return;
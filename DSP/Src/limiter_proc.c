@@ -18,15 +18,16 @@
 #include "limiter.h"
 #include "limiter_types.h"
 #include "dsp_common.h"
+#include "latency_manager.h"
+#include "param_snapshot.h"
 #include "math_utils.h"
+#include "cpu_budget.h"
 #include "debug.h"
 
 /* Private typedef -----------------------------------------------------------*/
 typedef struct {
   float currentGain;          /* Gain reduction saat ini */
   float peakLevel;            /* Level puncak yang terdeteksi */
-  float releaseTime;          /* Waktu release dalam sampel */
-  float attackTime;           /* Waktu attack dalam sampel */
   uint32_t holdCounter;       /* Counter untuk hold time */
   float targetGain;           /* Target gain reduction */
   float envelope;             /* Amplop sinyal terdeteksi */
@@ -38,6 +39,7 @@ typedef struct {
 /* Private variables ---------------------------------------------------------*/
 static LimiterState_Internal limiterState[AUDIO_OUTPUT_CHANNELS];
 static uint8_t limiterInitialized = 0;
+static uint8_t limiterIspAllowed = 1;        /* Dimatikan oleh quality scaler saat overload */
 
 /* Private constants ---------------------------------------------------------*/
 static const float MIN_GAIN_DB = -24.0f;    /* Batas gain reduction minimum */
@@ -45,12 +47,13 @@ static const float ENVELOPE_SMOOTHING = 0.9f; /* Faktor smoothing envelope */
 static const uint32_t DEFAULT_HOLD_SAMPLES = 50; /* Hold time default dalam sampel */
 
 /* Private function prototypes -----------------------------------------------*/
-static float Limiter_ProcessSample(uint8_t channel, float inputSample);
-static float Limiter_CalculateGainReduction(uint8_t channel, float inputLevel);
-static void Limiter_UpdateReleaseEnvelope(uint8_t channel, float gainReduction);
-static float Limiter_ApplyInterSampleProtection(uint8_t channel, float inputSample);
-static float Limiter_ProcessLookahead(uint8_t channel, float inputSample);
-static void Limiter_CalculateTimingParameters(uint8_t channel);
+static float Limiter_ProcessSample(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample);
+static float Limiter_CalculateGainReduction(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputLevel);
+static void Limiter_UpdateReleaseEnvelope(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float gainReduction);
+static float Limiter_ApplyInterSampleProtection(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample);
+static float Limiter_ProcessLookahead(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample);
+static void Limiter_PublishParams(uint8_t channel, const Limiter_TypeDef *config);
+static void Limiter_FillCpuLoad(uint8_t lookahead, uint8_t isp, CpuBudget_Load_TypeDef *load);
 
 /**
   * @brief  Initialize limiter dengan setting default
@@ -79,8 +82,14 @@ LimiterStatus_TypeDef Limiter_Init(uint8_t channel, Limiter_TypeDef *config)
     limiterState[channel].lookaheadBuffer[i] = 0.0f;
   }
 
-  /* Hitung parameter timing */
-  Limiter_CalculateTimingParameters(channel);
+  /* Hitung parameter timing dan publikasikan ke snapshot */
+  Limiter_PublishParams(channel, Limiter_GetConfig(channel));
+
+  /* Laporkan beban awal ke model biaya CPU */
+  CpuBudget_Load_TypeDef load;
+  Limiter_FillCpuLoad(Limiter_GetConfig(channel)->enableLookahead,
+                      Limiter_GetConfig(channel)->enableISP, &load);
+  CpuBudget_SetLoad(CPUBUDGET_STAGE_LIMITER, channel, &load);
 
   limiterInitialized = 1;
   DEBUG_PRINT("Limiter initialized for channel %d\r\n", channel);
@@ -124,33 +133,55 @@ LimiterStatus_TypeDef Limiter_Reset(uint8_t channel)
   */
 LimiterStatus_TypeDef Limiter_ProcessBlock(uint8_t channel, float *pData, uint16_t blockSize)
 {
+  const ParamSnapshot_Limiter_TypeDef *hot;
+
   if (!limiterInitialized || channel >= AUDIO_OUTPUT_CHANNELS || pData == NULL) {
     return LIMITER_ERROR;
   }
 
+  /* Parameters of this frame, fixed for the whole block */
+  hot = &ParamSnapshot_Frame()->limiter[channel];
+
   /* Process each sample in the block */
   for (uint16_t i = 0; i < blockSize; i++) {
-    pData[i] = Limiter_ProcessSample(channel, pData[i]);
+    pData[i] = Limiter_ProcessSample(channel, hot, pData[i]);
   }
 
   return LIMITER_OK;
 }
 
+/**
+  * @brief  Proses satu frame dari sebuah output melalui limiter
+  * @note   Entry point pipeline, parameter dibaca dari snapshot frame ini
+  * @param  outputChannel: Channel output (0-3)
+  * @param  pAudioBuffer: Buffer audio, diproses in-place
+  * @retval None
+  */
+void DSP_Limiter_Process(uint8_t outputChannel, AudioBuffer_TypeDef *pAudioBuffer)
+{
+  if (outputChannel >= AUDIO_OUTPUT_CHANNELS || pAudioBuffer == NULL) {
+    return;
+  }
+
+  Limiter_ProcessBlock(outputChannel, pAudioBuffer->samples[outputChannel], AUDIO_FRAME_SIZE);
+}
+
 /**
   * @brief  Memproses satu sampel audio dengan limiter
   * @param  channel: Channel yang akan diproses
+  * @param  hot: Parameter limiter untuk frame ini
   * @param  inputSample: Sampel input yang akan dibatasi
   * @retval Sampel output yang telah dibatasi
   */
-static float Limiter_ProcessSample(uint8_t channel, float inputSample)
+static float Limiter_ProcessSample(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample)
 {
   float outputSample;
   
   /* Check for inter-sample peaks */
-  float processedSample = Limiter_ApplyInterSampleProtection(channel, inputSample);
+  float processedSample = Limiter_ApplyInterSampleProtection(channel, hot, inputSample);
   
   /* Process through lookahead if enabled */
-  processedSample = Limiter_ProcessLookahead(channel, processedSample);
+  processedSample = Limiter_ProcessLookahead(channel, hot, processedSample);
   
   /* Get the absolute sample value */
   float sampleAbs = fabsf(processedSample);
@@ -161,13 +192,13 @@ static float Limiter_ProcessSample(uint8_t channel, float inputSample)
       (1.0f - ENVELOPE_SMOOTHING) * sampleAbs);
   
   /* Calculate gain reduction */
-  float gainReduction = Limiter_CalculateGainReduction(channel, limiterState[channel].peakLevel);
+  float gainReduction = Limiter_CalculateGainReduction(channel, hot, limiterState[channel].peakLevel);
   
   /* Apply gain reduction to produce output sample */
   outputSample = processedSample * limiterState[channel].currentGain;
   
   /* Update release envelope */
-  Limiter_UpdateReleaseEnvelope(channel, gainReduction);
+  Limiter_UpdateReleaseEnvelope(channel, hot, gainReduction);
   
   /* Hard clip to prevent any overflows (safety measure) */
   if (outputSample > 1.0f) outputSample = 1.0f;
@@ -182,27 +213,27 @@ static float Limiter_ProcessSample(uint8_t channel, float inputSample)
 /**
   * @brief  Menghitung nilai gain reduction berdasarkan level input
   * @param  channel: Channel yang akan dihitung
+  * @param  hot: Parameter limiter untuk frame ini
   * @param  inputLevel: Level input saat ini
   * @retval Nilai gain reduction yang dihitung
   */
-static float Limiter_CalculateGainReduction(uint8_t channel, float inputLevel)
+static float Limiter_CalculateGainReduction(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputLevel)
 {
   float gainReduction = 1.0f;
-  Limiter_TypeDef *config = Limiter_GetConfig(channel);
   
   /* Jika level melebihi threshold, hitung gain reduction */
-  if (inputLevel > config->threshold) {
+  if (inputLevel > hot->threshold) {
     /* Hitung gain reduction dalam linear */
-    gainReduction = config->threshold / inputLevel;
+    gainReduction = hot->threshold / inputLevel;
     
     /* Terapkan knee */
-    if (config->knee > 0.0f) {
-      float kneeStart = config->threshold - (config->knee / 2.0f);
-      float kneeEnd = config->threshold + (config->knee / 2.0f);
+    if (hot->knee > 0.0f) {
+      float kneeStart = hot->threshold - (hot->knee / 2.0f);
+      float kneeEnd = hot->threshold + (hot->knee / 2.0f);
       
       if (inputLevel < kneeEnd) {
         /* Dalam knee region, terapkan transisi halus */
-        float kneeRatio = (inputLevel - kneeStart) / config->knee;
+        float kneeRatio = (inputLevel - kneeStart) / hot->knee;
         gainReduction = 1.0f - kneeRatio * (1.0f - gainReduction);
       }
     }
@@ -231,13 +262,12 @@ static float Limiter_CalculateGainReduction(uint8_t channel, float inputLevel)
 /**
   * @brief  Update envelope release
   * @param  channel: Channel yang akan diupdate
+  * @param  hot: Parameter limiter untuk frame ini
   * @param  gainReduction: Nilai gain reduction saat ini
   * @retval None
   */
-static void Limiter_UpdateReleaseEnvelope(uint8_t channel, float gainReduction)
+static void Limiter_UpdateReleaseEnvelope(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float gainReduction)
 {
-  Limiter_TypeDef *config = Limiter_GetConfig(channel);
-  
   /* Jika dalam hold period, pertahankan current gain */
   if (limiterState[channel].holdCounter > 0) {
     limiterState[channel].currentGain = limiterState[channel].targetGain;
@@ -247,19 +277,19 @@ static void Limiter_UpdateReleaseEnvelope(uint8_t channel, float gainReduction)
   /* Attack phase - gain reduction semakin besar */
   if (gainReduction < limiterState[channel].currentGain) {
     /* Cepat attack untuk hasil yang responsif */
-    float attackCoeff = 1.0f / limiterState[channel].attackTime;
+    float attackCoeff = hot->attackCoeff;
     limiterState[channel].currentGain = limiterState[channel].currentGain * (1.0f - attackCoeff) + gainReduction * attackCoeff;
   } 
   /* Release phase - gain reduction semakin kecil */
   else if (gainReduction > limiterState[channel].currentGain) {
     /* Release lebih lambat untuk mencegah distorsi */
-    float releaseCoeff = 1.0f / limiterState[channel].releaseTime;
+    float releaseCoeff = hot->releaseCoeff;
     
     /* Gunakan karakteristik release yang eksponen */
     limiterState[channel].currentGain = limiterState[channel].currentGain * (1.0f - releaseCoeff) + gainReduction * releaseCoeff;
     
     /* Adaptif release - semakin besar gain reduction, semakin lambat release */
-    if (config->adaptiveRelease) {
+    if (hot->adaptiveRelease) {
       /* Skala koefisien release berdasarkan gain reduction saat ini */
       float adaptiveScale = 1.0f + 5.0f * (1.0f - limiterState[channel].currentGain);
       limiterState[channel].currentGain = limiterState[channel].currentGain * (1.0f - releaseCoeff/adaptiveScale) + 
@@ -271,14 +301,13 @@ static void Limiter_UpdateReleaseEnvelope(uint8_t channel, float gainReduction)
 /**
   * @brief  Menerapkan proteksi inter-sample peak
   * @param  channel: Channel yang akan diproses
+  * @param  hot: Parameter limiter untuk frame ini
   * @param  inputSample: Sampel input
   * @retval Sampel yang telah diproses
   */
-static float Limiter_ApplyInterSampleProtection(uint8_t channel, float inputSample)
+static float Limiter_ApplyInterSampleProtection(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample)
 {
-  Limiter_TypeDef *config = Limiter_GetConfig(channel);
-  
-  if (!config->enableISP) {
+  if (!hot->enableISP) {
     return inputSample;
   }
   
@@ -316,14 +345,14 @@ static float Limiter_ApplyInterSampleProtection(uint8_t channel, float inputSamp
 /**
   * @brief  Memproses sampel melalui sistem lookahead
   * @param  channel: Channel yang akan diproses
+  * @param  hot: Parameter limiter untuk frame ini
   * @param  inputSample: Sampel input untuk lookahead
   * @retval Sampel dari buffer lookahead
   */
-static float Limiter_ProcessLookahead(uint8_t channel, float inputSample)
+static float Limiter_ProcessLookahead(uint8_t channel, const ParamSnapshot_Limiter_TypeDef *hot, float inputSample)
 {
-  Limiter_TypeDef *config = Limiter_GetConfig(channel);
-  
-  if (!config->enableLookahead || config->lookaheadTime <= 0) {
+  /* lookaheadTime is 0 when lookahead is disabled */
+  if (hot->lookaheadTime == 0) {
     return inputSample;
   }
   
@@ -332,7 +361,7 @@ static float Limiter_ProcessLookahead(uint8_t channel, float inputSample)
   
   /* Hitung indeks output berdasarkan delay lookahead */
   uint16_t outputIndex = (limiterState[channel].lookaheadIndex + 
-                          LIMITER_MAX_LOOKAHEAD - config->lookaheadTime) % 
+                          LIMITER_MAX_LOOKAHEAD - hot->lookaheadTime) % 
                           LIMITER_MAX_LOOKAHEAD;
                           
   /* Ambil sampel dari buffer lookahead untuk output */
@@ -345,32 +374,66 @@ static float Limiter_ProcessLookahead(uint8_t channel, float inputSample)
 }
 
 /**
-  * @brief  Calculate timing parameters for attack and release
-  * @param  channel: Channel to calculate parameters for
+  * @brief  Publish the per-sample values of a configuration to the snapshot
+  * @note   Attack and release are converted from ms to per-sample coefficients
+  * @param  channel: Channel the configuration belongs to
+  * @param  config: Limiter configuration
   * @retval None
   */
-static void Limiter_CalculateTimingParameters(uint8_t channel)
+static void Limiter_PublishParams(uint8_t channel, const Limiter_TypeDef *config)
 {
-  Limiter_TypeDef *config = Limiter_GetConfig(channel);
+  ParamSnapshot_Limiter_TypeDef *hot = &ParamSnapshot_BeginUpdate()->limiter[channel];
   
   /* Convert time values from ms to samples */
   float sampleRate = (float)AUDIO_SAMPLE_RATE;
+  float attackSamples = (config->attackTime / 1000.0f) * sampleRate;
+  float releaseSamples = (config->releaseTime / 1000.0f) * sampleRate;
+  
+  hot->threshold = config->threshold;
+  hot->knee = config->knee;
+  hot->attackCoeff = 1.0f / fmaxf(attackSamples, 1.0f);
+  hot->releaseCoeff = 1.0f / fmaxf(releaseSamples, 1.0f);
+  hot->lookaheadTime = config->enableLookahead ? config->lookaheadTime : 0;
+  hot->enableISP = (config->enableISP && limiterIspAllowed) ? 1 : 0;
+  hot->adaptiveRelease = config->adaptiveRelease ? 1 : 0;
+  
+  ParamSnapshot_Publish();
+}
+
+/**
+  * @brief  Allow or forbid inter-sample peak prediction on all channels
+  * @note   The configured ISP setting is kept and applies again once allowed
+  * @param  allowed: 0 turns ISP off
+  * @retval None
+  */
+void Limiter_SetISPAllowed(uint8_t allowed)
+{
+  limiterIspAllowed = allowed ? 1 : 0;
   
-  /* Calculate attack time (in samples) */
-  limiterState[channel].attackTime = (config->attackTime / 1000.0f) * sampleRate;
-  if (limiterState[channel].attackTime < 1.0f) {
-    limiterState[channel].attackTime = 1.0f;
-  }
-  
-  /* Calculate release time (in samples) */
-  limiterState[channel].releaseTime = (config->releaseTime / 1000.0f) * sampleRate;
-  if (limiterState[channel].releaseTime < 1.0f) {
-    limiterState[channel].releaseTime = 1.0f;
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    Limiter_PublishParams(ch, Limiter_GetConfig(ch));
   }
 }
 
+/**
+  * @brief  Describe the limiter paths to the CPU cost model
+  * @param  lookahead: Lookahead delay enabled
+  * @param  isp: Inter-sample peak prediction enabled
+  * @param  load: Load to fill
+  * @retval None
+  */
+static void Limiter_FillCpuLoad(uint8_t lookahead, uint8_t isp, CpuBudget_Load_TypeDef *load)
+{
+  load->active = 1;
+  load->options = (lookahead ? CPUBUDGET_OPT_LOOKAHEAD : 0U) | (isp ? CPUBUDGET_OPT_ISP : 0U);
+  load->units = 0;
+  load->parts = 0;
+}
+
 /**
   * @brief  Update configuration for limiter
+  * @note   Enabling lookahead or ISP is refused when the frame budget
+  *         cannot take it; the previous configuration then stays.
   * @param  channel: Channel to update
   * @param  config: Pointer to new configuration
   * @retval Status of the update operation
@@ -402,11 +465,20 @@ LimiterStatus_TypeDef Limiter_UpdateConfig(uint8_t channel, Limiter_TypeDef *con
     DEBUG_PRINT("Limiter lookahead time limited to max value\r\n");
   }
   
+  /* Extra paths must fit in the frame */
+  CpuBudget_Load_TypeDef load;
+  Limiter_FillCpuLoad(config->enableLookahead, config->enableISP, &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_LIMITER, channel, &load) != HAL_OK) {
+    return LIMITER_ERROR;
+  }
+  
   /* Save config to global configuration structure */
   Limiter_SetConfig(channel, config);
+  Latency_ReportStage(channel, LATENCY_STAGE_LIMITER,
+                      config->enableLookahead ? config->lookaheadTime : 0);
   
-  /* Recalculate timing parameters */
-  Limiter_CalculateTimingParameters(channel);
+  /* Recalculate timing parameters for the audio side */
+  Limiter_PublishParams(channel, config);
   
   DEBUG_PRINT("Limiter config updated for channel %d: threshold=%f, attack=%f, release=%f\r\n", 
               channel, config->threshold, config->attackTime, config->releaseTime);
@@ -477,9 +549,19 @@ LimiterStatus_TypeDef Limiter_SetLookahead(uint8_t channel, uint16_t lookaheadTi
   
   /* Update configuration */
   Limiter_TypeDef *config = Limiter_GetConfig(channel);
+  CpuBudget_Load_TypeDef load;
+  Limiter_FillCpuLoad((lookaheadTime > 0) ? 1 : 0, config->enableISP, &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_LIMITER, channel, &load) != HAL_OK) {
+    return LIMITER_ERROR;
+  }
+  
   config->lookaheadTime = lookaheadTime;
   config->enableLookahead = (lookaheadTime > 0) ? 1 : 0;
   
+  /* Lookahead delays this output, let the latency manager realign the rest */
+  Latency_ReportStage(channel, LATENCY_STAGE_LIMITER, lookaheadTime);
+  Limiter_PublishParams(channel, config);
+  
   /* Reset buffer if lookahead is disabled */
   if (lookaheadTime == 0) {
     for (uint16_t i = 0; i < LIMITER_MAX_LOOKAHEAD; i++) {
@@ -506,6 +588,7 @@ LimiterStatus_TypeDef Limiter_SetAdaptiveRelease(uint8_t channel, uint8_t enable
   /* Update configuration */
   Limiter_TypeDef *config = Limiter_GetConfig(channel);
   config->adaptiveRelease = enable ? 1 : 0;
+  Limiter_PublishParams(channel, config);
   
   return LIMITER_OK;
 }
@@ -0,0 +1,895 @@
+/**
+  ******************************************************************************
+  * @file           : param_registry.c
+  * @brief          : Central parameter table addressed by numeric ID
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The table holds one entry per family, not per parameter: channel and
+  * index only select a slot inside the family. The module adapters at the
+  * end of the file are the only code that knows the setter of each family.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "param_registry.h"
+#include "peq.h"
+#include "crossover.h"
+#include "compressor.h"
+#include "limiter.h"
+#include "delay.h"
+#include "audio_driver.h"
+#include "input_strip.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define PARAM_PEQ_SLOTS             (AUDIO_OUTPUT_CHANNELS * PARAM_PEQ_BANDS)
+#define PARAM_OUTPUT_BASE           (5U * PARAM_PEQ_SLOTS)
+#define PARAM_OUTPUT_SLOT(n)        (PARAM_OUTPUT_BASE + (n) * AUDIO_OUTPUT_CHANNELS)
+#define PARAM_MASTER_SLOT           PARAM_OUTPUT_SLOT(15U)
+#define PARAM_INPUT_SLOT(n)         (PARAM_MASTER_SLOT + 1U + (n) * AUDIO_INPUT_CHANNELS)
+#define PARAM_DIRTY_WORDS           ((PARAM_IMAGE_SLOTS + 31U) / 32U)
+#define PARAM_GAIN_FLOOR_DB         -100.0f     /* Output gain shown for a muted output */
+#define PARAM_OUT_CH                AUDIO_OUTPUT_CHANNELS
+#define PARAM_IN_CH                 AUDIO_INPUT_CHANNELS
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef Param_SetPeq(uint8_t family, uint8_t channel, uint8_t index, float value);
+static float Param_GetPeq(uint8_t family, uint8_t channel, uint8_t index);
+static HAL_StatusTypeDef Param_SetCrossover(uint8_t family, uint8_t channel, uint8_t index, float value);
+static float Param_GetCrossover(uint8_t family, uint8_t channel, uint8_t index);
+static HAL_StatusTypeDef Param_SetCompressor(uint8_t family, uint8_t channel, uint8_t index, float value);
+static float Param_GetCompressor(uint8_t family, uint8_t channel, uint8_t index);
+static HAL_StatusTypeDef Param_SetOutput(uint8_t family, uint8_t channel, uint8_t index, float value);
+static float Param_GetOutput(uint8_t family, uint8_t channel, uint8_t index);
+static HAL_StatusTypeDef Param_SetInput(uint8_t family, uint8_t channel, uint8_t index, float value);
+static float Param_GetInput(uint8_t family, uint8_t channel, uint8_t index);
+
+static void ParamRegistry_LoadGroup(uint8_t group);
+static void ParamRegistry_Stage(const ParamRegistry_Entry_TypeDef *entry, uint16_t slot, float value);
+static HAL_StatusTypeDef ParamRegistry_Commit(void);
+static HAL_StatusTypeDef ParamRegistry_CommitPeq(void);
+static HAL_StatusTypeDef ParamRegistry_CommitCrossover(void);
+static uint8_t ParamRegistry_IsDirty(uint16_t slot);
+
+/* Private variables ---------------------------------------------------------*/
+static const ParamRegistry_Entry_TypeDef families[PARAM_FAMILY_COUNT] = {
+  /* name               type              law               group                  ch            idx              offset                  min                  max                                 set                  get */
+  { "PEQ_ENABLE",      PARAM_TYPE_BOOL,  PARAM_LAW_STEP,   PARAM_GROUP_PEQ,       PARAM_OUT_CH, PARAM_PEQ_BANDS, 0U * PARAM_PEQ_SLOTS,   0.0f,                1.0f,                               Param_SetPeq,        Param_GetPeq },
+  { "PEQ_TYPE",        PARAM_TYPE_ENUM,  PARAM_LAW_STEP,   PARAM_GROUP_PEQ,       PARAM_OUT_CH, PARAM_PEQ_BANDS, 1U * PARAM_PEQ_SLOTS,   0.0f,                (float)(PEQ_TYPE_MAX - 1),         Param_SetPeq,        Param_GetPeq },
+  { "PEQ_FREQ",        PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_PEQ,       PARAM_OUT_CH, PARAM_PEQ_BANDS, 2U * PARAM_PEQ_SLOTS,   20.0f,               20000.0f,                           Param_SetPeq,        Param_GetPeq },
+  { "PEQ_GAIN",        PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_PEQ,       PARAM_OUT_CH, PARAM_PEQ_BANDS, 3U * PARAM_PEQ_SLOTS,   -12.0f,              12.0f,                              Param_SetPeq,        Param_GetPeq },
+  { "PEQ_Q",           PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_PEQ,       PARAM_OUT_CH, PARAM_PEQ_BANDS, 4U * PARAM_PEQ_SLOTS,   0.1f,                10.0f,                              Param_SetPeq,        Param_GetPeq },
+  { "XOVER_ENABLE",    PARAM_TYPE_BOOL,  PARAM_LAW_STEP,   PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(0U),  0.0f,                1.0f,                               Param_SetCrossover,  Param_GetCrossover },
+  { "XOVER_TYPE",      PARAM_TYPE_ENUM,  PARAM_LAW_STEP,   PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(1U),  0.0f,                (float)(CROSSOVER_TYPE_COUNT - 1),  Param_SetCrossover,  Param_GetCrossover },
+  { "XOVER_ORDER",     PARAM_TYPE_ENUM,  PARAM_LAW_STEP,   PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(2U),  0.0f,                (float)(CROSSOVER_ORDER_COUNT - 1), Param_SetCrossover,  Param_GetCrossover },
+  { "XOVER_BANDPASS",  PARAM_TYPE_BOOL,  PARAM_LAW_STEP,   PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(3U),  0.0f,                1.0f,                               Param_SetCrossover,  Param_GetCrossover },
+  { "XOVER_HP_FREQ",   PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(4U),  20.0f,               20000.0f,                           Param_SetCrossover,  Param_GetCrossover },
+  { "XOVER_LP_FREQ",   PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_CROSSOVER, PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(5U),  20.0f,               20000.0f,                           Param_SetCrossover,  Param_GetCrossover },
+  { "COMP_ENABLE",     PARAM_TYPE_BOOL,  PARAM_LAW_STEP,   PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(6U),  0.0f,                1.0f,                               Param_SetCompressor, Param_GetCompressor },
+  { "COMP_THRESHOLD",  PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(7U),  -60.0f,              0.0f,                               Param_SetCompressor, Param_GetCompressor },
+  { "COMP_RATIO",      PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(8U),  1.0f,                20.0f,                              Param_SetCompressor, Param_GetCompressor },
+  { "COMP_ATTACK",     PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(9U),  0.1f,                100.0f,                             Param_SetCompressor, Param_GetCompressor },
+  { "COMP_RELEASE",    PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(10U), 10.0f,               1000.0f,                            Param_SetCompressor, Param_GetCompressor },
+  { "COMP_MAKEUP",     PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_DYNAMICS,  PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(11U), 0.0f,                24.0f,                              Param_SetCompressor, Param_GetCompressor },
+  { "LIMIT_THRESHOLD", PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_LIMITER,   PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(12U), -20.0f,              0.0f,                               Param_SetOutput,     Param_GetOutput },
+  /* DELAY_TIME is after temperature compensation, its max is per channel and storage format, see ParamRegistry_GetRange() */
+  { "DELAY_TIME",      PARAM_TYPE_FLOAT, PARAM_LAW_LINEAR, PARAM_GROUP_DELAY,     PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(13U), 0.0f,                (float)MAX_DELAY_MS,                Param_SetOutput,     Param_GetOutput },
+  { "OUTPUT_GAIN",     PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_OUTPUT,    PARAM_OUT_CH, 1,               PARAM_OUTPUT_SLOT(14U), PARAM_GAIN_FLOOR_DB, 12.0f,                              Param_SetOutput,     Param_GetOutput },
+  { "MASTER_VOLUME",   PARAM_TYPE_FLOAT, PARAM_LAW_DB,     PARAM_GROUP_OUTPUT,    1,            1,               PARAM_MASTER_SLOT,      AUDIO_MASTER_MIN_DB, 0.0f,                               Param_SetOutput,     Param_GetOutput },
+  { "INPUT_HPF_FREQ",  PARAM_TYPE_FLOAT, PARAM_LAW_LOG,    PARAM_GROUP_INPUT,     PARAM_IN_CH,  1,               PARAM_INPUT_SLOT(0U),   0.0f,                INPUT_STRIP_HPF_MAX_HZ,             Param_SetInput,      Param_GetInput },
+  { "INPUT_DELAY",     PARAM_TYPE_FLOAT, PARAM_LAW_LINEAR, PARAM_GROUP_INPUT,     PARAM_IN_CH,  1,               PARAM_INPUT_SLOT(1U),   0.0f,                INPUT_STRIP_MAX_DELAY_MS,           Param_SetInput,      Param_GetInput },
+  { "INPUT_INVERT",    PARAM_TYPE_BOOL,  PARAM_LAW_STEP,   PARAM_GROUP_INPUT,     PARAM_IN_CH,  1,               PARAM_INPUT_SLOT(2U),   0.0f,                1.0f,                               Param_SetInput,      Param_GetInput }
+};
+
+/* Batch staging */
+static float stage[PARAM_IMAGE_SLOTS];
+static uint32_t dirtySlots[PARAM_DIRTY_WORDS];
+static uint8_t loadedGroups;
+static uint8_t dirtyGroups;
+static uint8_t batchDepth;
+
+/**
+  * @brief  Reset the batch state
+  * @note   The parameters themselves live in their modules, nothing to load
+  * @retval None
+  */
+void ParamRegistry_Init(void)
+{
+  memset(dirtySlots, 0, sizeof(dirtySlots));
+  loadedGroups = 0;
+  dirtyGroups = 0;
+  batchDepth = 0;
+
+  DEBUG_PRINT("Param registry: %u families, %u slots\r\n",
+              (unsigned)PARAM_FAMILY_COUNT, (unsigned)PARAM_IMAGE_SLOTS);
+}
+
+/**
+  * @brief  Resolve an ID
+  * @param  id: Parameter ID
+  * @param  slot: Pointer to store the image slot, may be NULL
+  * @retval Family entry, NULL if the ID does not exist
+  */
+const ParamRegistry_Entry_TypeDef *ParamRegistry_Lookup(uint16_t id, uint16_t *slot)
+{
+  const uint8_t family = PARAM_ID_FAMILY(id);
+  const uint8_t channel = PARAM_ID_CHANNEL(id);
+  const uint8_t index = PARAM_ID_INDEX(id);
+  const ParamRegistry_Entry_TypeDef *entry;
+
+  if (family >= PARAM_FAMILY_COUNT) {
+    return NULL;
+  }
+
+  entry = &families[family];
+  if (channel >= entry->channels || index >= entry->indices) {
+    return NULL;
+  }
+
+  if (slot != NULL) {
+    *slot = (uint16_t)(entry->offset + channel * entry->indices + index);
+  }
+  return entry;
+}
+
+/**
+  * @brief  Get the table entry of a family
+  * @param  family: PARAM_x family
+  * @retval Family entry, NULL if out of range
+  */
+const ParamRegistry_Entry_TypeDef *ParamRegistry_GetFamily(ParamRegistry_Family_TypeDef family)
+{
+  return ((uint32_t)family < PARAM_FAMILY_COUNT) ? &families[family] : NULL;
+}
+
+/**
+  * @brief  Get the range a parameter accepts right now
+  * @note   The table range, except for the delay time: its maximum follows
+  *         the storage format of the channel's delay line
+  * @param  id: Parameter ID
+  * @param  min: Pointer to store the minimum, may be NULL
+  * @param  max: Pointer to store the maximum, may be NULL
+  * @retval HAL_ERROR if the ID does not exist
+  */
+HAL_StatusTypeDef ParamRegistry_GetRange(uint16_t id, float *min, float *max)
+{
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+  float upper;
+
+  if (entry == NULL) {
+    return HAL_ERROR;
+  }
+
+  upper = entry->max;
+  if (PARAM_ID_FAMILY(id) == PARAM_DELAY_TIME) {
+    upper = Delay_GetMaxDelayMs(PARAM_ID_CHANNEL(id));
+  }
+
+  if (min != NULL) {
+    *min = entry->min;
+  }
+  if (max != NULL) {
+    *max = upper;
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Check a value against the type and range of a parameter
+  * @param  id: Parameter ID
+  * @param  value: Value in engineering units
+  * @retval HAL_OK if it would be accepted, HAL_ERROR otherwise
+  */
+HAL_StatusTypeDef ParamRegistry_Validate(uint16_t id, float value)
+{
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+  float min, max;
+
+  if (entry == NULL || !isfinite(value)) {
+    return HAL_ERROR;
+  }
+
+  ParamRegistry_GetRange(id, &min, &max);
+  if (value < min || value > max) {
+    return HAL_ERROR;
+  }
+
+  if (entry->type != PARAM_TYPE_FLOAT && value != floorf(value)) {
+    return HAL_ERROR;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Set a parameter
+  * @note   Inside a batch the value is only staged. Outside it goes to the
+  *         module at once and its status is returned, e.g. HAL_BUSY when
+  *         the CPU budget refuses it.
+  * @param  id: Parameter ID
+  * @param  value: Value in engineering units
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef ParamRegistry_Set(uint16_t id, float value)
+{
+  uint16_t slot;
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, &slot);
+
+  if (ParamRegistry_Validate(id, value) != HAL_OK) {
+    DEBUG_PRINT("Param 0x%04X: invalid value %f\r\n", (unsigned)id, value);
+    return HAL_ERROR;
+  }
+
+  if (batchDepth > 0U) {
+    ParamRegistry_Stage(entry, slot, value);
+    return HAL_OK;
+  }
+
+  return entry->set(PARAM_ID_FAMILY(id), PARAM_ID_CHANNEL(id), PARAM_ID_INDEX(id), value);
+}
+
+/**
+  * @brief  Read a parameter
+  * @note   Inside a batch a staged value is returned
+  * @param  id: Parameter ID
+  * @param  value: Pointer to store the value
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef ParamRegistry_Get(uint16_t id, float *value)
+{
+  uint16_t slot;
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, &slot);
+
+  if (entry == NULL || value == NULL) {
+    return HAL_ERROR;
+  }
+
+  if (batchDepth > 0U && (loadedGroups & (1U << entry->group))) {
+    *value = stage[slot];
+  } else {
+    *value = entry->get(PARAM_ID_FAMILY(id), PARAM_ID_CHANNEL(id), PARAM_ID_INDEX(id));
+  }
+  return HAL_OK;
+}
+
+/**
+  * @brief  Open a batch, may be nested
+  * @retval None
+  */
+void ParamRegistry_BeginBatch(void)
+{
+  if (batchDepth == 0U) {
+    memset(dirtySlots, 0, sizeof(dirtySlots));
+    loadedGroups = 0;
+    dirtyGroups = 0;
+  }
+  batchDepth++;
+}
+
+/**
+  * @brief  Close a batch, the outermost one applies the staged changes
+  * @retval Status of the first group that failed, HAL_OK if none did
+  */
+HAL_StatusTypeDef ParamRegistry_EndBatch(void)
+{
+  if (batchDepth == 0U) {
+    return HAL_ERROR;
+  }
+
+  if (--batchDepth > 0U) {
+    return HAL_OK;
+  }
+
+  return ParamRegistry_Commit();
+}
+
+/**
+  * @brief  Set several parameters as one batch
+  * @note   All values are validated first, one bad value rejects the lot
+  * @param  values: ID and value pairs
+  * @param  count: Number of pairs
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef ParamRegistry_SetBatch(const ParamRegistry_Value_TypeDef *values, uint32_t count)
+{
+  if (values == NULL) {
+    return HAL_ERROR;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (ParamRegistry_Validate(values[i].id, values[i].value) != HAL_OK) {
+      DEBUG_PRINT("Param 0x%04X: invalid value %f, batch rejected\r\n",
+                  (unsigned)values[i].id, values[i].value);
+      return HAL_ERROR;
+    }
+  }
+
+  ParamRegistry_BeginBatch();
+  for (uint32_t i = 0; i < count; i++) {
+    ParamRegistry_Set(values[i].id, values[i].value);
+  }
+  return ParamRegistry_EndBatch();
+}
+
+/**
+  * @brief  Read every parameter into an image, e.g. for a preset
+  * @param  image: Image to fill
+  * @retval None
+  */
+void ParamRegistry_CaptureImage(float image[PARAM_IMAGE_SLOTS])
+{
+  if (image == NULL) {
+    return;
+  }
+
+  for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+    const ParamRegistry_Entry_TypeDef *entry = &families[f];
+
+    for (uint8_t ch = 0; ch < entry->channels; ch++) {
+      for (uint8_t idx = 0; idx < entry->indices; idx++) {
+        image[entry->offset + ch * entry->indices + idx] = entry->get(f, ch, idx);
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Apply a captured image as one batch
+  * @note   Only values that differ from the live ones are applied
+  * @param  image: Image from ParamRegistry_CaptureImage()
+  * @retval HAL_ERROR if any value is invalid, nothing is applied then
+  */
+HAL_StatusTypeDef ParamRegistry_ApplyImage(const float image[PARAM_IMAGE_SLOTS])
+{
+  if (image == NULL) {
+    return HAL_ERROR;
+  }
+
+  for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+    const ParamRegistry_Entry_TypeDef *entry = &families[f];
+
+    for (uint8_t ch = 0; ch < entry->channels; ch++) {
+      for (uint8_t idx = 0; idx < entry->indices; idx++) {
+        if (ParamRegistry_Validate(PARAM_ID(f, ch, idx), image[entry->offset + ch * entry->indices + idx]) != HAL_OK) {
+          DEBUG_PRINT("Param image: invalid %s ch %u idx %u\r\n", entry->name, ch, idx);
+          return HAL_ERROR;
+        }
+      }
+    }
+  }
+
+  ParamRegistry_BeginBatch();
+  for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+    const ParamRegistry_Entry_TypeDef *entry = &families[f];
+
+    for (uint16_t n = 0; n < (uint16_t)(entry->channels * entry->indices); n++) {
+      ParamRegistry_Stage(entry, (uint16_t)(entry->offset + n), image[entry->offset + n]);
+    }
+  }
+  return ParamRegistry_EndBatch();
+}
+
+/**
+  * @brief  Interpolate a parameter by its law
+  * @param  id: Parameter ID
+  * @param  from: Value at t = 0
+  * @param  to: Value at t = 1
+  * @param  t: Position, 0.0 to 1.0
+  * @retval Value at t; discrete parameters switch at the midpoint
+  */
+float ParamRegistry_Interpolate(uint16_t id, float from, float to, float t)
+{
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+
+  if (entry == NULL || from == to) {
+    return (t < 0.5f) ? from : to;
+  }
+
+  switch (entry->law) {
+    case PARAM_LAW_STEP:
+      return (t < 0.5f) ? from : to;
+
+    case PARAM_LAW_LOG:
+      if (from > 0.0f && to > 0.0f) {
+        return from * powf(to / from, t);
+      }
+      return from + (to - from) * t;
+
+    default:
+      return from + (to - from) * t;
+  }
+}
+
+/**
+  * @brief  Map a value to 0.0..1.0 by its law, for encoders and sliders
+  * @param  id: Parameter ID
+  * @param  value: Value in engineering units
+  * @retval Normalized position, 0.0 for an unknown ID
+  */
+float ParamRegistry_ToNormalized(uint16_t id, float value)
+{
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+  float min, max;
+  float n;
+
+  if (entry == NULL) {
+    return 0.0f;
+  }
+
+  ParamRegistry_GetRange(id, &min, &max);
+  if (max <= min) {
+    return 0.0f;
+  }
+
+  if (entry->law == PARAM_LAW_LOG && min > 0.0f) {
+    n = logf(fmaxf(value, min) / min) / logf(max / min);
+  } else {
+    n = (value - min) / (max - min);
+  }
+
+  return fminf(fmaxf(n, 0.0f), 1.0f);
+}
+
+/**
+  * @brief  Map a normalized position back to a valid value
+  * @param  id: Parameter ID
+  * @param  normalized: Position, clamped to 0.0..1.0
+  * @retval Value in engineering units, rounded for enums and flags
+  */
+float ParamRegistry_FromNormalized(uint16_t id, float normalized)
+{
+  const ParamRegistry_Entry_TypeDef *entry = ParamRegistry_Lookup(id, NULL);
+  const float n = fminf(fmaxf(normalized, 0.0f), 1.0f);
+  float min, max;
+  float value;
+
+  if (entry == NULL) {
+    return 0.0f;
+  }
+
+  ParamRegistry_GetRange(id, &min, &max);
+  if (entry->law == PARAM_LAW_LOG && min > 0.0f) {
+    value = min * powf(max / min, n);
+  } else {
+    value = min + (max - min) * n;
+  }
+
+  if (entry->type != PARAM_TYPE_FLOAT) {
+    value = roundf(value);
+  }
+
+  return fminf(fmaxf(value, min), max);
+}
+
+/**
+  * @brief  Copy the live values of a group into the stage
+  * @param  group: PARAM_GROUP_x
+  * @retval None
+  */
+static void ParamRegistry_LoadGroup(uint8_t group)
+{
+  for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+    const ParamRegistry_Entry_TypeDef *entry = &families[f];
+
+    if (entry->group != group) {
+      continue;
+    }
+
+    for (uint8_t ch = 0; ch < entry->channels; ch++) {
+      for (uint8_t idx = 0; idx < entry->indices; idx++) {
+        stage[entry->offset + ch * entry->indices + idx] = entry->get(f, ch, idx);
+      }
+    }
+  }
+
+  loadedGroups |= (uint8_t)(1U << group);
+}
+
+/**
+  * @brief  Stage a validated value, marking it dirty if it changes
+  * @param  entry: Family entry
+  * @param  slot: Image slot
+  * @param  value: Value
+  * @retval None
+  */
+static void ParamRegistry_Stage(const ParamRegistry_Entry_TypeDef *entry, uint16_t slot, float value)
+{
+  if (!(loadedGroups & (1U << entry->group))) {
+    ParamRegistry_LoadGroup(entry->group);
+  }
+
+  if (stage[slot] == value) {
+    return;
+  }
+
+  stage[slot] = value;
+  dirtySlots[slot >> 5] |= 1UL << (slot & 31U);
+  dirtyGroups |= (uint8_t)(1U << entry->group);
+}
+
+/**
+  * @brief  Apply the dirty groups of the closed batch
+  * @retval Status of the first failure, HAL_OK if none
+  */
+static HAL_StatusTypeDef ParamRegistry_Commit(void)
+{
+  HAL_StatusTypeDef result = HAL_OK;
+  HAL_StatusTypeDef status;
+
+  if (dirtyGroups & (1U << PARAM_GROUP_PEQ)) {
+    result = ParamRegistry_CommitPeq();
+  }
+
+  if (dirtyGroups & (1U << PARAM_GROUP_CROSSOVER)) {
+    status = ParamRegistry_CommitCrossover();
+    if (result == HAL_OK) {
+      result = status;
+    }
+  }
+
+  /* Everything else has a setter per value */
+  for (uint8_t f = 0; f < PARAM_FAMILY_COUNT; f++) {
+    const ParamRegistry_Entry_TypeDef *entry = &families[f];
+
+    if (entry->group == PARAM_GROUP_PEQ || entry->group == PARAM_GROUP_CROSSOVER ||
+        !(dirtyGroups & (1U << entry->group))) {
+      continue;
+    }
+
+    for (uint8_t ch = 0; ch < entry->channels; ch++) {
+      for (uint8_t idx = 0; idx < entry->indices; idx++) {
+        const uint16_t slot = (uint16_t)(entry->offset + ch * entry->indices + idx);
+
+        if (!ParamRegistry_IsDirty(slot)) {
+          continue;
+        }
+
+        status = entry->set(f, ch, idx, stage[slot]);
+        if (status != HAL_OK && result == HAL_OK) {
+          result = status;
+        }
+      }
+    }
+  }
+
+  dirtyGroups = 0;
+  loadedGroups = 0;
+  return result;
+}
+
+/**
+  * @brief  Apply all PEQ bands in one designer batch
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef ParamRegistry_CommitPeq(void)
+{
+  PEQBand_TypeDef bands[AUDIO_OUTPUT_CHANNELS][PARAM_PEQ_BANDS];
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    for (uint8_t b = 0; b < PARAM_PEQ_BANDS; b++) {
+      const uint16_t n = (uint16_t)(ch * PARAM_PEQ_BANDS + b);
+      PEQBand_TypeDef *band = &bands[ch][b];
+
+      band->enabled = (uint8_t)stage[families[PARAM_PEQ_ENABLE].offset + n];
+      band->type = (uint8_t)stage[families[PARAM_PEQ_TYPE].offset + n];
+      band->frequency = stage[families[PARAM_PEQ_FREQ].offset + n];
+      band->gain = stage[families[PARAM_PEQ_GAIN].offset + n];
+      band->q = stage[families[PARAM_PEQ_Q].offset + n];
+    }
+  }
+
+  return PEQ_ConfigureAllBands(bands);
+}
+
+/**
+  * @brief  Apply one crossover update per channel with dirty values
+  * @retval Status of the first failure, HAL_OK if none
+  */
+static HAL_StatusTypeDef ParamRegistry_CommitCrossover(void)
+{
+  HAL_StatusTypeDef result = HAL_OK;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    CrossoverConfig_TypeDef config;
+    uint8_t dirty = 0;
+    HAL_StatusTypeDef status;
+
+    for (uint8_t f = PARAM_XOVER_ENABLE; f <= PARAM_XOVER_LP_FREQ; f++) {
+      dirty |= ParamRegistry_IsDirty((uint16_t)(families[f].offset + ch));
+    }
+    if (!dirty) {
+      continue;
+    }
+
+    Crossover_Config_Get(ch, &config);
+    config.isEnabled = (uint8_t)stage[families[PARAM_XOVER_ENABLE].offset + ch];
+    config.filterType = (uint8_t)stage[families[PARAM_XOVER_TYPE].offset + ch];
+    config.filterOrder = (uint8_t)stage[families[PARAM_XOVER_ORDER].offset + ch];
+    config.bandPassEnabled = (uint8_t)stage[families[PARAM_XOVER_BANDPASS].offset + ch];
+    config.highPassFreq = stage[families[PARAM_XOVER_HP_FREQ].offset + ch];
+    config.lowPassFreq = stage[families[PARAM_XOVER_LP_FREQ].offset + ch];
+
+    status = Crossover_Config_Set(ch, &config);
+    if (status != HAL_OK && result == HAL_OK) {
+      result = status;
+    }
+  }
+
+  return result;
+}
+
+/**
+  * @brief  Check the dirty bit of a slot
+  * @param  slot: Image slot
+  * @retval 1 if dirty
+  */
+static uint8_t ParamRegistry_IsDirty(uint16_t slot)
+{
+  return (dirtySlots[slot >> 5] & (1UL << (slot & 31U))) ? 1U : 0U;
+}
+
+/* Module adapters -----------------------------------------------------------*/
+
+/**
+  * @brief  Set one field of a PEQ band
+  * @param  family: PARAM_PEQ_x
+  * @param  channel: Output channel
+  * @param  index: Band
+  * @param  value: Value
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef Param_SetPeq(uint8_t family, uint8_t channel, uint8_t index, float value)
+{
+  PEQBand_TypeDef band;
+
+  if (PEQ_GetBandConfig(channel, index, &band) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  switch (family) {
+    case PARAM_PEQ_ENABLE: band.enabled = (uint8_t)value; break;
+    case PARAM_PEQ_TYPE:   band.type = (uint8_t)value;    break;
+    case PARAM_PEQ_FREQ:   band.frequency = value;        break;
+    case PARAM_PEQ_GAIN:   band.gain = value;             break;
+    default:               band.q = value;                break;
+  }
+
+  return PEQ_ConfigureBand(channel, index, &band);
+}
+
+/**
+  * @brief  Get one field of a PEQ band
+  * @param  family: PARAM_PEQ_x
+  * @param  channel: Output channel
+  * @param  index: Band
+  * @retval Value
+  */
+static float Param_GetPeq(uint8_t family, uint8_t channel, uint8_t index)
+{
+  PEQBand_TypeDef band;
+
+  if (PEQ_GetBandConfig(channel, index, &band) != HAL_OK) {
+    return families[family].min;
+  }
+
+  switch (family) {
+    case PARAM_PEQ_ENABLE: return (float)band.enabled;
+    case PARAM_PEQ_TYPE:   return (float)band.type;
+    case PARAM_PEQ_FREQ:   return band.frequency;
+    case PARAM_PEQ_GAIN:   return band.gain;
+    default:               return band.q;
+  }
+}
+
+/**
+  * @brief  Set one field of a crossover channel
+  * @param  family: PARAM_XOVER_x
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @param  value: Value
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef Param_SetCrossover(uint8_t family, uint8_t channel, uint8_t index, float value)
+{
+  CrossoverConfig_TypeDef config;
+
+  (void)index;
+  Crossover_Config_Get(channel, &config);
+
+  switch (family) {
+    case PARAM_XOVER_ENABLE:   config.isEnabled = (uint8_t)value;       break;
+    case PARAM_XOVER_TYPE:     config.filterType = (uint8_t)value;      break;
+    case PARAM_XOVER_ORDER:    config.filterOrder = (uint8_t)value;     break;
+    case PARAM_XOVER_BANDPASS: config.bandPassEnabled = (uint8_t)value; break;
+    case PARAM_XOVER_HP_FREQ:  config.highPassFreq = value;             break;
+    default:                   config.lowPassFreq = value;              break;
+  }
+
+  return Crossover_Config_Set(channel, &config);
+}
+
+/**
+  * @brief  Get one field of a crossover channel
+  * @param  family: PARAM_XOVER_x
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @retval Value
+  */
+static float Param_GetCrossover(uint8_t family, uint8_t channel, uint8_t index)
+{
+  CrossoverConfig_TypeDef config;
+
+  (void)index;
+  Crossover_Config_Get(channel, &config);
+
+  switch (family) {
+    case PARAM_XOVER_ENABLE:   return (float)config.isEnabled;
+    case PARAM_XOVER_TYPE:     return (float)config.filterType;
+    case PARAM_XOVER_ORDER:    return (float)config.filterOrder;
+    case PARAM_XOVER_BANDPASS: return (float)config.bandPassEnabled;
+    case PARAM_XOVER_HP_FREQ:  return config.highPassFreq;
+    default:                   return config.lowPassFreq;
+  }
+}
+
+/**
+  * @brief  Set a compressor parameter
+  * @param  family: PARAM_COMP_x
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @param  value: Value
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef Param_SetCompressor(uint8_t family, uint8_t channel, uint8_t index, float value)
+{
+  (void)index;
+
+  switch (family) {
+    case PARAM_COMP_ENABLE:    return DSP_Compressor_SetEnabled(channel, (uint8_t)value);
+    case PARAM_COMP_THRESHOLD: return DSP_Compressor_SetThreshold(channel, value);
+    case PARAM_COMP_RATIO:     return DSP_Compressor_SetRatio(channel, value);
+    case PARAM_COMP_ATTACK:    return DSP_Compressor_SetAttack(channel, value);
+    case PARAM_COMP_RELEASE:   return DSP_Compressor_SetRelease(channel, value);
+    default:                   return DSP_Compressor_SetMakeupGain(channel, value);
+  }
+}
+
+/**
+  * @brief  Get a compressor parameter
+  * @param  family: PARAM_COMP_x
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @retval Value
+  */
+static float Param_GetCompressor(uint8_t family, uint8_t channel, uint8_t index)
+{
+  float threshold = 0.0f, ratio = 1.0f, attack = 0.1f, release = 10.0f, makeup = 0.0f;
+
+  (void)index;
+  if (family == PARAM_COMP_ENABLE) {
+    return (float)DSP_Compressor_GetEnabled(channel);
+  }
+
+  DSP_Compressor_GetConfig(channel, &threshold, &ratio, &attack, &release, &makeup, NULL, NULL);
+
+  switch (family) {
+    case PARAM_COMP_THRESHOLD: return threshold;
+    case PARAM_COMP_RATIO:     return ratio;
+    case PARAM_COMP_ATTACK:    return attack;
+    case PARAM_COMP_RELEASE:   return release;
+    default:                   return makeup;
+  }
+}
+
+/**
+  * @brief  Set a per-output level or time, or the master volume
+  * @param  family: PARAM_LIMIT_THRESHOLD, PARAM_DELAY_TIME, PARAM_OUTPUT_GAIN
+  *         or PARAM_MASTER_VOLUME
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @param  value: Value
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef Param_SetOutput(uint8_t family, uint8_t channel, uint8_t index, float value)
+{
+  (void)index;
+
+  switch (family) {
+    case PARAM_LIMIT_THRESHOLD: return DSP_Limiter_SetThreshold(channel, value);
+    case PARAM_DELAY_TIME:      return Delay_SetCompensatedTime(channel, value);
+    case PARAM_OUTPUT_GAIN:
+      return Audio_SetOutputGain(channel, (value <= PARAM_GAIN_FLOOR_DB) ? 0.0f : powf(10.0f, value / 20.0f));
+    default:                    return Audio_SetMasterVolume(value);
+  }
+}
+
+/**
+  * @brief  Get a per-output level or time, or the master volume
+  * @param  family: See Param_SetOutput()
+  * @param  channel: Output channel
+  * @param  index: Unused
+  * @retval Value
+  */
+static float Param_GetOutput(uint8_t family, uint8_t channel, uint8_t index)
+{
+  (void)index;
+
+  switch (family) {
+    case PARAM_LIMIT_THRESHOLD: {
+      LimiterParams_TypeDef limiter;
+
+      return (DSP_Limiter_GetConfig(channel, &limiter) == HAL_OK) ? limiter.thresholdDb : 0.0f;
+    }
+
+    case PARAM_DELAY_TIME:
+      return Delay_GetCompensatedTime(channel);
+
+    case PARAM_OUTPUT_GAIN: {
+      const float gain = Audio_GetStatus().outputGain[channel];
+
+      return (gain > 0.0f) ? fmaxf(20.0f * log10f(gain), PARAM_GAIN_FLOOR_DB) : PARAM_GAIN_FLOOR_DB;
+    }
+
+    default:
+      return Audio_GetMasterVolume();
+  }
+}
+
+/**
+  * @brief  Set an input strip parameter
+  * @param  family: PARAM_INPUT_x
+  * @param  channel: Input channel
+  * @param  index: Unused
+  * @param  value: Value
+  * @retval HAL_StatusTypeDef
+  */
+static HAL_StatusTypeDef Param_SetInput(uint8_t family, uint8_t channel, uint8_t index, float value)
+{
+  InputStrip_Params_TypeDef params;
+
+  (void)index;
+
+  switch (family) {
+    case PARAM_INPUT_HPF_FREQ:
+      /* Keeps the slope, only the corner is a registry parameter */
+      if (InputStrip_GetParams(channel, &params) != HAL_OK) {
+        return HAL_ERROR;
+      }
+      return InputStrip_SetHighPass(channel, value, params.hpfOrder);
+
+    case PARAM_INPUT_DELAY:
+      return InputStrip_SetDelay(channel, value);
+
+    default:
+      return InputStrip_SetInvert(channel, (uint8_t)value);
+  }
+}
+
+/**
+  * @brief  Get an input strip parameter
+  * @param  family: PARAM_INPUT_x
+  * @param  channel: Input channel
+  * @param  index: Unused
+  * @retval Value
+  */
+static float Param_GetInput(uint8_t family, uint8_t channel, uint8_t index)
+{
+  InputStrip_Params_TypeDef params;
+
+  (void)index;
+  if (InputStrip_GetParams(channel, &params) != HAL_OK) {
+    return 0.0f;
+  }
+
+  switch (family) {
+    case PARAM_INPUT_HPF_FREQ: return params.hpfFrequency;
+    case PARAM_INPUT_DELAY:    return params.delayMs;
+    default:                   return (float)params.invert;
+  }
+}
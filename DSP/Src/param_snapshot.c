@@ -0,0 +1,144 @@
+/**
+  ******************************************************************************
+  * @file           : param_snapshot.c
+  * @brief          : Per-frame snapshot of the runtime parameters hot loops read
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Triple buffer: one block is the latest published, one may be held by the
+  * running frame and the third is free for the next edit. The audio side
+  * announces the block it reads before using it and re-checks that it is
+  * still the latest, so an edit started in between never picks it.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "param_snapshot.h"
+#include "main.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define PARAM_SNAPSHOT_COUNT        3U
+#define PARAM_SNAPSHOT_NONE         0xFFU
+
+/* Private macro -------------------------------------------------------------*/
+#ifdef AUDIO_SIM
+#define PARAM_SNAPSHOT_BARRIER()    __sync_synchronize()
+#else
+#define PARAM_SNAPSHOT_BARRIER()    __DMB()
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static ParamSnapshot_TypeDef snapshots[PARAM_SNAPSHOT_COUNT];
+static volatile uint8_t activeIndex = 0;             /* Latest published block */
+static volatile uint8_t frameIndex = 0;              /* Block of the running frame */
+static uint8_t editIndex = PARAM_SNAPSHOT_NONE;      /* Block being edited */
+static const ParamSnapshot_TypeDef *frameSnapshot = &snapshots[0];
+
+/**
+  * @brief  Fill every block with pass-through defaults
+  * @note   Call before the modules that publish their settings are initialized
+  * @retval None
+  */
+void ParamSnapshot_Init(void)
+{
+  ParamSnapshot_TypeDef *s = &snapshots[0];
+
+  memset(s, 0, sizeof(*s));
+
+  for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+    s->inputGain[ch] = 1.0f;
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    s->outputGain[ch] = 1.0f;
+    s->limiter[ch].threshold = 1.0f;
+    s->limiter[ch].attackCoeff = 1.0f;
+    s->limiter[ch].releaseCoeff = 1.0f;
+  }
+
+  for (uint8_t i = 1; i < PARAM_SNAPSHOT_COUNT; i++) {
+    snapshots[i] = *s;
+  }
+
+  activeIndex = 0;
+  frameIndex = 0;
+  editIndex = PARAM_SNAPSHOT_NONE;
+  frameSnapshot = s;
+}
+
+/**
+  * @brief  Get a writable copy of the latest parameters
+  * @note   Repeated calls before Publish return the same copy, so several
+  *         setters can be batched into one publish
+  * @retval Block to modify, invisible to the audio side until published
+  */
+ParamSnapshot_TypeDef *ParamSnapshot_BeginUpdate(void)
+{
+  if (editIndex == PARAM_SNAPSHOT_NONE) {
+    const uint8_t active = activeIndex;
+    const uint8_t inUse = frameIndex;
+    uint8_t i = 0;
+
+    while (i == active || i == inUse) {
+      i++;
+    }
+
+    snapshots[i] = snapshots[active];
+    editIndex = i;
+  }
+
+  return &snapshots[editIndex];
+}
+
+/**
+  * @brief  Make the edited copy the latest parameters
+  * @note   Takes effect at the start of the next audio frame
+  * @retval None
+  */
+void ParamSnapshot_Publish(void)
+{
+  if (editIndex == PARAM_SNAPSHOT_NONE) {
+    return;
+  }
+
+  snapshots[editIndex].epoch = snapshots[activeIndex].epoch + 1U;
+
+  /* Block contents must be in memory before the index that exposes them */
+  PARAM_SNAPSHOT_BARRIER();
+  activeIndex = editIndex;
+  editIndex = PARAM_SNAPSHOT_NONE;
+}
+
+/**
+  * @brief  Pick up the latest parameters for the frame about to run
+  * @note   Call once at the start of every audio frame
+  * @retval Parameters valid until the next call
+  */
+const ParamSnapshot_TypeDef *ParamSnapshot_AcquireFrame(void)
+{
+  uint8_t index;
+
+  /* Claim the block, then make sure no publish slipped in before the claim */
+  do {
+    index = activeIndex;
+    frameIndex = index;
+    PARAM_SNAPSHOT_BARRIER();
+  } while (index != activeIndex);
+
+  frameSnapshot = &snapshots[index];
+
+  return frameSnapshot;
+}
+
+/**
+  * @brief  Parameters of the running frame
+  * @retval Block picked by the last ParamSnapshot_AcquireFrame()
+  */
+const ParamSnapshot_TypeDef *ParamSnapshot_Frame(void)
+{
+  return frameSnapshot;
+}
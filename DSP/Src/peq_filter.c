@@ -16,17 +16,17 @@
 /* Includes ------------------------------------------------------------------*/
 #include "peq.h"
 #include "peq_types.h"
-#include "biquad.h"
+#include "biquad_cascade.h"
+#include "coeff_batch.h"
+#include "cpu_budget.h"
+#include "response_cache.h"
 #include "math_utils.h"
 #include "debug.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-#define PEQ_MAX_BANDS_PER_CHANNEL    5
 #define PEQ_UNUSED_BAND_FLAG         0xFF
-
-/* Max. possible Q-factor - guard against division by near-zero */
-#define PEQ_MAX_Q_FACTOR             20.0f
+#define PEQ_CORRECTION_CASCADES      2    /* Fitted correction, up to 16 sections */
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -34,16 +34,22 @@
 /* EQ band configurations for each output channel */
 static PEQBand_TypeDef PEQBands[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL];
 
-/* Biquad filter states for each EQ band */
-static BiquadState_TypeDef PEQBiquadStates[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL];
+/* Normalized coefficients per band and the compiled per-channel cascade */
+static BiquadCoeff_t PEQCoeffs[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL];
+static BiquadCascade_TypeDef PEQCascades[AUDIO_OUTPUT_CHANNELS];
+
+/* Fitted correction behind the bands, written by the IIR fit */
+static BiquadCascade_TypeDef PEQCorrection[AUDIO_OUTPUT_CHANNELS][PEQ_CORRECTION_CASCADES];
+static uint8_t PEQCorrectionCount[AUDIO_OUTPUT_CHANNELS];
 
 /* Private function prototypes -----------------------------------------------*/
-static void PEQ_CalculateBell(float centerFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs);
-static void PEQ_CalculateLowShelf(float cutoffFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs);
-static void PEQ_CalculateHighShelf(float cutoffFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs);
-static void PEQ_CalculateLowPass(float cutoffFreq, float Q, float fs, BiquadCoeffs_TypeDef *coeffs);
-static void PEQ_CalculateHighPass(float cutoffFreq, float Q, float fs, BiquadCoeffs_TypeDef *coeffs);
 static void PEQ_UpdateFilterCoefficients(uint8_t channel, uint8_t band);
+static void PEQ_UpdateAllCoefficients(void);
+static void PEQ_FillBatchSpec(const PEQBand_TypeDef *band, CoeffBatch_Band_TypeDef *spec);
+static void PEQ_StoreCoefficients(uint8_t channel, uint8_t band, const BiquadCoeff_t *coeff);
+static void PEQ_CompileChannel(uint8_t channel);
+static void PEQ_FillCpuLoad(uint8_t channel, uint8_t band, uint8_t enabled, uint8_t correction,
+                            CpuBudget_Load_TypeDef *load);
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -56,6 +62,16 @@ void PEQ_Init(void)
 {
   /* Initialize all PEQ bands with default values */
   for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    CpuBudget_Load_TypeDef load = { 0 };
+    
+    BiquadCascade_Init(&PEQCascades[channel]);
+    
+    for (uint8_t i = 0; i < PEQ_CORRECTION_CASCADES; i++) {
+      BiquadCascade_Init(&PEQCorrection[channel][i]);
+    }
+    PEQCorrectionCount[channel] = 0;
+    CpuBudget_SetLoad(CPUBUDGET_STAGE_EQ, channel, &load);
+    
     for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
       /* Default values for EQ bands */
       PEQBands[channel][band].type = PEQ_TYPE_BELL;
@@ -63,15 +79,12 @@ void PEQ_Init(void)
       PEQBands[channel][band].gain = 0.0f;         /* 0dB - flat response */
       PEQBands[channel][band].q = 1.414f;          /* Q = 1.414 (sqrt(2)) */
       PEQBands[channel][band].enabled = 0;         /* Disabled by default */
-      
-      /* Initialize biquad filter states */
-      Biquad_ResetState(&PEQBiquadStates[channel][band]);
-      
-      /* Calculate initial coefficients */
-      PEQ_UpdateFilterCoefficients(channel, band);
     }
   }
   
+  /* Calculate initial coefficients of all bands in one batch */
+  PEQ_UpdateAllCoefficients();
+  
   DEBUG_PRINT("PEQ: Initialized all PEQ bands with default values\r\n");
 }
 
@@ -84,12 +97,20 @@ void PEQ_Init(void)
   */
 HAL_StatusTypeDef PEQ_ConfigureBand(uint8_t channel, uint8_t band, PEQBand_TypeDef *config)
 {
+  CpuBudget_Load_TypeDef load;
+  
   /* Check parameters */
   if (channel >= AUDIO_OUTPUT_CHANNELS || band >= PEQ_MAX_BANDS_PER_CHANNEL || config == NULL) {
     DEBUG_PRINT("PEQ: Invalid parameters in PEQ_ConfigureBand\r\n");
     return HAL_ERROR;
   }
   
+  /* Enabling a band adds a section to the cascade */
+  PEQ_FillCpuLoad(channel, band, config->enabled, PEQCorrectionCount[channel], &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_EQ, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  
   /* Safety checks on frequency range */
   if (config->frequency < 20.0f) {
     config->frequency = 20.0f;
@@ -127,6 +148,61 @@ HAL_StatusTypeDef PEQ_ConfigureBand(uint8_t channel, uint8_t band, PEQBand_TypeD
   return HAL_OK;
 }
 
+/**
+  * @brief  Configure every PEQ band at once (preset load)
+  * @note   Coefficients of all bands are designed in a single batch and each
+  *         channel cascade is compiled once
+  * @param  config: Band configurations [channel][band]
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PEQ_ConfigureAllBands(const PEQBand_TypeDef config[AUDIO_OUTPUT_CHANNELS][PEQ_MAX_BANDS_PER_CHANNEL])
+{
+  CpuBudget_Load_TypeDef loads[AUDIO_OUTPUT_CHANNELS];
+  
+  if (config == NULL) {
+    DEBUG_PRINT("PEQ: Invalid parameters in PEQ_ConfigureAllBands\r\n");
+    return HAL_ERROR;
+  }
+  
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    uint16_t sections = PEQCorrectionCount[channel];
+    
+    for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
+      sections += config[channel][band].enabled ? 1U : 0U;
+    }
+    loads[channel].active = (sections > 0U) ? 1U : 0U;
+    loads[channel].options = 0;
+    loads[channel].units = sections;
+    loads[channel].parts = 0;
+  }
+  
+  if (CpuBudget_AdmitStage(CPUBUDGET_STAGE_EQ, loads) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
+      PEQBand_TypeDef *dst = &PEQBands[channel][band];
+      
+      *dst = config[channel][band];
+      
+      /* Same limits as PEQ_ConfigureBand */
+      if (dst->frequency < 20.0f) dst->frequency = 20.0f;
+      if (dst->frequency > 20000.0f) dst->frequency = 20000.0f;
+      if (dst->q < 0.1f) dst->q = 0.1f;
+      if (dst->q > 10.0f) dst->q = 10.0f;
+      if (dst->gain < -12.0f) dst->gain = -12.0f;
+      if (dst->gain > 12.0f) dst->gain = 12.0f;
+    }
+  }
+  
+  PEQ_UpdateAllCoefficients();
+  
+  DEBUG_PRINT("PEQ: Configured all bands\r\n");
+  
+  return HAL_OK;
+}
+
 /**
   * @brief  Get the configuration of a specific PEQ band
   * @param  channel: Output channel index (0-3)
@@ -161,21 +237,98 @@ HAL_StatusTypeDef PEQ_GetBandConfig(uint8_t channel, uint8_t band, PEQBand_TypeD
   */
 HAL_StatusTypeDef PEQ_SetBandEnabled(uint8_t channel, uint8_t band, uint8_t enabled)
 {
+  CpuBudget_Load_TypeDef load;
+  
   /* Check parameters */
   if (channel >= AUDIO_OUTPUT_CHANNELS || band >= PEQ_MAX_BANDS_PER_CHANNEL) {
     DEBUG_PRINT("PEQ: Invalid parameters in PEQ_SetBandEnabled\r\n");
     return HAL_ERROR;
   }
   
+  PEQ_FillCpuLoad(channel, band, enabled, PEQCorrectionCount[channel], &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_EQ, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  
   /* Update enabled state */
   PEQBands[channel][band].enabled = enabled ? 1 : 0;
   
+  /* Drop or insert the band in the compiled cascade */
+  PEQ_CompileChannel(channel);
+  
   DEBUG_PRINT("PEQ: Channel %d band %d %s\r\n", 
               channel, band, enabled ? "enabled" : "disabled");
   
   return HAL_OK;
 }
 
+/**
+  * @brief  Clear the filter history of a channel, keeping its bands
+  * @param  channel: Output channel index (0-3)
+  * @retval None
+  */
+void PEQ_ResetState(uint8_t channel)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return;
+  }
+  
+  BiquadCascade_Reset(&PEQCascades[channel]);
+  
+  for (uint8_t i = 0; i < PEQ_CORRECTION_CASCADES; i++) {
+    BiquadCascade_Reset(&PEQCorrection[channel][i]);
+  }
+}
+
+/**
+  * @brief  Load fitted correction sections behind the bands of a channel
+  * @note   Sections fill the correction cascades eight at a time and the
+  *         gain rides on the last one used. A count of 0 removes the
+  *         correction; empty cascades cost nothing in the sample loop.
+  * @param  channel: Output channel index (0-3)
+  * @param  sections: Section coefficients (a0 normalized to 1)
+  * @param  count: Number of sections, 0 to 16
+  * @param  gain: Linear output gain of the correction
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PEQ_SetCorrection(uint8_t channel, const BiquadCoeff_t *sections, uint8_t count, float gain)
+{
+  CpuBudget_Load_TypeDef load;
+  uint8_t first = 0;
+  
+  if (channel >= AUDIO_OUTPUT_CHANNELS || (sections == NULL && count > 0U) ||
+      count > PEQ_CORRECTION_CASCADES * BIQUAD_CASCADE_MAX_STAGES) {
+    return HAL_ERROR;
+  }
+  
+  /* No band changes, the load is the enabled bands plus the new count */
+  PEQ_FillCpuLoad(channel, PEQ_UNUSED_BAND_FLAG, 0, count, &load);
+  if (CpuBudget_Admit(CPUBUDGET_STAGE_EQ, channel, &load) != HAL_OK) {
+    return HAL_BUSY;
+  }
+  PEQCorrectionCount[channel] = count;
+  
+  for (uint8_t i = 0; i < PEQ_CORRECTION_CASCADES; i++) {
+    BiquadCascade_TypeDef *cascade = &PEQCorrection[channel][i];
+    const uint8_t stages = (count - first > BIQUAD_CASCADE_MAX_STAGES) ?
+                           BIQUAD_CASCADE_MAX_STAGES : (uint8_t)(count - first);
+    
+    BiquadCascade_Compile(cascade, (stages > 0U) ? &sections[first] : NULL, NULL, stages, 0);
+    cascade->gain = 1.0f;
+    first += stages;
+  }
+  
+  if (count > 0U) {
+    PEQCorrection[channel][(count - 1U) / BIQUAD_CASCADE_MAX_STAGES].gain = gain;
+  }
+  ResponseCache_SetSection(channel, RESPCACHE_SLOT_CORRECTION, sections, count,
+                           (count > 0U) ? gain : 1.0f);
+  
+  DEBUG_PRINT("PEQ: Ch%d correction %d sections\r\n", channel + 1, count);
+  
+  return HAL_OK;
+}
+
 /**
   * @brief  Process audio data through the PEQ filter chain for one channel
   * @param  channel: Output channel index (0-3)
@@ -185,8 +338,6 @@ HAL_StatusTypeDef PEQ_SetBandEnabled(uint8_t channel, uint8_t band, uint8_t enab
 void PEQ_ProcessChannel(uint8_t channel, AudioBuffer_TypeDef *audioBuffer)
 {
   float *samples;
-  uint32_t numSamples;
-  float tempSample;
   
   /* Check parameters */
   if (channel >= AUDIO_OUTPUT_CHANNELS || audioBuffer == NULL) {
@@ -195,29 +346,34 @@ void PEQ_ProcessChannel(uint8_t channel, AudioBuffer_TypeDef *audioBuffer)
   }
   
   /* Get output samples array for this channel */
-  samples = audioBuffer->outputChannels[channel];
-  numSamples = audioBuffer->frameSize;
+  samples = audioBuffer->samples[channel];
   
-  /* Process each sample through all enabled EQ bands */
-  for (uint32_t i = 0; i < numSamples; i++) {
-    tempSample = samples[i];
-    
-    /* Apply each EQ band in series */
-    for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
-      /* Skip disabled bands */
-      if (!PEQBands[channel][band].enabled) {
-        continue;
-      }
-      
-      /* Process through biquad filter */
-      tempSample = Biquad_Process(&PEQBiquadStates[channel][band], tempSample);
-    }
-    
-    /* Write back to output buffer */
-    samples[i] = tempSample;
+  /* Enabled bands were packed at compile time, no per-band tests here */
+  BiquadCascade_Process(&PEQCascades[channel], samples, AUDIO_FRAME_SIZE);
+  
+  for (uint8_t i = 0; i < PEQ_CORRECTION_CASCADES; i++) {
+    BiquadCascade_Process(&PEQCorrection[channel][i], samples, AUDIO_FRAME_SIZE);
   }
 }
 
+/**
+  * @brief  Process one frame of an output through its bands and correction
+  * @note   Pipeline entry point, see PEQ_ProcessChannel()
+  * @param  channelIndex: Output channel index (0-3)
+  * @param  buffer: Audio buffer, processed in place
+  * @retval HAL status
+  */
+HAL_StatusTypeDef DSP_EQ_Process(uint8_t channelIndex, AudioBuffer_TypeDef* buffer)
+{
+  if (channelIndex >= AUDIO_OUTPUT_CHANNELS || buffer == NULL) {
+    return HAL_ERROR;
+  }
+  
+  PEQ_ProcessChannel(channelIndex, buffer);
+  
+  return HAL_OK;
+}
+
 /**
   * @brief  Process all channels through their respective PEQ filters
   * @param  audioBuffer: Pointer to audio buffer structure
@@ -225,9 +381,28 @@ void PEQ_ProcessChannel(uint8_t channel, AudioBuffer_TypeDef *audioBuffer)
   */
 void PEQ_ProcessAllChannels(AudioBuffer_TypeDef *audioBuffer)
 {
-  /* Process each output channel */
+  BiquadCascade_TypeDef *cascades[AUDIO_OUTPUT_CHANNELS];
+  float *samples[AUDIO_OUTPUT_CHANNELS];
+  
+  if (audioBuffer == NULL) {
+    return;
+  }
+  
+  /* Channels with equal band counts share one multi-channel kernel */
   for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
-    PEQ_ProcessChannel(channel, audioBuffer);
+    cascades[channel] = &PEQCascades[channel];
+    samples[channel] = audioBuffer->samples[channel];
+  }
+  
+  BiquadCascade_ProcessGroup(cascades, samples, AUDIO_OUTPUT_CHANNELS, AUDIO_FRAME_SIZE);
+  
+  /* Corrections of equal length share kernels the same way */
+  for (uint8_t i = 0; i < PEQ_CORRECTION_CASCADES; i++) {
+    for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+      cascades[channel] = &PEQCorrection[channel][i];
+    }
+    
+    BiquadCascade_ProcessGroup(cascades, samples, AUDIO_OUTPUT_CHANNELS, AUDIO_FRAME_SIZE);
   }
 }
 
@@ -241,260 +416,121 @@ void PEQ_ProcessAllChannels(AudioBuffer_TypeDef *audioBuffer)
   */
 static void PEQ_UpdateFilterCoefficients(uint8_t channel, uint8_t band)
 {
-  /* Get system sample rate */
-  float fs = (float)AUDIO_SAMPLE_RATE;
-  
-  /* Get references to band and its coefficients */
-  PEQBand_TypeDef *peqBand = &PEQBands[channel][band];
-  BiquadCoeffs_TypeDef coeffs;
+  CoeffBatch_Band_TypeDef spec;
+  BiquadCoeff_t coeff;
   
-  /* Calculate coefficients based on filter type */
-  switch (peqBand->type) {
-    case PEQ_TYPE_BELL:
-      PEQ_CalculateBell(peqBand->frequency, peqBand->gain, peqBand->q, fs, &coeffs);
-      break;
-      
-    case PEQ_TYPE_LOW_SHELF:
-      PEQ_CalculateLowShelf(peqBand->frequency, peqBand->gain, peqBand->q, fs, &coeffs);
-      break;
-      
-    case PEQ_TYPE_HIGH_SHELF:
-      PEQ_CalculateHighShelf(peqBand->frequency, peqBand->gain, peqBand->q, fs, &coeffs);
-      break;
-      
-    case PEQ_TYPE_LOW_PASS:
-      PEQ_CalculateLowPass(peqBand->frequency, peqBand->q, fs, &coeffs);
-      break;
-      
-    case PEQ_TYPE_HIGH_PASS:
-      PEQ_CalculateHighPass(peqBand->frequency, peqBand->q, fs, &coeffs);
-      break;
-      
-    default:
-      /* Invalid filter type, use pass-through (flat response) */
-      coeffs.b0 = 1.0f;
-      coeffs.b1 = 0.0f;
-      coeffs.b2 = 0.0f;
-      coeffs.a1 = 0.0f;
-      coeffs.a2 = 0.0f;
-      break;
-  }
+  PEQ_FillBatchSpec(&PEQBands[channel][band], &spec);
+  CoeffBatch_Design(&spec, &coeff, 1);
+  PEQ_StoreCoefficients(channel, band, &coeff);
   
-  /* Set coefficients to the biquad filter */
-  Biquad_SetCoefficients(&PEQBiquadStates[channel][band], &coeffs);
+  PEQ_CompileChannel(channel);
 }
 
 /**
-  * @brief  Calculate coefficients for Bell (Peaking) filter
-  * @param  centerFreq: Center frequency in Hz
-  * @param  gain: Gain in dB
-  * @param  Q: Q-factor
-  * @param  fs: Sample rate in Hz
-  * @param  coeffs: Pointer to store calculated coefficients
+  * @brief  Recalculate the coefficients of every band in one batch
   * @retval None
   */
-static void PEQ_CalculateBell(float centerFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs)
+static void PEQ_UpdateAllCoefficients(void)
 {
-  float A, omega, sn, cs, alpha, beta;
-  
-  /* Limit parameters to safe values */
-  if (Q > PEQ_MAX_Q_FACTOR) Q = PEQ_MAX_Q_FACTOR;
-  if (centerFreq <= 0.0f) centerFreq = 20.0f;
-  if (centerFreq >= fs/2.0f) centerFreq = fs/2.0f - 1.0f;
-  
-  /* Convert gain from dB to linear scale */
-  A = powf(10.0f, gain / 40.0f); /* 40 instead of 20 because A is squared in some terms */
-  
-  /* Calculate intermediate values */
-  omega = 2.0f * M_PI * centerFreq / fs;
-  sn = sinf(omega);
-  cs = cosf(omega);
-  alpha = sn / (2.0f * Q);
-  beta = sqrtf(A) / Q;
-  
-  /* Calculate coefficients */
-  coeffs->b0 = 1.0f + alpha * A;
-  coeffs->b1 = -2.0f * cs;
-  coeffs->b2 = 1.0f - alpha * A;
-  coeffs->a0 = 1.0f + alpha / A;
-  coeffs->a1 = -2.0f * cs;
-  coeffs->a2 = 1.0f - alpha / A;
-  
-  /* Normalize by a0 */
-  coeffs->b0 /= coeffs->a0;
-  coeffs->b1 /= coeffs->a0;
-  coeffs->b2 /= coeffs->a0;
-  coeffs->a1 /= coeffs->a0;
-  coeffs->a2 /= coeffs->a0;
-  coeffs->a0 = 1.0f;
+  CoeffBatch_Band_TypeDef specs[AUDIO_OUTPUT_CHANNELS * PEQ_MAX_BANDS_PER_CHANNEL];
+  BiquadCoeff_t coeffs[AUDIO_OUTPUT_CHANNELS * PEQ_MAX_BANDS_PER_CHANNEL];
+  uint32_t n = 0;
+  
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
+      PEQ_FillBatchSpec(&PEQBands[channel][band], &specs[n++]);
+    }
+  }
+  
+  CoeffBatch_Design(specs, coeffs, n);
+  
+  n = 0;
+  for (uint8_t channel = 0; channel < AUDIO_OUTPUT_CHANNELS; channel++) {
+    for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
+      PEQ_StoreCoefficients(channel, band, &coeffs[n++]);
+    }
+    PEQ_CompileChannel(channel);
+  }
 }
 
 /**
-  * @brief  Calculate coefficients for Low Shelf filter
-  * @param  cutoffFreq: Cutoff frequency in Hz
-  * @param  gain: Gain in dB
-  * @param  Q: Q-factor (slope control)
-  * @param  fs: Sample rate in Hz
-  * @param  coeffs: Pointer to store calculated coefficients
+  * @brief  Translate a band configuration into a batch designer spec
+  * @param  band: Band configuration
+  * @param  spec: Pointer to store the spec
   * @retval None
   */
-static void PEQ_CalculateLowShelf(float cutoffFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs)
+static void PEQ_FillBatchSpec(const PEQBand_TypeDef *band, CoeffBatch_Band_TypeDef *spec)
 {
-  float A, omega, sn, cs, alpha, beta;
-  
-  /* Limit parameters to safe values */
-  if (Q > PEQ_MAX_Q_FACTOR) Q = PEQ_MAX_Q_FACTOR;
-  if (cutoffFreq <= 0.0f) cutoffFreq = 20.0f;
-  if (cutoffFreq >= fs/2.0f) cutoffFreq = fs/2.0f - 1.0f;
-  
-  /* Convert gain from dB to linear scale */
-  A = powf(10.0f, gain / 40.0f);
-  
-  /* Calculate intermediate values */
-  omega = 2.0f * M_PI * cutoffFreq / fs;
-  sn = sinf(omega);
-  cs = cosf(omega);
-  alpha = sn / (2.0f * Q);
-  beta = 2.0f * sqrtf(A) * alpha;
-  
-  /* Calculate coefficients */
-  coeffs->b0 = A * ((A + 1.0f) - (A - 1.0f) * cs + beta);
-  coeffs->b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cs);
-  coeffs->b2 = A * ((A + 1.0f) - (A - 1.0f) * cs - beta);
-  coeffs->a0 = (A + 1.0f) + (A - 1.0f) * cs + beta;
-  coeffs->a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cs);
-  coeffs->a2 = (A + 1.0f) + (A - 1.0f) * cs - beta;
-  
-  /* Normalize by a0 */
-  coeffs->b0 /= coeffs->a0;
-  coeffs->b1 /= coeffs->a0;
-  coeffs->b2 /= coeffs->a0;
-  coeffs->a1 /= coeffs->a0;
-  coeffs->a2 /= coeffs->a0;
-  coeffs->a0 = 1.0f;
+  switch (band->type) {
+    case PEQ_TYPE_BELL:       spec->type = COEFF_BATCH_BELL;       break;
+    case PEQ_TYPE_LOW_SHELF:  spec->type = COEFF_BATCH_LOW_SHELF;  break;
+    case PEQ_TYPE_HIGH_SHELF: spec->type = COEFF_BATCH_HIGH_SHELF; break;
+    case PEQ_TYPE_LOW_PASS:   spec->type = COEFF_BATCH_LOW_PASS;   break;
+    case PEQ_TYPE_HIGH_PASS:  spec->type = COEFF_BATCH_HIGH_PASS;  break;
+    default:
+      /* Invalid filter type, use pass-through (flat response) */
+      spec->type = COEFF_BATCH_FLAT;
+      break;
+  }
+  
+  spec->frequency = band->frequency;
+  spec->gainDb = band->gain;
+  spec->q = band->q;
 }
 
 /**
-  * @brief  Calculate coefficients for High Shelf filter
-  * @param  cutoffFreq: Cutoff frequency in Hz
-  * @param  gain: Gain in dB
-  * @param  Q: Q-factor (slope control)
-  * @param  fs: Sample rate in Hz
-  * @param  coeffs: Pointer to store calculated coefficients
+  * @brief  Store designed coefficients of a band
+  * @param  channel: Output channel index (0-3)
+  * @param  band: Band index (0-4)
+  * @param  coeff: Normalized coefficients
   * @retval None
   */
-static void PEQ_CalculateHighShelf(float cutoffFreq, float gain, float Q, float fs, BiquadCoeffs_TypeDef *coeffs)
+static void PEQ_StoreCoefficients(uint8_t channel, uint8_t band, const BiquadCoeff_t *coeff)
 {
-  float A, omega, sn, cs, alpha, beta;
-  
-  /* Limit parameters to safe values */
-  if (Q > PEQ_MAX_Q_FACTOR) Q = PEQ_MAX_Q_FACTOR;
-  if (cutoffFreq <= 0.0f) cutoffFreq = 20.0f;
-  if (cutoffFreq >= fs/2.0f) cutoffFreq = fs/2.0f - 1.0f;
-  
-  /* Convert gain from dB to linear scale */
-  A = powf(10.0f, gain / 40.0f);
-  
-  /* Calculate intermediate values */
-  omega = 2.0f * M_PI * cutoffFreq / fs;
-  sn = sinf(omega);
-  cs = cosf(omega);
-  alpha = sn / (2.0f * Q);
-  beta = 2.0f * sqrtf(A) * alpha;
-  
-  /* Calculate coefficients */
-  coeffs->b0 = A * ((A + 1.0f) + (A - 1.0f) * cs + beta);
-  coeffs->b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cs);
-  coeffs->b2 = A * ((A + 1.0f) + (A - 1.0f) * cs - beta);
-  coeffs->a0 = (A + 1.0f) - (A - 1.0f) * cs + beta;
-  coeffs->a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cs);
-  coeffs->a2 = (A + 1.0f) - (A - 1.0f) * cs - beta;
-  
-  /* Normalize by a0 */
-  coeffs->b0 /= coeffs->a0;
-  coeffs->b1 /= coeffs->a0;
-  coeffs->b2 /= coeffs->a0;
-  coeffs->a1 /= coeffs->a0;
-  coeffs->a2 /= coeffs->a0;
-  coeffs->a0 = 1.0f;
+  PEQCoeffs[channel][band] = *coeff;
+  ResponseCache_SetSection(channel, RESPCACHE_SLOT_PEQ + band, coeff, 1, 1.0f);
 }
 
 /**
-  * @brief  Calculate coefficients for Low Pass filter
-  * @param  cutoffFreq: Cutoff frequency in Hz
-  * @param  Q: Q-factor (resonance control)
-  * @param  fs: Sample rate in Hz
-  * @param  coeffs: Pointer to store calculated coefficients
+  * @brief  Rebuild the compiled cascade of a channel from its enabled bands
+  * @param  channel: Output channel index (0-3)
   * @retval None
   */
-static void PEQ_CalculateLowPass(float cutoffFreq, float Q, float fs, BiquadCoeffs_TypeDef *coeffs)
+static void PEQ_CompileChannel(uint8_t channel)
 {
-  float omega, sn, cs, alpha;
-  
-  /* Limit parameters to safe values */
-  if (Q > PEQ_MAX_Q_FACTOR) Q = PEQ_MAX_Q_FACTOR;
-  if (cutoffFreq <= 0.0f) cutoffFreq = 20.0f;
-  if (cutoffFreq >= fs/2.0f) cutoffFreq = fs/2.0f - 1.0f;
-  
-  /* Calculate intermediate values */
-  omega = 2.0f * M_PI * cutoffFreq / fs;
-  sn = sinf(omega);
-  cs = cosf(omega);
-  alpha = sn / (2.0f * Q);
-  
-  /* Calculate coefficients */
-  coeffs->b0 = (1.0f - cs) / 2.0f;
-  coeffs->b1 = 1.0f - cs;
-  coeffs->b2 = (1.0f - cs) / 2.0f;
-  coeffs->a0 = 1.0f + alpha;
-  coeffs->a1 = -2.0f * cs;
-  coeffs->a2 = 1.0f - alpha;
-  
-  /* Normalize by a0 */
-  coeffs->b0 /= coeffs->a0;
-  coeffs->b1 /= coeffs->a0;
-  coeffs->b2 /= coeffs->a0;
-  coeffs->a1 /= coeffs->a0;
-  coeffs->a2 /= coeffs->a0;
-  coeffs->a0 = 1.0f;
+  uint8_t enabled[PEQ_MAX_BANDS_PER_CHANNEL];
+  
+  for (uint8_t band = 0; band < PEQ_MAX_BANDS_PER_CHANNEL; band++) {
+    enabled[band] = PEQBands[channel][band].enabled;
+    ResponseCache_SetEnabled(channel, RESPCACHE_SLOT_PEQ + band, enabled[band]);
+  }
+  
+  BiquadCascade_Compile(&PEQCascades[channel], PEQCoeffs[channel], enabled,
+                        PEQ_MAX_BANDS_PER_CHANNEL, 0);
 }
 
 /**
-  * @brief  Calculate coefficients for High Pass filter
-  * @param  cutoffFreq: Cutoff frequency in Hz
-  * @param  Q: Q-factor (resonance control)
-  * @param  fs: Sample rate in Hz
-  * @param  coeffs: Pointer to store calculated coefficients
+  * @brief  Describe the sections a channel would run after a change
+  * @param  channel: Output channel index (0-3)
+  * @param  band: Band being switched, PEQ_UNUSED_BAND_FLAG for none
+  * @param  enabled: New enable state of that band
+  * @param  correction: Correction sections after the change
+  * @param  load: Pointer to store the load for the CPU budget
   * @retval None
   */
-static void PEQ_CalculateHighPass(float cutoffFreq, float Q, float fs, BiquadCoeffs_TypeDef *coeffs)
+static void PEQ_FillCpuLoad(uint8_t channel, uint8_t band, uint8_t enabled, uint8_t correction,
+                            CpuBudget_Load_TypeDef *load)
 {
-  float omega, sn, cs, alpha;
-  
-  /* Limit parameters to safe values */
-  if (Q > PEQ_MAX_Q_FACTOR) Q = PEQ_MAX_Q_FACTOR;
-  if (cutoffFreq <= 0.0f) cutoffFreq = 20.0f;
-  if (cutoffFreq >= fs/2.0f) cutoffFreq = fs/2.0f - 1.0f;
-  
-  /* Calculate intermediate values */
-  omega = 2.0f * M_PI * cutoffFreq / fs;
-  sn = sinf(omega);
-  cs = cosf(omega);
-  alpha = sn / (2.0f * Q);
-  
-  /* Calculate coefficients */
-  coeffs->b0 = (1.0f + cs) / 2.0f;
-  coeffs->b1 = -(1.0f + cs);
-  coeffs->b2 = (1.0f + cs) / 2.0f;
-  coeffs->a0 = 1.0f + alpha;
-  coeffs->a1 = -2.0f * cs;
-  coeffs->a2 = 1.0f - alpha;
-  
-  /* Normalize by a0 */
-  coeffs->b0 /= coeffs->a0;
-  coeffs->b1 /= coeffs->a0;
-  coeffs->b2 /= coeffs->a0;
-  coeffs->a1 /= coeffs->a0;
-  coeffs->a2 /= coeffs->a0;
-  coeffs->a0 = 1.0f;
-}
\ No newline at end of file
+  uint16_t sections = correction;
+  
+  for (uint8_t i = 0; i < PEQ_MAX_BANDS_PER_CHANNEL; i++) {
+    const uint8_t on = (i == band) ? enabled : PEQBands[channel][i].enabled;
+    
+    sections += on ? 1U : 0U;
+  }
+  
+  load->active = (sections > 0U) ? 1U : 0U;
+  load->options = 0;
+  load->units = sections;
+  load->parts = 0;
+}
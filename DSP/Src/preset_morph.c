@@ -0,0 +1,460 @@
+/**
+  ******************************************************************************
+  * @file           : preset_morph.c
+  * @brief          : Timed morph between two complete parameter scenes
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Every MORPH_CONTROL_MS the main loop computes the eased position and
+  * pushes the values as one parameter registry batch, interpolated by the
+  * law of each parameter. Groups that are equal in both scenes are found
+  * at start and never touched, so a morph that only moves two EQ bands
+  * costs one PEQ batch per step.
+  *
+  * The fade is the only audio-side work: a gain ramp per frame while it
+  * moves, a single compare otherwise. The switch waits for the fade for
+  * at most MORPH_SWITCH_TIMEOUT_MS, so frames that skip the chain (the
+  * analyzer owning the converters) cannot hold a morph forever.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "preset_morph.h"
+#include "param_registry.h"
+#include "peq.h"
+#include "crossover.h"
+#include "delay.h"
+#include "limiter.h"
+#include "audio_driver.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define MORPH_GAIN_FLOOR            1.0e-5f     /* -100 dB, muted gains in dB */
+#define MORPH_SWITCH_TIMEOUT_MS     50U         /* Switch anyway if the fade does not finish */
+
+/* Private variables ---------------------------------------------------------*/
+static Morph_Scene_TypeDef sceneFrom;
+static Morph_Scene_TypeDef sceneTo;
+static volatile Morph_State_TypeDef state = MORPH_IDLE;
+
+static uint32_t startTick;
+static uint32_t switchTick;
+static uint32_t lastControlTick;
+static uint32_t durationMs;
+static float position;
+
+/* What differs between the scenes */
+static uint8_t peqChanged;
+static uint8_t crossoverChanged[AUDIO_OUTPUT_CHANNELS];
+static uint8_t delayChanged[AUDIO_OUTPUT_CHANNELS];
+static uint8_t limiterChanged[AUDIO_OUTPUT_CHANNELS];
+static uint8_t gainChanged[AUDIO_OUTPUT_CHANNELS];
+static uint8_t hasDiscrete;
+static uint8_t switched;
+
+/* Output fade around the discrete switch */
+static float fadeGain = 1.0f;
+static volatile float fadeTarget = 1.0f;
+static float fadeStep = 1.0f;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t Morph_IsGainType(uint8_t type);
+static uint8_t Morph_BandIsDiscrete(const Morph_PeqBand_TypeDef *a, const Morph_PeqBand_TypeDef *b);
+static void Morph_Compare(void);
+static void Morph_Apply(float t, uint8_t useTo);
+static void Morph_Set(uint8_t family, uint8_t channel, uint8_t index, float from, float to, float t);
+
+/**
+  * @brief  Reset the morph engine
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void Morph_Init(float sampleRate)
+{
+  const float fadeSamples = MORPH_FADE_MS * 0.001f * sampleRate;
+
+  state = MORPH_IDLE;
+  fadeGain = 1.0f;
+  fadeTarget = 1.0f;
+  fadeStep = (fadeSamples > (float)AUDIO_FRAME_SIZE) ? (float)AUDIO_FRAME_SIZE / fadeSamples : 1.0f;
+}
+
+/**
+  * @brief  Read the live parameters into a scene
+  * @param  scene: Scene to fill
+  * @retval None
+  */
+void Morph_CaptureScene(Morph_Scene_TypeDef *scene)
+{
+  AudioDriverStatus_TypeDef status;
+
+  if (scene == NULL) {
+    return;
+  }
+
+  memset(scene, 0, sizeof(*scene));
+  status = Audio_GetStatus();
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    CrossoverConfig_TypeDef xover;
+    LimiterParams_TypeDef limiter;
+
+    for (uint8_t b = 0; b < MORPH_PEQ_BANDS; b++) {
+      PEQBand_TypeDef band;
+
+      if (PEQ_GetBandConfig(ch, b, &band) == HAL_OK) {
+        scene->peq[ch][b].type = band.type;
+        scene->peq[ch][b].enabled = band.enabled;
+        scene->peq[ch][b].frequency = band.frequency;
+        scene->peq[ch][b].gainDb = band.gain;
+        scene->peq[ch][b].q = band.q;
+      }
+    }
+
+    Crossover_Config_Get(ch, &xover);
+    scene->crossover[ch].enabled = xover.isEnabled;
+    scene->crossover[ch].filterType = xover.filterType;
+    scene->crossover[ch].filterOrder = xover.filterOrder;
+    scene->crossover[ch].bandPass = xover.bandPassEnabled;
+    scene->crossover[ch].highPassHz = xover.highPassFreq;
+    scene->crossover[ch].lowPassHz = xover.lowPassFreq;
+
+    /* The delay the line applies, so a scene survives a temperature change */
+    scene->delayMs[ch] = Delay_GetCompensatedTime(ch);
+
+    if (DSP_Limiter_GetConfig(ch, &limiter) == HAL_OK) {
+      scene->limiterThresholdDb[ch] = limiter.thresholdDb;
+    }
+
+    scene->outputGainDb[ch] = 20.0f * log10f(fmaxf(status.outputGain[ch], MORPH_GAIN_FLOOR));
+  }
+}
+
+/**
+  * @brief  Morph between two scenes
+  * @note   The chain should be at (or near) the from scene already
+  * @param  from: Start scene
+  * @param  to: Target scene
+  * @param  timeMs: Morph time, 0 applies the target at the next service
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef Morph_Start(const Morph_Scene_TypeDef *from, const Morph_Scene_TypeDef *to,
+                              uint32_t timeMs)
+{
+  if (from == NULL || to == NULL) {
+    return HAL_ERROR;
+  }
+
+  if (from != &sceneFrom) {
+    sceneFrom = *from;
+  }
+  sceneTo = *to;
+
+  Morph_Compare();
+
+  durationMs = timeMs;
+  startTick = HAL_GetTick();
+  lastControlTick = startTick - MORPH_CONTROL_MS;
+  position = 0.0f;
+  switched = 0;
+  fadeTarget = 1.0f;
+  state = MORPH_RUNNING;
+
+  DEBUG_PRINT("Morph: %lu ms%s\r\n", (unsigned long)timeMs, hasDiscrete ? ", switch at midpoint" : "");
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Morph from the live parameters to a scene
+  * @param  to: Target scene
+  * @param  timeMs: Morph time
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef Morph_StartTo(const Morph_Scene_TypeDef *to, uint32_t timeMs)
+{
+  if (to == NULL) {
+    return HAL_ERROR;
+  }
+
+  Morph_CaptureScene(&sceneFrom);
+
+  return Morph_Start(&sceneFrom, to, timeMs);
+}
+
+/**
+  * @brief  Stop where the morph is now
+  * @note   A pending fade is reopened
+  * @retval None
+  */
+void Morph_Abort(void)
+{
+  if (state == MORPH_RUNNING || state == MORPH_SWITCHING) {
+    state = MORPH_IDLE;
+  }
+  fadeTarget = 1.0f;
+}
+
+/**
+  * @brief  Get the morph state
+  * @retval Morph_State_TypeDef
+  */
+Morph_State_TypeDef Morph_GetState(void)
+{
+  return state;
+}
+
+/**
+  * @brief  Get the progress of the running morph
+  * @retval 0.0 at the from scene to 1.0 at the target
+  */
+float Morph_GetPosition(void)
+{
+  return position;
+}
+
+/**
+  * @brief  Advance the morph at control rate
+  * @note   Call from the main loop, returns at once between control steps
+  * @retval None
+  */
+void Morph_Service(void)
+{
+  const uint32_t now = HAL_GetTick();
+  float eased;
+
+  if (state != MORPH_RUNNING && state != MORPH_SWITCHING) {
+    return;
+  }
+
+  if ((now - lastControlTick) < MORPH_CONTROL_MS) {
+    return;
+  }
+  lastControlTick = now;
+
+  position = (durationMs > 0U) ? fminf((float)(now - startTick) / (float)durationMs, 1.0f) : 1.0f;
+
+  /* Smoothstep, no jump in the rate of change at either end */
+  eased = position * position * (3.0f - 2.0f * position);
+
+  if (hasDiscrete && !switched && position >= 0.5f) {
+    if (state == MORPH_RUNNING) {
+      state = MORPH_SWITCHING;
+      switchTick = now;
+      fadeTarget = 0.0f;
+    }
+
+    if (fadeGain > 0.0f) {
+      if ((now - switchTick) < MORPH_SWITCH_TIMEOUT_MS) {
+        /* Outputs still fading, keep gliding on the from side */
+        Morph_Apply(eased, 0);
+        return;
+      }
+
+      /* No frame ran the fade (analyzer measuring, stream stopped): the
+         outputs are not playing the chain, switch without it */
+      DEBUG_PRINT("Morph: fade timed out, switching\r\n");
+    }
+
+    switched = 1;
+    Morph_Apply(eased, 1);
+    fadeTarget = 1.0f;
+    state = MORPH_RUNNING;
+  } else {
+    Morph_Apply(eased, switched);
+  }
+
+  if (position >= 1.0f && (!hasDiscrete || switched)) {
+    state = MORPH_DONE;
+    DEBUG_PRINT("Morph: done\r\n");
+  }
+}
+
+/**
+  * @brief  Apply the switch fade to the processed outputs
+  * @param  buffer: Output frame, all channels
+  * @retval None
+  */
+void Morph_ProcessFrame(AudioBuffer_TypeDef *buffer)
+{
+  const float target = fadeTarget;
+  const float from = fadeGain;
+  float to;
+
+  if (from == target && from == 1.0f) {
+    return;
+  }
+
+  to = (target > from) ? fminf(from + fadeStep, target) : fmaxf(from - fadeStep, target);
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    float *data = buffer->samples[ch];
+
+    if (from == 0.0f && to == 0.0f) {
+      memset(data, 0, AUDIO_FRAME_SIZE * sizeof(float));
+      continue;
+    }
+
+    for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+      data[i] *= from + (to - from) * ((float)(i + 1U) / (float)AUDIO_FRAME_SIZE);
+    }
+  }
+
+  fadeGain = to;
+}
+
+/**
+  * @brief  Check whether a 0 dB band of this type is flat
+  * @param  type: PEQ_TYPE_x
+  * @retval 1 for bell and shelves
+  */
+static uint8_t Morph_IsGainType(uint8_t type)
+{
+  return (type == PEQ_TYPE_BELL || type == PEQ_TYPE_LOW_SHELF || type == PEQ_TYPE_HIGH_SHELF) ? 1U : 0U;
+}
+
+/**
+  * @brief  Check whether a band needs the discrete switch
+  * @param  a: Band in the from scene
+  * @param  b: Band in the target scene
+  * @retval 1 if it cannot be morphed continuously
+  */
+static uint8_t Morph_BandIsDiscrete(const Morph_PeqBand_TypeDef *a, const Morph_PeqBand_TypeDef *b)
+{
+  if (!a->enabled && !b->enabled) {
+    return 0;
+  }
+
+  if (a->enabled && b->enabled) {
+    return (a->type != b->type) ? 1U : 0U;
+  }
+
+  /* Enabled on one side: fades in or out as a 0 dB band of the same type */
+  return Morph_IsGainType(a->enabled ? a->type : b->type) ? 0U : 1U;
+}
+
+/**
+  * @brief  Find the parameter groups that differ between the scenes
+  * @retval None
+  */
+static void Morph_Compare(void)
+{
+  peqChanged = (memcmp(sceneFrom.peq, sceneTo.peq, sizeof(sceneFrom.peq)) != 0) ? 1U : 0U;
+  hasDiscrete = 0;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    const Morph_Crossover_TypeDef *xa = &sceneFrom.crossover[ch];
+    const Morph_Crossover_TypeDef *xb = &sceneTo.crossover[ch];
+
+    for (uint8_t b = 0; b < MORPH_PEQ_BANDS; b++) {
+      hasDiscrete |= Morph_BandIsDiscrete(&sceneFrom.peq[ch][b], &sceneTo.peq[ch][b]);
+    }
+
+    crossoverChanged[ch] = (memcmp(xa, xb, sizeof(*xa)) != 0) ? 1U : 0U;
+    if (xa->enabled != xb->enabled || xa->filterType != xb->filterType ||
+        xa->filterOrder != xb->filterOrder || xa->bandPass != xb->bandPass) {
+      hasDiscrete = 1;
+    }
+
+    delayChanged[ch] = (sceneFrom.delayMs[ch] != sceneTo.delayMs[ch]) ? 1U : 0U;
+    limiterChanged[ch] = (sceneFrom.limiterThresholdDb[ch] != sceneTo.limiterThresholdDb[ch]) ? 1U : 0U;
+    gainChanged[ch] = (sceneFrom.outputGainDb[ch] != sceneTo.outputGainDb[ch]) ? 1U : 0U;
+  }
+}
+
+/**
+  * @brief  Push the parameters at a morph position to the chain
+  * @param  t: Eased position, 0.0 to 1.0
+  * @param  useTo: Take discrete values from the target scene
+  * @retval None
+  */
+static void Morph_Apply(float t, uint8_t useTo)
+{
+  ParamRegistry_BeginBatch();
+
+  if (peqChanged) {
+    for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+      for (uint8_t b = 0; b < MORPH_PEQ_BANDS; b++) {
+        Morph_PeqBand_TypeDef a = sceneFrom.peq[ch][b];
+        Morph_PeqBand_TypeDef z = sceneTo.peq[ch][b];
+        uint8_t enabled;
+
+        if (a.enabled != z.enabled && !Morph_BandIsDiscrete(&a, &z)) {
+          /* The missing side is the same band at 0 dB */
+          if (!a.enabled) {
+            a = z;
+            a.gainDb = 0.0f;
+          } else {
+            z = a;
+            z.gainDb = 0.0f;
+          }
+          enabled = (t < 1.0f) ? 1U : sceneTo.peq[ch][b].enabled;
+        } else {
+          enabled = useTo ? z.enabled : a.enabled;
+        }
+
+        ParamRegistry_Set(PARAM_ID(PARAM_PEQ_ENABLE, ch, b), (float)enabled);
+        ParamRegistry_Set(PARAM_ID(PARAM_PEQ_TYPE, ch, b), (float)(useTo ? z.type : a.type));
+        Morph_Set(PARAM_PEQ_FREQ, ch, b, a.frequency, z.frequency, t);
+        Morph_Set(PARAM_PEQ_GAIN, ch, b, a.gainDb, z.gainDb, t);
+        Morph_Set(PARAM_PEQ_Q, ch, b, a.q, z.q, t);
+      }
+    }
+  }
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    if (crossoverChanged[ch]) {
+      const Morph_Crossover_TypeDef *xa = &sceneFrom.crossover[ch];
+      const Morph_Crossover_TypeDef *xb = &sceneTo.crossover[ch];
+      const Morph_Crossover_TypeDef *xd = useTo ? xb : xa;
+
+      ParamRegistry_Set(PARAM_ID(PARAM_XOVER_ENABLE, ch, 0), (float)xd->enabled);
+      ParamRegistry_Set(PARAM_ID(PARAM_XOVER_TYPE, ch, 0), (float)xd->filterType);
+      ParamRegistry_Set(PARAM_ID(PARAM_XOVER_ORDER, ch, 0), (float)xd->filterOrder);
+      ParamRegistry_Set(PARAM_ID(PARAM_XOVER_BANDPASS, ch, 0), (float)xd->bandPass);
+      Morph_Set(PARAM_XOVER_HP_FREQ, ch, 0, xa->highPassHz, xb->highPassHz, t);
+      Morph_Set(PARAM_XOVER_LP_FREQ, ch, 0, xa->lowPassHz, xb->lowPassHz, t);
+    }
+
+    if (delayChanged[ch]) {
+      Morph_Set(PARAM_DELAY_TIME, ch, 0, sceneFrom.delayMs[ch], sceneTo.delayMs[ch], t);
+    }
+
+    if (limiterChanged[ch]) {
+      Morph_Set(PARAM_LIMIT_THRESHOLD, ch, 0, sceneFrom.limiterThresholdDb[ch], sceneTo.limiterThresholdDb[ch], t);
+    }
+
+    if (gainChanged[ch]) {
+      Morph_Set(PARAM_OUTPUT_GAIN, ch, 0, sceneFrom.outputGainDb[ch], sceneTo.outputGainDb[ch], t);
+    }
+  }
+
+  /* All PEQ bands in one designer batch, one update per crossover */
+  ParamRegistry_EndBatch();
+}
+
+/**
+  * @brief  Stage a continuous parameter at a morph position
+  * @note   Scene values outside the registry range are clamped to it
+  * @param  family: PARAM_x family
+  * @param  channel: Channel
+  * @param  index: Band, 0 for per-channel parameters
+  * @param  from: Value at t = 0
+  * @param  to: Value at t = 1
+  * @param  t: Position
+  * @retval None
+  */
+static void Morph_Set(uint8_t family, uint8_t channel, uint8_t index, float from, float to, float t)
+{
+  const uint16_t id = PARAM_ID(family, channel, index);
+  const float value = ParamRegistry_Interpolate(id, from, to, t);
+  float min, max;
+
+  ParamRegistry_GetRange(id, &min, &max);
+  ParamRegistry_Set(id, fminf(fmaxf(value, min), max));
+}
@@ -0,0 +1,275 @@
+/**
+  ******************************************************************************
+  * @file           : quality_scaler.c
+  * @brief          : Graceful quality reduction when frames run out of slack
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The audio side only folds each frame into the current window; decisions
+  * and the module calls that apply a rung run from the main loop.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "quality_scaler.h"
+#include "dynamics.h"
+#include "delay.h"
+#include "limiter.h"
+#include "debug.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+  * @brief  What one rung allows
+  */
+typedef struct {
+  const char *name;
+  uint8_t analysis;             /* Background analysis services run */
+  uint8_t controlBlock;         /* Dynamics gain computer sub-block */
+  uint8_t cubic;                /* Cubic delay interpolation allowed */
+  uint8_t isp;                  /* Limiter ISP allowed */
+} QualityScaler_Rung_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const QualityScaler_Rung_TypeDef ladder[QUALITY_LEVEL_COUNT] = {
+  /* name            analysis  controlBlock           cubic  isp */
+  { "FULL",          1,        1,                     1,     1 },
+  { "NO_ANALYSIS",   0,        1,                     1,     1 },
+  { "CONTROL_RATE",  0,        QUALITY_CONTROL_BLOCK, 1,     1 },
+  { "LINEAR_DELAY",  0,        QUALITY_CONTROL_BLOCK, 0,     1 },
+  { "NO_ISP",        0,        QUALITY_CONTROL_BLOCK, 0,     0 }
+};
+
+static QualityScaler_Level_TypeDef level;
+static uint32_t frameCycles;
+static int32_t downSlack;
+static int32_t upSlack;
+static uint32_t upSince;
+
+/* Current window, written by the audio side */
+static int32_t windowMinSlack;
+static uint32_t windowFrames;
+static uint32_t windowLate;
+
+static QualityScaler_Status_TypeDef status;
+
+/* Transition log */
+static QualityScaler_Event_TypeDef events[QUALITY_EVENT_COUNT];
+static uint8_t eventHead;
+static uint8_t eventCount;
+
+/* Private function prototypes -----------------------------------------------*/
+static void QualityScaler_Step(QualityScaler_Level_TypeDef to, int32_t slack, uint32_t late);
+static void QualityScaler_RestartWindow(void);
+
+/**
+  * @brief  Start at full quality with an empty window
+  * @note   Does not touch the processing modules, they start at full
+  *         quality on their own
+  * @retval None
+  */
+void QualityScaler_Init(void)
+{
+  level = QUALITY_LEVEL_FULL;
+  frameCycles = (SystemCoreClock / AUDIO_SAMPLE_RATE) * AUDIO_FRAME_SIZE;
+  downSlack = (int32_t)((frameCycles * QUALITY_DOWN_SLACK_PERCENT) / 100U);
+  upSlack = (int32_t)((frameCycles * QUALITY_UP_SLACK_PERCENT) / 100U);
+  upSince = HAL_GetTick();
+
+  memset(&status, 0, sizeof(status));
+  status.frameCycles = frameCycles;
+  status.windowSlackCycles = (int32_t)frameCycles;
+  status.worstSlackCycles = (int32_t)frameCycles;
+  eventHead = 0;
+  eventCount = 0;
+  QualityScaler_RestartWindow();
+}
+
+/**
+  * @brief  Fold one processed frame into the window
+  * @param  elapsedCycles: Cycles from the DMA signal to the end of the frame
+  * @param  overrun: Another frame was signalled before this one started
+  * @retval None
+  */
+void QualityScaler_ReportFrame(uint32_t elapsedCycles, uint8_t overrun)
+{
+  const int32_t slack = (int32_t)frameCycles - (int32_t)elapsedCycles;
+
+  if (slack < windowMinSlack) {
+    windowMinSlack = slack;
+  }
+  if (slack < 0 || overrun) {
+    windowLate++;
+  }
+  windowFrames++;
+}
+
+/**
+  * @brief  Decide on a full window, step the ladder by at most one rung
+  * @note   A late frame closes the window early, so a missed deadline
+  *         steps down on the next main loop pass. Between the two slack
+  *         thresholds nothing changes and the hold time for stepping up
+  *         starts over
+  * @retval None
+  */
+void QualityScaler_Update(void)
+{
+  const uint32_t now = HAL_GetTick();
+  int32_t slack;
+  uint32_t late;
+
+  if (windowFrames < QUALITY_WINDOW_FRAMES && windowLate == 0U) {
+    return;
+  }
+
+  slack = windowMinSlack;
+  late = windowLate;
+  QualityScaler_RestartWindow();
+
+  status.windowSlackCycles = slack;
+  if (slack < status.worstSlackCycles) {
+    status.worstSlackCycles = slack;
+  }
+  status.lateFrames += late;
+
+  if (late > 0U || slack < downSlack) {
+    if (level < QUALITY_LEVEL_COUNT - 1) {
+      QualityScaler_Step((QualityScaler_Level_TypeDef)(level + 1), slack, late);
+    }
+    upSince = now;
+  } else if (slack >= upSlack) {
+    if (level > QUALITY_LEVEL_FULL && (now - upSince) >= QUALITY_UP_HOLD_MS) {
+      QualityScaler_Step((QualityScaler_Level_TypeDef)(level - 1), slack, late);
+      upSince = now;
+    }
+  } else {
+    upSince = now;
+  }
+}
+
+/**
+  * @brief  Get the current rung
+  * @retval QualityScaler_Level_TypeDef
+  */
+QualityScaler_Level_TypeDef QualityScaler_GetLevel(void)
+{
+  return level;
+}
+
+/**
+  * @brief  Check whether background analysis services may run
+  * @retval 1 if allowed
+  */
+uint8_t QualityScaler_IsAnalysisAllowed(void)
+{
+  return ladder[level].analysis;
+}
+
+/**
+  * @brief  Check whether the audio chain runs below its configured quality
+  * @note   Such frames are cheaper than the settings and must not
+  *         calibrate the CPU cost model
+  * @retval 1 if any processing override is active
+  */
+uint8_t QualityScaler_IsChainReduced(void)
+{
+  const QualityScaler_Rung_TypeDef *rung = &ladder[level];
+
+  return (rung->controlBlock > 1U || !rung->cubic || !rung->isp) ? 1U : 0U;
+}
+
+/**
+  * @brief  Get the scaler state
+  * @param  result: Status
+  * @retval None
+  */
+void QualityScaler_GetStatus(QualityScaler_Status_TypeDef *result)
+{
+  if (result == NULL) {
+    return;
+  }
+
+  *result = status;
+  result->level = (uint8_t)level;
+}
+
+/**
+  * @brief  Get a logged transition, newest first
+  * @param  index: 0 for the newest event
+  * @param  event: Event
+  * @retval 1 if the event exists
+  */
+uint8_t QualityScaler_GetEvent(uint8_t index, QualityScaler_Event_TypeDef *event)
+{
+  if (index >= eventCount || event == NULL) {
+    return 0;
+  }
+
+  *event = events[(eventHead + QUALITY_EVENT_COUNT - 1U - index) % QUALITY_EVENT_COUNT];
+  return 1;
+}
+
+/**
+  * @brief  Get the name of a rung
+  * @param  rungLevel: QUALITY_LEVEL_x
+  * @retval Name string
+  */
+const char *QualityScaler_GetLevelName(QualityScaler_Level_TypeDef rungLevel)
+{
+  return (rungLevel < QUALITY_LEVEL_COUNT) ? ladder[rungLevel].name : "?";
+}
+
+/**
+  * @brief  Apply the overrides that differ between two rungs and log the step
+  * @param  to: New rung
+  * @param  slack: Window slack that caused the step
+  * @param  late: Late frames in that window
+  * @retval None
+  */
+static void QualityScaler_Step(QualityScaler_Level_TypeDef to, int32_t slack, uint32_t late)
+{
+  const QualityScaler_Rung_TypeDef *from = &ladder[level];
+  const QualityScaler_Rung_TypeDef *next = &ladder[to];
+  QualityScaler_Event_TypeDef *event;
+
+  if (next->controlBlock != from->controlBlock) {
+    Dynamics_SetControlBlock(next->controlBlock);
+  }
+  if (next->cubic != from->cubic) {
+    Delay_SetCubicAllowed(next->cubic);
+  }
+  if (next->isp != from->isp) {
+    Limiter_SetISPAllowed(next->isp);
+  }
+
+  event = &events[eventHead];
+  event->tick = HAL_GetTick();
+  event->slackCycles = slack;
+  event->from = (uint8_t)level;
+  event->to = (uint8_t)to;
+  event->lateFrames = (late > 255U) ? 255U : (uint8_t)late;
+  eventHead = (uint8_t)((eventHead + 1U) % QUALITY_EVENT_COUNT);
+  if (eventCount < QUALITY_EVENT_COUNT) {
+    eventCount++;
+  }
+  status.transitions++;
+
+  DEBUG_PRINT("Quality: %s -> %s, slack %ld cycles, %lu late frames\r\n",
+              from->name, next->name, (long)slack, (unsigned long)late);
+
+  level = to;
+}
+
+/**
+  * @brief  Empty the measurement window
+  * @retval None
+  */
+static void QualityScaler_RestartWindow(void)
+{
+  windowMinSlack = (int32_t)frameCycles;
+  windowFrames = 0;
+  windowLate = 0;
+}
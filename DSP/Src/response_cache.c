@@ -0,0 +1,330 @@
+/**
+  ******************************************************************************
+  * @file           : response_cache.c
+  * @brief          : Incremental magnitude and phase curves of every output
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Runs on the control side only, from the setters that design the
+  * coefficients. Nothing here is touched by the audio path.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "response_cache.h"
+#include "debug.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define RESPCACHE_PI                3.14159265f
+#define RESPCACHE_PHASE_SCALE       (32768.0f / RESPCACHE_PI)   /* Steps per radian */
+#define RESPCACHE_FNV_OFFSET        2166136261UL
+#define RESPCACHE_FNV_PRIME         16777619UL
+
+/* Private variables ---------------------------------------------------------*/
+/* Grid, sin^2(w/2) for the magnitude and e^-jw for the phase */
+static float gridPhi[RESPCACHE_GRID_POINTS];
+static float gridCos[RESPCACHE_GRID_POINTS];
+static float gridSin[RESPCACHE_GRID_POINTS];
+
+/* Curve of every slot and their sums */
+static int16_t slotDb[AUDIO_OUTPUT_CHANNELS][RESPCACHE_SLOT_COUNT][RESPCACHE_GRID_POINTS];
+static uint16_t slotPhase[AUDIO_OUTPUT_CHANNELS][RESPCACHE_SLOT_COUNT][RESPCACHE_GRID_POINTS];
+static int32_t sumDb[AUDIO_OUTPUT_CHANNELS][RESPCACHE_GRID_POINTS];
+static uint16_t sumPhase[AUDIO_OUTPUT_CHANNELS][RESPCACHE_GRID_POINTS];
+
+static uint32_t slotHash[AUDIO_OUTPUT_CHANNELS][RESPCACHE_SLOT_COUNT];
+static uint8_t slotEnabled[AUDIO_OUTPUT_CHANNELS][RESPCACHE_SLOT_COUNT];
+static uint32_t version[AUDIO_OUTPUT_CHANNELS];
+
+/* Private function prototypes -----------------------------------------------*/
+static void ResponseCache_Evaluate(const BiquadCoeff_t *sections, uint8_t count, float gain,
+                                   int16_t *db, uint16_t *phase);
+static uint32_t ResponseCache_Hash(const BiquadCoeff_t *sections, uint8_t count, float gain);
+static void ResponseCache_Convert(const int32_t *db, const uint16_t *phase, float *magnitudeDb,
+                                  float *phaseRad);
+
+/**
+  * @brief  Build the grid tables and start with flat, enabled slots
+  * @note   Call before the filter modules are initialized, they report
+  *         their coefficients from their init on
+  * @param  sampleRate: Audio sample rate in Hz
+  * @retval None
+  */
+void ResponseCache_Init(float sampleRate)
+{
+  const uint32_t flat = ResponseCache_Hash(NULL, 0, 1.0f);
+
+  for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+    const float w = 2.0f * RESPCACHE_PI * ResponseCache_GetGridFrequency(i) / sampleRate;
+    const float s = sinf(0.5f * w);
+
+    gridPhi[i] = s * s;
+    gridCos[i] = cosf(w);
+    gridSin[i] = sinf(w);
+  }
+
+  memset(slotDb, 0, sizeof(slotDb));
+  memset(slotPhase, 0, sizeof(slotPhase));
+  memset(sumDb, 0, sizeof(sumDb));
+  memset(sumPhase, 0, sizeof(sumPhase));
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    for (uint8_t slot = 0; slot < RESPCACHE_SLOT_COUNT; slot++) {
+      slotHash[ch][slot] = flat;
+      slotEnabled[ch][slot] = 1;
+    }
+    version[ch] = 0;
+  }
+}
+
+/**
+  * @brief  Frequency of a grid point
+  * @param  index: Grid point, 0 to RESPCACHE_GRID_POINTS - 1
+  * @retval Frequency in Hz
+  */
+float ResponseCache_GetGridFrequency(uint32_t index)
+{
+  return AutoEQ_GetGridFrequency(index);
+}
+
+/**
+  * @brief  Report the sections of a slot after a redesign
+  * @note   O(grid x count) when the coefficients changed, a hash otherwise
+  * @param  channel: Output channel
+  * @param  slot: RESPCACHE_SLOT_x
+  * @param  sections: Section coefficients, a0 = 1; NULL with count 0 for none
+  * @param  count: Number of sections
+  * @param  gain: Linear gain of the slot, negative for inverted polarity
+  * @retval None
+  */
+void ResponseCache_SetSection(uint8_t channel, uint8_t slot, const BiquadCoeff_t *sections,
+                              uint8_t count, float gain)
+{
+  int16_t db[RESPCACHE_GRID_POINTS];
+  uint16_t phase[RESPCACHE_GRID_POINTS];
+  uint32_t hash;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || slot >= RESPCACHE_SLOT_COUNT ||
+      (sections == NULL && count > 0U)) {
+    return;
+  }
+
+  hash = ResponseCache_Hash(sections, count, gain);
+  if (hash == slotHash[channel][slot]) {
+    return;
+  }
+  slotHash[channel][slot] = hash;
+
+  ResponseCache_Evaluate(sections, count, gain, db, phase);
+
+  if (slotEnabled[channel][slot]) {
+    int32_t *sum = sumDb[channel];
+    uint16_t *sumPh = sumPhase[channel];
+    const int16_t *oldDb = slotDb[channel][slot];
+    const uint16_t *oldPh = slotPhase[channel][slot];
+
+    for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+      sum[i] += (int32_t)db[i] - (int32_t)oldDb[i];
+      sumPh[i] = (uint16_t)(sumPh[i] + phase[i] - oldPh[i]);
+    }
+    version[channel]++;
+  }
+
+  memcpy(slotDb[channel][slot], db, sizeof(db));
+  memcpy(slotPhase[channel][slot], phase, sizeof(phase));
+}
+
+/**
+  * @brief  Add a slot to the output sum or take it out
+  * @note   O(grid) integer work, the slot curve is kept either way
+  * @param  channel: Output channel
+  * @param  slot: RESPCACHE_SLOT_x
+  * @param  enabled: 1 if the slot runs
+  * @retval None
+  */
+void ResponseCache_SetEnabled(uint8_t channel, uint8_t slot, uint8_t enabled)
+{
+  int32_t *sum;
+  uint16_t *sumPh;
+  const int16_t *db;
+  const uint16_t *phase;
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || slot >= RESPCACHE_SLOT_COUNT) {
+    return;
+  }
+
+  enabled = enabled ? 1U : 0U;
+  if (slotEnabled[channel][slot] == enabled) {
+    return;
+  }
+  slotEnabled[channel][slot] = enabled;
+
+  sum = sumDb[channel];
+  sumPh = sumPhase[channel];
+  db = slotDb[channel][slot];
+  phase = slotPhase[channel][slot];
+
+  if (enabled) {
+    for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+      sum[i] += db[i];
+      sumPh[i] = (uint16_t)(sumPh[i] + phase[i]);
+    }
+  } else {
+    for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+      sum[i] -= db[i];
+      sumPh[i] = (uint16_t)(sumPh[i] - phase[i]);
+    }
+  }
+  version[channel]++;
+}
+
+/**
+  * @brief  Get the total response of an output
+  * @param  channel: Output channel
+  * @param  magnitudeDb: RESPCACHE_GRID_POINTS values in dB, may be NULL
+  * @param  phaseRad: RESPCACHE_GRID_POINTS values, wrapped to +-pi, may be NULL
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef ResponseCache_GetCurve(uint8_t channel, float *magnitudeDb, float *phaseRad)
+{
+  if (channel >= AUDIO_OUTPUT_CHANNELS) {
+    return HAL_ERROR;
+  }
+
+  ResponseCache_Convert(sumDb[channel], sumPhase[channel], magnitudeDb, phaseRad);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the contribution of one slot, e.g. to draw a single band
+  * @note   Returned whether or not the slot is enabled
+  * @param  channel: Output channel
+  * @param  slot: RESPCACHE_SLOT_x
+  * @param  magnitudeDb: RESPCACHE_GRID_POINTS values in dB, may be NULL
+  * @param  phaseRad: RESPCACHE_GRID_POINTS values, wrapped to +-pi, may be NULL
+  * @retval HAL_StatusTypeDef
+  */
+HAL_StatusTypeDef ResponseCache_GetSlotCurve(uint8_t channel, uint8_t slot, float *magnitudeDb,
+                                             float *phaseRad)
+{
+  int32_t db[RESPCACHE_GRID_POINTS];
+
+  if (channel >= AUDIO_OUTPUT_CHANNELS || slot >= RESPCACHE_SLOT_COUNT) {
+    return HAL_ERROR;
+  }
+
+  for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+    db[i] = slotDb[channel][slot][i];
+  }
+
+  ResponseCache_Convert(db, slotPhase[channel][slot], magnitudeDb, phaseRad);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the change counter of an output
+  * @note   A display only has to redraw when this moves
+  * @param  channel: Output channel
+  * @retval Counter, 0 for an invalid channel
+  */
+uint32_t ResponseCache_GetVersion(uint8_t channel)
+{
+  return (channel < AUDIO_OUTPUT_CHANNELS) ? version[channel] : 0U;
+}
+
+/**
+  * @brief  Evaluate a cascade on the grid
+  * @note   Magnitude in the sin^2(w/2) form like AutoEQ_SectionDb(), the
+  *         cos(w) form cancels to noise for low bands in float
+  * @param  sections: Section coefficients
+  * @param  count: Number of sections
+  * @param  gain: Linear gain
+  * @param  db: Magnitude, 1/256 dB
+  * @param  phase: Phase, 1/65536 turn
+  * @retval None
+  */
+static void ResponseCache_Evaluate(const BiquadCoeff_t *sections, uint8_t count, float gain,
+                                   int16_t *db, uint16_t *phase)
+{
+  const float gainMag = fabsf(gain);
+  const float gainDb = (gainMag > 0.0f) ? 20.0f * log10f(gainMag) : -RESPCACHE_DB_LIMIT;
+  const float gainPhase = (gain < 0.0f) ? RESPCACHE_PI : 0.0f;
+
+  for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+    const float phi = gridPhi[i];
+    const float c1 = gridCos[i];
+    const float s1 = gridSin[i];
+    const float c2 = 2.0f * c1 * c1 - 1.0f;
+    const float s2 = 2.0f * s1 * c1;
+    float magDb = gainDb;
+    float rad = gainPhase;
+
+    for (uint8_t k = 0; k < count; k++) {
+      const BiquadCoeff_t *c = &sections[k];
+      const float bs = c->b0 + c->b1 + c->b2;
+      const float as = 1.0f + c->a1 + c->a2;
+      float num, den;
+
+      num = bs * bs - 4.0f * phi * (c->b0 * c->b1 + 4.0f * c->b0 * c->b2 + c->b1 * c->b2 -
+                                    4.0f * c->b0 * c->b2 * phi);
+      den = as * as - 4.0f * phi * (c->a1 + 4.0f * c->a2 + c->a1 * c->a2 - 4.0f * c->a2 * phi);
+      magDb += 10.0f * log10f(fmaxf(num, 1e-20f) / fmaxf(den, 1e-20f));
+
+      rad += atan2f(-(c->b1 * s1 + c->b2 * s2), c->b0 + c->b1 * c1 + c->b2 * c2) -
+             atan2f(-(c->a1 * s1 + c->a2 * s2), 1.0f + c->a1 * c1 + c->a2 * c2);
+    }
+
+    magDb = fminf(fmaxf(magDb, -RESPCACHE_DB_LIMIT), RESPCACHE_DB_LIMIT);
+    db[i] = (int16_t)lrintf(magDb * RESPCACHE_DB_SCALE);
+    phase[i] = (uint16_t)(int32_t)lrintf(rad * RESPCACHE_PHASE_SCALE);
+  }
+}
+
+/**
+  * @brief  FNV-1a over the coefficients, count and gain of a slot
+  * @param  sections: Section coefficients, may be NULL with count 0
+  * @param  count: Number of sections
+  * @param  gain: Linear gain
+  * @retval Hash
+  */
+static uint32_t ResponseCache_Hash(const BiquadCoeff_t *sections, uint8_t count, float gain)
+{
+  const uint8_t *bytes = (const uint8_t *)sections;
+  const uint8_t *gainBytes = (const uint8_t *)&gain;
+  uint32_t hash = RESPCACHE_FNV_OFFSET;
+
+  for (uint32_t i = 0; i < count * sizeof(BiquadCoeff_t); i++) {
+    hash = (hash ^ bytes[i]) * RESPCACHE_FNV_PRIME;
+  }
+  for (uint32_t i = 0; i < sizeof(gain); i++) {
+    hash = (hash ^ gainBytes[i]) * RESPCACHE_FNV_PRIME;
+  }
+
+  return (hash ^ count) * RESPCACHE_FNV_PRIME;
+}
+
+/**
+  * @brief  Convert fixed-point curves to dB and radians
+  * @param  db: Magnitude, 1/256 dB
+  * @param  phase: Phase, 1/65536 turn
+  * @param  magnitudeDb: Output in dB, may be NULL
+  * @param  phaseRad: Output in radians, may be NULL
+  * @retval None
+  */
+static void ResponseCache_Convert(const int32_t *db, const uint16_t *phase, float *magnitudeDb,
+                                  float *phaseRad)
+{
+  for (uint32_t i = 0; i < RESPCACHE_GRID_POINTS; i++) {
+    if (magnitudeDb != NULL) {
+      magnitudeDb[i] = (float)db[i] * (1.0f / RESPCACHE_DB_SCALE);
+    }
+    if (phaseRad != NULL) {
+      phaseRad[i] = (float)(int16_t)phase[i] * (1.0f / RESPCACHE_PHASE_SCALE);
+    }
+  }
+}
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file           : biquad_cascade.h
+  * @brief          : Specialized biquad cascade kernels
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Block processing of cascaded biquads (Direct Form II Transposed) through
+  * kernels specialized per stage count (1-8) and channel count (1/2/4).
+  * A cascade is compiled once when its coefficients change; disabled stages
+  * are removed at that point so the sample loop has no per-stage branches.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __BIQUAD_CASCADE_H
+#define __BIQUAD_CASCADE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "filter_types.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define BIQUAD_CASCADE_MAX_STAGES    8   /* Up to 16th order */
+#define BIQUAD_CASCADE_MAX_GROUP     4   /* Widest channel group kernel */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Compiled cascade for one channel
+  * @note   coeff rows are {b0, b1, b2, a1, a2} with a0 normalized to 1,
+  *         state rows are the two DF2T delay elements
+  */
+typedef struct {
+  float coeff[BIQUAD_CASCADE_MAX_STAGES][5];
+  float state[BIQUAD_CASCADE_MAX_STAGES][2];
+  float gain;                   /* Output gain applied after the last stage */
+  uint8_t numStages;            /* Compiled stage count (incl. padding) */
+  uint8_t activeMask;           /* Source stages packed at last compile */
+} BiquadCascade_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void BiquadCascade_Init(BiquadCascade_TypeDef *cascade);
+void BiquadCascade_Compile(BiquadCascade_TypeDef *cascade, const BiquadCoeff_t *coeffs,
+                           const uint8_t *enabled, uint8_t count, uint8_t padToStages);
+void BiquadCascade_Reset(BiquadCascade_TypeDef *cascade);
+void BiquadCascade_Process(BiquadCascade_TypeDef *cascade, float *data, uint32_t blockSize);
+void BiquadCascade_ProcessGroup(BiquadCascade_TypeDef *const *cascades, float *const *data,
+                                uint8_t numChannels, uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BIQUAD_CASCADE_H */
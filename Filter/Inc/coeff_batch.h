@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : coeff_batch.h
+  * @brief          : Batch biquad coefficient designer
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Designs many RBJ biquads in one call. Work is done per stage over all
+  * bands of a chunk (trig, gain, alpha, coefficients) instead of per band,
+  * with a polynomial sincos, a dB to amplitude table and a trig table for
+  * the encoder frequency grid (Audio_PercentToFreq) in place of the libm
+  * calls. A full preset (all PEQ bands) is a single call.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __COEFF_BATCH_H
+#define __COEFF_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "filter_types.h"
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define COEFF_BATCH_GRID_POINTS      101U      /* Audio_PercentToFreq(0..100) */
+#define COEFF_BATCH_DB_RANGE         48U       /* Table covers +/- this gain in dB */
+#define COEFF_BATCH_DB_STEPS         4U        /* Table points per dB */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Section types, RBJ cookbook definitions
+  */
+typedef enum {
+  COEFF_BATCH_FLAT = 0,         /* Pass-through */
+  COEFF_BATCH_BELL,
+  COEFF_BATCH_LOW_SHELF,
+  COEFF_BATCH_HIGH_SHELF,
+  COEFF_BATCH_LOW_PASS,
+  COEFF_BATCH_HIGH_PASS,
+  COEFF_BATCH_BAND_PASS,        /* 0 dB peak gain */
+  COEFF_BATCH_NOTCH,
+  COEFF_BATCH_ALL_PASS
+} CoeffBatch_Type_TypeDef;
+
+/**
+  * @brief  One section to design
+  */
+typedef struct {
+  uint8_t type;                 /* CoeffBatch_Type_TypeDef */
+  float frequency;              /* Center / corner frequency in Hz */
+  float gainDb;                 /* Bell and shelf gain */
+  float q;                      /* Q, shelf slope for shelves */
+} CoeffBatch_Band_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void CoeffBatch_Init(float sampleRate);
+void CoeffBatch_Design(const CoeffBatch_Band_TypeDef *bands, BiquadCoeff_t *coeffs, uint32_t count);
+void CoeffBatch_SinCos(float omega, float *sn, float *cs);
+float CoeffBatch_DbToAmplitude(float gainDb);
+float CoeffBatch_GetSampleRate(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COEFF_BATCH_H */
@@ -25,6 +25,18 @@ extern "C" {
 #include <stdbool.h>
 #include "filter_types.h"
 
+/* Exported constants --------------------------------------------------------*/
+#define FILTER_DESIGN_SUCCESS           0
+#define FILTER_DESIGN_ERROR_PARAMS      1
+#define FILTER_DESIGN_ERROR_TYPE        2
+#define FILTER_DESIGN_ERROR_ORDER       3
+#define FILTER_DESIGN_ERROR_RESPONSE    4
+
+/* Koefisien float32: elliptic order >= 9 dengan sudut rendah (20-30 Hz)
+   meleset beberapa dB di passband, jadi order dibatasi 8 (4 biquad) */
+#define FILTER_STEEP_MAX_ORDER          8
+#define FILTER_STEEP_MAX_SECTIONS       ((FILTER_STEEP_MAX_ORDER + 1) / 2)
+
 /**
   * @brief  Desain filter IIR berdasarkan parameter yang diberikan
   * @param  filter: Pointer ke struktur filter IIR yang akan didesain
@@ -202,6 +214,34 @@ bool FilterDesign_GetResponse(IIRFilter_t *filter, float frequency, float sample
   */
 bool FilterDesign_GetCoefficients(IIRFilter_t *filter, uint8_t section, BiquadCoeff_t *coeff);
 
+/**
+  * @brief  Desain filter LP/HP Butterworth, Chebyshev I/II atau elliptic
+  * @param  sections: Array section biquad hasil desain
+  * @param  maxSections: Kapasitas sections, minimal (order + 1) / 2
+  * @param  spec: Spesifikasi filter
+  * @retval Status desain (FILTER_DESIGN_SUCCESS jika berhasil)
+  */
+int FilterDesign_CreateSteep(BiquadCoeff_t* sections, uint8_t maxSections, const FilterSteepSpec_t* spec);
+
+/**
+  * @brief  Order terkecil yang mencapai redaman stopband pada jarak tertentu
+  * @param  spec: Spesifikasi filter (field order diabaikan)
+  * @param  offsetOctaves: Jarak tepi stopband dari frekuensi sudut dalam oktaf
+  * @retval Order filter, 0 jika tidak tercapai sampai FILTER_STEEP_MAX_ORDER
+  */
+uint8_t FilterDesign_MinimumOrder(const FilterSteepSpec_t* spec, float offsetOctaves);
+
+/**
+  * @brief  Desain filter dengan order terkecil yang memenuhi target redaman
+  * @param  sections: Array section biquad hasil desain
+  * @param  maxSections: Kapasitas sections
+  * @param  spec: Spesifikasi filter, field order diisi hasil optimasi
+  * @param  offsetOctaves: Jarak tepi stopband dari frekuensi sudut dalam oktaf
+  * @retval Status desain (FILTER_DESIGN_SUCCESS jika berhasil)
+  */
+int FilterDesign_CreateSteepForTarget(BiquadCoeff_t* sections, uint8_t maxSections,
+                                      FilterSteepSpec_t* spec, float offsetOctaves);
+
 #ifdef __cplusplus
 }
 #endif
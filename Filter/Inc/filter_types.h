@@ -52,6 +52,16 @@ typedef enum {
   FILTER_CATEGORY_CUSTOM        /* Filter kustom dengan koefisien manual */
 } FilterCategory_t;
 
+/**
+  * @brief  Keluarga respons untuk filter curam (lihat FilterDesign_CreateSteep)
+  */
+typedef enum {
+  FILTER_FAMILY_BUTTERWORTH = 0, /* Maximally flat, -3 dB di frekuensi sudut */
+  FILTER_FAMILY_CHEBYSHEV1,      /* Ripple di passband, stopband monoton */
+  FILTER_FAMILY_CHEBYSHEV2,      /* Passband datar, zero di stopband */
+  FILTER_FAMILY_ELLIPTIC         /* Ripple di kedua band, transisi tercuram */
+} FilterFamily_t;
+
 /**
   * @brief  Order/slope filter yang tersedia
   */
@@ -124,6 +134,21 @@ typedef struct {
   FilterOrder_t order;    /* Order filter */
 } FilterDesignParams_t;
 
+/**
+  * @brief  Spesifikasi filter curam LP/HP
+  * @note   frequency adalah tepi passband: -3 dB untuk Butterworth,
+  *         -passRippleDb untuk Chebyshev I/II dan elliptic
+  */
+typedef struct {
+  FilterFamily_t family;  /* Keluarga respons */
+  FilterType_t type;      /* FILTER_TYPE_LOWPASS atau FILTER_TYPE_HIGHPASS */
+  float frequency;        /* Tepi passband dalam Hz */
+  float passRippleDb;     /* Ripple passband dalam dB (Chebyshev, elliptic) */
+  float stopAttenDb;      /* Redaman minimum stopband dalam dB (Chebyshev II, elliptic) */
+  uint8_t order;          /* Order filter, 1 sampai FILTER_STEEP_MAX_ORDER */
+  float sampleRate;       /* Sample rate dalam Hz */
+} FilterSteepSpec_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "biquad.h"
 #include "math_utils.h"  // For dB conversion utilities
+#include "coeff_batch.h"
 
 /* Private defines -----------------------------------------------------------*/
 #define PI 3.14159265358979323846f
@@ -61,106 +62,43 @@ void Biquad_Reset(BiquadState_t *state)
  */
 void Biquad_CalculateCoefficients(BiquadState_t *state, const BiquadConfig_t *config)
 {
-  float omega, sinOmega, cosOmega;
-  float alpha, beta, A, sqrtA;
+  CoeffBatch_Band_TypeDef spec;
+  BiquadCoeff_t coeff;
   
   /* Constraint check to avoid division by zero */
   if (config->sampleRate <= 0.0f) {
     return;
   }
   
-  /* Calculate intermediate values */
-  omega = 2.0f * PI * config->frequency / config->sampleRate;
-  sinOmega = sinf(omega);
-  cosOmega = cosf(omega);
-  
-  /* Alpha value based on Q factor */
-  alpha = sinOmega / (2.0f * config->Q);
-  
-  /* Calculate coefficients based on filter type */
   switch (config->type) {
-    case BIQUAD_TYPE_LPF:  /* Low Pass Filter */
-      state->b0 = (1.0f - cosOmega) / 2.0f;
-      state->b1 = 1.0f - cosOmega;
-      state->b2 = (1.0f - cosOmega) / 2.0f;
-      state->a1 = -2.0f * cosOmega;
-      state->a2 = 1.0f - alpha;
-      break;
-      
-    case BIQUAD_TYPE_HPF:  /* High Pass Filter */
-      state->b0 = (1.0f + cosOmega) / 2.0f;
-      state->b1 = -(1.0f + cosOmega);
-      state->b2 = (1.0f + cosOmega) / 2.0f;
-      state->a1 = -2.0f * cosOmega;
-      state->a2 = 1.0f - alpha;
-      break;
-      
-    case BIQUAD_TYPE_BPF:  /* Band Pass Filter */
-      state->b0 = alpha;
-      state->b1 = 0.0f;
-      state->b2 = -alpha;
-      state->a1 = -2.0f * cosOmega;
-      state->a2 = 1.0f - alpha;
-      break;
-      
-    case BIQUAD_TYPE_NOTCH:  /* Notch Filter */
-      state->b0 = 1.0f;
-      state->b1 = -2.0f * cosOmega;
-      state->b2 = 1.0f;
-      state->a1 = -2.0f * cosOmega;
-      state->a2 = 1.0f - alpha;
-      break;
-      
-    case BIQUAD_TYPE_PEAK:  /* Peaking EQ Filter */
-      A = powf(10.0f, config->gainDB / 40.0f);  // Convert dB to linear
-      state->b0 = 1.0f + alpha * A;
-      state->b1 = -2.0f * cosOmega;
-      state->b2 = 1.0f - alpha * A;
-      state->a1 = -2.0f * cosOmega;
-      state->a2 = 1.0f - alpha / A;
-      break;
-      
-    case BIQUAD_TYPE_LOWSHELF:  /* Low Shelf Filter */
-      A = powf(10.0f, config->gainDB / 40.0f);  // Convert dB to linear
-      sqrtA = sqrtf(A);
-      beta = 2.0f * sqrtA * alpha;
-      
-      state->b0 = A * ((A + 1.0f) - (A - 1.0f) * cosOmega + beta);
-      state->b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cosOmega);
-      state->b2 = A * ((A + 1.0f) - (A - 1.0f) * cosOmega - beta);
-      state->a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cosOmega);
-      state->a2 = (A + 1.0f) + (A - 1.0f) * cosOmega - beta;
-      break;
-      
-    case BIQUAD_TYPE_HIGHSHELF:  /* High Shelf Filter */
-      A = powf(10.0f, config->gainDB / 40.0f);  // Convert dB to linear
-      sqrtA = sqrtf(A);
-      beta = 2.0f * sqrtA * alpha;
-      
-      state->b0 = A * ((A + 1.0f) + (A - 1.0f) * cosOmega + beta);
-      state->b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cosOmega);
-      state->b2 = A * ((A + 1.0f) + (A - 1.0f) * cosOmega - beta);
-      state->a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cosOmega);
-      state->a2 = (A + 1.0f) - (A - 1.0f) * cosOmega - beta;
-      break;
-      
+    case BIQUAD_TYPE_LPF:       spec.type = COEFF_BATCH_LOW_PASS;   break;
+    case BIQUAD_TYPE_HPF:       spec.type = COEFF_BATCH_HIGH_PASS;  break;
+    case BIQUAD_TYPE_BPF:       spec.type = COEFF_BATCH_BAND_PASS;  break;
+    case BIQUAD_TYPE_NOTCH:     spec.type = COEFF_BATCH_NOTCH;      break;
+    case BIQUAD_TYPE_PEAK:      spec.type = COEFF_BATCH_BELL;       break;
+    case BIQUAD_TYPE_LOWSHELF:  spec.type = COEFF_BATCH_LOW_SHELF;  break;
+    case BIQUAD_TYPE_HIGHSHELF: spec.type = COEFF_BATCH_HIGH_SHELF; break;
     default:
       // Invalid filter type, set as passthrough
-      state->b0 = 1.0f;
-      state->b1 = 0.0f;
-      state->b2 = 0.0f;
-      state->a1 = 0.0f;
-      state->a2 = 0.0f;
+      spec.type = COEFF_BATCH_FLAT;
       break;
   }
   
-  /* Normalize coefficients to a0 = 1.0 */
-  float a0 = 1.0f + alpha;
-  state->b0 /= a0;
-  state->b1 /= a0;
-  state->b2 /= a0;
-  state->a1 /= a0;
-  state->a2 /= a0;
+  /* The designer works at its own rate, keep the normalized frequency */
+  spec.frequency = config->frequency;
+  if (config->sampleRate != CoeffBatch_GetSampleRate()) {
+    spec.frequency *= CoeffBatch_GetSampleRate() / config->sampleRate;
+  }
+  spec.gainDb = config->gainDB;
+  spec.q = config->Q;
+  
+  CoeffBatch_Design(&spec, &coeff, 1);
+  
+  state->b0 = coeff.b0;
+  state->b1 = coeff.b1;
+  state->b2 = coeff.b2;
+  state->a1 = coeff.a1;
+  state->a2 = coeff.a2;
 }
 
 /**
@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @file           : biquad_cascade.c
+  * @brief          : Specialized biquad cascade kernels
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Kernels are generated by macros for every stage count 1-8 and channel
+  * group of 1, 2 and 4. Coefficients and state of each stage are loaded into
+  * locals before the sample loop and written back after it, so the inner
+  * loop is fully unrolled, branch-free and keeps state in FPU registers.
+  *
+  * A group kernel runs one sample of every channel per iteration, stage by
+  * stage across the channels. Within a channel each section waits for the
+  * previous one; the channels are independent, so their sections fill the
+  * FPU pipeline stalls of each other.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "biquad_cascade.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+typedef void (*BiquadCascadeKernel_t)(BiquadCascade_TypeDef *const *cascades,
+                                      float *const *data, uint32_t blockSize);
+
+/* Private macro -------------------------------------------------------------*/
+/* Channel j of the group: its cascade, samples and output gain */
+#define BQ_OPEN(j)                                                            \
+  BiquadCascade_TypeDef *const c##j = cascades[j];                            \
+  float *const p##j = data[j];                                                \
+  const float g##j = c##j->gain;
+
+/* Load stage k of channel j into locals */
+#define BQ_LOAD(k, j)                                                         \
+  const float b0_##k##_##j = c##j->coeff[k][0], b1_##k##_##j = c##j->coeff[k][1]; \
+  const float b2_##k##_##j = c##j->coeff[k][2], a1_##k##_##j = c##j->coeff[k][3]; \
+  const float a2_##k##_##j = c##j->coeff[k][4];                               \
+  float s1_##k##_##j = c##j->state[k][0], s2_##k##_##j = c##j->state[k][1];
+
+/* One DF2T section of channel j, x##j is both input and output */
+#define BQ_STEP(k, j)                                                         \
+  {                                                                           \
+    const float y = b0_##k##_##j * x##j + s1_##k##_##j;                       \
+    s1_##k##_##j = b1_##k##_##j * x##j - a1_##k##_##j * y + s2_##k##_##j;     \
+    s2_##k##_##j = b2_##k##_##j * x##j - a2_##k##_##j * y;                    \
+    x##j = y;                                                                 \
+  }
+
+/* Write stage k state of channel j back */
+#define BQ_STORE(k, j)                                                        \
+  c##j->state[k][0] = s1_##k##_##j;                                           \
+  c##j->state[k][1] = s2_##k##_##j;
+
+#define BQ_IN(j)        float x##j = p##j[i];
+#define BQ_OUT(j)       p##j[i] = x##j * g##j;
+
+/* Per-channel macro over the channels of a group */
+#define BQ_CHANNELS_1(M)  M(0)
+#define BQ_CHANNELS_2(M)  BQ_CHANNELS_1(M) M(1)
+#define BQ_CHANNELS_4(M)  BQ_CHANNELS_2(M) M(2) M(3)
+
+/* Stage k for every channel of a group */
+#define BQ_LOADS_1(k)   BQ_LOAD(k, 0)
+#define BQ_LOADS_2(k)   BQ_LOADS_1(k) BQ_LOAD(k, 1)
+#define BQ_LOADS_4(k)   BQ_LOADS_2(k) BQ_LOAD(k, 2) BQ_LOAD(k, 3)
+#define BQ_STEPS_1(k)   BQ_STEP(k, 0)
+#define BQ_STEPS_2(k)   BQ_STEPS_1(k) BQ_STEP(k, 1)
+#define BQ_STEPS_4(k)   BQ_STEPS_2(k) BQ_STEP(k, 2) BQ_STEP(k, 3)
+#define BQ_STORES_1(k)  BQ_STORE(k, 0)
+#define BQ_STORES_2(k)  BQ_STORES_1(k) BQ_STORE(k, 1)
+#define BQ_STORES_4(k)  BQ_STORES_2(k) BQ_STORE(k, 2) BQ_STORE(k, 3)
+
+#define BQ_REPEAT_1(M)  M(0)
+#define BQ_REPEAT_2(M)  BQ_REPEAT_1(M) M(1)
+#define BQ_REPEAT_3(M)  BQ_REPEAT_2(M) M(2)
+#define BQ_REPEAT_4(M)  BQ_REPEAT_3(M) M(3)
+#define BQ_REPEAT_5(M)  BQ_REPEAT_4(M) M(4)
+#define BQ_REPEAT_6(M)  BQ_REPEAT_5(M) M(5)
+#define BQ_REPEAT_7(M)  BQ_REPEAT_6(M) M(6)
+#define BQ_REPEAT_8(M)  BQ_REPEAT_7(M) M(7)
+
+/* Kernel for N stages over a fixed group of NCH channels */
+#define BQ_DEFINE_KERNEL(N, NCH)                                              \
+static void BiquadCascade_Kernel_##N##x##NCH(BiquadCascade_TypeDef *const *cascades, \
+                                             float *const *data, uint32_t blockSize) \
+{                                                                             \
+  BQ_CHANNELS_##NCH(BQ_OPEN)                                                  \
+  BQ_REPEAT_##N(BQ_LOADS_##NCH)                                               \
+  for (uint32_t i = 0; i < blockSize; i++) {                                  \
+    BQ_CHANNELS_##NCH(BQ_IN)                                                  \
+    BQ_REPEAT_##N(BQ_STEPS_##NCH)                                             \
+    BQ_CHANNELS_##NCH(BQ_OUT)                                                 \
+  }                                                                           \
+  BQ_REPEAT_##N(BQ_STORES_##NCH)                                              \
+}
+
+#define BQ_DEFINE_KERNELS(N)                                                  \
+  BQ_DEFINE_KERNEL(N, 1)                                                      \
+  BQ_DEFINE_KERNEL(N, 2)                                                      \
+  BQ_DEFINE_KERNEL(N, 4)
+
+#define BQ_KERNEL_ROW(N)                                                      \
+  { BiquadCascade_Kernel_##N##x1, BiquadCascade_Kernel_##N##x2, BiquadCascade_Kernel_##N##x4 }
+
+/* Generated kernels ---------------------------------------------------------*/
+BQ_DEFINE_KERNELS(1)
+BQ_DEFINE_KERNELS(2)
+BQ_DEFINE_KERNELS(3)
+BQ_DEFINE_KERNELS(4)
+BQ_DEFINE_KERNELS(5)
+BQ_DEFINE_KERNELS(6)
+BQ_DEFINE_KERNELS(7)
+BQ_DEFINE_KERNELS(8)
+
+/* Private variables ---------------------------------------------------------*/
+/* Dispatch table indexed by [stages - 1][group: 1, 2, 4 channels] */
+static const BiquadCascadeKernel_t kernelTable[BIQUAD_CASCADE_MAX_STAGES][3] = {
+  BQ_KERNEL_ROW(1), BQ_KERNEL_ROW(2), BQ_KERNEL_ROW(3), BQ_KERNEL_ROW(4),
+  BQ_KERNEL_ROW(5), BQ_KERNEL_ROW(6), BQ_KERNEL_ROW(7), BQ_KERNEL_ROW(8)
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void BiquadCascade_ApplyGain(const BiquadCascade_TypeDef *cascade, float *data, uint32_t blockSize);
+
+/**
+  * @brief  Initialize cascade as unity-gain pass-through
+  * @param  cascade: Pointer to cascade
+  * @retval None
+  */
+void BiquadCascade_Init(BiquadCascade_TypeDef *cascade)
+{
+  memset(cascade, 0, sizeof(BiquadCascade_TypeDef));
+  cascade->gain = 1.0f;
+}
+
+/**
+  * @brief  Compile a list of sections into the cascade
+  * @note   Disabled sections are dropped. When padToStages is larger than the
+  *         enabled count, identity sections are appended so several channels
+  *         can share one group kernel. Filter state is kept when the set of
+  *         enabled sections is unchanged, so coefficient updates do not click.
+  * @param  cascade: Pointer to cascade
+  * @param  coeffs: Array of section coefficients (a0 normalized to 1)
+  * @param  enabled: Array of enable flags, NULL if all sections are enabled
+  * @param  count: Number of sections in coeffs
+  * @param  padToStages: Minimum compiled stage count (0 for none)
+  * @retval None
+  */
+void BiquadCascade_Compile(BiquadCascade_TypeDef *cascade, const BiquadCoeff_t *coeffs,
+                           const uint8_t *enabled, uint8_t count, uint8_t padToStages)
+{
+  uint8_t mask = 0;
+  uint8_t stages = 0;
+
+  if (count > BIQUAD_CASCADE_MAX_STAGES) {
+    count = BIQUAD_CASCADE_MAX_STAGES;
+  }
+  if (padToStages > BIQUAD_CASCADE_MAX_STAGES) {
+    padToStages = BIQUAD_CASCADE_MAX_STAGES;
+  }
+
+  /* Pack enabled sections */
+  for (uint8_t i = 0; i < count; i++) {
+    if (enabled != NULL && !enabled[i]) {
+      continue;
+    }
+    cascade->coeff[stages][0] = coeffs[i].b0;
+    cascade->coeff[stages][1] = coeffs[i].b1;
+    cascade->coeff[stages][2] = coeffs[i].b2;
+    cascade->coeff[stages][3] = coeffs[i].a1;
+    cascade->coeff[stages][4] = coeffs[i].a2;
+    mask |= (uint8_t)(1U << i);
+    stages++;
+  }
+
+  /* Pad with identity sections */
+  while (stages < padToStages) {
+    cascade->coeff[stages][0] = 1.0f;
+    cascade->coeff[stages][1] = 0.0f;
+    cascade->coeff[stages][2] = 0.0f;
+    cascade->coeff[stages][3] = 0.0f;
+    cascade->coeff[stages][4] = 0.0f;
+    stages++;
+  }
+
+  /* Sections moved to other slots, their history no longer matches */
+  if (mask != cascade->activeMask || stages != cascade->numStages) {
+    memset(cascade->state, 0, sizeof(cascade->state));
+  }
+
+  cascade->activeMask = mask;
+  cascade->numStages = stages;
+}
+
+/**
+  * @brief  Clear cascade filter state
+  * @param  cascade: Pointer to cascade
+  * @retval None
+  */
+void BiquadCascade_Reset(BiquadCascade_TypeDef *cascade)
+{
+  memset(cascade->state, 0, sizeof(cascade->state));
+}
+
+/**
+  * @brief  Process a block in place through one cascade
+  * @param  cascade: Pointer to compiled cascade
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples
+  * @retval None
+  */
+void BiquadCascade_Process(BiquadCascade_TypeDef *cascade, float *data, uint32_t blockSize)
+{
+  if (cascade->numStages == 0) {
+    BiquadCascade_ApplyGain(cascade, data, blockSize);
+    return;
+  }
+
+  kernelTable[cascade->numStages - 1][0](&cascade, &data, blockSize);
+}
+
+/**
+  * @brief  Process one block for several channels
+  * @note   Channels with equal stage counts go through the 4- or 2-channel
+  *         kernels, the rest falls back to single-channel kernels
+  * @param  cascades: Array of cascade pointers, one per channel
+  * @param  data: Array of sample buffers, one per channel
+  * @param  numChannels: Number of channels
+  * @param  blockSize: Number of samples per channel
+  * @retval None
+  */
+void BiquadCascade_ProcessGroup(BiquadCascade_TypeDef *const *cascades, float *const *data,
+                                uint8_t numChannels, uint32_t blockSize)
+{
+  uint8_t ch = 0;
+
+  while (ch < numChannels) {
+    uint8_t stages = cascades[ch]->numStages;
+    uint8_t run = 1;
+
+    /* Count following channels with the same stage count */
+    while ((ch + run) < numChannels && run < BIQUAD_CASCADE_MAX_GROUP &&
+           cascades[ch + run]->numStages == stages) {
+      run++;
+    }
+
+    if (stages == 0) {
+      for (uint8_t i = 0; i < run; i++) {
+        BiquadCascade_ApplyGain(cascades[ch + i], data[ch + i], blockSize);
+      }
+    } else if (run == 4) {
+      kernelTable[stages - 1][2](&cascades[ch], &data[ch], blockSize);
+    } else if (run >= 2) {
+      run = 2;
+      kernelTable[stages - 1][1](&cascades[ch], &data[ch], blockSize);
+    } else {
+      kernelTable[stages - 1][0](&cascades[ch], &data[ch], blockSize);
+    }
+
+    ch += run;
+  }
+}
+
+/**
+  * @brief  Apply output gain of an empty cascade
+  * @param  cascade: Pointer to cascade
+  * @param  data: Sample buffer
+  * @param  blockSize: Number of samples
+  * @retval None
+  */
+static void BiquadCascade_ApplyGain(const BiquadCascade_TypeDef *cascade, float *data, uint32_t blockSize)
+{
+  const float g = cascade->gain;
+
+  if (g == 1.0f) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < blockSize; i++) {
+    data[i] *= g;
+  }
+}
@@ -0,0 +1,336 @@
+/**
+  ******************************************************************************
+  * @file           : coeff_batch.c
+  * @brief          : Batch biquad coefficient designer
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Bands are designed in chunks of COEFF_BATCH_CHUNK. Each stage runs as its
+  * own loop over the chunk on small local arrays, so the trig and gain
+  * evaluations are straight-line code without a per-band type switch.
+  *
+  * sincos is a Taylor polynomial after reduction to [-pi/2, pi/2], absolute
+  * error below 1e-6. Frequencies that sit exactly on the encoder grid take
+  * their sine and cosine from a table built once with libm. The dB to
+  * amplitude table is linearly interpolated, relative error below 3e-5,
+  * gains outside its range fall back to powf.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "coeff_batch.h"
+#include "audio_config.h"
+#include "dsp_common.h"
+#include <math.h>
+#include <stddef.h>
+
+/* Private define ------------------------------------------------------------*/
+#define COEFF_BATCH_CHUNK            16U
+#define COEFF_BATCH_DB_POINTS        (2U * COEFF_BATCH_DB_RANGE * COEFF_BATCH_DB_STEPS + 1U)
+#define COEFF_BATCH_MAX_Q            20.0f
+#define COEFF_BATCH_MIN_Q            0.05f
+
+/* Private variables ---------------------------------------------------------*/
+static float batchSampleRate = (float)AUDIO_SAMPLE_RATE;
+static float omegaScale = DSP_TWOPI / (float)AUDIO_SAMPLE_RATE;
+static float gridFreq[COEFF_BATCH_GRID_POINTS];
+static float gridSin[COEFF_BATCH_GRID_POINTS];
+static float gridCos[COEFF_BATCH_GRID_POINTS];
+static float dbTable[COEFF_BATCH_DB_POINTS];   /* 10^(dB/40) */
+static uint8_t tablesReady = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t CoeffBatch_FindGrid(float frequency);
+static void CoeffBatch_DesignChunk(const CoeffBatch_Band_TypeDef *bands, BiquadCoeff_t *coeffs, uint32_t count);
+
+/**
+  * @brief  Build the grid trig and dB tables for a sample rate
+  * @param  sampleRate: Sample rate in Hz
+  * @retval None
+  */
+void CoeffBatch_Init(float sampleRate)
+{
+  batchSampleRate = (sampleRate > 0.0f) ? sampleRate : (float)AUDIO_SAMPLE_RATE;
+  omegaScale = DSP_TWOPI / batchSampleRate;
+
+  for (uint32_t p = 0; p < COEFF_BATCH_GRID_POINTS; p++) {
+    float omega;
+
+    gridFreq[p] = Audio_PercentToFreq((uint8_t)p);
+    omega = gridFreq[p] * omegaScale;
+    gridSin[p] = sinf(omega);
+    gridCos[p] = cosf(omega);
+  }
+
+  for (uint32_t i = 0; i < COEFF_BATCH_DB_POINTS; i++) {
+    float db = (float)i / (float)COEFF_BATCH_DB_STEPS - (float)COEFF_BATCH_DB_RANGE;
+    dbTable[i] = powf(10.0f, db / 40.0f);
+  }
+
+  tablesReady = 1;
+}
+
+/**
+  * @brief  Get the sample rate the tables were built for
+  * @retval Sample rate in Hz
+  */
+float CoeffBatch_GetSampleRate(void)
+{
+  return batchSampleRate;
+}
+
+/**
+  * @brief  Design normalized coefficients (a0 = 1) for a set of sections
+  * @param  bands: Section specifications
+  * @param  coeffs: Output coefficients, one per band
+  * @param  count: Number of bands
+  * @retval None
+  */
+void CoeffBatch_Design(const CoeffBatch_Band_TypeDef *bands, BiquadCoeff_t *coeffs, uint32_t count)
+{
+  if (bands == NULL || coeffs == NULL) {
+    return;
+  }
+
+  if (!tablesReady) {
+    CoeffBatch_Init(batchSampleRate);
+  }
+
+  while (count > 0U) {
+    uint32_t n = (count > COEFF_BATCH_CHUNK) ? COEFF_BATCH_CHUNK : count;
+
+    CoeffBatch_DesignChunk(bands, coeffs, n);
+    bands += n;
+    coeffs += n;
+    count -= n;
+  }
+}
+
+/**
+  * @brief  Polynomial sine and cosine
+  * @param  omega: Angle in radians
+  * @param  sn: Pointer to store sin(omega)
+  * @param  cs: Pointer to store cos(omega)
+  * @retval None
+  */
+void CoeffBatch_SinCos(float omega, float *sn, float *cs)
+{
+  const int32_t turns = (int32_t)(omega * (1.0f / DSP_TWOPI) + ((omega >= 0.0f) ? 0.5f : -0.5f));
+  float x = omega - (float)turns * DSP_TWOPI;
+  float cosSign = 1.0f;
+
+  /* Fold into [-pi/2, pi/2]: sin(pi - x) = sin(x), cos(pi - x) = -cos(x) */
+  if (x > DSP_HALFPI) {
+    x = DSP_PI - x;
+    cosSign = -1.0f;
+  } else if (x < -DSP_HALFPI) {
+    x = -DSP_PI - x;
+    cosSign = -1.0f;
+  }
+
+  const float x2 = x * x;
+
+  *sn = x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f +
+        x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+  *cs = cosSign * (1.0f + x2 * (-0.5f + x2 * (4.1666667e-2f + x2 * (-1.3888889e-3f +
+        x2 * (2.4801587e-5f + x2 * (-2.7557319e-7f + x2 * 2.0876757e-9f))))));
+}
+
+/**
+  * @brief  Convert a gain in dB to the RBJ amplitude A = 10^(dB/40)
+  * @param  gainDb: Gain in dB
+  * @retval Amplitude
+  */
+float CoeffBatch_DbToAmplitude(float gainDb)
+{
+  const float pos = (gainDb + (float)COEFF_BATCH_DB_RANGE) * (float)COEFF_BATCH_DB_STEPS;
+
+  if (!tablesReady || pos < 0.0f || pos >= (float)(COEFF_BATCH_DB_POINTS - 1U)) {
+    return powf(10.0f, gainDb / 40.0f);
+  }
+
+  const uint32_t i = (uint32_t)pos;
+  const float frac = pos - (float)i;
+
+  return dbTable[i] + frac * (dbTable[i + 1U] - dbTable[i]);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Find a frequency that lies exactly on the encoder grid
+  * @param  frequency: Frequency in Hz
+  * @retval Grid index, or -1 when off grid
+  */
+static int32_t CoeffBatch_FindGrid(float frequency)
+{
+  int32_t lo = 0;
+  int32_t hi = (int32_t)COEFF_BATCH_GRID_POINTS - 1;
+
+  while (lo <= hi) {
+    const int32_t mid = (lo + hi) >> 1;
+
+    if (gridFreq[mid] == frequency) {
+      return mid;
+    }
+    if (gridFreq[mid] < frequency) {
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  return -1;
+}
+
+/**
+  * @brief  Design up to COEFF_BATCH_CHUNK sections, one stage at a time
+  * @param  bands: Section specifications
+  * @param  coeffs: Output coefficients
+  * @param  count: Number of bands (<= COEFF_BATCH_CHUNK)
+  * @retval None
+  */
+static void CoeffBatch_DesignChunk(const CoeffBatch_Band_TypeDef *bands, BiquadCoeff_t *coeffs, uint32_t count)
+{
+  float sn[COEFF_BATCH_CHUNK];
+  float cs[COEFF_BATCH_CHUNK];
+  float amp[COEFF_BATCH_CHUNK];
+  float alpha[COEFF_BATCH_CHUNK];
+  const float nyquist = 0.5f * batchSampleRate;
+
+  /* Trig: grid table when the frequency is an encoder position */
+  for (uint32_t i = 0; i < count; i++) {
+    float f = bands[i].frequency;
+    const int32_t g = CoeffBatch_FindGrid(f);
+
+    if (g >= 0 && gridFreq[g] < nyquist) {
+      sn[i] = gridSin[g];
+      cs[i] = gridCos[g];
+      continue;
+    }
+
+    if (f <= 0.0f) f = 20.0f;
+    if (f >= nyquist) f = nyquist - 1.0f;
+    CoeffBatch_SinCos(f * omegaScale, &sn[i], &cs[i]);
+  }
+
+  /* Gain, unity for types that do not use it */
+  for (uint32_t i = 0; i < count; i++) {
+    const uint8_t t = bands[i].type;
+    const uint8_t hasGain = (t == COEFF_BATCH_BELL || t == COEFF_BATCH_LOW_SHELF || t == COEFF_BATCH_HIGH_SHELF);
+
+    amp[i] = hasGain ? CoeffBatch_DbToAmplitude(bands[i].gainDb) : 1.0f;
+  }
+
+  /* Bandwidth */
+  for (uint32_t i = 0; i < count; i++) {
+    float q = bands[i].q;
+
+    if (q > COEFF_BATCH_MAX_Q) q = COEFF_BATCH_MAX_Q;
+    if (q < COEFF_BATCH_MIN_Q) q = COEFF_BATCH_MIN_Q;
+    alpha[i] = sn[i] / (2.0f * q);
+  }
+
+  /* Coefficients, normalized by a0 */
+  for (uint32_t i = 0; i < count; i++) {
+    const float c = cs[i];
+    const float al = alpha[i];
+    const float A = amp[i];
+    float b0, b1, b2, a0, a1, a2;
+
+    switch (bands[i].type) {
+      case COEFF_BATCH_BELL:
+        b0 = 1.0f + al * A;
+        b1 = -2.0f * c;
+        b2 = 1.0f - al * A;
+        a0 = 1.0f + al / A;
+        a1 = b1;
+        a2 = 1.0f - al / A;
+        break;
+
+      case COEFF_BATCH_LOW_SHELF:
+      case COEFF_BATCH_HIGH_SHELF: {
+        const float beta = 2.0f * sqrtf(A) * al;
+        const float ap = A + 1.0f;
+        const float am = A - 1.0f;
+        /* The high shelf is the low shelf with cos(w) negated and odd terms flipped */
+        const float s = (bands[i].type == COEFF_BATCH_LOW_SHELF) ? 1.0f : -1.0f;
+        const float cc = s * c;
+
+        b0 = A * (ap - am * cc + beta);
+        b1 = s * 2.0f * A * (am - ap * cc);
+        b2 = A * (ap - am * cc - beta);
+        a0 = ap + am * cc + beta;
+        a1 = -s * 2.0f * (am + ap * cc);
+        a2 = ap + am * cc - beta;
+        break;
+      }
+
+      case COEFF_BATCH_LOW_PASS:
+        b1 = 1.0f - c;
+        b0 = 0.5f * b1;
+        b2 = b0;
+        a0 = 1.0f + al;
+        a1 = -2.0f * c;
+        a2 = 1.0f - al;
+        break;
+
+      case COEFF_BATCH_HIGH_PASS:
+        b1 = -(1.0f + c);
+        b0 = -0.5f * b1;
+        b2 = b0;
+        a0 = 1.0f + al;
+        a1 = -2.0f * c;
+        a2 = 1.0f - al;
+        break;
+
+      case COEFF_BATCH_BAND_PASS:
+        b0 = al;
+        b1 = 0.0f;
+        b2 = -al;
+        a0 = 1.0f + al;
+        a1 = -2.0f * c;
+        a2 = 1.0f - al;
+        break;
+
+      case COEFF_BATCH_NOTCH:
+        b0 = 1.0f;
+        b1 = -2.0f * c;
+        b2 = 1.0f;
+        a0 = 1.0f + al;
+        a1 = b1;
+        a2 = 1.0f - al;
+        break;
+
+      case COEFF_BATCH_ALL_PASS:
+        b0 = 1.0f - al;
+        b1 = -2.0f * c;
+        b2 = 1.0f + al;
+        a0 = b2;
+        a1 = b1;
+        a2 = b0;
+        break;
+
+      case COEFF_BATCH_FLAT:
+      default:
+        b0 = 1.0f;
+        b1 = 0.0f;
+        b2 = 0.0f;
+        a0 = 1.0f;
+        a1 = 0.0f;
+        a2 = 0.0f;
+        break;
+    }
+
+    const float inv = 1.0f / a0;
+
+    coeffs[i].b0 = b0 * inv;
+    coeffs[i].b1 = b1 * inv;
+    coeffs[i].b2 = b2 * inv;
+    coeffs[i].a1 = a1 * inv;
+    coeffs[i].a2 = a2 * inv;
+  }
+}
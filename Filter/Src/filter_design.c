@@ -27,6 +27,7 @@
 /* Private define ------------------------------------------------------------*/
 #define MAX_FILTER_ORDER    8
 #define MAX_FILTER_SECTIONS 4  /* For up to 8th order filters (4 biquads) */
+#define STEEP_LANDEN_STEPS  8  /* Landen iterations, far below double precision after 5 */
 
 /* Private typedef -----------------------------------------------------------*/
 typedef struct {
@@ -35,6 +36,11 @@ typedef struct {
     double gain;     /* Overall gain factor */
 } FilterSection_t;
 
+typedef struct {
+    double n[3];     /* Numerator, n[i] multiplies s^i */
+    double d[3];     /* Denominator, d[2] = 0 for a first-order section */
+} AnalogSection_t;
+
 /* Private function prototypes -----------------------------------------------*/
 static void BilinearTransform(FilterCoefficients_t* coeffs, float sampleFreq);
 static void NormalizeCoefficients(FilterCoefficients_t* coeffs);
@@ -48,6 +54,18 @@ static void DesignPeakingEQ(FilterCoefficients_t* coeffs, float freq, float Q, f
 static float ComputeQForButterworthOrder(uint8_t order, uint8_t section);
 static void ComputeShelfParameters(float gainDb, float freq, float Q, 
                                   float* A, float* beta, float* omega);
+static double Steep_EllipK(double kc);
+static void Steep_Landen(double k, double* v);
+static void Steep_Cde(double uRe, double uIm, double k, double* wRe, double* wIm);
+static double Steep_Asne(double w, double k);
+static void Steep_SetPair(AnalogSection_t* section, double poleRe, double poleMag2, double zeroMag2);
+static void Steep_SetReal(AnalogSection_t* section, double pole);
+static void Steep_Finish(AnalogSection_t* sections, uint8_t pairs, double gain);
+static void Steep_ChebyshevPrototype(AnalogSection_t* sections, FilterFamily_t family, uint8_t order,
+                                     double passRippleDb, double stopAttenDb);
+static void Steep_EllipticPrototype(AnalogSection_t* sections, uint8_t order,
+                                    double passRippleDb, double stopAttenDb);
+static void Steep_Bilinear(const AnalogSection_t* section, double warp, BiquadCoeff_t* coeff);
 
 /* Filter design functions ---------------------------------------------------*/
 
@@ -344,6 +362,195 @@ void FilterDesign_ConvertToFixed(const FilterCoefficients_t* src,
     }
 }
 
+/**
+  * @brief  Design a Butterworth, Chebyshev I/II or elliptic LP/HP cascade
+  * @note   The analog prototype is built from its poles and zeros, moved to
+  *         high-pass by s -> 1/s and mapped with a bilinear transform
+  *         prewarped at spec->frequency. Sections come out in ascending
+  *         pole Q, the first-order section (odd orders) last.
+  * @param  sections: Output sections, a0 normalized to 1
+  * @param  maxSections: Room in sections, at least (order + 1) / 2
+  * @param  spec: Design specification
+  * @retval Filter design status (0 = success)
+  */
+int FilterDesign_CreateSteep(BiquadCoeff_t* sections,
+                             uint8_t maxSections,
+                             const FilterSteepSpec_t* spec)
+{
+    AnalogSection_t analog[FILTER_STEEP_MAX_SECTIONS];
+    uint8_t numSections;
+    double warp;
+    
+    /* Validate parameters */
+    if (sections == NULL || spec == NULL || spec->sampleRate <= 0.0f ||
+        spec->frequency <= 0.0f || spec->frequency >= 0.5f * spec->sampleRate) {
+        return FILTER_DESIGN_ERROR_PARAMS;
+    }
+    
+    if (spec->type != FILTER_TYPE_LOWPASS && spec->type != FILTER_TYPE_HIGHPASS) {
+        return FILTER_DESIGN_ERROR_TYPE;
+    }
+    
+    numSections = (uint8_t)((spec->order + 1U) / 2U);
+    if (spec->order < 1U || spec->order > FILTER_STEEP_MAX_ORDER || numSections > maxSections) {
+        return FILTER_DESIGN_ERROR_ORDER;
+    }
+    
+    if (spec->family != FILTER_FAMILY_BUTTERWORTH &&
+        (spec->passRippleDb <= 0.0f ||
+         (spec->family != FILTER_FAMILY_CHEBYSHEV1 && spec->stopAttenDb <= spec->passRippleDb))) {
+        return FILTER_DESIGN_ERROR_PARAMS;
+    }
+    
+    /* Lowpass prototype with the passband edge at 1 rad/s */
+    switch (spec->family) {
+        case FILTER_FAMILY_BUTTERWORTH:
+            Steep_ChebyshevPrototype(analog, spec->family, spec->order, 0.0, 0.0);
+            break;
+            
+        case FILTER_FAMILY_CHEBYSHEV1:
+            Steep_ChebyshevPrototype(analog, spec->family, spec->order, spec->passRippleDb, 0.0);
+            break;
+            
+        case FILTER_FAMILY_CHEBYSHEV2:
+            Steep_ChebyshevPrototype(analog, spec->family, spec->order, spec->passRippleDb, spec->stopAttenDb);
+            break;
+            
+        case FILTER_FAMILY_ELLIPTIC:
+            Steep_EllipticPrototype(analog, spec->order, spec->passRippleDb, spec->stopAttenDb);
+            break;
+            
+        default:
+            return FILTER_DESIGN_ERROR_RESPONSE;
+    }
+    
+    warp = 1.0 / tan(M_PI * (double)spec->frequency / (double)spec->sampleRate);
+    
+    for (uint8_t i = 0; i < numSections; i++) {
+        AnalogSection_t* a = &analog[i];
+        
+        /* Highpass: s -> 1/s, i.e. reverse both polynomials */
+        if (spec->type == FILTER_TYPE_HIGHPASS) {
+            double t;
+            if (a->d[2] == 0.0) {
+                t = a->n[0]; a->n[0] = a->n[1]; a->n[1] = t;
+                t = a->d[0]; a->d[0] = a->d[1]; a->d[1] = t;
+            } else {
+                t = a->n[0]; a->n[0] = a->n[2]; a->n[2] = t;
+                t = a->d[0]; a->d[0] = a->d[2]; a->d[2] = t;
+            }
+        }
+        
+        Steep_Bilinear(a, warp, &sections[i]);
+    }
+    
+    return FILTER_DESIGN_SUCCESS;
+}
+
+/**
+  * @brief  Lowest order of a family that meets an attenuation target
+  * @note   Closed-form degree equations on the prewarped edges, so the
+  *         result holds for the digital filter as well. The corner is
+  *         the passband edge (-3 dB for Butterworth, -passRippleDb for
+  *         the others).
+  * @param  spec: Family, type, corner, ripple, stopband attenuation and
+  *         sample rate; the order field is ignored
+  * @param  offsetOctaves: Distance of the stopband edge from the corner
+  *         (below it for a high-pass, above it for a low-pass)
+  * @retval Order (sections = (order + 1) / 2), 0 if no order up to
+  *         FILTER_STEEP_MAX_ORDER meets the target
+  */
+uint8_t FilterDesign_MinimumOrder(const FilterSteepSpec_t* spec, float offsetOctaves)
+{
+    double stopFreq, ratio, ep, es, n;
+    
+    if (spec == NULL || offsetOctaves <= 0.0f || spec->sampleRate <= 0.0f ||
+        spec->frequency <= 0.0f || spec->stopAttenDb <= 0.0f) {
+        return 0;
+    }
+    
+    /* Stopband edge, prewarped ratio to the corner */
+    if (spec->type == FILTER_TYPE_HIGHPASS) {
+        stopFreq = (double)spec->frequency / pow(2.0, (double)offsetOctaves);
+        ratio = tan(M_PI * (double)spec->frequency / (double)spec->sampleRate) /
+                tan(M_PI * stopFreq / (double)spec->sampleRate);
+    } else {
+        stopFreq = (double)spec->frequency * pow(2.0, (double)offsetOctaves);
+        if (stopFreq >= 0.5 * (double)spec->sampleRate) {
+            return 0;
+        }
+        ratio = tan(M_PI * stopFreq / (double)spec->sampleRate) /
+                tan(M_PI * (double)spec->frequency / (double)spec->sampleRate);
+    }
+    
+    ep = sqrt(pow(10.0, ((spec->family == FILTER_FAMILY_BUTTERWORTH) ? 3.0103 : (double)spec->passRippleDb) / 10.0) - 1.0);
+    es = sqrt(pow(10.0, (double)spec->stopAttenDb / 10.0) - 1.0);
+    if (es <= ep) {
+        return 1;
+    }
+    
+    switch (spec->family) {
+        case FILTER_FAMILY_BUTTERWORTH:
+            n = log(es / ep) / log(ratio);
+            break;
+            
+        case FILTER_FAMILY_CHEBYSHEV1:
+        case FILTER_FAMILY_CHEBYSHEV2:
+            n = acosh(es / ep) / acosh(ratio);
+            break;
+            
+        case FILTER_FAMILY_ELLIPTIC:
+        {
+            /* N >= K(k) K'(k1) / (K'(k) K(k1)), k = 1/ratio, k1 = ep/es */
+            const double k = 1.0 / ratio;
+            const double k1 = ep / es;
+            n = (Steep_EllipK(sqrt(1.0 - k * k)) * Steep_EllipK(k1)) /
+                (Steep_EllipK(k) * Steep_EllipK(sqrt(1.0 - k1 * k1)));
+            break;
+        }
+            
+        default:
+            return 0;
+    }
+    
+    /* Tolerance keeps an exact fit from rounding up a whole order */
+    n = ceil(n - 1e-9);
+    if (n < 1.0) {
+        n = 1.0;
+    }
+    
+    return (n > (double)FILTER_STEEP_MAX_ORDER) ? 0U : (uint8_t)n;
+}
+
+/**
+  * @brief  Design the cheapest filter of a family that meets a target
+  * @param  sections: Output sections
+  * @param  maxSections: Room in sections
+  * @param  spec: Design specification, order is filled in
+  * @param  offsetOctaves: Stopband edge distance from the corner
+  * @retval Filter design status (0 = success)
+  */
+int FilterDesign_CreateSteepForTarget(BiquadCoeff_t* sections,
+                                      uint8_t maxSections,
+                                      FilterSteepSpec_t* spec,
+                                      float offsetOctaves)
+{
+    uint8_t order;
+    
+    if (spec == NULL) {
+        return FILTER_DESIGN_ERROR_PARAMS;
+    }
+    
+    order = FilterDesign_MinimumOrder(spec, offsetOctaves);
+    if (order == 0U || (uint8_t)((order + 1U) / 2U) > maxSections) {
+        return FILTER_DESIGN_ERROR_ORDER;
+    }
+    
+    spec->order = order;
+    
+    return FilterDesign_CreateSteep(sections, maxSections, spec);
+}
+
 /* Private functions ---------------------------------------------------------*/
 
 /**
@@ -918,4 +1125,323 @@ int FilterDesign_CreateFirstOrder(FilterCoefficients_t* coeffs,
     return FILTER_DESIGN_SUCCESS;
 }
 
+/* Steep filter design -------------------------------------------------------*/
+
+/**
+  * @brief  Complete elliptic integral of the first kind
+  * @param  kc: Complementary modulus sqrt(1 - k^2), passed directly so
+  *         moduli near 1 keep their precision
+  * @retval K(k)
+  */
+static double Steep_EllipK(double kc)
+{
+    double a = 1.0;
+    double b = kc;
+    
+    /* Arithmetic-geometric mean, converges in a handful of steps */
+    for (uint8_t i = 0; i < 16 && fabs(a - b) > 1e-15 * a; i++) {
+        const double t = 0.5 * (a + b);
+        b = sqrt(a * b);
+        a = t;
+    }
+    
+    return M_PI / (2.0 * a);
+}
+
+/**
+  * @brief  Descending Landen sequence of a modulus
+  * @param  k: Modulus
+  * @param  v: Sequence, STEEP_LANDEN_STEPS entries
+  * @retval None
+  */
+static void Steep_Landen(double k, double* v)
+{
+    for (uint8_t n = 0; n < STEEP_LANDEN_STEPS; n++) {
+        k = k / (1.0 + sqrt(1.0 - k * k));
+        k = k * k;
+        v[n] = k;
+    }
+}
+
+/**
+  * @brief  Jacobi cd(u K, k) for a complex argument
+  * @param  uRe: Real part of u (normalized to K)
+  * @param  uIm: Imaginary part of u
+  * @param  k: Modulus
+  * @param  wRe: Real part of the result
+  * @param  wIm: Imaginary part of the result
+  * @retval None
+  */
+static void Steep_Cde(double uRe, double uIm, double k, double* wRe, double* wIm)
+{
+    double v[STEEP_LANDEN_STEPS];
+    const double x = 0.5 * M_PI * uRe;
+    const double y = 0.5 * M_PI * uIm;
+    double re = cos(x) * cosh(y);
+    double im = -sin(x) * sinh(y);
+    
+    Steep_Landen(k, v);
+    
+    /* Ascending Landen: w = (1 + v) w / (1 + v w^2) */
+    for (int8_t n = STEEP_LANDEN_STEPS - 1; n >= 0; n--) {
+        const double w2Re = re * re - im * im;
+        const double w2Im = 2.0 * re * im;
+        const double dRe = 1.0 + v[n] * w2Re;
+        const double dIm = v[n] * w2Im;
+        const double dMag = dRe * dRe + dIm * dIm;
+        const double nRe = (1.0 + v[n]) * re;
+        const double nIm = (1.0 + v[n]) * im;
+        
+        re = (nRe * dRe + nIm * dIm) / dMag;
+        im = (nIm * dRe - nRe * dIm) / dMag;
+    }
+    
+    *wRe = re;
+    *wIm = im;
+}
+
+/**
+  * @brief  Inverse of sn(u K, k) for a real value in [0, 1]
+  * @param  w: sn value
+  * @param  k: Modulus
+  * @retval u (normalized to K)
+  */
+static double Steep_Asne(double w, double k)
+{
+    double v[STEEP_LANDEN_STEPS];
+    
+    Steep_Landen(k, v);
+    
+    /* Inverse of cd by descending Landen, sn(u) = cd(1 - u) */
+    for (uint8_t n = 0; n < STEEP_LANDEN_STEPS; n++) {
+        const double v1 = (n == 0U) ? k : v[n - 1U];
+        w = w / (1.0 + sqrt(1.0 - w * w * v1 * v1)) * 2.0 / (1.0 + v[n]);
+    }
+    
+    if (w > 1.0) {
+        w = 1.0;
+    }
+    
+    return 1.0 - (2.0 / M_PI) * acos(w);
+}
+
+/**
+  * @brief  Store a conjugate pole pair (and zero pair) as an analog section
+  * @note   Unity gain at DC; zeroMag2 of 0 means no finite zeros
+  * @param  section: Analog section
+  * @param  poleRe: Real part of the pole (negative)
+  * @param  poleMag2: Squared pole magnitude
+  * @param  zeroMag2: Squared magnitude of the imaginary-axis zeros
+  * @retval None
+  */
+static void Steep_SetPair(AnalogSection_t* section, double poleRe, double poleMag2, double zeroMag2)
+{
+    const double scale = (zeroMag2 > 0.0) ? (poleMag2 / zeroMag2) : poleMag2;
+    
+    section->n[0] = (zeroMag2 > 0.0) ? zeroMag2 * scale : scale;
+    section->n[1] = 0.0;
+    section->n[2] = (zeroMag2 > 0.0) ? scale : 0.0;
+    section->d[0] = poleMag2;
+    section->d[1] = -2.0 * poleRe;
+    section->d[2] = 1.0;
+}
+
+/**
+  * @brief  Store a real pole as a first-order analog section, unity at DC
+  * @param  section: Analog section
+  * @param  pole: Real pole (negative)
+  * @retval None
+  */
+static void Steep_SetReal(AnalogSection_t* section, double pole)
+{
+    section->n[0] = -pole;
+    section->n[1] = 0.0;
+    section->n[2] = 0.0;
+    section->d[0] = -pole;
+    section->d[1] = 1.0;
+    section->d[2] = 0.0;
+}
+
+/**
+  * @brief  Sort pole-pair sections by ascending Q, apply the DC gain
+  * @param  sections: Analog sections, pairs first
+  * @param  pairs: Number of second-order sections
+  * @param  gain: Passband gain at DC
+  * @retval None
+  */
+static void Steep_Finish(AnalogSection_t* sections, uint8_t pairs, double gain)
+{
+    /* Q = sqrt(d0) / d1, low Q first keeps the intermediate levels down */
+    for (uint8_t i = 1; i < pairs; i++) {
+        const AnalogSection_t key = sections[i];
+        const double keyQ = sqrt(key.d[0]) / key.d[1];
+        int8_t j = (int8_t)i - 1;
+        
+        while (j >= 0 && sqrt(sections[j].d[0]) / sections[j].d[1] > keyQ) {
+            sections[j + 1] = sections[j];
+            j--;
+        }
+        sections[j + 1] = key;
+    }
+    
+    for (uint8_t c = 0; c < 3; c++) {
+        sections[0].n[c] *= gain;
+    }
+}
+
+/**
+  * @brief  Butterworth / Chebyshev lowpass prototype, passband edge at 1 rad/s
+  * @param  sections: Analog sections, (order + 1) / 2 entries
+  * @param  family: FILTER_FAMILY_BUTTERWORTH, _CHEBYSHEV1 or _CHEBYSHEV2
+  * @param  order: Filter order
+  * @param  passRippleDb: Passband ripple (loss at the edge for Chebyshev II)
+  * @param  stopAttenDb: Stopband attenuation (Chebyshev II)
+  * @retval None
+  */
+static void Steep_ChebyshevPrototype(AnalogSection_t* sections, FilterFamily_t family, uint8_t order,
+                                     double passRippleDb, double stopAttenDb)
+{
+    const uint8_t pairs = order / 2U;
+    const double ep = sqrt(pow(10.0, passRippleDb / 10.0) - 1.0);
+    const double es = sqrt(pow(10.0, stopAttenDb / 10.0) - 1.0);
+    double mu = 0.0;
+    double scale = 1.0;
+    double gain = 1.0;
+    
+    if (family == FILTER_FAMILY_CHEBYSHEV1) {
+        mu = asinh(1.0 / ep) / order;
+        gain = (order % 2U) ? 1.0 : 1.0 / sqrt(1.0 + ep * ep);
+    } else if (family == FILTER_FAMILY_CHEBYSHEV2) {
+        mu = asinh(es) / order;
+        /* Prototype has its stopband edge at 1, move the passband edge there */
+        scale = cosh(acosh(es / ep) / order);
+    }
+    
+    for (uint8_t k = 0; k < pairs; k++) {
+        const double theta = M_PI * (2.0 * k + 1.0) / (2.0 * order);
+        double re = -sin(theta);
+        double im = cos(theta);
+        double zeroMag2 = 0.0;
+        
+        if (family != FILTER_FAMILY_BUTTERWORTH) {
+            re *= sinh(mu);
+            im *= cosh(mu);
+        }
+        
+        if (family == FILTER_FAMILY_CHEBYSHEV2) {
+            /* Inverse Chebyshev: reciprocal poles, zeros at 1 / cos(theta) */
+            const double mag2 = re * re + im * im;
+            re = re / mag2 * scale;
+            im = -im / mag2 * scale;
+            zeroMag2 = scale * scale / (cos(theta) * cos(theta));
+        }
+        
+        Steep_SetPair(&sections[k], re, re * re + im * im, zeroMag2);
+    }
+    
+    if (order % 2U) {
+        double pole = -1.0;
+        
+        if (family == FILTER_FAMILY_CHEBYSHEV1) {
+            pole = -sinh(mu);
+        } else if (family == FILTER_FAMILY_CHEBYSHEV2) {
+            pole = -scale / sinh(mu);
+        }
+        Steep_SetReal(&sections[pairs], pole);
+    }
+    
+    Steep_Finish(sections, pairs, gain);
+}
+
+/**
+  * @brief  Elliptic (Cauer) lowpass prototype, passband edge at 1 rad/s
+  * @note   Jacobi functions by Landen transformations, selectivity from
+  *         the degree equation for the given order, ripple and attenuation
+  * @param  sections: Analog sections, (order + 1) / 2 entries
+  * @param  order: Filter order
+  * @param  passRippleDb: Passband ripple
+  * @param  stopAttenDb: Minimum stopband attenuation
+  * @retval None
+  */
+static void Steep_EllipticPrototype(AnalogSection_t* sections, uint8_t order,
+                                    double passRippleDb, double stopAttenDb)
+{
+    const uint8_t pairs = order / 2U;
+    const double ep = sqrt(pow(10.0, passRippleDb / 10.0) - 1.0);
+    const double es = sqrt(pow(10.0, stopAttenDb / 10.0) - 1.0);
+    const double k1 = ep / es;
+    const double k1c = sqrt(1.0 - k1 * k1);
+    double product = 1.0;
+    double kc, k, v0;
+    
+    /* Degree equation: selectivity k reached by this order */
+    for (uint8_t i = 0; i < pairs; i++) {
+        double sn, unused;
+        Steep_Cde(1.0 - (2.0 * i + 1.0) / order, 0.0, k1c, &sn, &unused);
+        product *= sn;
+    }
+    kc = pow(k1c, order) * pow(product, 4.0);
+    k = sqrt(1.0 - kc * kc);
+    
+    /* Imaginary offset of the poles: sn(j v0 N K1, k1) = j / ep */
+    v0 = Steep_Asne(1.0 / sqrt(1.0 + ep * ep), k1c) * Steep_EllipK(k1) / Steep_EllipK(k1c) / order;
+    
+    for (uint8_t i = 0; i < pairs; i++) {
+        const double u = (2.0 * i + 1.0) / order;
+        double zeta, unused, wRe, wIm;
+        
+        Steep_Cde(u, 0.0, k, &zeta, &unused);
+        Steep_Cde(u, -v0, k, &wRe, &wIm);
+        
+        /* Pole j * cd(u - j v0), zeros j / (k zeta) */
+        Steep_SetPair(&sections[i], -wIm, wRe * wRe + wIm * wIm, 1.0 / (k * k * zeta * zeta));
+    }
+    
+    if (order % 2U) {
+        double wRe, wIm;
+        Steep_Cde(1.0, -v0, k, &wRe, &wIm);
+        Steep_SetReal(&sections[pairs], -fabs(wIm));
+    }
+    
+    Steep_Finish(sections, pairs, (order % 2U) ? 1.0 : 1.0 / sqrt(1.0 + ep * ep));
+}
+
+/**
+  * @brief  Map an analog section to a digital biquad
+  * @param  section: Analog section, edge at 1 rad/s
+  * @param  warp: cot(pi * fc / fs), puts the edge at fc
+  * @param  coeff: Digital coefficients, a0 normalized to 1
+  * @retval None
+  */
+static void Steep_Bilinear(const AnalogSection_t* section, double warp, BiquadCoeff_t* coeff)
+{
+    const double* n = section->n;
+    const double* d = section->d;
+    double b0, b1, b2, a0, a1, a2;
+    
+    if (d[2] == 0.0) {
+        /* First order, no cancelled pole-zero pair at Nyquist */
+        b0 = n[1] * warp + n[0];
+        b1 = n[0] - n[1] * warp;
+        b2 = 0.0;
+        a0 = d[1] * warp + d[0];
+        a1 = d[0] - d[1] * warp;
+        a2 = 0.0;
+    } else {
+        const double w2 = warp * warp;
+        b0 = n[2] * w2 + n[1] * warp + n[0];
+        b1 = 2.0 * (n[0] - n[2] * w2);
+        b2 = n[2] * w2 - n[1] * warp + n[0];
+        a0 = d[2] * w2 + d[1] * warp + d[0];
+        a1 = 2.0 * (d[0] - d[2] * w2);
+        a2 = d[2] * w2 - d[1] * warp + d[0];
+    }
+    
+    coeff->b0 = (float)(b0 / a0);
+    coeff->b1 = (float)(b1 / a0);
+    coeff->b2 = (float)(b2 / a0);
+    coeff->a1 = (float)(a1 / a0);
+    coeff->a2 = (float)(a2 / a0);
+}
+
 /* End of file */
\ No newline at end of file
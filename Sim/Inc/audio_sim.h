@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file           : audio_sim.h
+  * @brief          : Virtual-time I2S/DMA scheduling simulator (host build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Models the I2S word clock of the ADC (I2S2) and DAC (I2S3) streams, their
+  * half/full DMA interrupts and the single main loop that services
+  * Audio_Pipeline_Process(). Frames are signaled by the ADC interrupts as on
+  * the board, the DAC interrupts set their deadlines. Callbacks are dispatched in virtual time, the
+  * pipeline cost is taken from the real code (host time scaled to the
+  * target) or from a fixed cycle count, and the report shows deadline
+  * misses, lost frames, start jitter and worst-case I/O latency against the
+  * configured CPU clock.
+  *
+  * Host only, not part of the firmware image.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __AUDIO_SIM_H
+#define __AUDIO_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Hooks into the code under test, NULL hooks are skipped
+  */
+typedef struct {
+  void (*rxHalfComplete)(void);     /* HAL_I2S_RxHalfCpltCallback(&hi2s2) */
+  void (*rxComplete)(void);         /* HAL_I2S_RxCpltCallback(&hi2s2) */
+  void (*txHalfComplete)(void);     /* HAL_I2S_TxHalfCpltCallback(&hi2s3) */
+  void (*txComplete)(void);         /* HAL_I2S_TxCpltCallback(&hi2s3) */
+  uint32_t (*process)(void);        /* One audio pass of the main loop, returns
+                                       target cycles or 0 to use host time */
+  void (*background)(void);         /* Non-audio main loop work (UI, menu) */
+  void (*clock)(double timeUs);     /* Virtual time, set before every other hook */
+} AudioSim_Hooks_TypeDef;
+
+/**
+  * @brief  Simulation setup
+  */
+typedef struct {
+  float sampleRate;                 /* Nominal I2S frame rate in Hz */
+  uint32_t frameSize;               /* Samples per DMA half buffer */
+  float cpuHz;                      /* Target core clock */
+  float cpuScale;                   /* Target time per unit of host time */
+  uint32_t fixedCycles;             /* Pipeline cost override, 0 = measured */
+  uint32_t isrCycles;               /* Cost of one DMA interrupt */
+  float txOffsetUs;                 /* DAC stream start relative to ADC */
+  float txDriftPpm;                 /* DAC clock error relative to ADC */
+  float backgroundPeriodUs;         /* Main loop background work period, 0 = none */
+  float backgroundCostUs;           /* Duration of one background pass */
+  uint32_t frames;                  /* ADC half buffers to simulate */
+} AudioSim_Config_TypeDef;
+
+/**
+  * @brief  Simulation results, times in microseconds
+  */
+typedef struct {
+  uint32_t framesSignaled;          /* ADC half/full interrupts */
+  uint32_t framesProcessed;
+  uint32_t framesLost;              /* Signaled again before being serviced */
+  uint32_t deadlineMisses;          /* Finished after the DMA needed the data */
+  float periodUs;                   /* ADC frame period */
+  float startJitterMaxUs;           /* Worst delay from interrupt to start */
+  float startJitterMeanUs;
+  float processMaxUs;               /* Worst pipeline duration incl. preemption */
+  float processMeanUs;
+  float slackMinUs;                 /* Smallest margin to the deadline */
+  float latencyMaxUs;               /* First captured sample to playback */
+  float latencyMinUs;
+  float loadMaxPercent;             /* processMaxUs relative to the period */
+} AudioSim_Stats_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void AudioSim_GetDefaultConfig(AudioSim_Config_TypeDef *config);
+int AudioSim_Run(const AudioSim_Config_TypeDef *config, const AudioSim_Hooks_TypeDef *hooks,
+                 AudioSim_Stats_TypeDef *stats);
+void AudioSim_PrintReport(const AudioSim_Config_TypeDef *config, const AudioSim_Stats_TypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AUDIO_SIM_H */
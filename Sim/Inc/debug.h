@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file           : debug.h
+  * @brief          : Host stand-in for the firmware debug output (simulator build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * DEBUG_PRINT() goes to stdout when the simulator is built with
+  * -DSIM_DEBUG_PRINT and is compiled out otherwise, so a long run is not
+  * dominated by console output. The format string and arguments are still
+  * type checked in both cases.
+  *
+  * Host only, found ahead of the firmware headers through Sim/Inc.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __DEBUG_H
+#define __DEBUG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+/* Exported macro ------------------------------------------------------------*/
+#ifdef SIM_DEBUG_PRINT
+#define DEBUG_PRINT(...)            printf(__VA_ARGS__)
+#else
+#define DEBUG_PRINT(...)            do { if (0) { printf(__VA_ARGS__); } } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEBUG_H */
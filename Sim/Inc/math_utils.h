@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file           : math_utils.h
+  * @brief          : Host stand-in for the firmware math helpers (simulator build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The level conversions the DSP modules use, on top of <math.h>.
+  *
+  * Host only, found ahead of the firmware headers through Sim/Inc.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __MATH_UTILS_H
+#define __MATH_UTILS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+
+/* Exported macro ------------------------------------------------------------*/
+#define DB_TO_LINEAR(db)            powf(10.0f, (db) / 20.0f)
+#define LINEAR_TO_DB(lin)           (20.0f * log10f(lin))
+
+/* Exported functions --------------------------------------------------------*/
+static inline float dBToLinear(float db)
+{
+  return DB_TO_LINEAR(db);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MATH_UTILS_H */
@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file           : sim_pipeline.h
+  * @brief          : Host audio path driven by the simulator (host build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * The firmware main loop, audio driver and the filter stages behind them
+  * do not build on the host yet. This is the part of the audio path that
+  * does, serviced the way Audio_MainLoopService() services the real one:
+  * the I2S callbacks hand DMA slots over through the same DMA_Slots rings,
+  * the main loop pass takes the frame, runs input gate, compressor and
+  * dynamics with the CPU budget marks, and converts into the DAC slot with
+  * the level statistics.
+  *
+  * Host only, not part of the firmware image.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __SIM_PIPELINE_H
+#define __SIM_PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  What the audio path did over a run
+  */
+typedef struct {
+  uint32_t framesProcessed;         /* Main loop passes that took a frame */
+  uint32_t inputLate;               /* ADC reached a slot the CPU still held */
+  uint32_t inputDropped;            /* Captured frames overwritten unread */
+  uint32_t outputLate;              /* DAC reached a slot the CPU still wrote */
+  uint32_t outputReplayed;          /* DAC replayed a slot never refilled */
+  uint8_t silentOutputs;            /* Outputs that never carried the test tone */
+} SimPipeline_Stats_TypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+void SimPipeline_Init(float toneHz, float toneDb);
+void SimPipeline_Service(void);
+void SimPipeline_GetStats(SimPipeline_Stats_TypeDef *stats);
+void SimPipeline_PrintReport(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_PIPELINE_H */
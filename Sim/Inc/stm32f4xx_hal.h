@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file           : stm32f4xx_hal.h
+  * @brief          : Host stand-in for the STM32F4 HAL (simulator build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Only what the audio path, the codec drivers and system init touch: the
+  * status codes, I2S/GPIO/TIM handles, the peripheral instances compared in
+  * the callbacks, the core intrinsics and the DWT cycle counter. Peripheral
+  * calls succeed without doing anything. DWT->CYCCNT and HAL_GetTick()
+  * follow the virtual time of the simulator, see sim_hal.c.
+  *
+  * Found ahead of the real HAL through Sim/Inc on the include path and
+  * forced into every unit by the simulator Makefile. Host only.
+  *
+  ******************************************************************************
+  */
+
+#ifndef __STM32F4XX_HAL_H
+#define __STM32F4XX_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef __weak
+#define __weak                      __attribute__((weak))
+#endif
+#define __IO                        volatile
+
+#define GPIO_PIN_12                 ((uint16_t)0x1000)
+#define GPIO_PIN_13                 ((uint16_t)0x2000)
+#define GPIO_PIN_14                 ((uint16_t)0x4000)
+#define GPIO_PIN_15                 ((uint16_t)0x8000)
+#define GPIO_MODE_OUTPUT_PP         0x00000001U
+#define GPIO_NOPULL                 0x00000000U
+#define GPIO_SPEED_FREQ_LOW         0x00000000U
+
+#define I2S_MODE_MASTER_TX          0x00000200U
+#define I2S_MODE_MASTER_RX          0x00000300U
+#define I2S_STANDARD_PHILIPS        0x00000000U
+#define I2S_DATAFORMAT_16B          0x00000000U
+#define I2S_DATAFORMAT_24B          0x00000003U
+#define I2S_DATAFORMAT_32B          0x00000005U
+#define I2S_MCLKOUTPUT_ENABLE       0x00000200U
+#define I2S_MCLKOUTPUT_DISABLE      0x00000000U
+#define I2S_CPOL_LOW                0x00000000U
+
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef enum {
+  HAL_I2S_STATE_RESET      = 0x00U,
+  HAL_I2S_STATE_READY      = 0x01U,
+  HAL_I2S_STATE_BUSY       = 0x02U,
+  HAL_I2S_STATE_BUSY_TX    = 0x03U,
+  HAL_I2S_STATE_BUSY_RX    = 0x04U,
+  HAL_I2S_STATE_ERROR      = 0x07U
+} HAL_I2S_StateTypeDef;
+
+/* Peripheral instances are only compared by address */
+typedef struct { uint32_t id; } SPI_TypeDef;
+typedef struct { uint32_t id; } TIM_TypeDef;
+typedef struct { uint32_t ODR; } GPIO_TypeDef;
+
+typedef struct {
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+typedef struct {
+  uint32_t Mode;
+  uint32_t Standard;
+  uint32_t DataFormat;
+  uint32_t MCLKOutput;
+  uint32_t AudioFreq;
+  uint32_t CPOL;
+  uint32_t ClockSource;
+  uint32_t FullDuplexMode;
+} I2S_InitTypeDef;
+
+typedef struct {
+  SPI_TypeDef *Instance;
+  I2S_InitTypeDef Init;
+  __IO HAL_I2S_StateTypeDef State;
+  __IO uint32_t ErrorCode;
+} I2S_HandleTypeDef;
+
+typedef struct {
+  TIM_TypeDef *Instance;
+} TIM_HandleTypeDef;
+
+typedef struct {
+  __IO uint32_t CTRL;
+  __IO uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t SystemCoreClock;          /* Target clock, set by SimHal_SetClock */
+extern SPI_TypeDef SimHal_SPI2, SimHal_SPI3, SimHal_SPI4;
+extern TIM_TypeDef SimHal_TIM6;
+extern GPIO_TypeDef SimHal_GPIOA, SimHal_GPIOB, SimHal_GPIOC;
+extern CoreDebug_Type SimHal_CoreDebug;
+
+/* Exported macro ------------------------------------------------------------*/
+#define SPI2                        (&SimHal_SPI2)
+#define SPI3                        (&SimHal_SPI3)
+#define SPI4                        (&SimHal_SPI4)
+#define TIM6                        (&SimHal_TIM6)
+#define GPIOA                       (&SimHal_GPIOA)
+#define GPIOB                       (&SimHal_GPIOB)
+#define GPIOC                       (&SimHal_GPIOC)
+#define CoreDebug                   (&SimHal_CoreDebug)
+#define DWT                         (SimHal_GetDWT())
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_PWR_CLK_ENABLE()      ((void)0)
+
+/* Single-threaded host: interrupts are hooks called between main loop passes */
+#define __disable_irq()             ((void)0)
+#define __enable_irq()              ((void)0)
+#define __get_PRIMASK()             (0U)
+#define __DMB()                     __sync_synchronize()
+#define __DSB()                     __sync_synchronize()
+#define __NOP()                     ((void)0)
+
+/* Exported functions --------------------------------------------------------*/
+HAL_StatusTypeDef HAL_Init(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+HAL_StatusTypeDef HAL_I2S_Init(I2S_HandleTypeDef *hi2s);
+HAL_StatusTypeDef HAL_I2S_DeInit(I2S_HandleTypeDef *hi2s);
+HAL_StatusTypeDef HAL_I2S_Transmit_DMA(I2S_HandleTypeDef *hi2s, uint16_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2S_Receive_DMA(I2S_HandleTypeDef *hi2s, uint16_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2S_DMAStop(I2S_HandleTypeDef *hi2s);
+void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s);
+void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s);
+void HAL_I2S_RxHalfCpltCallback(I2S_HandleTypeDef *hi2s);
+void HAL_I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s);
+void HAL_I2S_ErrorCallback(I2S_HandleTypeDef *hi2s);
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+
+/* Simulator side */
+DWT_Type *SimHal_GetDWT(void);
+void SimHal_SetClock(float cpuHz, float cpuScale);
+void SimHal_SetTime(double timeUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F4XX_HAL_H */
@@ -0,0 +1,288 @@
+/**
+  ******************************************************************************
+  * @file           : audio_sim.c
+  * @brief          : Virtual-time I2S/DMA scheduling simulator (host build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Discrete-event model of one core:
+  *  - DMA interrupts fire on the ADC and DAC half-buffer boundaries and
+  *    preempt whatever runs, each costing isrCycles.
+  *  - The main loop services a pending audio frame first and background
+  *    work second, both run to completion.
+  *  - An ADC interrupt signals a frame, as Audio_ProcessCallback() does on
+  *    the board. Its output goes into the DAC half the DMA left last and
+  *    must be written before the DMA enters that half again, at the first
+  *    DAC interrupt after the signal.
+  *
+  * Hooks run in virtual time order, so the code under test sees the same
+  * sequence of callbacks and pipeline passes as on the board.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_sim.h"
+#include <float.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  uint8_t active;
+  uint8_t isFrame;
+  double start;
+  double signal;                /* ADC interrupt that requested the frame */
+  double deadline;
+  double captureStart;          /* First sample of the input half in use */
+} AudioSim_Job_TypeDef;
+
+/* Private function prototypes -----------------------------------------------*/
+static double AudioSim_HostTimeUs(void);
+static void AudioSim_FinishJob(const AudioSim_Job_TypeDef *job, double finish, AudioSim_Stats_TypeDef *stats,
+                               double *startSum, double *processSum);
+
+/**
+  * @brief  Fill a configuration with the board defaults
+  * @param  config: Pointer to configuration
+  * @retval None
+  */
+void AudioSim_GetDefaultConfig(AudioSim_Config_TypeDef *config)
+{
+  memset(config, 0, sizeof(*config));
+  config->sampleRate = 48000.0f;
+  config->frameSize = 32;                 /* AUDIO_FRAME_SIZE */
+  config->cpuHz = 100000000.0f;           /* STM32F411 at 100 MHz */
+  config->cpuScale = 1.0f;
+  config->isrCycles = 150;
+  config->backgroundPeriodUs = 50000.0f;  /* UI refresh at 20 Hz */
+  config->backgroundCostUs = 0.0f;
+  config->frames = 15000;                 /* 10 s */
+}
+
+/**
+  * @brief  Run a simulation
+  * @param  config: Simulation setup
+  * @param  hooks: Code under test
+  * @param  stats: Pointer to store results
+  * @retval 0 on success, -1 on invalid setup
+  */
+int AudioSim_Run(const AudioSim_Config_TypeDef *config, const AudioSim_Hooks_TypeDef *hooks,
+                 AudioSim_Stats_TypeDef *stats)
+{
+  AudioSim_Job_TypeDef job;
+  double periodRx, periodTx, isrUs;
+  double cpuFree = 0.0;
+  double nextBackground;
+  double signalTime = 0.0;
+  double signalDeadline = 0.0;
+  double startSum = 0.0, processSum = 0.0;
+  uint32_t rxCount = 0, txCount = 0;
+  uint8_t pending = 0;
+
+  if (config == NULL || hooks == NULL || stats == NULL ||
+      config->sampleRate <= 0.0f || config->frameSize == 0U || config->cpuHz <= 0.0f) {
+    return -1;
+  }
+
+  memset(stats, 0, sizeof(*stats));
+  memset(&job, 0, sizeof(job));
+
+  periodRx = 1.0e6 * (double)config->frameSize / (double)config->sampleRate;
+  periodTx = periodRx / (1.0 + 1.0e-6 * (double)config->txDriftPpm);
+  isrUs = 1.0e6 * (double)config->isrCycles / (double)config->cpuHz;
+  nextBackground = (config->backgroundPeriodUs > 0.0f) ? (double)config->backgroundPeriodUs : -1.0;
+
+  stats->periodUs = (float)periodRx;
+  stats->slackMinUs = (float)periodTx;
+  stats->latencyMinUs = 1.0e9f;
+
+  for (;;) {
+    const double tRx = (double)(rxCount + 1U) * periodRx;
+    const double tTx = (double)config->txOffsetUs + (double)(txCount + 1U) * periodTx;
+    const uint8_t done = (stats->framesSignaled >= config->frames) ? 1 : 0;
+    const double tEvent = done ? DBL_MAX : ((tRx <= tTx) ? tRx : tTx);
+
+    /* Main loop gets the core until the next interrupt */
+    if (cpuFree <= tEvent) {
+      if (job.active) {
+        AudioSim_FinishJob(&job, cpuFree, stats, &startSum, &processSum);
+        job.active = 0;
+      }
+
+      if (pending) {
+        uint32_t cycles = 0;
+        double costUs;
+        const double t0 = AudioSim_HostTimeUs();
+        const double start = (cpuFree > signalTime) ? cpuFree : signalTime;
+
+        if (hooks->clock != NULL) {
+          hooks->clock(start);
+        }
+        if (hooks->process != NULL) {
+          cycles = hooks->process();
+        }
+        if (config->fixedCycles != 0U) {
+          cycles = config->fixedCycles;
+        }
+        costUs = (cycles != 0U) ? 1.0e6 * (double)cycles / (double)config->cpuHz
+                                : (AudioSim_HostTimeUs() - t0) * (double)config->cpuScale;
+
+        job.active = 1;
+        job.isFrame = 1;
+        job.start = start;
+        job.signal = signalTime;
+        job.deadline = signalDeadline;
+        job.captureStart = signalTime - periodRx;
+        cpuFree = job.start + costUs;
+        pending = 0;
+        stats->framesProcessed++;
+        continue;
+      }
+
+      if (!done && nextBackground >= 0.0 && nextBackground <= tEvent) {
+        job.active = 1;
+        job.isFrame = 0;
+        job.start = (cpuFree > nextBackground) ? cpuFree : nextBackground;
+        if (hooks->clock != NULL) {
+          hooks->clock(job.start);
+        }
+        if (hooks->background != NULL) {
+          hooks->background();
+        }
+        cpuFree = job.start + (double)config->backgroundCostUs;
+        nextBackground += (double)config->backgroundPeriodUs;
+        continue;
+      }
+
+      if (done) {
+        break;
+      }
+    }
+
+    /* Interrupt preempts the running job or occupies the idle core */
+    cpuFree = ((cpuFree > tEvent) ? cpuFree : tEvent) + isrUs;
+    if (hooks->clock != NULL) {
+      hooks->clock(tEvent);
+    }
+
+    if (tRx <= tTx) {
+      rxCount++;
+      stats->framesSignaled++;
+      if ((rxCount & 1U) && hooks->rxHalfComplete != NULL) {
+        hooks->rxHalfComplete();
+      } else if (!(rxCount & 1U) && hooks->rxComplete != NULL) {
+        hooks->rxComplete();
+      }
+
+      /* A second request before the first was serviced overwrites the flag */
+      if (pending) {
+        stats->framesLost++;
+      }
+      pending = 1;
+      signalTime = tRx;
+
+      /* The free DAC half is played from the next DAC interrupt on */
+      signalDeadline = (tTx > tRx) ? tTx : tTx + periodTx;
+    } else {
+      txCount++;
+      if ((txCount & 1U) && hooks->txHalfComplete != NULL) {
+        hooks->txHalfComplete();
+      } else if (!(txCount & 1U) && hooks->txComplete != NULL) {
+        hooks->txComplete();
+      }
+    }
+  }
+
+  if (stats->framesProcessed > 0U) {
+    stats->startJitterMeanUs = (float)(startSum / (double)stats->framesProcessed);
+    stats->processMeanUs = (float)(processSum / (double)stats->framesProcessed);
+  }
+  if (stats->latencyMinUs > stats->latencyMaxUs) {
+    stats->latencyMinUs = 0.0f;
+  }
+  stats->loadMaxPercent = 100.0f * stats->processMaxUs / stats->periodUs;
+
+  return 0;
+}
+
+/**
+  * @brief  Print a simulation report
+  * @param  config: Simulation setup
+  * @param  stats: Results of AudioSim_Run()
+  * @retval None
+  */
+void AudioSim_PrintReport(const AudioSim_Config_TypeDef *config, const AudioSim_Stats_TypeDef *stats)
+{
+  printf("Audio scheduling simulation\r\n");
+  printf("  %.0f Hz, %lu samples/frame, period %.2f us, CPU %.0f MHz x%.2f\r\n",
+         config->sampleRate, (unsigned long)config->frameSize, stats->periodUs,
+         config->cpuHz / 1.0e6f, config->cpuScale);
+  printf("  frames      : %lu signaled, %lu processed, %lu lost\r\n",
+         (unsigned long)stats->framesSignaled, (unsigned long)stats->framesProcessed,
+         (unsigned long)stats->framesLost);
+  printf("  deadlines   : %lu missed, min slack %.2f us\r\n",
+         (unsigned long)stats->deadlineMisses, stats->slackMinUs);
+  printf("  process     : mean %.2f us, max %.2f us (%.1f%% load)\r\n",
+         stats->processMeanUs, stats->processMaxUs, stats->loadMaxPercent);
+  printf("  start jitter: mean %.2f us, max %.2f us\r\n",
+         stats->startJitterMeanUs, stats->startJitterMaxUs);
+  printf("  I/O latency : %.2f .. %.2f us\r\n", stats->latencyMinUs, stats->latencyMaxUs);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Account a finished job
+  * @param  job: Job that just completed
+  * @param  finish: Completion time including preemption
+  * @param  stats: Statistics to update
+  * @param  startSum: Running sum of start delays
+  * @param  processSum: Running sum of durations
+  * @retval None
+  */
+static void AudioSim_FinishJob(const AudioSim_Job_TypeDef *job, double finish, AudioSim_Stats_TypeDef *stats,
+                               double *startSum, double *processSum)
+{
+  const double startDelay = job->start - job->signal;
+  const double duration = finish - job->start;
+  const double slack = job->deadline - finish;
+
+  if (!job->isFrame) {
+    return;
+  }
+
+  *startSum += startDelay;
+  *processSum += duration;
+  if (startDelay > (double)stats->startJitterMaxUs) stats->startJitterMaxUs = (float)startDelay;
+  if (duration > (double)stats->processMaxUs) stats->processMaxUs = (float)duration;
+  if (slack < (double)stats->slackMinUs) stats->slackMinUs = (float)slack;
+
+  if (slack < 0.0) {
+    stats->deadlineMisses++;
+    return;
+  }
+
+  /* Output of an on-time frame starts playing at its deadline */
+  if (job->captureStart >= 0.0) {
+    const double latency = job->deadline - job->captureStart;
+
+    if (latency > (double)stats->latencyMaxUs) stats->latencyMaxUs = (float)latency;
+    if (latency < (double)stats->latencyMinUs) stats->latencyMinUs = (float)latency;
+  }
+}
+
+/**
+  * @brief  Monotonic host time
+  * @retval Time in microseconds
+  */
+static double AudioSim_HostTimeUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1.0e6 * (double)ts.tv_sec + 1.0e-3 * (double)ts.tv_nsec;
+}
@@ -0,0 +1,261 @@
+/**
+  ******************************************************************************
+  * @file           : sim_hal.c
+  * @brief          : Host stand-in for the STM32F4 HAL (simulator build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Replaces the HAL library and the board files that program peripherals
+  * (Core/Src/i2s.c, dma.c, gpio.c, ...). The I2S handles and the lockstep
+  * DAC start live here, the DMA interrupts come from audio_sim.
+  *
+  * The cycle counter runs on virtual time: audio_sim sets the time before
+  * every hook, and while a hook runs the counter advances with host time
+  * scaled to the target, so cycle measurements in the firmware (frame
+  * slack, stage costs) see the same clock as the simulation.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+#include "i2s.h"
+#include <time.h>
+
+/* Private variables ---------------------------------------------------------*/
+SPI_TypeDef SimHal_SPI2 = { 2U };
+SPI_TypeDef SimHal_SPI3 = { 3U };
+SPI_TypeDef SimHal_SPI4 = { 4U };
+TIM_TypeDef SimHal_TIM6 = { 6U };
+GPIO_TypeDef SimHal_GPIOA, SimHal_GPIOB, SimHal_GPIOC;
+CoreDebug_Type SimHal_CoreDebug;
+uint32_t SystemCoreClock = 100000000U;
+
+I2S_HandleTypeDef hi2s2 = { .Instance = &SimHal_SPI2, .State = HAL_I2S_STATE_READY };
+I2S_HandleTypeDef hi2s3 = { .Instance = &SimHal_SPI3, .State = HAL_I2S_STATE_READY };
+I2S_HandleTypeDef hi2s4 = { .Instance = &SimHal_SPI4, .State = HAL_I2S_STATE_READY };
+
+static DWT_Type simDwt;
+static double simCyclesPerUs = 100.0;     /* Target cycles per microsecond */
+static double simScale = 1.0;             /* Target time per unit of host time */
+static double simTimeUs;                  /* Virtual time at the last SetTime */
+static double simHostUs;                  /* Host time at the last SetTime */
+
+/* Private function prototypes -----------------------------------------------*/
+static double SimHal_HostTimeUs(void);
+static double SimHal_NowUs(void);
+
+/**
+  * @brief  Reset the virtual clock
+  * @retval HAL status
+  */
+HAL_StatusTypeDef HAL_Init(void)
+{
+  SimHal_SetTime(0.0);
+  return HAL_OK;
+}
+
+/**
+  * @brief  Milliseconds of virtual time
+  * @retval Tick count
+  */
+uint32_t HAL_GetTick(void)
+{
+  return (uint32_t)(SimHal_NowUs() / 1000.0);
+}
+
+/**
+  * @brief  Delays are skipped, virtual time only moves with the simulation
+  * @param  Delay: Milliseconds
+  * @retval None
+  */
+void HAL_Delay(uint32_t Delay)
+{
+  (void)Delay;
+}
+
+/**
+  * @brief  Pins need no setup on the host
+  */
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+  (void)GPIOx;
+  (void)GPIO_Init;
+}
+
+/**
+  * @brief  Latch a pin level so it can be read back
+  */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+  if (PinState == GPIO_PIN_SET) {
+    GPIOx->ODR |= GPIO_Pin;
+  } else {
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+  }
+}
+
+/**
+  * @brief  Read back a latched pin level
+  */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+  return ((GPIOx->ODR & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/**
+  * @brief  Mark a stream ready
+  */
+HAL_StatusTypeDef HAL_I2S_Init(I2S_HandleTypeDef *hi2s)
+{
+  hi2s->State = HAL_I2S_STATE_READY;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Mark a stream reset
+  */
+HAL_StatusTypeDef HAL_I2S_DeInit(I2S_HandleTypeDef *hi2s)
+{
+  hi2s->State = HAL_I2S_STATE_RESET;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Mark a DAC stream running, its interrupts come from audio_sim
+  */
+HAL_StatusTypeDef HAL_I2S_Transmit_DMA(I2S_HandleTypeDef *hi2s, uint16_t *pData, uint16_t Size)
+{
+  (void)pData;
+  (void)Size;
+  hi2s->State = HAL_I2S_STATE_BUSY_TX;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Mark the ADC stream running, its interrupts come from audio_sim
+  */
+HAL_StatusTypeDef HAL_I2S_Receive_DMA(I2S_HandleTypeDef *hi2s, uint16_t *pData, uint16_t Size)
+{
+  (void)pData;
+  (void)Size;
+  hi2s->State = HAL_I2S_STATE_BUSY_RX;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Mark a stream stopped
+  */
+HAL_StatusTypeDef HAL_I2S_DMAStop(I2S_HandleTypeDef *hi2s)
+{
+  hi2s->State = HAL_I2S_STATE_READY;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Timers do not run, the UI tick is a simulator hook
+  */
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+  (void)htim;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Start both DAC streams, the simulated ones never skew
+  * @param  dac1Buffer: DMA buffer of I2S3
+  * @param  dac2Buffer: DMA buffer of I2S4
+  * @param  size: Words per buffer
+  * @retval HAL status
+  */
+HAL_StatusTypeDef I2S_StartOutputsLockstep(int32_t *dac1Buffer, int32_t *dac2Buffer, uint16_t size)
+{
+  if (HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t *)dac1Buffer, size) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  return HAL_I2S_Transmit_DMA(&hi2s4, (uint16_t *)dac2Buffer, size);
+}
+
+/**
+  * @brief  Skew between the DAC streams
+  * @param  size: Words per buffer
+  * @retval Always 0
+  */
+int32_t I2S_GetOutputSkew(uint16_t size)
+{
+  (void)size;
+  return 0;
+}
+
+/**
+  * @brief  Board setup of the replaced Core/Src files, nothing to program here
+  */
+void MX_GPIO_Init(void) {}
+void MX_DMA_Init(void) {}
+void MX_I2C1_Init(void) {}
+void MX_I2S2_Init(void) {}
+void MX_I2S3_Init(void) {}
+void MX_SPI1_Init(void) {}
+void MX_TIM6_Init(void) {}
+void MX_TIM3_Init(void) {}
+void MX_USART1_UART_Init(void) {}
+
+/**
+  * @brief  Cycle counter at the current virtual time
+  * @retval DWT registers
+  */
+DWT_Type *SimHal_GetDWT(void)
+{
+  simDwt.CYCCNT = (uint32_t)(uint64_t)(SimHal_NowUs() * simCyclesPerUs);
+  return &simDwt;
+}
+
+/**
+  * @brief  Target clock used by the cycle counter and SystemCoreClock
+  * @param  cpuHz: Target core clock
+  * @param  cpuScale: Target time per unit of host time
+  * @retval None
+  */
+void SimHal_SetClock(float cpuHz, float cpuScale)
+{
+  simCyclesPerUs = (double)cpuHz * 1.0e-6;
+  simScale = (double)cpuScale;
+  SystemCoreClock = (uint32_t)cpuHz;
+}
+
+/**
+  * @brief  Move the virtual clock, called by the simulator before each hook
+  * @param  timeUs: Virtual time in microseconds
+  * @retval None
+  */
+void SimHal_SetTime(double timeUs)
+{
+  simTimeUs = timeUs;
+  simHostUs = SimHal_HostTimeUs();
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Virtual time, advancing with scaled host time inside a hook
+  * @retval Time in microseconds
+  */
+static double SimHal_NowUs(void)
+{
+  return simTimeUs + (SimHal_HostTimeUs() - simHostUs) * simScale;
+}
+
+/**
+  * @brief  Monotonic host time
+  * @retval Time in microseconds
+  */
+static double SimHal_HostTimeUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1.0e6 * (double)ts.tv_sec + 1.0e-3 * (double)ts.tv_nsec;
+}
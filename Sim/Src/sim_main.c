@@ -0,0 +1,167 @@
+/**
+  ******************************************************************************
+  * @file           : sim_main.c
+  * @brief          : Host entry point driving the firmware through audio_sim
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Built by Sim/Makefile together with the firmware sources that build on
+  * the host and -DAUDIO_SIM against the host HAL in sim_hal.c. The
+  * simulator calls the I2S callbacks of hi2s2 / hi2s3 and the audio part of
+  * the main loop in virtual time, both provided by the host audio path in
+  * sim_pipeline.c. DWT->CYCCNT and HAL_GetTick() follow the same virtual
+  * clock.
+  *
+  * Usage: audio_sim [-n frames] [-s cpuScale] [-c fixedCycles] [-i isrCycles]
+  *                  [-o txOffsetUs] [-p txDriftPpm] [-b backgroundCostUs]
+  *
+  * cpuScale converts host time into target time, calibrate it once by
+  * comparing SystemState.dspLoadPercent on the board with a host run.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_sim.h"
+#include "sim_pipeline.h"
+#include "main.h"
+#include "i2s.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_TONE_HZ               1000.0f   /* ADC test tone */
+#define SIM_TONE_DB               -12.0f
+
+/* Private function prototypes -----------------------------------------------*/
+static void Sim_RxHalfComplete(void);
+static void Sim_RxComplete(void);
+static void Sim_TxHalfComplete(void);
+static void Sim_TxComplete(void);
+static uint32_t Sim_Process(void);
+static void Sim_Clock(double timeUs);
+
+/**
+  * @brief  Simulator entry point
+  * @param  argc: Argument count
+  * @param  argv: Arguments
+  * @retval 0 if no deadline was missed and every output carried the tone,
+  *         1 otherwise, 2 on usage error
+  */
+int main(int argc, char **argv)
+{
+  AudioSim_Config_TypeDef config;
+  AudioSim_Stats_TypeDef stats;
+  AudioSim_Hooks_TypeDef hooks;
+  SimPipeline_Stats_TypeDef pipeline;
+
+  AudioSim_GetDefaultConfig(&config);
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char *opt = argv[i];
+    const char *val = argv[i + 1];
+
+    if (strcmp(opt, "-n") == 0) {
+      config.frames = (uint32_t)strtoul(val, NULL, 0);
+    } else if (strcmp(opt, "-s") == 0) {
+      config.cpuScale = strtof(val, NULL);
+    } else if (strcmp(opt, "-c") == 0) {
+      config.fixedCycles = (uint32_t)strtoul(val, NULL, 0);
+    } else if (strcmp(opt, "-i") == 0) {
+      config.isrCycles = (uint32_t)strtoul(val, NULL, 0);
+    } else if (strcmp(opt, "-o") == 0) {
+      config.txOffsetUs = strtof(val, NULL);
+    } else if (strcmp(opt, "-p") == 0) {
+      config.txDriftPpm = strtof(val, NULL);
+    } else if (strcmp(opt, "-b") == 0) {
+      config.backgroundCostUs = strtof(val, NULL);
+    } else {
+      fprintf(stderr, "Unknown option %s\n", opt);
+      return 2;
+    }
+  }
+
+  memset(&hooks, 0, sizeof(hooks));
+  hooks.rxHalfComplete = Sim_RxHalfComplete;
+  hooks.rxComplete = Sim_RxComplete;
+  hooks.txHalfComplete = Sim_TxHalfComplete;
+  hooks.txComplete = Sim_TxComplete;
+  hooks.process = Sim_Process;
+  hooks.clock = Sim_Clock;
+
+  HAL_Init();
+  SimHal_SetClock(config.cpuHz, config.cpuScale);
+  SimPipeline_Init(SIM_TONE_HZ, SIM_TONE_DB);
+
+  if (AudioSim_Run(&config, &hooks, &stats) != 0) {
+    fprintf(stderr, "Invalid simulation setup\n");
+    return 2;
+  }
+
+  AudioSim_PrintReport(&config, &stats);
+  SimPipeline_PrintReport();
+  SimPipeline_GetStats(&pipeline);
+
+  return (stats.deadlineMisses != 0U || stats.framesLost != 0U || pipeline.silentOutputs != 0U) ? 1 : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  ADC DMA half transfer
+  * @retval None
+  */
+static void Sim_RxHalfComplete(void)
+{
+  HAL_I2S_RxHalfCpltCallback(&hi2s2);
+}
+
+/**
+  * @brief  ADC DMA full transfer
+  * @retval None
+  */
+static void Sim_RxComplete(void)
+{
+  HAL_I2S_RxCpltCallback(&hi2s2);
+}
+
+/**
+  * @brief  DAC DMA half transfer
+  * @retval None
+  */
+static void Sim_TxHalfComplete(void)
+{
+  HAL_I2S_TxHalfCpltCallback(&hi2s3);
+}
+
+/**
+  * @brief  DAC DMA full transfer
+  * @retval None
+  */
+static void Sim_TxComplete(void)
+{
+  HAL_I2S_TxCpltCallback(&hi2s3);
+}
+
+/**
+  * @brief  Audio pass of the main loop
+  * @retval 0, cost is measured on the host
+  */
+static uint32_t Sim_Process(void)
+{
+  SimPipeline_Service();
+  return 0;
+}
+
+/**
+  * @brief  Move the firmware clock to the virtual time of the next hook
+  * @param  timeUs: Virtual time in microseconds
+  * @retval None
+  */
+static void Sim_Clock(double timeUs)
+{
+  SimHal_SetTime(timeUs);
+}
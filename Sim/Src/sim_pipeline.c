@@ -0,0 +1,340 @@
+/**
+  ******************************************************************************
+  * @file           : sim_pipeline.c
+  * @brief          : Host audio path driven by the simulator (host build)
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Takes the place of audio_driver.c and the audio part of main.c in the
+  * host build, see sim_pipeline.h. The ADC is a sine generator writing the
+  * slot the Rx stream is in, the DAC slots are only converted and metered.
+  *
+  * Host only, not part of the firmware image.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim_pipeline.h"
+#include "main.h"
+#include "i2s.h"
+#include "audio_config.h"
+#include "dma_slots.h"
+#include "param_snapshot.h"
+#include "cpu_budget.h"
+#include "input_gate.h"
+#include "compressor.h"
+#include "level_stats.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+/* Same layout as audio_driver.c, one slot per DMA half; only the I2S3 DAC
+   is modelled, I2S4 runs in lockstep with it on the board */
+#define SIM_SLOT_COUNT            2U
+#define SIM_DAC_CHANNELS          2U
+#define SIM_INPUT_SLOT_WORDS      (AUDIO_FRAME_SIZE * AUDIO_INPUT_CHANNELS)
+#define SIM_OUTPUT_SLOT_WORDS     (AUDIO_FRAME_SIZE * SIM_DAC_CHANNELS)
+
+#define SIM_FULL_SCALE            8388607.0f    /* 2^23 - 1, 24-bit in a 32-bit word */
+#define SIM_TONE_FLOOR            0.001f        /* Below this an output counts as silent */
+
+/* Private variables ---------------------------------------------------------*/
+static int32_t inputDmaBuffer[SIM_INPUT_SLOT_WORDS * SIM_SLOT_COUNT];
+static int32_t dacDmaBuffer[SIM_OUTPUT_SLOT_WORDS * SIM_SLOT_COUNT];
+static DMA_Slots_TypeDef inputSlots;
+static DMA_Slots_TypeDef outputSlots;
+
+static AudioBuffer_TypeDef inputBuffer;
+static AudioBuffer_TypeDef outputBuffer;
+
+static volatile uint8_t frameFlag;
+static uint32_t framesProcessed;
+static float outputPeak[AUDIO_OUTPUT_CHANNELS];
+
+static float tonePhase;
+static float tonePhaseStep;
+static float toneAmplitude;
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimPipeline_Capture(void);
+static void SimPipeline_ProcessFrame(void);
+static void SimPipeline_Convert(const int32_t *slot, AudioBuffer_TypeDef *buffer);
+static void SimPipeline_Output(int32_t *slot, const AudioBuffer_TypeDef *buffer);
+
+/**
+  * @brief  Initialize the host audio path and its stages
+  * @note   Call after SimHal_SetClock, the CPU budget takes the frame
+  *         cycles from SystemCoreClock
+  * @param  toneHz: Frequency of the ADC test tone
+  * @param  toneDb: Level of the ADC test tone in dBFS
+  * @retval None
+  */
+void SimPipeline_Init(float toneHz, float toneDb)
+{
+  memset(inputDmaBuffer, 0, sizeof(inputDmaBuffer));
+  memset(dacDmaBuffer, 0, sizeof(dacDmaBuffer));
+  DMA_Slots_Init(&inputSlots, inputDmaBuffer, SIM_INPUT_SLOT_WORDS, SIM_SLOT_COUNT, DMA_SLOTS_RX);
+  DMA_Slots_Init(&outputSlots, dacDmaBuffer, SIM_OUTPUT_SLOT_WORDS, SIM_SLOT_COUNT, DMA_SLOTS_TX);
+
+  ParamSnapshot_Init();
+  CpuBudget_Init();
+  InputGate_Init((float)AUDIO_SAMPLE_RATE);
+  DSP_Compressor_Init((float)AUDIO_SAMPLE_RATE);
+  LevelStats_Init((float)AUDIO_SAMPLE_RATE);
+
+  frameFlag = 0;
+  framesProcessed = 0;
+  memset(outputPeak, 0, sizeof(outputPeak));
+
+  tonePhase = 0.0f;
+  tonePhaseStep = 2.0f * (float)M_PI * toneHz / (float)AUDIO_SAMPLE_RATE;
+  toneAmplitude = powf(10.0f, toneDb / 20.0f);
+}
+
+/**
+  * @brief  Audio part of one main loop pass
+  * @note   Same order as Audio_MainLoopService: the frame first, then the
+  *         control-rate services
+  * @retval None
+  */
+void SimPipeline_Service(void)
+{
+  if (frameFlag) {
+    frameFlag = 0;
+    SimPipeline_ProcessFrame();
+  }
+
+  /* Calibrate the cost model from the last measured frames */
+  CpuBudget_Update();
+}
+
+/**
+  * @brief  Get the counters of the run so far
+  * @param  stats: Pointer to statistics
+  * @retval None
+  */
+void SimPipeline_GetStats(SimPipeline_Stats_TypeDef *stats)
+{
+  DMA_Slots_Stats_TypeDef in;
+  DMA_Slots_Stats_TypeDef out;
+
+  DMA_Slots_GetStats(&inputSlots, &in);
+  DMA_Slots_GetStats(&outputSlots, &out);
+
+  memset(stats, 0, sizeof(*stats));
+  stats->framesProcessed = framesProcessed;
+  stats->inputLate = in.lateFrames;
+  stats->inputDropped = in.droppedFrames;
+  stats->outputLate = out.lateFrames;
+  stats->outputReplayed = out.droppedFrames;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    if (outputPeak[ch] < SIM_TONE_FLOOR) {
+      stats->silentOutputs++;
+    }
+  }
+}
+
+/**
+  * @brief  Print the DMA ring counters, CPU budget and output levels
+  * @retval None
+  */
+void SimPipeline_PrintReport(void)
+{
+  SimPipeline_Stats_TypeDef stats;
+  CpuBudget_Report_TypeDef budget;
+  LevelStats_Summary_TypeDef level;
+
+  SimPipeline_GetStats(&stats);
+  CpuBudget_GetReport(&budget);
+
+  printf("Host audio path\r\n");
+  printf("  frames      : %lu processed\r\n", (unsigned long)stats.framesProcessed);
+  printf("  ADC slots   : %lu late, %lu dropped\r\n",
+         (unsigned long)stats.inputLate, (unsigned long)stats.inputDropped);
+  printf("  DAC slots   : %lu late, %lu replayed\r\n",
+         (unsigned long)stats.outputLate, (unsigned long)stats.outputReplayed);
+  printf("  CPU budget  : %u%% headroom\r\n", (unsigned)CpuBudget_GetHeadroomPercent());
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    LevelStats_GetSummary(ch, &level);
+    printf("  output %u    : peak %.1f dBFS, rms %.1f dBFS\r\n",
+           (unsigned)(ch + 1U), level.peakMaxDb, level.rmsDb);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Write the next half of the test tone into the slot the ADC is in
+  * @retval None
+  */
+static void SimPipeline_Capture(void)
+{
+  int32_t *slot = inputSlots.base + (uint32_t)inputSlots.dmaSlot * inputSlots.slotWords;
+
+  for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+    const int32_t sample = (int32_t)(toneAmplitude * sinf(tonePhase) * SIM_FULL_SCALE);
+
+    for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+      slot[i * AUDIO_INPUT_CHANNELS + ch] = sample;
+    }
+
+    tonePhase += tonePhaseStep;
+    if (tonePhase >= 2.0f * (float)M_PI) {
+      tonePhase -= 2.0f * (float)M_PI;
+    }
+  }
+}
+
+/**
+  * @brief  Run one frame through the host audio path
+  * @retval None
+  */
+static void SimPipeline_ProcessFrame(void)
+{
+  const int32_t *in;
+  int32_t *out;
+
+  ParamSnapshot_AcquireFrame();
+  CpuBudget_BeginFrame();
+
+  /* Take the half the ADC just finished */
+  in = DMA_Slots_Acquire(&inputSlots);
+  if (in == NULL) {
+    return;
+  }
+  SimPipeline_Convert(in, &inputBuffer);
+  DMA_Slots_Release(&inputSlots);
+
+  /* Gate idle inputs before they reach the outputs */
+  InputGate_Process(&inputBuffer);
+
+  /* Fixed routing, outputs 1/3 from the left input and 2/4 from the right */
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    memcpy(outputBuffer.samples[ch], inputBuffer.samples[ch % AUDIO_INPUT_CHANNELS],
+           AUDIO_FRAME_SIZE * sizeof(float));
+  }
+  CpuBudget_Mark(CPUBUDGET_STAGE_FIXED);
+
+  DSP_Compressor_ProcessAll(&outputBuffer);
+  CpuBudget_Mark(CPUBUDGET_STAGE_COMPRESSOR);
+
+  /* Take the half the DAC plays next */
+  out = DMA_Slots_Acquire(&outputSlots);
+  if (out != NULL) {
+    SimPipeline_Output(out, &outputBuffer);
+    DMA_Slots_Release(&outputSlots);
+  }
+
+  CpuBudget_EndFrame();
+  framesProcessed++;
+}
+
+/**
+  * @brief  Convert an interleaved int24 slot into the float buffer
+  * @param  slot: Owned input slot
+  * @param  buffer: Pointer to audio buffer
+  * @retval None
+  */
+static void SimPipeline_Convert(const int32_t *slot, AudioBuffer_TypeDef *buffer)
+{
+  const float *gain = ParamSnapshot_Frame()->inputGain;
+
+  for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+    for (uint8_t ch = 0; ch < AUDIO_INPUT_CHANNELS; ch++) {
+      buffer->samples[ch][i] = (float)slot[i * AUDIO_INPUT_CHANNELS + ch] / SIM_FULL_SCALE * gain[ch];
+    }
+  }
+}
+
+/**
+  * @brief  Meter every output and write outputs 1-2 into the DAC slot
+  * @param  slot: Owned output slot
+  * @param  buffer: Pointer to audio buffer
+  * @retval None
+  */
+static void SimPipeline_Output(int32_t *slot, const AudioBuffer_TypeDef *buffer)
+{
+  const float *gain = ParamSnapshot_Frame()->outputGain;
+
+  for (uint8_t ch = 0; ch < AUDIO_OUTPUT_CHANNELS; ch++) {
+    float peak = 0.0f;
+    float sum = 0.0f;
+    uint32_t clips = 0;
+
+    for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+      const float y = buffer->samples[ch][i] * gain[ch];
+      const float magnitude = fabsf(y);
+
+      sum += y * y;
+      peak = (magnitude > peak) ? magnitude : peak;
+      clips += (magnitude >= 1.0f) ? 1U : 0U;
+
+      if (ch < SIM_DAC_CHANNELS) {
+        slot[i * SIM_DAC_CHANNELS + ch] = (int32_t)(fmaxf(-1.0f, fminf(1.0f, y)) * SIM_FULL_SCALE);
+      }
+    }
+
+    LevelStats_Update(ch, peak, sum, clips);
+    outputPeak[ch] = (peak > outputPeak[ch]) ? peak : outputPeak[ch];
+  }
+}
+
+/* I2S DMA Callbacks ---------------------------------------------------------*/
+
+/**
+  * @brief  I2S Rx Half Complete callback
+  * @param  hi2s: I2S handle
+  * @retval None
+  */
+void HAL_I2S_RxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  if (hi2s->Instance == SPI2) {
+    SimPipeline_Capture();
+    DMA_Slots_Advance(&inputSlots);
+    frameFlag = 1;
+  }
+}
+
+/**
+  * @brief  I2S Rx Complete callback
+  * @param  hi2s: I2S handle
+  * @retval None
+  */
+void HAL_I2S_RxCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  if (hi2s->Instance == SPI2) {
+    SimPipeline_Capture();
+    DMA_Slots_Advance(&inputSlots);
+    frameFlag = 1;
+  }
+}
+
+/**
+  * @brief  I2S Tx Half Complete callback
+  * @param  hi2s: I2S handle
+  * @retval None
+  */
+void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  if (hi2s->Instance == SPI3) {
+    DMA_Slots_Advance(&outputSlots);
+  }
+}
+
+/**
+  * @brief  I2S Tx Complete callback
+  * @param  hi2s: I2S handle
+  * @retval None
+  */
+void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s)
+{
+  if (hi2s->Instance == SPI3) {
+    DMA_Slots_Advance(&outputSlots);
+  }
+}
@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file           : check_auto_eq.c
+  * @brief          : Host check, a fitted AutoEQ result reaches the EQ output
+  * @author         : asepsupriatna90
+  * @version        : 1.0.0
+  ******************************************************************************
+  * @attention
+  *
+  * Fits a measured +6 dB bump at 1 kHz against a flat target with apply set,
+  * then runs a 1 kHz tone through DSP_EQ_Process, the wrapper the main loop
+  * calls. The fitted cut must be in the PEQ and take the bump back out of
+  * the tone; another output must stay untouched.
+  *
+  * Run by make -C Sim check. Host only, not part of the firmware image.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "audio_config.h"
+#include "auto_eq.h"
+#include "peq.h"
+#include "coeff_batch.h"
+#include "response_cache.h"
+#include "cpu_budget.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CHECK_CHANNEL             1U
+#define CHECK_OTHER_CHANNEL       2U
+#define CHECK_BUMP_HZ             1000.0f
+#define CHECK_BUMP_DB             6.0f
+#define CHECK_FRAMES              200U      /* About 130 ms of tone */
+#define CHECK_SETTLE_FRAMES       50U       /* Filter transient, not measured */
+
+/* Private function prototypes -----------------------------------------------*/
+static float Check_ToneGainDb(uint8_t channel);
+
+/**
+  * @brief  Check entry point
+  * @retval 0 on success, 1 on failure
+  */
+int main(void)
+{
+  static float measuredDb[AUTOEQ_GRID_POINTS];
+  AutoEQ_Config_TypeDef config;
+  AutoEQ_Result_TypeDef result;
+  PEQBand_TypeDef band;
+  uint8_t enabled = 0;
+  float before;
+  float after;
+  float other;
+
+  HAL_Init();
+  SimHal_SetClock(100000000.0f, 1.0f);
+  CoeffBatch_Init((float)AUDIO_SAMPLE_RATE);
+  ResponseCache_Init((float)AUDIO_SAMPLE_RATE);
+  CpuBudget_Init();
+  PEQ_Init();
+
+  /* Bell-shaped bump, one octave wide */
+  for (uint32_t i = 0; i < AUTOEQ_GRID_POINTS; i++) {
+    const float octaves = log2f(AutoEQ_GetGridFrequency(i) / CHECK_BUMP_HZ);
+
+    measuredDb[i] = CHECK_BUMP_DB * expf(-2.0f * octaves * octaves);
+  }
+
+  before = Check_ToneGainDb(CHECK_CHANNEL);
+
+  AutoEQ_GetDefaultConfig(&config);
+  config.channel = CHECK_CHANNEL;
+  config.firstBand = 0;
+  config.bandCount = 3;
+  config.apply = 1;
+  config.fitLowHz = 100.0f;
+  config.fitHighHz = 10000.0f;
+
+  if (AutoEQ_Start(&config, measuredDb, NULL) != HAL_OK) {
+    printf("FAIL: AutoEQ_Start refused the job\r\n");
+    return 1;
+  }
+
+  while (AutoEQ_Service(AUTOEQ_SERVICE_CYCLES) != AUTOEQ_DONE) {
+    if (AutoEQ_GetState() != AUTOEQ_PICKING && AutoEQ_GetState() != AUTOEQ_REFINING) {
+      printf("FAIL: fit ended in state %d\r\n", (int)AutoEQ_GetState());
+      return 1;
+    }
+  }
+
+  AutoEQ_GetResult(&result);
+
+  for (uint8_t b = 0; b < config.bandCount; b++) {
+    if (PEQ_GetBandConfig(CHECK_CHANNEL, b, &band) == HAL_OK && band.enabled) {
+      enabled++;
+    }
+  }
+
+  after = Check_ToneGainDb(CHECK_CHANNEL);
+  other = Check_ToneGainDb(CHECK_OTHER_CHANNEL);
+
+  printf("AutoEQ: %u bands, error %.2f -> %.2f dB RMS, %u enabled in the PEQ\r\n",
+         (unsigned)result.bandsUsed, result.initialRmsDb, result.finalRmsDb, (unsigned)enabled);
+  printf("1 kHz through DSP_EQ_Process: %.2f dB before, %.2f dB after, other output %.2f dB\r\n",
+         before, after, other);
+
+  if (result.bandsUsed == 0U || enabled != result.bandsUsed) {
+    printf("FAIL: fitted bands are not enabled in the PEQ\r\n");
+    return 1;
+  }
+
+  if (fabsf(before) > 0.01f || fabsf(after + CHECK_BUMP_DB) > 1.0f || fabsf(other) > 0.01f) {
+    printf("FAIL: EQ output does not follow the fit\r\n");
+    return 1;
+  }
+
+  printf("PASS\r\n");
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  Gain of the EQ on a settled 1 kHz tone
+  * @param  channel: Output channel to measure
+  * @retval Output over input RMS in dB
+  */
+static float Check_ToneGainDb(uint8_t channel)
+{
+  static AudioBuffer_TypeDef buffer;
+  const float step = 2.0f * (float)M_PI * CHECK_BUMP_HZ / (float)AUDIO_SAMPLE_RATE;
+  double in = 0.0;
+  double out = 0.0;
+  uint32_t n = 0;
+
+  PEQ_ResetState(channel);
+
+  for (uint32_t frame = 0; frame < CHECK_FRAMES; frame++) {
+    float x[AUDIO_FRAME_SIZE];
+
+    for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++, n++) {
+      x[i] = 0.5f * sinf(step * (float)n);
+      buffer.samples[channel][i] = x[i];
+    }
+
+    DSP_EQ_Process(channel, &buffer);
+
+    if (frame >= CHECK_SETTLE_FRAMES) {
+      for (uint32_t i = 0; i < AUDIO_FRAME_SIZE; i++) {
+        in += (double)x[i] * x[i];
+        out += (double)buffer.samples[channel][i] * buffer.samples[channel][i];
+      }
+    }
+  }
+
+  return 10.0f * log10f((float)(out / in));
+}